@@ -0,0 +1,71 @@
+/*
+ * cmd_shell.h
+ * 串口命令解释器：表驱动，运行中调整采集与驱动参数，不必为每次改动重新烧录
+ *
+ * 说明：命令行由 usart_debug 的命令队列按行提供，cmd_shell_poll() 在主循环中逐条取出执行，
+ * 所有 HAL / I2C 操作都在主循环上下文完成。解析就地切分参数，不使用堆。
+ * 命令格式：名称 + 空格分隔的参数，数值可写十进制或 0x 十六进制；U 为芯片编号 0..1 或 *（全部）。
+ *   help | h | ?             命令列表与当前状态
+ *   stat                     各芯片配置与故障统计
+ *   rd U REG                 读 FDC2214 寄存器
+ *   wr U REG VAL             写 FDC2214 寄存器（配置寄存器同步影子缓存）
+ *   sps U RATE               目标采样率（每通道 SPS），重新规划 RCOUNT
+ *   seq U 2|3|4|c0..c3       扫描通道数，或单通道连续转换
+ *   prof U NAME              采样预设（见 cmd_shell.c 中 s_profiles）
+ *   stream off|text|bin      样本输出：停止 / 抽取后的文本 / 每组一帧二进制遥测
+ *   dec N                    文本输出抽取因子（每 N 组样本打印一次）
+ *   filt [KEY VAL | reset]   基线跟踪参数 ema|touch|release|step|freeze，reset 重新起算
+ *   duty PCT                 TIM2 CH1 占空比 0..100，可带 3 位小数
+ *   pwmf HZ                  TIM2 PWM 载波频率
+ *   freq HZ                  TIM3 振动频率，可带 3 位小数（如 175.35），0 停止；波形模式下限约 4.3 Hz
+ *   dead US                  IN1/IN2 换向死区（us）
+ *   dither on|off            TIM3 小数 tick 抖动
+ *   wave off|NAME            驱动波形：方波，或 drive_wave.c 中的幅度表（sine / tri / trap）
+ *   sweep U:CH|adc F0 F1 STEP [SETTLE_MS [MEAS_MS]]
+ *                            LRA 扫频：F0..F1 Hz 每 STEP Hz 一点（可带 3 位小数），测量 FDC 通道或 ADC1 的
+ *                            响应幅度 / 相位，结束后驱动停在谐振点（lra_sweep.h）；sweep stop 中止，
+ *                            不带参数显示上次结果
+ *   track U:CH|adc [DEG [GAIN]]
+ *                            谐振跟踪：从当前驱动频率起持续微调，使响应相位保持在 DEG（默认 -90°，
+ *                            可带 1 位小数），GAIN 为每 1° 误差调整的 mHz（lra_track.h）；track off 停止，
+ *                            不带参数显示跟踪状态
+ * 兼容原 HandleTIM3Command 的简写：纯数字为占空比，"f20" 为 TIM3 频率。
+ * 增加命令：在 cmd_shell.c 的 s_cmds 表中加一行并实现处理函数。
+ */
+
+#ifndef __CMD_SHELL_H__
+#define __CMD_SHELL_H__
+
+#include <stdint.h>
+#include "fdc2214.h"
+#include "fdc_baseline.h"
+
+/* 样本输出方式 */
+typedef enum {
+    CMD_STREAM_OFF = 0,
+    CMD_STREAM_TEXT = 1,
+    CMD_STREAM_BINARY = 2,
+} cmd_stream_t;
+
+/* 命令可修改的主循环运行参数与对象，由 main 在初始化时提供 */
+typedef struct {
+    fdc_dev_t *const *dev;          /* 芯片句柄数组 */
+    const uint8_t *dev_ok;          /* 初始化成功的芯片 */
+    fdc_baseline_t *baseline;       /* 每片芯片的基线跟踪器 */
+    uint8_t dev_count;
+    uint8_t stream;                 /* cmd_stream_t */
+    uint16_t decimation;            /* 文本输出抽取因子，>= 1 */
+    /* 芯片采样配置改变后调用（重算换算常数、重置基线等），可为 NULL */
+    void (*on_reconfig)(uint8_t u);
+} cmd_shell_ctx_t;
+
+/* 绑定运行上下文；ctx 在整个运行期间须保持有效 */
+void cmd_shell_init(cmd_shell_ctx_t *ctx);
+
+/* 执行一行命令；line 会被就地切分 */
+void cmd_shell_exec(char *line);
+
+/* 主循环调用：取出命令队列中的全部命令并执行 */
+void cmd_shell_poll(void);
+
+#endif /* __CMD_SHELL_H__ */
@@ -0,0 +1,31 @@
+/*
+ * drive_wave.h
+ * LRA 驱动波形表：TIM2 CH1 占空比在半个驱动周期内的幅度包络（tim_control.h 的波形模式使用）
+ *
+ * 说明：极性由 IN1/IN2 换向给出，表只描述幅度，取值 Q15（32768 = 满幅，即当前设定的占空比）。
+ * 每个样本占一个 TIM2 PWM 周期，半个驱动周期正好 len 个样本，所以 PWM 载波 = 2 × len × 驱动频率。
+ * 表为 const，链接在 Flash；增加波形：在 drive_wave.c 中加一个数组并登记到 drive_waves[]。
+ */
+
+#ifndef __DRIVE_WAVE_H__
+#define __DRIVE_WAVE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* 单张表的最大样本数（决定 tim_control.c 中 DMA 缓冲区的大小） */
+#define DRIVE_WAVE_LEN_MAX  128U
+
+typedef struct {
+    const char *name;
+    const uint16_t *table;      /* Q15 幅度，len 个 */
+    uint16_t len;               /* 2..DRIVE_WAVE_LEN_MAX */
+} drive_wave_t;
+
+extern const drive_wave_t drive_waves[];
+extern const uint8_t drive_wave_count;
+
+/* 按名称查找，找不到返回 NULL */
+const drive_wave_t *drive_wave_find(const char *name);
+
+#endif /* __DRIVE_WAVE_H__ */
@@ -3,7 +3,8 @@
  * FDC2214 capacitive sensing IC driver (header)
  *
  * 说明：基于 TI FDC2214 数据手册实现的简易驱动头文件。
- * 使用 STM32 HAL 的 I2C 句柄 `hi2c1`。
+ * 每片芯片由一个 fdc_dev_t 句柄描述（I2C 句柄、地址、INTB 引脚、影子缓存与异步采集状态），
+ * 同一 I2C 总线上可挂两片（ADDR 引脚分别接低/高，地址 0x2A/0x2B），共 8 个通道。
  * 请根据手册校对寄存器常量（这里已填入常见值）。
  */
 
@@ -11,12 +12,15 @@
 #define __FDC2214_H__
 
 #include "main.h"
+#include "fdc_config.h"
 
 /* 7-bit I2C 地址（请根据 ADDR 引脚实际接法修改） 
 when ADDR=L, I2C address = 0x2A, when ADDR=H, I2C address =0x2B.*///D
 #define FDC2214_ADDR_7BIT    0x2A
+#define FDC2214_ADDR2_7BIT   0x2B   /* 第二片芯片（ADDR = H） */
 /* HAL 接口通常使用左移 1 位的地址作为 DevAddress 参数 */
 #define FDC2214_ADDR_HAL     (FDC2214_ADDR_7BIT << 1)
+#define FDC2214_ADDR2_HAL    (FDC2214_ADDR2_7BIT << 1)
 
 #define FDC2214_I2C_TIMEOUT_MS   100U
 
@@ -31,6 +35,11 @@ when ADDR=L, I2C address = 0x2A, when ADDR=H, I2C address =0x2B.*///D
 #define FDC2214_REG_DATA_CH3        0x06
 #define FDC2214_REG_DATA_LSB_CH3    0x07
 
+/* DATA_CHx 的 bit[11:0] 为 28-bit 结果的高 12 位，bit[13]/bit[12] 为 ERR_WD/ERR_AW 标志 */
+#define FDC2214_DATA_MSB_MASK       0x0FFFU
+/* 四个通道 DATA 寄存器 (0x00-0x07) 共 8 个 16-bit 寄存器 = 16 字节，可一次连续读出 */
+#define FDC2214_DATA_BURST_BYTES    16U
+
 /* 通道配置寄存器 *///D，100SPS（SPS，全称Samples per Second ，即每秒采样次数，是转化速率的单位。100SPS每次采样时间TSAMPLE=10ms，1s 100次
 //转换时间 Conversion Time (tC0)= 1/N × (TSAMPLE – settling time – channel switching delay) = 1/4 (10,000 – 4 – 1) =2.49875ms
 #define FDC2214_REG_RCOUNT_CH0      0x08//N是通道数，确定转换时间寄存器值，请使用以下公式并求解CH0_RCOUNT转换时间：(tC0)= (CH0_RCOUNT × 16)/fREF0
@@ -59,10 +68,34 @@ when ADDR=L, I2C address = 0x2A, when ADDR=H, I2C address =0x2B.*///D
 #define FDC2214_REG_STATUS_CONFIG  0x19
 #define FDC2214_REG_CONFIG         0x1A//D
 #define FDC2214_REG_MUX_CONFIG     0x1B//D
+#define FDC2214_REG_RESET_DEV      0x1C
+
+/* RESET_DEV (0x1C)：bit15 RESET_DEV 写 1 复位芯片，全部寄存器恢复默认值并进入睡眠模式（读回恒为 0） */
+#define FDC2214_RESET_DEV_RESET          (1U << 15)
+
+/* STATUS_CONFIG (0x19，手册中称 ERROR_CONFIG)：bit0 DRDY_2INT = 1 时，数据就绪通过 INTB 拉低通知主机；
+ * bit13/12/11 把看门狗超时、振幅过高、振幅过低写入 DATA_CHx 的 ERR_WD / ERR_AW 标志位 */
+#define FDC2214_STATUS_CONFIG_DRDY_2INT     (1U << 0)
+#define FDC2214_STATUS_CONFIG_AL_WARN2OUT   (1U << 11)
+#define FDC2214_STATUS_CONFIG_AH_WARN2OUT   (1U << 12)
+#define FDC2214_STATUS_CONFIG_WD_ERR2OUT    (1U << 13)
+/* STATUS (0x18)：ERR_CHAN[15:14] 为产生错误的通道，ERR_WD/ERR_AHW/ERR_ALW 为错误类型，
+ * bit6 DRDY 数据就绪，bit3..0 为 CH0..CH3 有未读转换结果（CH0 在 bit3） */
+#define FDC2214_STATUS_ERR_CHAN_POS      (14U)
+#define FDC2214_STATUS_ERR_CHAN_MASK     (3U << FDC2214_STATUS_ERR_CHAN_POS)
+#define FDC2214_STATUS_ERR_WD            (1U << 11)
+#define FDC2214_STATUS_ERR_AHW           (1U << 10)
+#define FDC2214_STATUS_ERR_ALW           (1U << 9)
+#define FDC2214_STATUS_DRDY              (1U << 6)
+#define FDC2214_STATUS_UNREADCONV(ch)    (1U << (3U - (ch)))
+/* DATA_CHx（MSB 寄存器）中的错误标志 */
+#define FDC2214_DATA_ERR_WD              (1U << 13)
+#define FDC2214_DATA_ERR_AW              (1U << 12)
+/* 28-bit 结果的满量程值：0 或满量程表示传感器频率超出可测范围 */
+#define FDC2214_DATA_FULL_SCALE          0x0FFFFFFFUL
 
 /* 参考/频率/错误/复位等控制寄存器 (按手册地址) */
 // #define FDC2214_REG_ERROR_CONFIG   0x19
-// #define FDC2214_REG_RESET_DEV      0x1C
 
 /* 注意：REF_CLK_SRC 位位于 CONFIG 寄存器 (0x1A) 的 bit[9]。
  * 将该位设置为 1 可选择使用外部时钟作为 controller/参考时钟。
@@ -72,6 +105,9 @@ when ADDR=L, I2C address = 0x2A, when ADDR=H, I2C address =0x2B.*///D
 #define FDC2214_CONFIG_REF_CLK_SRC_MASK  (1U << FDC2214_CONFIG_REF_CLK_SRC_BIT)  /* 0x0200 */
 #define FDC2214_CONFIG_REF_CLK_SRC_INTERNAL  (0U)
 #define FDC2214_CONFIG_REF_CLK_SRC_EXTERNAL (FDC2214_CONFIG_REF_CLK_SRC_MASK)
+/* CONFIG.INTB_DIS 位于 bit[7]：0 = 状态寄存器更新时拉低 INTB，1 = 禁用 INTB */
+#define FDC2214_CONFIG_INTB_DIS_BIT      (7U)
+#define FDC2214_CONFIG_INTB_DIS_MASK     (1U << FDC2214_CONFIG_INTB_DIS_BIT)    /* 0x0080 */
 
 
 /* 驱动电流寄存器（每通道） *///D
@@ -104,17 +140,211 @@ typedef enum {
     FDC_ERR_UNKNOWN = -10,
 } fdc_status_t;
 
+/* 异步采集得到的一组样本（四通道同一轮转换） */
+typedef struct {
+    uint32_t tick;      /* INTB 触发时刻 HAL_GetTick() (ms) */
+    uint32_t stamp;     /* INTB 触发时刻由 fdc_set_stamp_hook 注册的函数取得的值（如驱动相位），未注册为 0 */
+    uint32_t seq;       /* 样本序号，连续递增；出现跳号说明环形缓冲区满丢样 */
+    uint32_t raw[4];    /* 各通道 28-bit 结果（未激活通道为 0） */
+    uint8_t active_mask; /* 本组样本包含的通道位图，bit n 对应 CHn */
+    uint8_t valid_mask;  /* 结果可信的通道：激活、无 ERR_WD/ERR_AW、不在 0/满量程、非重复读取的旧值 */
+    uint16_t status;     /* 本轮读取前的 STATUS 寄存器值 */
+} fdc_sample_t;
+
+/* 每片芯片的故障统计（自 fdc_init 或 fdc_clear_stats 起累计） */
+typedef struct {
+    uint32_t err_wd[4];     /* 看门狗超时（传感器不振荡），来自 DATA_CHx.ERR_WD */
+    uint32_t err_ahw[4];    /* 振幅过高警告，来自 STATUS.ERR_AHW + ERR_CHAN */
+    uint32_t err_alw[4];    /* 振幅过低警告，来自 STATUS.ERR_ALW + ERR_CHAN */
+    uint32_t range[4];      /* 结果为 0 或满量程 */
+    uint32_t stale[4];      /* 读取时该通道没有新转换（UNREADCONV 未置位） */
+    uint32_t overruns[4];   /* 未及时读取而被覆盖的转换轮数（按相邻样本的 INTB 时刻与实际采样率估算） */
+    uint32_t samples;       /* 成功读取的样本组数 */
+    uint32_t dropped;       /* 样本环形缓冲区满而丢弃的组数 */
+    uint32_t i2c_errors;    /* 异步传输启动失败或总线错误次数 */
+    uint32_t i2c_retries;   /* 阻塞接口的重试次数（I2C 为整片共享，不区分通道） */
+} fdc_stats_t;
+
+/* 通道扫描序列：对应 MUX_CONFIG.RR_SEQUENCE（自动扫描）或 CONFIG.ACTIVE_CHAN（单通道连续转换） */
+typedef enum {
+    FDC_SEQ_CH0_1 = 0,      /* 自动扫描 CH0, CH1 */
+    FDC_SEQ_CH0_2 = 1,      /* 自动扫描 CH0..CH2 */
+    FDC_SEQ_CH0_3 = 2,      /* 自动扫描 CH0..CH3 */
+    FDC_SEQ_SINGLE_CH0 = 4, /* 仅 CH0 连续转换 */
+    FDC_SEQ_SINGLE_CH1 = 5,
+    FDC_SEQ_SINGLE_CH2 = 6,
+    FDC_SEQ_SINGLE_CH3 = 7,
+} fdc_sequence_t;
+
+/* 样本环形缓冲区长度（必须为 2 的幂） */
+#define FDC_SAMPLE_RING_LEN  8U
+
+/* 影子缓存覆盖的寄存器范围 0x08 (RCOUNT_CH0) .. 0x21 (DRIVE_CURRENT_CH3) */
+#define FDC2214_SHADOW_FIRST  FDC2214_REG_RCOUNT_CH0
+#define FDC2214_SHADOW_LAST   FDC2214_REG_DRIVE_CURRENT_CH3
+#define FDC2214_SHADOW_COUNT  (FDC2214_SHADOW_LAST - FDC2214_SHADOW_FIRST + 1)
+
+/* 同一驱动最多管理的芯片数（板上 ADDR 只有两种取值） */
+#define FDC_MAX_DEVICES  2U
+
+/* 设备句柄：一片 FDC2214 的硬件连接与驱动状态。
+ * 前 5 个成员为硬件连接，由使用者静态初始化（见 fdc_dev0 / fdc_dev1），其余由驱动维护。 */
+typedef struct {
+    I2C_HandleTypeDef *hi2c;      /* 所在 I2C 总线 */
+    uint16_t addr_hal;            /* HAL 格式地址（7-bit 左移 1 位） */
+    GPIO_TypeDef *intb_port;      /* INTB 引脚 */
+    uint16_t intb_pin;
+    IRQn_Type intb_irqn;
+
+    /* 当前生效的采样配置与规划请求 */
+    fdc_config_t cfg;
+    fdc_plan_req_t req;
+
+    /* 配置寄存器影子缓存，dirty 每一位对应 reg - FDC2214_SHADOW_FIRST */
+    uint16_t shadow[FDC2214_SHADOW_COUNT];
+    uint32_t shadow_dirty;
+    uint8_t shadow_valid;
+
+    /* DRDY 与异步采集状态（ISR 与主循环共享） */
+    volatile uint8_t drdy_pending;
+    volatile uint32_t drdy_count;
+    volatile uint8_t async_enabled;
+    volatile uint8_t async_busy;
+    volatile uint32_t async_tick;
+    volatile uint32_t drdy_stamp;   /* 最近一次 INTB 下降沿时的时间戳钩子返回值 */
+    volatile uint32_t async_stamp;
+    volatile uint32_t drdy_cyc;     /* 最近一次 INTB 下降沿时的 DWT CYCCNT（HCLK 周期） */
+    volatile uint32_t async_cyc;
+    volatile uint8_t async_phase;   /* 0 = 正在读 STATUS，1 = 正在读 DATA */
+    uint16_t async_status;
+    uint32_t last_tick;             /* 上一组样本的 INTB 时刻（ms / CYCCNT），用于估算覆盖轮数 */
+    uint32_t last_cyc;
+    uint8_t last_valid;             /* 0：配置改变或重新启动采集后尚无基准，下一组样本只建立基准 */
+    uint8_t async_first;
+    uint8_t async_count;
+    uint8_t async_rx[FDC2214_DATA_BURST_BYTES];
+
+    /* 样本环形缓冲区：生产者为 I2C 完成回调，消费者为主循环 */
+    fdc_sample_t ring[FDC_SAMPLE_RING_LEN];
+    volatile uint32_t ring_head;
+    volatile uint32_t ring_tail;
+    volatile uint32_t sample_seq;
+
+    fdc_stats_t stats;
+} fdc_dev_t;
+
+/* 板上两片芯片：fdc_dev0 (0x2A, INTB = PB8)，fdc_dev1 (0x2B, INTB = PB9)，共用 hi2c1 */
+extern fdc_dev_t fdc_dev0;
+extern fdc_dev_t fdc_dev1;
+
 /* API 用法说明：
- * - 在 main 的初始化阶段调用 fdc_init()。
+ * - 在 main 的初始化阶段对每片芯片调用 fdc_init(dev)，之后所有接口都以该句柄为第一个参数。
  * - 使用 fdc_read_result_raw() 读取 24-bit 原始结果（unit: raw counts / frequency）。
  * - 若需要写特殊寄存器或进行复杂配置，可直接使用 fdc_read_reg / fdc_write_reg。
  */
-int fdc_init(void);
-int fdc_write_reg(uint8_t reg, uint16_t value);
-int fdc_read_reg(uint8_t reg, uint16_t *value);
-int fdc_read_result_raw(fdc_channel_t ch, uint32_t *raw24);
-int fdc_soft_reset(void);
-int fdc_read_device_id(uint16_t *did);
+int fdc_init(fdc_dev_t *dev);
+int fdc_write_reg(fdc_dev_t *dev, uint8_t reg, uint16_t value);
+int fdc_read_reg(fdc_dev_t *dev, uint8_t reg, uint16_t *value);
+int fdc_read_result_raw(fdc_dev_t *dev, fdc_channel_t ch, uint32_t *raw24);
+/* 一次 I2C 事务（写寄存器指针 + 重复起始 + 连续读）读出全部激活通道的结果。
+ * 利用 FDC2214 寄存器指针自动递增，代替逐通道 4 次收发（共 16 次事务）；
+ * 只读取当前扫描序列中的通道（例如 CH0-1 时只读 8 字节）。
+ * raw 数组按通道下标返回 28-bit 结果，未激活通道置 0。
+ * valid_mask 可为 NULL；非 NULL 时返回结果可信的通道位图（判定同 fdc_sample_t.valid_mask，不含旧值检查）。
+ */
+int fdc_read_all_channels(fdc_dev_t *dev, uint32_t raw[4], uint8_t *valid_mask);
+int fdc_soft_reset(fdc_dev_t *dev);
+int fdc_set_ref_clk_external(fdc_dev_t *dev);
+
+/* 配置寄存器影子缓存（0x08..0x21，不含 STATUS/RESET_DEV）：
+ * - fdc_shadow_sync()：一次连续读建立缓存（fdc_init 中调用）；
+ * - fdc_shadow_write/modify()：只修改 RAM 中的缓存并标记为脏，不访问总线；
+ * - fdc_shadow_read()：读缓存值，替代读-改-写前的 I2C 读；
+ * - fdc_commit()：进入睡眠模式，把脏寄存器按连续区间合并为少量突发写，再退出睡眠。
+ * fdc_write_reg() 直接写入的值也会同步到缓存。
+ */
+int fdc_shadow_sync(fdc_dev_t *dev);
+int fdc_shadow_write(fdc_dev_t *dev, uint8_t reg, uint16_t value);
+int fdc_shadow_modify(fdc_dev_t *dev, uint8_t reg, uint16_t clear_mask, uint16_t set_mask);
+int fdc_shadow_read(fdc_dev_t *dev, uint8_t reg, uint16_t *value);
+int fdc_commit(fdc_dev_t *dev);
+
+/* 默认采样配置（fdc_init 使用）：4 通道、100 SPS、外部 40 MHz 参考时钟、单端传感器约 6 MHz */
+#define FDC_DEFAULT_CHANNELS     4U
+#ifndef FDC_DEFAULT_SPS   /* 主机仿真可在编译时覆盖，见 sim/CMakeLists.txt */
+#define FDC_DEFAULT_SPS          100U
+#endif
+#define FDC_DEFAULT_FCLK_HZ      40000000UL
+#define FDC_DEFAULT_FSENSOR_HZ   6000000UL
+
+/* 把 fdc_plan_config() 规划出的配置写入芯片：
+ * 各激活通道的 RCOUNT/SETTLECOUNT/CLOCK_DIVIDERS/DRIVE_CURRENT 与 MUX_CONFIG/CONFIG 写入影子缓存，
+ * 再由 fdc_commit() 在睡眠模式下只写入有变化的寄存器。
+ * 成功后驱动记住该配置，可用 fdc_get_config() 查询。
+ */
+int fdc_apply_config(fdc_dev_t *dev, const fdc_config_t *cfg);
+const fdc_config_t *fdc_get_config(const fdc_dev_t *dev);
+
+/* 规划并应用：调用 fdc_plan_config() 后写入芯片，并记住该请求供后续修改（如切换通道序列）。
+ * 异步采集运行期间可直接调用，fdc_commit 提交时会暂停总线调度。
+ */
+int fdc_configure(fdc_dev_t *dev, const fdc_plan_req_t *req);
+const fdc_plan_req_t *fdc_get_plan_request(const fdc_dev_t *dev);
+
+/* 运行时切换扫描序列（CH0-1 / CH0-2 / CH0-3 / 单通道），并按新的通道数重新规划 RCOUNT，
+ * 使目标采样率下全部转换时间都用在激活通道上。读取路径只读取激活通道。
+ */
+int fdc_set_sequence(fdc_dev_t *dev, fdc_sequence_t seq);
+/* 当前激活通道位图，bit n 对应 CHn */
+uint8_t fdc_get_active_mask(const fdc_dev_t *dev);
+int fdc_read_device_id(fdc_dev_t *dev, uint16_t *did);
+
+/* DRDY 中断驱动采集：
+ * - fdc_intb_init()：配置该芯片的 INTB 引脚（fdc_dev0 为 PB8，fdc_dev1 为 PB9）为下降沿 EXTI 输入并使能 NVIC；
+ * - fdc_enable_drdy_interrupt()：写 STATUS_CONFIG.DRDY_2INT = 1 并清 CONFIG.INTB_DIS，
+ *   芯片完成一轮转换后拉低 INTB，读取 DATA 寄存器后 INTB 自动释放；
+ * - fdc_data_ready()：主循环查询，返回 1 表示有新数据（同时清除标志），此时再读取结果。
+ * 这样采样节拍由 RCOUNT/SETTLECOUNT 决定，不再依赖 HAL_Delay 轮询。
+ */
+void fdc_intb_init(fdc_dev_t *dev);
+int fdc_enable_drdy_interrupt(fdc_dev_t *dev);
+int fdc_data_ready(fdc_dev_t *dev);
+/* 诊断：返回自上电以来 INTB 下降沿次数 */
+uint32_t fdc_get_drdy_count(const fdc_dev_t *dev);
+
+/* 非阻塞异步采集（中断驱动 I2C）：
+ * - fdc_async_start()：进入异步模式。INTB 下降沿的 EXTI 回调直接启动 HAL_I2C_Mem_Read_IT，
+ *   I2C 完成回调解码 4 通道结果并写入样本环形缓冲区，CPU 不再等待总线；
+ * - fdc_async_get()：主循环非阻塞取出一组样本，返回 1 表示取到；
+ * - fdc_async_poll()：主循环周期调用（对全部已初始化芯片），若 INTB 仍为低而总线空闲
+ *   （边沿丢失或 I2C 出错后）重新发起读取；
+ * 多片芯片共用一条总线时由交错调度器仲裁：同一时刻只有一次中断传输，一片读完后在完成回调中
+ * 立即轮询下一片有 DRDY 挂起的芯片，两片的读取背靠背进行，不会互相等待主循环。
+ * 阻塞接口（寄存器读写、fdc_commit 等）在访问总线前会暂停调度器并等待进行中的传输结束，
+ * 异步采集运行期间也可以安全调用。
+ * fdc_async_start() 会打开 DWT 周期计数器：EXTI 回调按 CYCCNT 记录 INTB 时刻，用于估算 overruns。
+ */
+int fdc_async_start(fdc_dev_t *dev);
+void fdc_async_stop(fdc_dev_t *dev);
+int fdc_async_get(fdc_dev_t *dev, fdc_sample_t *out);
+void fdc_async_poll(void);
+/* 样本时间戳钩子：在 INTB 下降沿的 EXTI 回调中调用（ISR 上下文，须短小、不阻塞），返回值随样本
+ * 记入 fdc_sample_t.stamp。tick 只有 ms 分辨率，需要与其他硬件（如 TIM3 驱动相位）精确对齐的
+ * 应用在这里取自己的时基，驱动本身不关心其含义。NULL 取消，全部芯片共用 */
+typedef uint32_t (*fdc_stamp_fn_t)(void);
+void fdc_set_stamp_hook(fdc_stamp_fn_t fn);
+/* 诊断：缓冲区满丢弃的样本数 / I2C 错误次数（与 fdc_stats_t 中的同名计数相同） */
+uint32_t fdc_async_get_dropped(const fdc_dev_t *dev);
+uint32_t fdc_async_get_i2c_errors(const fdc_dev_t *dev);
+
+/* 故障统计：
+ * 异步读取每轮先读 STATUS（同时清除锁存的错误与 INTB），再连续读 DATA，
+ * 按 ERR_CHAN / DATA 标志位累加各通道计数，并在样本的 valid_mask 中剔除有问题的通道；
+ * overruns 持续增长说明主循环或总线太慢，转换结果在读取前已被覆盖。 */
+void fdc_get_stats(const fdc_dev_t *dev, fdc_stats_t *out);
+void fdc_clear_stats(fdc_dev_t *dev);
+/* 读取并解码 STATUS（阻塞），同时累加 ERR_AHW / ERR_ALW 计数 */
+int fdc_read_status(fdc_dev_t *dev, uint16_t *status);
 
 /* 返回错误字符串，供上层打印使用 */
 const char *fdc_err_str(int e);
@@ -122,7 +352,8 @@ const char *fdc_err_str(int e);
 /* 将寄存器原始输出 DATAx (无符号整数，驱动中为 28-bit 有效位) 转换为振荡器频率 f_sensor（Hz）
  * 公式：DATAx = f_sensor * 2^28 / f_ref  => f_sensor = DATAx * f_ref / 2^28
  * 参数：raw24 - 驱动读取到的原始值（uint32_t）
- *       fref_hz - 参考时钟频率（Hz），例如 40e6 表示 40 MHz
+ *       fref_hz - 参考时钟频率（Hz），例如 40e6 表示 40 MHz；FIN_SEL = ÷2 时应乘 2，
+ *                 即传入 fdc_plan_data_fref_hz(fdc_get_config(dev))
  * 返回：fsensor (Hz)（double）
  */
 double fdc_raw_to_freq(uint32_t raw24, double fref_hz);
@@ -134,10 +365,12 @@ double fdc_raw_to_freq(uint32_t raw24, double fref_hz);
  *       L_h - 已知电感量 (H)
  *       C0_f - 并联固定电容 (F), 如 20e-12 表示 20 pF
  * 返回：C (F)
+ * 注：以上两个 double 版本作为参考实现保留；M3 无 FPU，逐样本换算请使用 fdc_fixed.h。
  */
 double fdc_freq_to_capacitance(double fsensor_hz, double L_h, double C0_f);
 
-/* 简单基线校准：读取 N 次样本求均值，保存到用户数组 */
-int fdc_calibrate_baseline(fdc_channel_t ch, uint32_t *baseline_out, uint8_t samples);
+/* 简单基线校准：读取 N 次样本求均值，保存到用户数组。
+ * 阻塞 samples × (读取 + 5 ms)，且不能在异步采集期间调用；运行中的基线跟踪请使用 fdc_baseline.h。 */
+int fdc_calibrate_baseline(fdc_dev_t *dev, fdc_channel_t ch, uint32_t *baseline_out, uint8_t samples);
 
 #endif /* __FDC2214_H__ */
@@ -0,0 +1,69 @@
+/*
+ * fdc_baseline.h
+ * 流式基线跟踪（纯 C，不依赖 HAL）
+ *
+ * 说明：fdc_calibrate_baseline() 需要阻塞采集 samples 次求均值，4 通道 × 100 次会让
+ * 启动卡住数秒，而且只在启动时校准一次，无法补偿温湿度引起的慢漂移。
+ * 本模块在每个样本到来时做一次 O(1) 整数更新：
+ *   - 第一个样本直接作为初始基线，启动无需等待；
+ *   - 慢速指数滑动平均 base += (raw - base) / 2^ema_shift（Q3 定点，保留小数部分）；
+ *   - |delta| 超过 touch_threshold 视为“触摸”，冻结基线，避免把触摸学进基线；
+ *     |delta| 回到 release_threshold 以内才解除（迟滞，防止阈值附近来回抖动）；
+ *   - 每个样本基线最多移动 max_step 个计数，限制漂移补偿速度；
+ *   - 连续冻结超过 max_freeze 个样本（例如上电时已有物体贴近）则以当前值重新起算。
+ * delta 的符号：电容增大 -> 频率降低 -> DATA 减小，因此触摸时 delta 为负。
+ */
+
+#ifndef __FDC_BASELINE_H__
+#define __FDC_BASELINE_H__
+
+#include <stdint.h>
+
+/* 基线小数位数：28-bit DATA 左移 3 位后仍小于 2^31，差值可用 int32 表示 */
+#define FDC_BASELINE_FRAC_BITS  3U
+
+/* 默认参数（100 SPS 下的经验值，阈值与具体电极相关，请按实测调整） */
+#define FDC_BASELINE_DEFAULT_EMA_SHIFT   8U       /* 时间常数约 256 个样本（2.56 s） */
+#define FDC_BASELINE_DEFAULT_TOUCH       20000U   /* 触摸判定阈值（raw counts） */
+#define FDC_BASELINE_DEFAULT_RELEASE     10000U   /* 解除阈值（raw counts） */
+#define FDC_BASELINE_DEFAULT_MAX_STEP    4U       /* 每样本最大漂移补偿（raw counts） */
+#define FDC_BASELINE_DEFAULT_MAX_FREEZE  3000U    /* 最长冻结样本数（约 30 s） */
+
+/* 跟踪参数（所有通道共用） */
+typedef struct {
+    uint8_t  ema_shift;          /* EMA 系数 α = 2^-ema_shift */
+    uint32_t touch_threshold;    /* |delta| > 该值进入冻结 */
+    uint32_t release_threshold;  /* |delta| < 该值解除冻结 */
+    uint32_t max_step;           /* 每样本基线最大移动量（raw counts），0 表示不限制 */
+    uint32_t max_freeze;         /* 连续冻结样本上限，0 表示不限制 */
+} fdc_baseline_param_t;
+
+/* 单通道状态 */
+typedef struct {
+    uint32_t base_q;        /* 基线（Q3） */
+    uint32_t frozen_count;  /* 当前连续冻结的样本数 */
+    uint8_t  seeded;        /* 是否已由第一个样本初始化 */
+    uint8_t  touched;       /* 当前是否处于冻结（触摸）状态 */
+} fdc_baseline_ch_t;
+
+typedef struct {
+    fdc_baseline_param_t param;
+    fdc_baseline_ch_t ch[4];
+} fdc_baseline_t;
+
+/* 初始化；param 为 NULL 时使用 FDC_BASELINE_DEFAULT_* */
+void fdc_baseline_init(fdc_baseline_t *bl, const fdc_baseline_param_t *param);
+
+/* 输入一个样本，更新基线并返回 delta = raw - baseline（raw counts） */
+int32_t fdc_baseline_update(fdc_baseline_t *bl, uint8_t ch, uint32_t raw28);
+
+/* 当前基线（raw counts，四舍五入）；未初始化的通道返回 0 */
+uint32_t fdc_baseline_get(const fdc_baseline_t *bl, uint8_t ch);
+
+/* 当前是否处于冻结（触摸）状态 */
+int fdc_baseline_is_touched(const fdc_baseline_t *bl, uint8_t ch);
+
+/* 丢弃通道基线，下一个样本重新起算（例如切换扫描序列或修改 RCOUNT 后） */
+void fdc_baseline_reset(fdc_baseline_t *bl, uint8_t ch);
+
+#endif /* __FDC_BASELINE_H__ */
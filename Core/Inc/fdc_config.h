@@ -0,0 +1,100 @@
+/*
+ * fdc_config.h
+ * FDC2214 采样配置规划器（纯 C，不依赖 HAL，可在 PC 上编译做离线扫参）
+ *
+ * 说明：根据激活通道数、目标采样率、参考时钟 fREF 与预计的传感器频率，
+ * 计算 RCOUNT / SETTLECOUNT / CLOCK_DIVIDERS / MUX_CONFIG / CONFIG 的寄存器值。
+ * 原则：在时间预算内使 RCOUNT 最大（分辨率最高），无法满足的请求直接拒绝。
+ *
+ * 手册公式（SNOSCZ5B 7.3.2）：
+ *   传感器激活时间   tS  = SETTLECOUNT * 16 / fREF
+ *   转换时间         tC  = (RCOUNT * 16 + 4) / fREF
+ *   通道切换延时     tSW = 692 ns + 5 / fREF
+ *   多通道时每轮耗时 = N * (tS + tC + tSW)，单通道连续转换时只有 tC
+ *   有效位数 ENOB ≈ log2(RCOUNT * 16)，例如 RCOUNT = 0x0200 -> 8192 周期 -> 13 bit
+ */
+
+#ifndef __FDC_CONFIG_H__
+#define __FDC_CONFIG_H__
+
+#include <stdint.h>
+
+/* 手册 Table 7-1 的时钟约束 */
+#define FDC_PLAN_FREF_MAX_MULTI_HZ    55000000UL  /* 多通道 fREF ≤ 55 MHz */
+#define FDC_PLAN_FREF_MAX_SINGLE_HZ   35000000UL  /* 单通道 fREF ≤ 35 MHz（取内/外部时钟中较严者） */
+#define FDC_PLAN_FIN_DIFF_MAX_HZ      8750000UL   /* 差分传感器 FIN_SEL=1 时 fIN ≤ 8.75 MHz */
+#define FDC_PLAN_FSENSOR_MAX_HZ       10000000UL  /* 传感器频率上限 10 MHz */
+#define FDC_PLAN_RCOUNT_MIN           0x0100U     /* FDC2214 寄存器表：RCOUNT 0x0000..0x00FF 保留 */
+#define FDC_PLAN_SETTLECOUNT_MIN      0x0004U     /* SETTLECOUNT 必须 > 3 */
+#define FDC_PLAN_FREF_DIVIDER_MAX     0x03FFU     /* CLOCK_DIVIDERS.FREF_DIVIDER 为 10 bit */
+
+/* 寄存器位域（fdc2214.h 包含本头文件，驱动与规划器共用） */
+#define FDC2214_CLOCK_DIVIDERS_FIN_SEL_POS   (12U)
+#define FDC2214_CLOCK_DIVIDERS_FIN_DIV1      (1U << FDC2214_CLOCK_DIVIDERS_FIN_SEL_POS)  /* b01: fIN = fSENSOR */
+#define FDC2214_CLOCK_DIVIDERS_FIN_DIV2      (2U << FDC2214_CLOCK_DIVIDERS_FIN_SEL_POS)  /* b10: fIN = fSENSOR / 2 */
+#define FDC2214_MUX_CONFIG_AUTOSCAN_EN       (1U << 15)
+#define FDC2214_MUX_CONFIG_RR_SEQUENCE_POS   (13U)
+#define FDC2214_MUX_CONFIG_RR_SEQUENCE_MASK  (3U << FDC2214_MUX_CONFIG_RR_SEQUENCE_POS)
+#define FDC2214_MUX_CONFIG_RESERVED          0x0208U  /* bit[12:3] 保留位，手册要求写 b00 0100 0001 */
+#define FDC2214_MUX_CONFIG_DEGLITCH_1MHZ     0x0001U
+#define FDC2214_MUX_CONFIG_DEGLITCH_3M3HZ    0x0004U
+#define FDC2214_MUX_CONFIG_DEGLITCH_10MHZ    0x0005U
+#define FDC2214_MUX_CONFIG_DEGLITCH_33MHZ    0x0003U
+#define FDC2214_CONFIG_ACTIVE_CHAN_POS       (14U)
+#define FDC2214_CONFIG_ACTIVE_CHAN_MASK      (3U << FDC2214_CONFIG_ACTIVE_CHAN_POS)
+#define FDC2214_CONFIG_SLEEP_MODE_EN         (1U << 13)
+#define FDC2214_CONFIG_RESERVED              0x1401U  /* bit12 = 1, bit10 = 1, bit[5:0] = b00 0001 */
+
+/* 默认值（与原 fdc_init 中的写死配置一致） */
+#define FDC_PLAN_DEFAULT_SETTLECOUNT  0x000AU
+#define FDC_PLAN_DEFAULT_DRIVE        0x7800U
+
+/* 规划器返回码（与 fdc_status_t 同为负数错误码，数值不重叠） */
+typedef enum {
+    FDC_PLAN_OK = 0,
+    FDC_PLAN_ERR_PARAM = -20,     /* 参数非法（空指针、通道数不在 1..4、频率为 0 等） */
+    FDC_PLAN_ERR_FSENSOR = -21,   /* 传感器频率超出范围或不满足 fIN < fREF/4 */
+    FDC_PLAN_ERR_RATE = -22,      /* 目标采样率太高，RCOUNT 无法 ≥ 最小值 */
+} fdc_plan_status_t;
+
+/* 规划请求 */
+typedef struct {
+    uint8_t  channel_count;   /* 激活通道数 1..4：1 为单通道连续转换，2..4 为 CH0..CH(n-1) 自动扫描 */
+    uint8_t  active_channel;  /* 单通道模式（channel_count = 1）下转换的通道 0..3，多通道时忽略 */
+    uint8_t  single_ended;    /* 1 = 单端传感器（FIN_SEL 固定为 ÷2），0 = 差分传感器 */
+    uint8_t  ref_external;    /* 1 = 参考时钟来自 CLKIN，0 = 内部振荡器 */
+    uint32_t target_sps;      /* 目标采样率：每通道每秒样本数（即每秒完整扫描轮数） */
+    uint32_t fclk_hz;         /* 参考时钟源频率 fCLK（Hz），例如外部 40 MHz 晶振 */
+    uint32_t fsensor_hz;      /* 预计传感器 LC 振荡频率（Hz） */
+    uint16_t settlecount;     /* 0 = 使用默认值 FDC_PLAN_DEFAULT_SETTLECOUNT */
+    uint16_t drive_current;   /* 0 = 使用默认值 FDC_PLAN_DEFAULT_DRIVE */
+} fdc_plan_req_t;
+
+/* 规划结果：可直接写入芯片的寄存器值以及推导出的性能指标 */
+typedef struct {
+    uint8_t  channel_count;   /* 激活通道数 */
+    uint8_t  first_channel;   /* 第一个激活通道：自动扫描时为 0，单通道时为 active_channel */
+    uint16_t rcount;          /* RCOUNT_CHx */
+    uint16_t settlecount;     /* SETTLECOUNT_CHx */
+    uint16_t clock_dividers;  /* CLOCK_DIVIDERS_CHx = FIN_SEL[13:12] | FREF_DIVIDER[9:0] */
+    uint16_t drive_current;   /* DRIVE_CURRENT_CHx */
+    uint16_t mux_config;      /* MUX_CONFIG */
+    uint16_t config;          /* CONFIG（SLEEP_MODE_EN = 0） */
+    uint32_t fref_hz;         /* 实际 fREF = fCLK / FREF_DIVIDER */
+    uint32_t actual_msps;     /* 实际采样率（milli-SPS，每通道） */
+    uint8_t  enob;            /* 估计有效位数 */
+} fdc_config_t;
+
+/* 根据请求计算寄存器配置；成功返回 FDC_PLAN_OK 并填充 cfg */
+int fdc_plan_config(const fdc_plan_req_t *req, fdc_config_t *cfg);
+
+/* DATA 换算用的参考频率：fSENSOR = DATA × fREF × FIN_SEL / 2^28，即 fref_hz 乘以 FIN_SEL 分频系数
+ * （单端传感器 ÷2 时为 2 × fREF）。传给 fdc_raw_to_freq() / fdc_fixed_init() 等换算函数 */
+uint32_t fdc_plan_data_fref_hz(const fdc_config_t *cfg);
+
+/* 通道 ch 的等效采样时刻比 DRDY（INTB 拉低）早多少 ns：本通道转换窗口中点到一轮结束。
+ * 多通道时 DRDY 在最后一个通道转换完成后才置位，排在前面的通道还要加上后续通道的耗时。
+ * 用于把 INTB 时刻取得的时间戳 / 驱动相位折算回实际采样时刻；ch 不在激活范围内时返回 0 */
+uint32_t fdc_plan_sample_delay_ns(const fdc_config_t *cfg, uint8_t ch);
+
+#endif /* __FDC_CONFIG_H__ */
@@ -0,0 +1,54 @@
+/*
+ * fdc_fixed.h
+ * FDC2214 原始值 -> 频率 / 电容的定点换算（纯整数，不依赖 HAL 与 FPU）
+ *
+ * 说明：STM32F103 没有 FPU，fdc_raw_to_freq() / fdc_freq_to_capacitance() 的 double
+ * 运算（含除法与 (2*pi*f)^2）全部由软件浮点库完成，每通道每样本要上千个周期。
+ * 本模块把与 DATA 无关的常数在初始化时合并：
+ *   f = DATA * fREF / 2^28
+ *   C = 1 / (L * (2*pi*f)^2) - C0 = K / DATA^2 - C0，  K = 2^56 / (4*pi^2 * L * fREF^2)
+ * 每个样本只需计算 1/DATA^2：
+ *   1) 用 CLZ 把 DATA 归一化为 u ∈ [0.5, 1)；
+ *   2) 查 64 项 1/u 表（Q2.30，误差 ≤ 2^-8）得到初值，两次牛顿迭代 y = y*(2 - u*y)；
+ *   3) y^2 乘以 K 的尾数，再按指数移位得到 fF。
+ * 只用 32x32->64 乘法与移位，没有除法。
+ *
+ * 误差（在 PC 上对 DATA = 1..2^28-1 全码域与 double 参考比较）：
+ *   - 1/u 迭代后相对误差 < 2^-28，K 尾数截断 < 2^-31，平方与移位截断 < 2^-29；
+ *   - 总相对误差 < 1e-8，输出按 1 fF 四舍五入，因此 |误差| ≤ 0.5 fF + 1e-8 * (C + C0)；
+ *     典型 L = 18 uH、fREF = 40 MHz、C ≈ 40 pF 时误差不超过 1 fF。
+ *   - 频率换算为 64-bit 精确整数运算，误差 ≤ 0.5 Hz（四舍五入）。
+ *   上述误差界由主机测试 sim/test/test_fdc_fixed.c 逐码断言；M3 上的耗时用 main.c 的
+ *   FDC_FIXED_BENCH（DWT 周期计数）测量。
+ * 与 fdc_raw_to_freq() 一致，这里没有计入 CLOCK_DIVIDERS.FIN_SEL 的分频；
+ * 调用方传入已乘 FIN_SEL 分频系数的 fdc_plan_data_fref_hz()（单端传感器为 2 × fREF）。
+ */
+
+#ifndef __FDC_FIXED_H__
+#define __FDC_FIXED_H__
+
+#include <stdint.h>
+
+/* fdc_fixed_raw_to_ff() 的错误返回值（DATA = 0 或未初始化） */
+#define FDC_FIXED_C_INVALID  INT32_MIN
+
+/* 定点换算常数，由 fdc_fixed_init() 计算一次 */
+typedef struct {
+    uint32_t k_mant;    /* K 的尾数，归一化到 [2^31, 2^32) */
+    int16_t  k_exp;     /* K(fF) = k_mant * 2^k_exp */
+    int32_t  c0_ff;     /* 并联固定电容 C0（fF） */
+    uint32_t fref_hz;   /* DATA 换算用参考频率（Hz），含 FIN_SEL 系数 */
+} fdc_fixed_cal_t;
+
+/* 计算换算常数。L_nh：线圈电感（nH），C0_ff：并联固定电容（fF）。
+ * 仅在此处使用一次浮点运算，返回 0 成功，-1 参数非法。 */
+int fdc_fixed_init(fdc_fixed_cal_t *cal, uint32_t fref_hz, uint32_t L_nh, int32_t C0_ff);
+
+/* DATA -> 传感器频率（Hz，四舍五入） */
+uint32_t fdc_fixed_raw_to_freq_hz(uint32_t raw28, uint32_t fref_hz);
+
+/* DATA -> 被测电容（fF，四舍五入）。DATA 太小导致溢出时饱和为 INT32_MAX，
+ * DATA = 0 时返回 FDC_FIXED_C_INVALID。 */
+int32_t fdc_fixed_raw_to_ff(const fdc_fixed_cal_t *cal, uint32_t raw28);
+
+#endif /* __FDC_FIXED_H__ */
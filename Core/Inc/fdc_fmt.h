@@ -0,0 +1,25 @@
+/*
+ * fdc_fmt.h
+ * 轻量格式化输出：调试打印用的 printf 子集，纯整数实现，可重入，不使用堆
+ *
+ * 说明：newlib vsnprintf 需要 -u _printf_float 才能打印 %f，链接进来的浮点格式化与 _dtoa
+ * 占用大量 Flash（64 KB 的 F103C8 上尤其明显），格式化时还可能 malloc。本模块只支持：
+ *   %d %i %u %x %X %o %c %s %p %%
+ *   标志 - 0 + 空格 #，宽度与精度（数字或 *），长度修饰 hh h l ll z j
+ *   %.Nk  定点小数：参数为有符号整数（可带 l / ll），按 10^N 缩放打印 N 位小数，
+ *         例如 fdc_fmt_snprintf(buf, n, "%.3k", 136042) 输出 "136.042"；N 最大 9，缺省为 0
+ * 不支持 %f / %e / %g：浮点量先换算为定点整数，再用 %.Nk 打印。
+ * 其他转换符原样输出。返回值与 snprintf 相同：不计结尾 '\0' 的完整长度，超出 size 的部分截断。
+ * 32-bit 以内的数值只用 32-bit 除法（M3 有硬件 UDIV），64-bit 数值才走软件除法。
+ */
+
+#ifndef __FDC_FMT_H__
+#define __FDC_FMT_H__
+
+#include <stdarg.h>
+#include <stddef.h>
+
+int fdc_fmt_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap);
+int fdc_fmt_snprintf(char *buf, size_t size, const char *fmt, ...);
+
+#endif /* __FDC_FMT_H__ */
@@ -0,0 +1,86 @@
+/*
+ * fdc_log.h
+ * 令牌化日志：固件只发送格式串编号与原始参数，由主机端按字典还原文本
+ *
+ * 说明：newlib vsnprintf（加上 -u _printf_float）每行要花数千个周期，格式串本身也占 Flash。
+ * 定义 FDC_LOG_TOKENIZED = 1（CMake 选项 FDC_LOG_TOKENIZED）后，usart_debug.h 把
+ * fdc_debug_print 换成下面的宏（fdc_debug_print_limited 等限频宏建立在它之上），调用点写法不变：
+ * - 每个调用点的格式串（必须是字符串字面量）放进段 fdc_log_fmt，链接脚本中该段为 INFO 段，
+ *   不下载到 Flash；令牌 = 格式串在该段内的偏移；
+ * - 参数按 C 类型（_Generic）编码，运行时不解析格式串：
+ *     整型    zigzag varint（按数值编码，有符号数符号扩展），位宽由主机按格式串截取
+ *     浮点    float 小端 4 字节
+ *     字符串  varint 长度 + 字节（最多 FDC_LOG_STR_MAX 字节，超出截断）
+ *   %s 以外的指针参数不支持；参数最多 FDC_LOG_MAX_ARGS 个；
+ * - 记录以 fdc_telemetry 帧发送（type = FDC_TLM_TYPE_LOG）：
+ *     payload = [type<<4] | token(varint) | args...
+ *   payload 超过 FDC_LOG_PAYLOAD_MAX 时后面的参数不再编码，主机端显示为 <?>。
+ * 构建后 tools/fdc_logdict.py 从 ELF 的 fdc_log_fmt 段导出字典 <elf>.logdict.json，
+ * tools/fdc_telemetry.py --dict 用它还原文本。
+ */
+
+#ifndef __FDC_LOG_H__
+#define __FDC_LOG_H__
+
+#include <stdint.h>
+
+#ifndef FDC_LOG_TOKENIZED
+#define FDC_LOG_TOKENIZED    0
+#endif
+
+#define FDC_LOG_PAYLOAD_MAX  80U
+#define FDC_LOG_STR_MAX      24U
+#define FDC_LOG_MAX_ARGS     10
+
+typedef struct {
+    uint8_t buf[FDC_LOG_PAYLOAD_MAX + 2U];   /* 末尾 2 字节留给帧 CRC */
+    uint8_t len;
+    uint8_t full;       /* 已有参数放不下，后续参数丢弃 */
+} fdc_log_rec_t;
+
+/* fmt 必须指向 fdc_log_fmt 段内的格式串（由 FDC_LOG_TOKEN_PRINT 生成） */
+void fdc_log_begin(fdc_log_rec_t *rec, const char *fmt);
+void fdc_log_put_int(fdc_log_rec_t *rec, int64_t v);
+void fdc_log_put_uint(fdc_log_rec_t *rec, uint64_t v);
+void fdc_log_put_f32(fdc_log_rec_t *rec, double v);
+void fdc_log_put_str(fdc_log_rec_t *rec, const char *s);
+/* 编码为帧写入串口发送缓冲区（fdc_debug_write，缓冲区不足时整帧丢弃） */
+void fdc_log_end(fdc_log_rec_t *rec);
+
+/* 按参数的 C 类型选择编码函数 */
+#define FDC_LOG_PUT_ARG_(r, x) _Generic((x),                                   \
+    float: fdc_log_put_f32, double: fdc_log_put_f32,                          \
+    char *: fdc_log_put_str, const char *: fdc_log_put_str,                   \
+    char: fdc_log_put_int, signed char: fdc_log_put_int, short: fdc_log_put_int, \
+    int: fdc_log_put_int, long: fdc_log_put_int, long long: fdc_log_put_int,  \
+    default: fdc_log_put_uint)((r), (x));
+
+/* 参数计数与逐个展开（0..FDC_LOG_MAX_ARGS 个，依赖 GNU ##__VA_ARGS__） */
+#define FDC_LOG_NARG_(...)  FDC_LOG_NARG_I_(0, ##__VA_ARGS__, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define FDC_LOG_NARG_I_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, N, ...) N
+#define FDC_LOG_CAT_(a, b)   FDC_LOG_CAT_I_(a, b)
+#define FDC_LOG_CAT_I_(a, b) a##b
+#define FDC_LOG_PUT_ALL_(r, ...) FDC_LOG_CAT_(FDC_LOG_PUT_, FDC_LOG_NARG_(__VA_ARGS__))(r, ##__VA_ARGS__)
+#define FDC_LOG_PUT_0(r)
+#define FDC_LOG_PUT_1(r, a)       FDC_LOG_PUT_ARG_(r, a)
+#define FDC_LOG_PUT_2(r, a, ...)  FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_1(r, __VA_ARGS__)
+#define FDC_LOG_PUT_3(r, a, ...)  FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_2(r, __VA_ARGS__)
+#define FDC_LOG_PUT_4(r, a, ...)  FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_3(r, __VA_ARGS__)
+#define FDC_LOG_PUT_5(r, a, ...)  FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_4(r, __VA_ARGS__)
+#define FDC_LOG_PUT_6(r, a, ...)  FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_5(r, __VA_ARGS__)
+#define FDC_LOG_PUT_7(r, a, ...)  FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_6(r, __VA_ARGS__)
+#define FDC_LOG_PUT_8(r, a, ...)  FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_7(r, __VA_ARGS__)
+#define FDC_LOG_PUT_9(r, a, ...)  FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_8(r, __VA_ARGS__)
+#define FDC_LOG_PUT_10(r, a, ...) FDC_LOG_PUT_ARG_(r, a) FDC_LOG_PUT_9(r, __VA_ARGS__)
+
+/* 一次令牌化打印：格式串放入 fdc_log_fmt 段，参数逐个编码后整帧发送 */
+#define FDC_LOG_TOKEN_PRINT(fmt, ...)                                                      \
+    do {                                                                                   \
+        static const char fdc_log_fmt_[] __attribute__((section("fdc_log_fmt"), used)) = fmt; \
+        fdc_log_rec_t fdc_log_rec_;                                                        \
+        fdc_log_begin(&fdc_log_rec_, fdc_log_fmt_);                                        \
+        FDC_LOG_PUT_ALL_(&fdc_log_rec_, ##__VA_ARGS__)                                     \
+        fdc_log_end(&fdc_log_rec_);                                                        \
+    } while (0)
+
+#endif /* __FDC_LOG_H__ */
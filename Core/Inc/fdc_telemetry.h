@@ -0,0 +1,54 @@
+/*
+ * fdc_telemetry.h
+ * 样本的二进制遥测帧编码（纯 C，不依赖 HAL）
+ *
+ * 说明：文本打印 "CHn raw=... f=...Hz C=... pF" 每通道约 40 字节，4 通道一组样本约 180 字节，
+ * 115200 bps 下只能持续输出约 60 组/秒。二进制帧一组样本 28 字节，同样带宽可输出约 400 组/秒。
+ *
+ * 帧格式（多字节字段均为小端）：
+ *   0x00 | COBS( payload[24] | crc16[2] ) | 0x00
+ *   payload：
+ *     [0]      type(高 4 位) | dev(低 4 位)       type = FDC_TLM_TYPE_SAMPLE
+ *     [1..2]   seq      样本序号低 16 位（fdc_sample_t.seq），跳号表示丢样
+ *     [3..6]   tick     INTB 触发时刻（ms）
+ *     [7..20]  raw[4]   4 × 28 bit 紧密排列：CHn 占位流的 bit [28n, 28n+28)
+ *     [21]     active_mask(高 4 位) | valid_mask(低 4 位)
+ *     [22..23] status   STATUS 寄存器
+ *   crc16：CRC-16/CCITT-FALSE（多项式 0x1021，初值 0xFFFF），覆盖 payload
+ * COBS 保证帧内没有 0x00，帧前后各有一个 0x00 分隔符：同一串口上夹杂的文本（不含 0x00）
+ * 自成一段，解码端按 0x00 切分后 CRC 不通过的段可当作文本显示，而不会破坏相邻的帧。
+ * 其他类型的帧使用相同的分隔、COBS 与 CRC，payload[0] 高 4 位区分类型：
+ *   FDC_TLM_TYPE_LOG  令牌化日志记录（见 fdc_log.h）
+ *   FDC_TLM_TYPE_SWEEP  LRA 扫频的频点 / 结果（见 lra_sweep.h）
+ * 主机端解码见 tools/fdc_telemetry.py。
+ */
+
+#ifndef __FDC_TELEMETRY_H__
+#define __FDC_TELEMETRY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fdc2214.h"
+
+#define FDC_TLM_TYPE_SAMPLE      0x1U
+#define FDC_TLM_TYPE_LOG         0x2U
+#define FDC_TLM_TYPE_SWEEP       0x3U
+#define FDC_TLM_SAMPLE_PAYLOAD   24U
+/* n 字节 payload 的最大帧长：payload + CRC，COBS 每 254 字节额外 1 字节，前后分隔符各 1 字节 */
+#define FDC_TLM_FRAME_LEN(n)     ((n) + 2U + ((n) + 2U) / 254U + 1U + 2U)
+#define FDC_TLM_FRAME_MAX        FDC_TLM_FRAME_LEN(FDC_TLM_SAMPLE_PAYLOAD)
+
+/* CRC-16/CCITT-FALSE */
+uint16_t fdc_tlm_crc16(const uint8_t *data, size_t len);
+
+/* COBS 编码（不含结尾 0x00）；out 至少 len + len / 254 + 1 字节，返回编码后长度 */
+size_t fdc_tlm_cobs_encode(const uint8_t *in, size_t len, uint8_t *out);
+
+/* 把 payload 编码为完整帧（含前后分隔符）：CRC 写在 buf[len..len+1]，buf 须有 len + 2 字节空间；
+ * cap 不足 FDC_TLM_FRAME_LEN(len) 时返回 0，否则返回帧长 */
+size_t fdc_tlm_encode_frame(uint8_t *buf, size_t len, uint8_t *out, size_t cap);
+
+/* 把一组样本编码为完整帧（含前后分隔符）；cap 不足 FDC_TLM_FRAME_MAX 时返回 0 */
+size_t fdc_tlm_encode_sample(uint8_t dev, const fdc_sample_t *smp, uint8_t *out, size_t cap);
+
+#endif /* __FDC_TELEMETRY_H__ */
@@ -0,0 +1,61 @@
+/*
+ * lra_lockin.h
+ * 锁相（同步）检测：按驱动相位求响应在驱动频率上的幅度与相位（纯 C 整数运算，不依赖 HAL）
+ *
+ * 说明：驱动频率已知，每个样本带有采样时刻的驱动相位 φ（Q32，TIM3_GetDrivePhase），
+ * 把响应拟合为 x ≈ m + b·sin φ + c·cos φ，则
+ *   幅度 A = √(b² + c²)，相位 θ = atan2(c, b)，即 x 的基波分量 = A·sin(φ + θ)；
+ *   θ > 0 表示响应超前于驱动基波，LRA 位移在谐振点滞后约 90°。
+ * b、c 由减去均值后的 2×2 最小二乘方程联立求得（含 sin φ 与 cos φ 的相关项），在相位分布不均匀时也不偏，
+ * 不要求采样率高于驱动频率或与之同步：欠采样时只要相位在周期内分布开即可（样本率不是驱动频率的整数倍）。
+ * 驱动频率是样本率一半的整数倍（如每通道 100 SPS 时的 150 / 200 / 250 Hz）时每个样本的相位相同或只在两个值间
+ * 交替，方程病态，结果为 LRA_LOCKIN_ERR_PHASE；这与没有响应不同，把频率偏开 lra_lockin_detune_mhz() 后重测即可。
+ * 直流与慢漂移由减去均值消除。每样本只有查表与 64-bit 乘加，结果在取值时计算一次。
+ * 数值范围：样本以第一个样本为零点，偏离限幅 ±2^22 个计数；最多累加 LRA_LOCKIN_N_MAX 个样本
+ * （之后的样本忽略），此时全部累加值在 int64 以内。
+ */
+
+#ifndef __LRA_LOCKIN_H__
+#define __LRA_LOCKIN_H__
+
+#include <stdint.h>
+
+/* 单次检测最多 / 最少的样本数 */
+#define LRA_LOCKIN_N_MAX  65535U
+#define LRA_LOCKIN_N_MIN  8U
+
+/* lra_lockin_result() 的返回码（与 lra_sweep_status_t / lra_track_status_t 同为负数，数值不重叠） */
+typedef enum {
+    LRA_LOCKIN_OK = 0,
+    LRA_LOCKIN_ERR_SAMPLES = -50,   /* 样本不足 LRA_LOCKIN_N_MIN（没有数据） */
+    LRA_LOCKIN_ERR_PHASE = -51,     /* 相位没有分布开：驱动频率与样本率相干，方程病态 */
+} lra_lockin_status_t;
+
+typedef struct {
+    int32_t x0;         /* 第一个样本（零点） */
+    uint32_t n;
+    int64_t sx, ss, sc;
+    int64_t sxs, sxc, sss, scc, ssc;
+} lra_lockin_t;
+
+typedef struct {
+    int32_t in_phase_q8;    /* b = A·cosθ（与驱动同相的分量），单位：样本计数 × 256 */
+    int32_t quadrature_q8;  /* c = A·sinθ */
+    uint32_t amp_q8;        /* A，样本计数 × 256 */
+    int16_t phase_ddeg;     /* θ，0.1°，-1800..1800 */
+    uint32_t n;             /* 参与计算的样本数 */
+} lra_lockin_result_t;
+
+void lra_lockin_reset(lra_lockin_t *l);
+/* 累加一个样本：x 为响应（如 FDC raw），phase 为该样本采样时刻的驱动相位（Q32） */
+void lra_lockin_add(lra_lockin_t *l, int32_t x, uint32_t phase);
+/* 计算结果，成功返回 LRA_LOCKIN_OK；样本不足返回 LRA_LOCKIN_ERR_SAMPLES，相位没有分布开返回 LRA_LOCKIN_ERR_PHASE */
+int lra_lockin_result(const lra_lockin_t *l, lra_lockin_result_t *out);
+/* 相干时的失谐量（mHz）：驱动频率偏开该值后，window_ms 的测量窗口内样本相位至少漂移 1/4 周期 */
+uint32_t lra_lockin_detune_mhz(uint32_t window_ms);
+
+/* 延迟 delay_ns 在频率 f_mhz（mHz）下对应的相位（Q32，取一周内的小数部分）。
+ * 样本的时间戳比实际采样时刻晚 delay_ns 时，从时间戳相位中减去该值即为采样时刻的相位 */
+uint32_t lra_phase_of_delay(uint32_t f_mhz, uint32_t delay_ns);
+
+#endif /* __LRA_LOCKIN_H__ */
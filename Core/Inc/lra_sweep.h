@@ -0,0 +1,94 @@
+/*
+ * lra_sweep.h
+ * LRA 频率响应扫描与谐振点查找：TIM3 驱动频率逐点步进，在每个频点用锁相检测（lra_lockin.h）
+ * 测量 FDC2214 某一通道（或 ADC1）在驱动频率上的响应幅度与相位，输出 Bode 幅频 / 相频数据与谐振峰
+ *
+ * 说明：
+ * - 每个频点：设置频率 -> 等待 settle_ms（LRA 瞬态衰减）-> 累加 measure_ms 内的样本 -> 计算幅度 / 相位；
+ *   样本的驱动相位来自 INTB 时刻的时间戳钩子（main 中 fdc_set_stamp_hook(TIM3_GetDrivePhase)），
+ *   再减去通道采样延迟（fdc_plan_sample_delay_ns）对应的相位；ADC1 源在主循环中每 ms 取一次转换结果，
+ *   同时读取驱动相位。锁相检测不要求采样率高于驱动频率（4 通道 100 SPS 也可测 175 Hz 的响应）。
+ * - 锁相检测失败的点标为无效：相位没有分布开（驱动频率接近样本率一半的整数倍，如 100 SPS 时的 200 Hz）时
+ *   先把该点沿扫描方向偏开 lra_lockin_detune_mhz(measure_ms)（不超过半个步长）重新等待、测量一次，
+ *   仍失败或根本没有样本则输出为无效点，不参与下面的峰值、插值与 -3 dB 交点。
+ * - 扫描结束：取幅度最大的有效点，用它与两侧最近有效点的三点抛物线插值得到谐振频率 f0，按幅度下降到峰值 1/√2 的两侧交点
+ *   （点间线性插值）得到 -3 dB 带宽与 Q = f0 / 带宽（任一侧不在扫描范围内时不给出），
+ *   驱动停在 f0；没有任何有效点或中途 lra_sweep_stop() 则恢复扫描前的驱动频率。
+ * - 全部在主循环中完成（lra_sweep_feed 每个样本，lra_sweep_poll 每轮），ISR 中只有时间戳钩子。
+ * - 输出：文本模式每点一行，二进制模式每点一帧 FDC_TLM_TYPE_SWEEP 遥测（主机 tools/fdc_telemetry.py
+ *   换算 dB），结束时一条结果。帧 payload（多字节小端）：
+ *     [0]      type(高 4 位) | src(低 4 位)    src = 芯片 × 4 + 通道，ADC1 为 LRA_SWEEP_SRC_ADC
+ *     [1]      kind    LRA_SWEEP_KIND_POINT / LRA_SWEEP_KIND_RESULT
+ *     POINT（16 字节）：[2..3] 点序号  [4..7] 实际频率 mHz  [8..11] 幅度（样本计数 × 256）
+ *                       [12..13] 相位 0.1°（int16，LRA_SWEEP_PHASE_INVALID = 无效点，幅度为 0）  [14..15] 样本数
+ *     RESULT（20 字节）：[2..3] 点数  [4..7] f0 mHz  [8..11] 峰值幅度（× 256）  [12..15] -3 dB 带宽 mHz（0 = 未知）
+ *                       [16..17] Q × 100（0 = 未知）  [18..19] 峰值点相位 0.1°
+ * 驱动频率在扫描期间由本模块占用，"freq" 等命令的修改会在下一个频点被覆盖，"freq 0" 中止扫描。
+ * 扫频（chirp）需要连续改频率与逐周期解调，这里采用步进扫描：每点稳态测量，结果不受扫描速度影响。
+ */
+
+#ifndef __LRA_SWEEP_H__
+#define __LRA_SWEEP_H__
+
+#include <stdint.h>
+#include "fdc2214.h"
+
+/* 单次扫描最多的频点数 */
+#define LRA_SWEEP_POINTS_MAX    64U
+/* 默认等待 / 测量时间（ms） */
+#define LRA_SWEEP_SETTLE_MS     300U
+#define LRA_SWEEP_MEASURE_MS    500U
+
+#define LRA_SWEEP_SRC_ADC       0xFU
+#define LRA_SWEEP_KIND_POINT    0U
+#define LRA_SWEEP_KIND_RESULT   1U
+#define LRA_SWEEP_POINT_PAYLOAD   16U
+#define LRA_SWEEP_RESULT_PAYLOAD  20U
+/* POINT 帧中无效点的相位（正常相位在 -1800..1800） */
+#define LRA_SWEEP_PHASE_INVALID   INT16_MIN
+
+/* 返回码（与 fdc_status_t / fdc_plan_status_t 同为负数，数值不重叠） */
+typedef enum {
+    LRA_SWEEP_OK = 0,
+    LRA_SWEEP_ERR_PARAM = -30,      /* 频率超出 TIM3 范围、步长为 0、时间为 0 等 */
+    LRA_SWEEP_ERR_POINTS = -31,     /* 频点数超过 LRA_SWEEP_POINTS_MAX */
+} lra_sweep_status_t;
+
+typedef struct {
+    uint8_t use_adc;            /* 1 = ADC1，0 = FDC 芯片 dev 的通道 ch */
+    uint8_t dev;
+    uint8_t ch;
+    uint8_t binary;             /* 1 = 输出遥测帧，0 = 文本 */
+    uint32_t f_start_mhz;       /* 起止频率（mHz），起点可高于终点（向下扫） */
+    uint32_t f_stop_mhz;
+    uint32_t f_step_mhz;
+    uint16_t settle_ms;
+    uint16_t measure_ms;
+    uint32_t delay_ns;          /* 样本采样时刻早于时间戳的时间（FDC 源为 fdc_plan_sample_delay_ns，ADC 为 0） */
+} lra_sweep_cfg_t;
+
+/* 扫描结果 */
+typedef struct {
+    uint8_t points;
+    uint8_t valid_points;       /* 锁相检测成功、参与分析的点数 */
+    uint32_t f0_mhz;            /* 插值后的谐振频率 */
+    uint32_t amp_q8;            /* 峰值点幅度（样本计数 × 256） */
+    int16_t phase_ddeg;         /* 峰值点相位（0.1°） */
+    uint32_t bw_mhz;            /* -3 dB 带宽，0 = 未知 */
+    uint16_t q_x100;            /* Q × 100，0 = 未知 */
+} lra_sweep_result_t;
+
+/* 开始扫描（正在扫描时先中止上一次）；成功后驱动立即切到起点频率 */
+int lra_sweep_start(const lra_sweep_cfg_t *cfg);
+/* 中止扫描并恢复扫描前的驱动频率 */
+void lra_sweep_stop(void);
+/* 扫描进行中返回 1 */
+int lra_sweep_busy(void);
+/* 主循环：每取到芯片 dev 的一组样本调用一次 */
+void lra_sweep_feed(uint8_t dev, const fdc_sample_t *smp);
+/* 主循环：每轮调用，推进频点并输出结果 */
+void lra_sweep_poll(void);
+/* 最近一次完成的扫描结果；尚无结果返回 0 */
+int lra_sweep_get_result(lra_sweep_result_t *out);
+
+#endif /* __LRA_SWEEP_H__ */
@@ -0,0 +1,90 @@
+/*
+ * lra_track.h
+ * LRA 谐振跟踪：后台锁相环，测量 TIM3 驱动基波与传感响应之间的相位，持续微调驱动频率，
+ * 使 LRA 在温度 / 负载引起谐振点漂移时仍工作在谐振点上（同样的驱动功率得到最大振幅）
+ *
+ * 说明：
+ * - 相位检测与扫频相同（lra_lockin.h）：每个样本带 INTB 时刻的驱动相位，减去通道采样延迟；
+ *   每个测量窗口（measure_ms）得到一次响应相位 θ。
+ * - 二阶系统的位移在谐振点滞后驱动 90°，低于谐振时滞后更少、高于时更多，θ 随频率单调下降，
+ *   斜率约 -360·Q / (π·f0) °/Hz。误差 e = θ - 设定值（默认 -90°，用速度类信号如反电动势时设 0°），
+ *   频率按 Δf = gain × e 积分（每个窗口一次，单步限幅 LRA_TRACK_STEP_MAX_MHZ），即锁相环的积分环节：
+ *   稳态相位误差为 0，频率漂移由积分吸收。gain 取斜率倒数的一半左右时每个窗口消去约一半误差；
+ *   上次扫频给出 Q 时按其 f0 / Q 计算默认 gain，否则用 LRA_TRACK_GAIN_MHZ_PER_DEG。
+ * - 改频后先等待 settle_ms（LRA 瞬态衰减，时间常数 Q / (π·f0)）再开始下一个窗口；
+ *   频率限制在启动频率 ± span_mhz 内，响应消失（没有样本或幅度为 0）时保持当前频率。
+ * - 驱动频率接近 k·SPS/2 时窗口内相位几乎不变，相位解不出（LRA_LOCKIN_ERR_PHASE，与"没有响应"分开报告）：
+ *   由窗口内驱动相位的漂移推算盲区中心，测量窗口加长到 LRA_TRACK_BLIND_WIN_MUL 倍（盲区随之变窄），
+ *   移到中心 ± lra_lockin_detune_mhz(窗口) 再测；此后环路要求的频率落在盲区内时停在边缘
+ *   （状态行标 "held off k*SPS/2"），离开盲区 4 倍失调量后清除记录、窗口恢复 measure_ms。
+ * - |e| 连续 LRA_TRACK_LOCK_COUNT 个窗口小于 LRA_TRACK_LOCK_DDEG 视为锁定，锁定 / 失锁时各打印一行，
+ *   另外每 LRA_TRACK_REPORT_MS 打印一次状态。
+ * - 与扫频一样全部在主循环中完成（lra_track_feed 每个样本，lra_track_poll 每轮），ISR 中只有时间戳钩子；
+ *   驱动频率由本模块占用，"freq" 命令修改后以新的频率为中心继续跟踪，驱动停止（freq 0）时跟踪自动结束。
+ */
+
+#ifndef __LRA_TRACK_H__
+#define __LRA_TRACK_H__
+
+#include <stdint.h>
+#include "fdc2214.h"
+
+/* 默认等待 / 测量时间（ms） */
+#define LRA_TRACK_SETTLE_MS         100U
+#define LRA_TRACK_MEASURE_MS        300U
+/* 默认设定相位（0.1°）与环路增益（每 1° 相位误差调整的 mHz） */
+#define LRA_TRACK_SETPOINT_DDEG     (-900)
+#define LRA_TRACK_GAIN_MHZ_PER_DEG  40U
+/* 单个窗口最大调整量（mHz）与默认跟踪范围（启动频率 ± mHz） */
+#define LRA_TRACK_STEP_MAX_MHZ      2000U
+#define LRA_TRACK_SPAN_MHZ          20000U
+/* 锁定判据与状态打印周期 */
+#define LRA_TRACK_LOCK_DDEG         50
+#define LRA_TRACK_LOCK_COUNT        3U
+#define LRA_TRACK_REPORT_MS         1000U
+/* 相位解不出时测量窗口的加长倍数（盲区宽度与窗口时长成反比） */
+#define LRA_TRACK_BLIND_WIN_MUL     4U
+
+/* 返回码（与 lra_sweep_status_t 同为负数，数值不重叠） */
+typedef enum {
+    LRA_TRACK_OK = 0,
+    LRA_TRACK_ERR_PARAM = -40,      /* 源通道、时间或增益无效 */
+    LRA_TRACK_ERR_STOPPED = -41,    /* 驱动未运行：先用 freq 设置起始频率 */
+} lra_track_status_t;
+
+typedef struct {
+    uint8_t use_adc;            /* 1 = ADC1，0 = FDC 芯片 dev 的通道 ch */
+    uint8_t dev;
+    uint8_t ch;
+    int16_t setpoint_ddeg;      /* 设定相位（0.1°，-1800..1800） */
+    uint32_t gain_mhz_per_deg;  /* 0 = 默认（见上面的说明） */
+    uint32_t span_mhz;          /* 0 = LRA_TRACK_SPAN_MHZ */
+    uint16_t settle_ms;
+    uint16_t measure_ms;
+    uint32_t delay_ns;          /* 样本采样时刻早于时间戳的时间（同 lra_sweep_cfg_t） */
+} lra_track_cfg_t;
+
+typedef struct {
+    uint8_t running;
+    uint8_t locked;
+    uint32_t f_mhz;             /* 当前驱动频率（实际值） */
+    int16_t phase_ddeg;         /* 最近一个窗口的响应相位 */
+    int16_t error_ddeg;         /* 相位误差 θ - 设定值 */
+    uint32_t amp_q8;            /* 最近一个窗口的响应幅度（样本计数 × 256） */
+    uint32_t gain_mhz_per_deg;
+    uint32_t updates;           /* 已完成的窗口数 */
+    int8_t lockin_status;       /* 最近一个窗口：LRA_LOCKIN_OK，相位解不出 LRA_LOCKIN_ERR_PHASE，
+                                 * 没有响应 LRA_LOCKIN_ERR_SAMPLES；非 OK 时 phase / error 为更早窗口的值 */
+} lra_track_state_t;
+
+/* 从当前驱动频率开始跟踪（正在跟踪时按新参数重新开始） */
+int lra_track_start(const lra_track_cfg_t *cfg);
+void lra_track_stop(void);
+int lra_track_busy(void);
+/* 主循环：每取到芯片 dev 的一组样本调用一次 */
+void lra_track_feed(uint8_t dev, const fdc_sample_t *smp);
+/* 主循环：每轮调用，窗口结束时更新频率 */
+void lra_track_poll(void);
+void lra_track_get_state(lra_track_state_t *out);
+
+#endif /* __LRA_TRACK_H__ */
@@ -69,6 +69,14 @@ void Error_Handler(void);
 #define IN1_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
+/* FDC2214 INTB（低有效，DRDY 中断），接 PB8 -> EXTI8 */
+#define FDC_INTB_Pin GPIO_PIN_8
+#define FDC_INTB_GPIO_Port GPIOB
+#define FDC_INTB_EXTI_IRQn EXTI9_5_IRQn
+/* 第二片 FDC2214（ADDR = H，0x2B）的 INTB，接 PB9 -> EXTI9，与 PB8 共用 EXTI9_5 中断 */
+#define FDC2_INTB_Pin GPIO_PIN_9
+#define FDC2_INTB_GPIO_Port GPIOB
+#define FDC2_INTB_EXTI_IRQn EXTI9_5_IRQn
 
 /* USER CODE END Private defines */
 
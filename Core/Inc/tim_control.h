@@ -1,19 +1,33 @@
 /*
  * tim_control.h
- * 1) TIM2 CH1 PWM输出控制（占空比可调）
- * 2) TIM3 低频振动控制（20/60/100Hz），通过中断翻转IN1/IN2
- * 支持串口命令配置PWM占空比和振动频率
+ * 1) TIM2 CH1 PWM输出控制（载波频率与占空比可调，占空比最高 16-bit 分辨率）
+ * 2) TIM3 低频振动控制（20/60/100Hz），硬件定时换向IN1/IN2并插入死区
+ * 3) 波形模式：驱动幅度按 Flash 中的表（正弦等）逐 PWM 周期变化，DMA 写 CCR1，与换向硬件同步
+ * 串口命令（cmd_shell.h 的 duty / freq）调用下面的接口配置PWM占空比和振动频率
  *
  * 使用说明：
  * - TIM2 PWM输出：
- *   1. 调用 TIM2_Control_Init() 启动PWM
- *   2. 使用 TIM2_PWM_SetDutyPercent(percent) 设定占空比（0-100）
+ *   1. 调用 TIM2_Control_Init() 启动PWM（载波 TIM2_PWM_CARRIER_HZ）
+ *   2. 使用 TIM2_PWM_SetDutyQ16() / SetDutyPermille() / SetDutyPercent() 设定占空比
+ *   3. TIM2_PWM_SetCarrierHz() 改载波：PSC 取最小，ARR+1 即占空比级数（72 MHz、10 kHz 时 7200 级）
+ *   ARR、CCR1 均为预装载，新占空比在当前 PWM 周期结束后生效，不会出现被截断的脉冲。
  * 
  * - TIM3 振动控制：
- *   1. 在main中已由CubeMX生成的MX_TIM3_Init()配置并启动定时器
- *   2. 使用 TIM3_SetSquareFreqHz() 设置频率（如20/60/100Hz）
- *   3. 主循环中调用 TIM3_HandlePendingToggle() 执行IN1/IN2翻转
- *   4. 通过串口发送命令（如"f20"）可动态调整频率
+ *   1. MX_TIM3_Init() 之后调用 TIM3_Drive_Init()（从 RCC 得到定时器时钟、配置 CC1 与预装载，不启动）
+ *   2. 使用 TIM3_SetSquareFreqHz() / TIM3_SetSquareFreqMilliHz() 设置频率并启动，0 停止
+ *   3. 通过串口发送命令（如"freq 20"、"freq 175.35"或"f20"、"dead 50"、"dither on"）可动态调整
+ *   频率按 PSC/ARR 联合搜索合成（72 MHz 时钟下 100~200 Hz 的误差在 0.001 Hz 量级），可选小数抖动；
+ *   运行中改频率在换向处整体切换，驱动不停、不丢半周期。
+ *   IN1/IN2（PB4/PB3）不是 TIM3 的输出引脚，换向由 TIM3 更新事件与 CC1 比较事件各触发
+ *   一个 DMA 通道（DMA1_Ch3 / DMA1_Ch6，见 tim.c）写 GPIOB->BSRR 完成：边沿时刻只取决于
+ *   定时器，与主循环、中断负载无关，运行中不需要任何 CPU 参与。
+ *
+ * - 波形模式（正弦等幅度包络，降低方波驱动的谐波）：
+ *   1. TIM3_SetWaveform(drive_wave_find("sine")) 选择 Flash 中的幅度表（drive_wave.h），NULL 回到方波
+ *   2. 频率、死区仍用上面的接口设置；占空比接口设置满幅样本对应的占空比（即驱动幅度）
+ *   TIM2 的更新事件经 DMA1_Ch2 逐周期把样本写入 CCR1，同时作为 TRGO 给 TIM3 计数：半周期正好
+ *   一张表（PWM 载波 = 2 × 表长 × 驱动频率，pwmf 设置在回到方波模式后生效），两者硬件同步，
+ *   运行中没有中断。频率分辨率为半周期的表长个定时器时钟，不使用小数抖动。
  */
 
 #ifndef __TIM_CONTROL_H
@@ -21,31 +35,87 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "drive_wave.h"
+
+/* TIM2 PWM 默认载波频率（Hz），与原 CubeMX 配置（PSC=71、ARR=99）相同 */
+#ifndef TIM2_PWM_CARRIER_HZ
+#define TIM2_PWM_CARRIER_HZ  10000U
+#endif
+/* 载波上限对应的最少占空比级数 */
+#define TIM2_PWM_MIN_STEPS   100U
 
 /* 初始化并启动TIM2 PWM输出 */
 void TIM2_Control_Init(void);
 
-/* 设置TIM2 CH1 PWM占空比（0-100%）
- * 内部自动根据ARR换算并立即生效
+/* 设置载波频率（Hz），返回实际频率；占空比保持不变。波形模式下只记录，返回当前载波 */
+uint32_t TIM2_PWM_SetCarrierHz(uint32_t hz);
+uint32_t TIM2_PWM_GetCarrierHz(void);
+/* 每个 PWM 周期的计数级数（ARR+1） */
+uint32_t TIM2_PWM_GetSteps(void);
+
+/* 设置TIM2 CH1 PWM占空比，在下一个PWM周期生效
+ * - Q16：0..65536（65536 = 100%），按当前级数四舍五入
+ * - 千分比：0..1000
+ * - 百分比：0..100
  */
+void TIM2_PWM_SetDutyQ16(uint32_t q16);
+void TIM2_PWM_SetDutyPermille(uint16_t permille);
 void TIM2_PWM_SetDutyPercent(uint8_t percent);
+/* 最近一次设置的占空比 */
+uint32_t TIM2_PWM_GetDutyQ16(void);
+uint16_t TIM2_PWM_GetDutyPermille(void);
+uint8_t TIM2_PWM_GetDutyPercent(void);
+
+/* IN1/IN2 换向死区的默认值（us） */
+#ifndef TIM3_DEADTIME_US
+#define TIM3_DEADTIME_US  100U
+#endif
 
-/* 设置TIM3频率（Hz）
- * - 支持20/60/100Hz等低频档位
- * - 会自动计算ARR并重启定时器
+/* 振动频率范围（mHz）：上限保证运行中改频率的更新中断远快于半周期 */
+#define TIM3_FREQ_MIN_MHZ  1000U
+#define TIM3_FREQ_MAX_MHZ  5000000U
+
+/* 配置TIM3为H桥驱动时基（定时器时钟取自RCC，ARR/CCR1预装载），两路输出拉低，不启动 */
+void TIM3_Drive_Init(void);
+
+/* 设置TIM3频率（mHz），超出 TIM3_GetFreqMinMilliHz()..TIM3_FREQ_MAX_MHZ 时取边界值
+ * - 在 PSC/ARR 组合中搜索误差最小者，抖动打开时再用逐周期 ARR 抖动补上小数 tick
+ * - 停止状态下启动驱动；运行中由下一次更新中断写入新的 PSC/ARR/CCR1，在之后的换向处
+ *   整体生效（最迟两个半周期），定时器不停，每个半周期都完整
+ * - mhz = 0 停止驱动并把IN1/IN2拉低
  */
+void TIM3_SetSquareFreqMilliHz(uint32_t mhz);
+/* 整数 Hz 版本 */
 void TIM3_SetSquareFreqHz(uint32_t hz);
+/* 当前波形可达的最低频率（mHz）：方波为 TIM3_FREQ_MIN_MHZ；波形模式下 TIM2 PSC 固定为 0，
+ * 半周期最多 len × 65536 个定时器时钟（72 MHz、128 点时约 4.292 Hz） */
+uint32_t TIM3_GetFreqMinMilliHz(void);
+/* 最近一次设置的频率，未设置时为 0 */
+uint32_t TIM3_GetSquareFreqHz(void);
+uint32_t TIM3_GetSquareFreqMilliHz(void);
+/* 合成得到的实际（平均）频率，mHz */
+uint32_t TIM3_GetActualFreqMilliHz(void);
+/* 当前（或待生效）的 PSC、ARR 与 Q16 小数 tick，可传 NULL；波形模式下为 TIM2 载波的 PSC / ARR */
+void TIM3_GetTiming(uint16_t *psc, uint16_t *arr, uint16_t *frac);
 
-/* TIM3中断设置的翻转请求标志 */
-extern volatile uint8_t tim3_toggle_flag;
+/* 当前驱动相位，Q32（2^32 = 一个驱动周期）：以驱动电压的基波为准，驱动基波 ∝ sin(相位)，
+ * 即相位 0 在 IN1 半周期的开始（已补偿死区造成的基波滞后）。由 TIM3 / TIM2 计数与换向 DMA 的
+ * 剩余计数换算，可在中断中调用（如 fdc_set_stamp_hook）；驱动停止时返回 0 */
+uint32_t TIM3_GetDrivePhase(void);
 
-/* 主循环调用：执行IN1/IN2翻转（带2ms软件死区） */
-void TIM3_HandlePendingToggle(void);
+/* 设置换向死区（us），最多取半周期的一半；运行中在下一次换向处生效 */
+void TIM3_SetDeadTimeUs(uint32_t us);
+uint32_t TIM3_GetDeadTimeUs(void);
 
-/* 解析串口命令
- * - PWM占空比：数字表示百分比，如"50"设置为50%
- * - TIM3频率："f"开头，如"f20"设置为20Hz
- */
-void HandleTIM3Command(const char *cmd);
+/* 小数抖动：打开后每个半周期进一次 TIM3 更新中断（只写预装载寄存器，边沿仍由硬件定时），
+ * 平均频率精确到 1/65536 tick；关闭时运行中没有中断，频率只能取整数 tick。默认关闭 */
+void TIM3_SetDither(bool on);
+bool TIM3_GetDither(void);
+
+/* 选择驱动波形：wave 为 drive_waves[] 中的表，NULL 为方波（默认）。运行中切换时驱动先停再按
+ * 当前频率重新启动（低于新波形的 TIM3_GetFreqMinMilliHz() 时取下限）；
+ * 波形模式下 TIM2 由驱动占用（载波随频率变化），停止驱动后恢复原载波 */
+void TIM3_SetWaveform(const drive_wave_t *wave);
+const drive_wave_t *TIM3_GetWaveform(void);
 
 #endif /* __TIM_CONTROL_H */
@@ -36,6 +36,9 @@ extern UART_HandleTypeDef huart1;
 
 /* USER CODE BEGIN Private defines */
 
+extern DMA_HandleTypeDef hdma_usart1_tx;
+extern DMA_HandleTypeDef hdma_usart1_rx;
+
 /* USER CODE END Private defines */
 
 void MX_USART1_UART_Init(void);
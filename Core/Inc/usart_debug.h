@@ -6,16 +6,100 @@
 #define __USART_DEBUG_H__
 
 #include "main.h"
+#include "fdc_log.h"
 
-/* 调试输出函数，内部使用 HAL_UART_Transmit 阻塞发送 */
+/* 发送环形缓冲区大小（字节，须为 2 的幂且不超过 32768） */
+#ifndef FDC_DEBUG_TX_BUF_SIZE
+#define FDC_DEBUG_TX_BUF_SIZE   1024U
+#endif
+
+/* 命令接收：循环 DMA 缓冲区大小（字节）。连续发送时只有半满 / 满才回调，一次最多交付半个缓冲区，
+ * 即最多 FDC_DEBUG_RX_DMA_SIZE / 4 条最短命令（1 个字符 + 换行）；命令队列深度不小于此数，
+ * 主循环两次取命令之间到达的一整批命令都放得下 */
+#ifndef FDC_DEBUG_RX_DMA_SIZE
+#define FDC_DEBUG_RX_DMA_SIZE   64U
+#endif
+/* 单条命令最大长度（含结尾 '\0'，最长的 sweep 命令约 42 字节）与命令队列深度（须为 2 的幂且不超过 128） */
+#define FDC_DEBUG_CMD_MAX       48U
+#ifndef FDC_DEBUG_CMD_QUEUE
+#define FDC_DEBUG_CMD_QUEUE     16U
+#endif
+
+/* 发送统计：累计值，不清零 */
+typedef struct {
+    uint32_t queued_bytes;   /* 写入缓冲区的字节数 */
+    uint32_t dropped_msgs;   /* 缓冲区放不下而整条丢弃的消息数 */
+    uint32_t dropped_bytes;
+    uint16_t high_water;     /* 缓冲区占用的最大值 */
+} fdc_debug_tx_stats_t;
+
+/* 接收统计：累计值，不清零 */
+typedef struct {
+    uint32_t lines;          /* 放入命令队列的行数 */
+    uint32_t dropped_lines;  /* 命令队列满而丢弃的行数 */
+    uint32_t overlong;       /* 超过 FDC_DEBUG_CMD_MAX - 1 字节而丢弃的行数 */
+    uint32_t restarts;       /* 接收错误后重启 DMA 接收的次数 */
+} fdc_debug_rx_stats_t;
+
+/* 限频打印的缺省参数：每 FDC_DEBUG_LIMIT_PERIOD_MS 补充 1 个令牌，最多积攒 FDC_DEBUG_LIMIT_BURST 个 */
+#ifndef FDC_DEBUG_LIMIT_PERIOD_MS
+#define FDC_DEBUG_LIMIT_PERIOD_MS  1000U
+#endif
+#ifndef FDC_DEBUG_LIMIT_BURST
+#define FDC_DEBUG_LIMIT_BURST      3U
+#endif
+
+/* 单个调用点的令牌桶限频状态，由 fdc_debug_print_ratelimit 宏在调用点定义为 static */
+typedef struct {
+    uint32_t last_ms;        /* 上次补充令牌的时刻（HAL_GetTick） */
+    uint16_t period_ms;      /* 每补充 1 个令牌的间隔 */
+    uint8_t burst;           /* 桶容量：空闲一段时间后允许连续打印的条数 */
+    uint8_t tokens;          /* 当前令牌数 */
+    uint32_t suppressed;     /* 自上次放行以来被抑制的条数 */
+} fdc_debug_limit_t;
+
+#define FDC_DEBUG_LIMIT_INIT(period_ms, burst) { 0U, (period_ms), (burst), (burst), 0U }
+
+/* 调试输出函数：写入发送环形缓冲区后立即返回，由 USART1 TX DMA 在后台发送
+ * 格式符为 fdc_fmt.h 支持的子集：不支持 %f，小数先换算为定点整数再用 %.Nk 打印 */
 void fdc_debug_init(void); /* 如需初始化额外资源可在此实现 */
 void fdc_debug_print(const char *fmt, ...);
-/* 限频打印：在周期性或循环中调用错误打印时使用，默认限频为 1000 ms。
- * 该函数会保证同一处的频繁调用不会导致串口刷屏。实现为全局限频。
- */
-void fdc_debug_print_limited(const char *fmt, ...);
+
+/* 限频判定（令牌桶）：有令牌时取走 1 个并返回 1，*suppressed 输出自上次放行以来被抑制的条数并清零；
+ * 无令牌时计入 lim->suppressed 并返回 0。同一个 lim 只能在一个执行上下文（主循环或某个中断）中使用 */
+int fdc_debug_limit_pass(fdc_debug_limit_t *lim, uint32_t *suppressed);
+/* 报告某个调用点被抑制的条数（紧跟在该调用点放行的那条消息之后打印） */
+void fdc_debug_report_suppressed(uint32_t suppressed);
+
+/* 限频打印：在周期性或循环中调用错误打印时使用。每个调用点有独立的令牌桶，
+ * 一处错误刷屏不会挡住其他调用点的诊断；最多连续打印 burst 条，之后每 period_ms 一条，
+ * 期间被抑制的条数在下一次放行时报告。串口负载上限为 调用点数 × 每秒 1000 / period_ms 条 */
+#define fdc_debug_print_ratelimit(period_ms, burst, fmt, ...)                             \
+    do {                                                                                   \
+        static fdc_debug_limit_t fdc_debug_lim_ = FDC_DEBUG_LIMIT_INIT(period_ms, burst);  \
+        uint32_t fdc_debug_sup_;                                                           \
+        if (fdc_debug_limit_pass(&fdc_debug_lim_, &fdc_debug_sup_)) {                      \
+            fdc_debug_print(fmt, ##__VA_ARGS__);                                           \
+            if (fdc_debug_sup_ != 0U) fdc_debug_report_suppressed(fdc_debug_sup_);         \
+        }                                                                                  \
+    } while (0)
+/* 缺省参数的限频打印 */
+#define fdc_debug_print_limited(fmt, ...) \
+    fdc_debug_print_ratelimit(FDC_DEBUG_LIMIT_PERIOD_MS, FDC_DEBUG_LIMIT_BURST, fmt, ##__VA_ARGS__)
+
+#if FDC_LOG_TOKENIZED
+/* 令牌化日志（见 fdc_log.h）：调用点不变，格式化移到主机端；
+ * 格式串必须是字符串字面量。需要设备端格式化时可写成 (fdc_debug_print)(fmt, ...) 绕过宏 */
+#define fdc_debug_print(fmt, ...)  FDC_LOG_TOKEN_PRINT(fmt, ##__VA_ARGS__)
+#endif
+
+/* 原样写入二进制数据（如 fdc_telemetry 帧），与打印共用发送缓冲区，整块写入或整块丢弃
+ * 返回 0 成功，-1 缓冲区不足已丢弃（计入 fdc_debug_tx_stats_t） */
+int fdc_debug_write(const void *data, uint16_t len);
 
 /* 从主循环读取已接收到的一条完整命令（非阻塞）
+ * 命令由 USART1 RX 循环 DMA + IDLE 中断按行提取，放入 FDC_DEBUG_CMD_QUEUE 条深的队列，
+ * 连续发送的多条命令不会互相覆盖；每次取出最早的一条
  * out: 输出缓冲区，maxlen: 缓冲区长度
  * 返回 1 表示有命令已读取并复制到 out；返回 0 表示无命令
  */
@@ -24,4 +108,10 @@ int fdc_debug_get_command(char *out, int maxlen);
 /* 诊断接口：获取并清除自上次读取以来 UART Rx 回调触发计数（用于确认回调是否被调用） */
 int fdc_debug_get_rx_events(void);
 
+/* 读取发送缓冲区统计（原子拷贝） */
+void fdc_debug_get_tx_stats(fdc_debug_tx_stats_t *out);
+
+/* 读取命令接收统计（原子拷贝） */
+void fdc_debug_get_rx_stats(fdc_debug_rx_stats_t *out);
+
 #endif /* __USART_DEBUG_H__ */
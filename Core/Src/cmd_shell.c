@@ -0,0 +1,636 @@
+/*
+ * cmd_shell.c
+ * 表驱动串口命令解释器（命令列表见 cmd_shell.h）
+ */
+
+#include "cmd_shell.h"
+#include "tim_control.h"
+#include "lra_sweep.h"
+#include "lra_track.h"
+#include "lra_lockin.h"
+#include "usart_debug.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* 单条命令最多参数个数（含命令名） */
+#define CMD_ARGC_MAX  8
+
+typedef struct {
+    const char *name;
+    const char *usage;      /* NULL = 别名，不在 help 中列出；令牌化日志下字符串参数最多 FDC_LOG_STR_MAX 字节 */
+    uint8_t min_args;       /* 不含命令名 */
+    void (*fn)(int argc, char **argv);
+} cmd_entry_t;
+
+/* 采样预设：目标采样率与 SETTLECOUNT（0 = 默认值） */
+typedef struct {
+    const char *name;
+    uint32_t sps;
+    uint16_t settlecount;
+} cmd_profile_t;
+
+static const cmd_profile_t s_profiles[] = {
+    { "fast", 400U, 0U },     /* 高速：分辨率较低，适合快速接近检测 */
+    { "norm", 100U, 0U },     /* 默认配置（FDC_DEFAULT_SPS） */
+    { "fine", 25U, 0x0020U }, /* 低速高分辨率：更长的 RCOUNT 与稳定时间 */
+};
+
+static const char *const s_stream_names[] = { "off", "text", "bin" };
+
+static cmd_shell_ctx_t *s_ctx;
+
+static void cmd_help(int argc, char **argv);
+
+/* 严格解析无符号整数（十进制或 0x 十六进制），整串都必须是数字 */
+static int parse_u32(const char *s, uint32_t *out)
+{
+    char *end;
+    if (s == NULL || *s == '\0' || *s == '-') return 0;
+    unsigned long v = strtoul(s, &end, 0);
+    if (*end != '\0') return 0;
+    *out = (uint32_t)v;
+    return 1;
+}
+
+/* 解析最多 3 位小数的十进制数，结果放大 1000 倍（"175.35" -> 175350）；不用浮点 */
+static int parse_milli(const char *s, uint32_t *out)
+{
+    uint32_t v = 0;
+    int digits = 0, frac = -1;
+    if (s == NULL || *s == '\0') return 0;
+    for (; *s != '\0'; ++s) {
+        if (*s == '.' && frac < 0) {
+            frac = 0;
+            continue;
+        }
+        if (*s < '0' || *s > '9' || frac >= 3 || v > (UINT32_MAX - 9U) / 10U) return 0;
+        v = v * 10U + (uint32_t)(*s - '0');
+        digits++;
+        if (frac >= 0) frac++;
+    }
+    if (digits == 0) return 0;
+    for (int i = (frac < 0) ? 0 : frac; i < 3; ++i) {
+        if (v > UINT32_MAX / 10U) return 0;
+        v *= 10U;
+    }
+    *out = v;
+    return 1;
+}
+
+/* 解析芯片参数："0".."n-1" 返回对应位，"*" 返回全部初始化成功的芯片；失败返回 0 */
+static uint8_t parse_dev(const char *s)
+{
+    uint8_t mask = 0;
+    for (uint8_t u = 0; u < s_ctx->dev_count; ++u) {
+        if (s_ctx->dev_ok[u]) mask |= (uint8_t)(1U << u);
+    }
+    if (strcmp(s, "*") == 0) return mask;
+    uint32_t u;
+    if (!parse_u32(s, &u) || u >= s_ctx->dev_count) return 0;
+    if (!(mask & (1U << u))) {
+        fdc_debug_print("U%lu not initialized\r\n", (unsigned long)u);
+        return 0;
+    }
+    return (uint8_t)(1U << u);
+}
+
+static void print_config(uint8_t u)
+{
+    const fdc_config_t *cfg = fdc_get_config(s_ctx->dev[u]);
+    fdc_debug_print("U%u: %u ch from CH%u, %.3lk SPS, RCOUNT=0x%04X SETTLE=0x%04X fREF=%lu Hz ENOB=%u\r\n",
+                    (unsigned)u, (unsigned)cfg->channel_count, (unsigned)cfg->first_channel,
+                    (long)cfg->actual_msps, (unsigned)cfg->rcount, (unsigned)cfg->settlecount,
+                    (unsigned long)cfg->fref_hz, (unsigned)cfg->enob);
+}
+
+/* 采样配置改变后的公共处理：打印结果并通知主循环 */
+static void after_reconfig(uint8_t u, int r)
+{
+    if (r != FDC_OK) {
+        fdc_debug_print("U%u: %s (%d)\r\n", (unsigned)u, fdc_err_str(r), r);
+        return;
+    }
+    if (s_ctx->on_reconfig != NULL) s_ctx->on_reconfig(u);
+    print_config(u);
+}
+
+static void cmd_stat(int argc, char **argv)
+{
+    for (uint8_t u = 0; u < s_ctx->dev_count; ++u) {
+        if (!s_ctx->dev_ok[u]) {
+            fdc_debug_print("U%u: not present\r\n", (unsigned)u);
+            continue;
+        }
+        fdc_stats_t st;
+        print_config(u);
+        fdc_get_stats(s_ctx->dev[u], &st);
+        /* 分两行打印：令牌化日志每条最多 FDC_LOG_MAX_ARGS 个参数 */
+        fdc_debug_print("U%u: samples=%lu dropped=%lu i2c_err=%lu\r\n", (unsigned)u, (unsigned long)st.samples,
+                        (unsigned long)st.dropped, (unsigned long)st.i2c_errors);
+        fdc_debug_print("U%u: wd=%lu/%lu/%lu/%lu overrun=%lu/%lu/%lu/%lu\r\n", (unsigned)u,
+                        (unsigned long)st.err_wd[0], (unsigned long)st.err_wd[1], (unsigned long)st.err_wd[2],
+                        (unsigned long)st.err_wd[3], (unsigned long)st.overruns[0], (unsigned long)st.overruns[1],
+                        (unsigned long)st.overruns[2], (unsigned long)st.overruns[3]);
+    }
+}
+
+static void cmd_rd(int argc, char **argv)
+{
+    uint8_t mask = parse_dev(argv[1]);
+    uint32_t reg;
+    if (mask == 0U || !parse_u32(argv[2], &reg) || reg > 0xFFU) {
+        fdc_debug_print("usage: rd U REG\r\n");
+        return;
+    }
+    for (uint8_t u = 0; u < s_ctx->dev_count; ++u) {
+        if (!(mask & (1U << u))) continue;
+        uint16_t v;
+        int r = fdc_read_reg(s_ctx->dev[u], (uint8_t)reg, &v);
+        if (r == FDC_OK) fdc_debug_print("U%u reg 0x%02lX = 0x%04X\r\n", (unsigned)u, (unsigned long)reg, (unsigned)v);
+        else fdc_debug_print("U%u reg 0x%02lX: %s\r\n", (unsigned)u, (unsigned long)reg, fdc_err_str(r));
+    }
+}
+
+static void cmd_wr(int argc, char **argv)
+{
+    uint8_t mask = parse_dev(argv[1]);
+    uint32_t reg, val;
+    if (mask == 0U || !parse_u32(argv[2], &reg) || reg > 0xFFU || !parse_u32(argv[3], &val) || val > 0xFFFFU) {
+        fdc_debug_print("usage: wr U REG VAL\r\n");
+        return;
+    }
+    for (uint8_t u = 0; u < s_ctx->dev_count; ++u) {
+        if (!(mask & (1U << u))) continue;
+        int r = fdc_write_reg(s_ctx->dev[u], (uint8_t)reg, (uint16_t)val);
+        fdc_debug_print("U%u reg 0x%02lX <- 0x%04lX: %s\r\n", (unsigned)u, (unsigned long)reg,
+                        (unsigned long)val, fdc_err_str(r));
+    }
+}
+
+static void cmd_sps(int argc, char **argv)
+{
+    uint8_t mask = parse_dev(argv[1]);
+    uint32_t sps;
+    if (mask == 0U || !parse_u32(argv[2], &sps) || sps == 0U) {
+        fdc_debug_print("usage: sps U RATE\r\n");
+        return;
+    }
+    for (uint8_t u = 0; u < s_ctx->dev_count; ++u) {
+        if (!(mask & (1U << u))) continue;
+        fdc_plan_req_t req = *fdc_get_plan_request(s_ctx->dev[u]);
+        req.target_sps = sps;
+        after_reconfig(u, fdc_configure(s_ctx->dev[u], &req));
+    }
+}
+
+static void cmd_seq(int argc, char **argv)
+{
+    uint8_t mask = parse_dev(argv[1]);
+    const char *a = argv[2];
+    fdc_sequence_t seq;
+    if ((a[0] == 'c' || a[0] == 'C') && a[1] >= '0' && a[1] <= '3' && a[2] == '\0') {
+        seq = (fdc_sequence_t)(FDC_SEQ_SINGLE_CH0 + (a[1] - '0'));
+    } else if (a[0] >= '2' && a[0] <= '4' && a[1] == '\0') {
+        seq = (fdc_sequence_t)(FDC_SEQ_CH0_1 + (a[0] - '2'));
+    } else {
+        mask = 0;
+    }
+    if (mask == 0U) {
+        fdc_debug_print("usage: seq U 2|3|4|c0..c3\r\n");
+        return;
+    }
+    for (uint8_t u = 0; u < s_ctx->dev_count; ++u) {
+        if (!(mask & (1U << u))) continue;
+        after_reconfig(u, fdc_set_sequence(s_ctx->dev[u], seq));
+    }
+}
+
+static void cmd_prof(int argc, char **argv)
+{
+    uint8_t mask = parse_dev(argv[1]);
+    const cmd_profile_t *p = NULL;
+    for (size_t i = 0; i < sizeof(s_profiles) / sizeof(s_profiles[0]); ++i) {
+        if (strcmp(argv[2], s_profiles[i].name) == 0) p = &s_profiles[i];
+    }
+    if (mask == 0U || p == NULL) {
+        fdc_debug_print("usage: prof U fast|norm|fine\r\n");
+        return;
+    }
+    for (uint8_t u = 0; u < s_ctx->dev_count; ++u) {
+        if (!(mask & (1U << u))) continue;
+        fdc_plan_req_t req = *fdc_get_plan_request(s_ctx->dev[u]);
+        req.target_sps = p->sps;
+        req.settlecount = p->settlecount;
+        after_reconfig(u, fdc_configure(s_ctx->dev[u], &req));
+    }
+}
+
+static void cmd_stream(int argc, char **argv)
+{
+    for (uint8_t i = 0; i < 3U; ++i) {
+        if (strcmp(argv[1], s_stream_names[i]) == 0) {
+            s_ctx->stream = i;
+            fdc_debug_print("stream %s\r\n", s_stream_names[i]);
+            return;
+        }
+    }
+    fdc_debug_print("usage: stream off|text|bin\r\n");
+}
+
+static void cmd_dec(int argc, char **argv)
+{
+    uint32_t n;
+    if (!parse_u32(argv[1], &n) || n == 0U || n > 0xFFFFU) {
+        fdc_debug_print("usage: dec N (1..65535)\r\n");
+        return;
+    }
+    s_ctx->decimation = (uint16_t)n;
+    fdc_debug_print("decimation %lu\r\n", (unsigned long)n);
+}
+
+static void cmd_filt(int argc, char **argv)
+{
+    fdc_baseline_param_t *p = &s_ctx->baseline[0].param;
+    if (argc >= 2 && strcmp(argv[1], "reset") == 0) {
+        for (uint8_t u = 0; u < s_ctx->dev_count; ++u) {
+            for (uint8_t ch = 0; ch < 4U; ++ch) fdc_baseline_reset(&s_ctx->baseline[u], ch);
+        }
+        fdc_debug_print("baseline reset\r\n");
+        return;
+    }
+    if (argc >= 3) {
+        uint32_t v;
+        fdc_baseline_param_t np = *p;
+        if (!parse_u32(argv[2], &v)) np.ema_shift = 0xFFU;
+        else if (strcmp(argv[1], "ema") == 0) np.ema_shift = (uint8_t)((v <= 16U) ? v : 0xFFU);
+        else if (strcmp(argv[1], "touch") == 0) np.touch_threshold = v;
+        else if (strcmp(argv[1], "release") == 0) np.release_threshold = v;
+        else if (strcmp(argv[1], "step") == 0) np.max_step = v;
+        else if (strcmp(argv[1], "freeze") == 0) np.max_freeze = v;
+        else np.ema_shift = 0xFFU;
+        if (np.ema_shift == 0xFFU || np.release_threshold > np.touch_threshold) {
+            fdc_debug_print("usage: filt ema 0..16|touch|release|step|freeze N (release <= touch)\r\n");
+            return;
+        }
+        /* 参数所有通道共用，各芯片保持一致；只改参数不重置基线 */
+        for (uint8_t u = 0; u < s_ctx->dev_count; ++u) s_ctx->baseline[u].param = np;
+    } else if (argc == 2) {
+        fdc_debug_print("usage: filt [KEY VAL | reset]\r\n");
+        return;
+    }
+    fdc_debug_print("filt: ema=%u touch=%lu release=%lu step=%lu freeze=%lu\r\n", (unsigned)p->ema_shift,
+                    (unsigned long)p->touch_threshold, (unsigned long)p->release_threshold,
+                    (unsigned long)p->max_step, (unsigned long)p->max_freeze);
+}
+
+static void set_duty(const char *arg)
+{
+    uint32_t v;     /* 0.001% 为单位 */
+    if (!parse_milli(arg, &v) || v > 100000U) {
+        fdc_debug_print("Invalid PWM duty: %s (0-100, up to 3 decimals)\r\n", arg);
+        return;
+    }
+    TIM2_PWM_SetDutyQ16((uint32_t)(((uint64_t)v * 0x10000U + 50000U) / 100000U));
+    uint32_t steps = TIM2_PWM_GetSteps();
+    fdc_debug_print("PWM duty set to %.3lk%% (CCR1=%lu/%lu)\r\n", (long)v,
+                    (unsigned long)((TIM2_PWM_GetDutyQ16() * (uint64_t)steps + 0x8000U) >> 16), (unsigned long)steps);
+}
+
+static void set_freq(const char *arg)
+{
+    uint32_t v;
+    /* 下限随波形变化：波形模式的 TIM2 载波级数有上限，低于约 4.3 Hz 无法合成 */
+    const uint32_t v_min = TIM3_GetFreqMinMilliHz();
+    if (!parse_milli(arg, &v) || (v != 0U && (v < v_min || v > TIM3_FREQ_MAX_MHZ))) {
+        fdc_debug_print("Invalid TIM3 freq: %s (0=off, %.3lk-%lu in %s mode, up to 3 decimals)\r\n", arg,
+                        (long)v_min, (unsigned long)(TIM3_FREQ_MAX_MHZ / 1000U),
+                        TIM3_GetWaveform() != NULL ? "wave" : "square");
+        return;
+    }
+    TIM3_SetSquareFreqMilliHz(v);
+    if (v == 0U) {
+        fdc_debug_print("TIM3 drive off\r\n");
+        return;
+    }
+    uint16_t psc, arr, frac;
+    TIM3_GetTiming(&psc, &arr, &frac);
+    fdc_debug_print("TIM3 freq set to %.3lk Hz (actual %.3lk Hz, PSC=%u ARR=%u frac=%u/65536)\r\n", (long)v,
+                    (long)TIM3_GetActualFreqMilliHz(), (unsigned)psc, (unsigned)arr, (unsigned)frac);
+}
+
+static void cmd_dead(int argc, char **argv)
+{
+    uint32_t v;
+    if (!parse_u32(argv[1], &v) || v > 10000U) {
+        fdc_debug_print("Invalid dead time: %s (0-10000 us)\r\n", argv[1]);
+        return;
+    }
+    TIM3_SetDeadTimeUs(v);
+    fdc_debug_print("TIM3 dead time set to %lu us\r\n", (unsigned long)v);
+}
+
+static void cmd_dither(int argc, char **argv)
+{
+    if (strcmp(argv[1], "on") == 0) {
+        TIM3_SetDither(true);
+    } else if (strcmp(argv[1], "off") == 0) {
+        TIM3_SetDither(false);
+    } else {
+        fdc_debug_print("usage: dither on|off\r\n");
+        return;
+    }
+    fdc_debug_print("TIM3 dither %s, actual %.3lk Hz\r\n", TIM3_GetDither() ? "on" : "off",
+                    (long)TIM3_GetActualFreqMilliHz());
+}
+
+static void cmd_wave(int argc, char **argv)
+{
+    const drive_wave_t *w = NULL;
+    if (strcmp(argv[1], "off") != 0) {
+        w = drive_wave_find(argv[1]);
+        if (w == NULL) {
+            fdc_debug_print("Unknown wave: %s (see help)\r\n", argv[1]);
+            return;
+        }
+    }
+    TIM3_SetWaveform(w);
+    if (w == NULL) {
+        fdc_debug_print("TIM3 drive: square\r\n");
+        return;
+    }
+    if (TIM3_GetSquareFreqMilliHz() == 0U) {
+        fdc_debug_print("TIM3 drive: %s, %u samples per half period (starts with freq)\r\n", w->name, (unsigned)w->len);
+        return;
+    }
+    /* 原频率低于该波形的下限时 TIM3_SetWaveform 已取下限，这里打印实际频率 */
+    fdc_debug_print("TIM3 drive: %s, %u samples per half period, carrier %lu Hz, freq %.3lk Hz\r\n", w->name,
+                    (unsigned)w->len, (unsigned long)TIM2_PWM_GetCarrierHz(), (long)TIM3_GetSquareFreqMilliHz());
+}
+
+static void print_sweep_result(void)
+{
+    lra_sweep_result_t r;
+    if (!lra_sweep_get_result(&r)) {
+        fdc_debug_print("SWEEP: no result yet\r\n");
+        return;
+    }
+    fdc_debug_print("SWEEP last: %u points, f0=%.3lk Hz, bw=%.3lk Hz, Q=%.2k (0 = unknown)\r\n", (unsigned)r.points,
+                    (long)r.f0_mhz, (long)r.bw_mhz, (int)r.q_x100);
+}
+
+/* 解析响应源："adc" 或 "U:CH"（须在该芯片的扫描序列中），同时给出通道的采样延迟；失败时已打印原因 */
+static int parse_source(char *arg, uint8_t *use_adc, uint8_t *dev, uint8_t *ch, uint32_t *delay_ns)
+{
+    *use_adc = 0;
+    *dev = 0;
+    *ch = 0;
+    *delay_ns = 0;
+    if (strcmp(arg, "adc") == 0) {
+        *use_adc = 1;
+        return 1;
+    }
+    char *colon = strchr(arg, ':');
+    uint32_t c;
+    if (colon == NULL) {
+        fdc_debug_print("Invalid source: %s (U:CH or adc)\r\n", arg);
+        return 0;
+    }
+    *colon = '\0';
+    uint8_t mask = parse_dev(arg);
+    if (mask == 0U || (mask & (mask - 1U)) != 0U || !parse_u32(colon + 1, &c) || c > 3U) {
+        fdc_debug_print("Invalid source (U:CH or adc)\r\n");
+        return 0;
+    }
+    while (!(mask & (1U << *dev))) (*dev)++;
+    const fdc_config_t *fc = fdc_get_config(s_ctx->dev[*dev]);
+    if (c < fc->first_channel || c >= (uint32_t)fc->first_channel + fc->channel_count) {
+        fdc_debug_print("U%u CH%lu is not in the scan sequence (see seq)\r\n", (unsigned)*dev, (unsigned long)c);
+        return 0;
+    }
+    *ch = (uint8_t)c;
+    *delay_ns = fdc_plan_sample_delay_ns(fc, *ch);
+    return 1;
+}
+
+/* sweep SRC F0 F1 STEP [SETTLE_MS [MEASURE_MS]]，SRC 为 U:CH 或 adc；sweep stop；无参数时显示状态 */
+static void cmd_sweep(int argc, char **argv)
+{
+    if (argc < 2) {
+        if (lra_sweep_busy()) fdc_debug_print("SWEEP running\r\n");
+        else print_sweep_result();
+        return;
+    }
+    if (strcmp(argv[1], "stop") == 0) {
+        lra_sweep_stop();
+        fdc_debug_print("SWEEP stopped, TIM3=%.3lk Hz\r\n", (long)TIM3_GetActualFreqMilliHz());
+        return;
+    }
+    if (argc < 5) {
+        fdc_debug_print("usage: sweep U:CH|adc F0 F1 STEP [SETTLE_MS [MEAS_MS]] | stop\r\n");
+        return;
+    }
+
+    lra_sweep_cfg_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    if (!parse_source(argv[1], &cfg.use_adc, &cfg.dev, &cfg.ch, &cfg.delay_ns)) return;
+    uint32_t settle = LRA_SWEEP_SETTLE_MS, measure = LRA_SWEEP_MEASURE_MS;
+    if (!parse_milli(argv[2], &cfg.f_start_mhz) || !parse_milli(argv[3], &cfg.f_stop_mhz) ||
+        !parse_milli(argv[4], &cfg.f_step_mhz) || (argc > 5 && !parse_u32(argv[5], &settle)) ||
+        (argc > 6 && !parse_u32(argv[6], &measure)) || settle > 60000U || measure > 60000U) {
+        fdc_debug_print("usage: sweep U:CH|adc F0 F1 STEP [SETTLE_MS [MEAS_MS]] | stop\r\n");
+        return;
+    }
+    cfg.settle_ms = (uint16_t)settle;
+    cfg.measure_ms = (uint16_t)measure;
+    cfg.binary = (s_ctx->stream == CMD_STREAM_BINARY);
+
+    /* 扫频与谐振跟踪都要占用驱动频率，扫频优先 */
+    if (lra_track_busy()) {
+        lra_track_stop();
+        fdc_debug_print("TRACK stopped for sweep\r\n");
+    }
+    int r = lra_sweep_start(&cfg);
+    if (r == LRA_SWEEP_ERR_POINTS) {
+        fdc_debug_print("SWEEP: too many points (max %u)\r\n", (unsigned)LRA_SWEEP_POINTS_MAX);
+    } else if (r != LRA_SWEEP_OK) {
+        fdc_debug_print("SWEEP: invalid range (%lu-%lu Hz, STEP > 0, times > 0)\r\n",
+                        (unsigned long)(TIM3_FREQ_MIN_MHZ / 1000U), (unsigned long)(TIM3_FREQ_MAX_MHZ / 1000U));
+    }
+}
+
+/* 解析带符号、最多 1 位小数的角度（"-90"、"-85.5"），结果为 0.1° */
+static int parse_ddeg(const char *s, int32_t *out)
+{
+    uint32_t v;
+    int neg = (*s == '-');
+    if (!parse_milli(neg ? s + 1 : s, &v) || v % 100U != 0U || v > 180000U) return 0;
+    *out = neg ? -(int32_t)(v / 100U) : (int32_t)(v / 100U);
+    return 1;
+}
+
+static void print_track_state(void)
+{
+    lra_track_state_t st;
+    lra_track_get_state(&st);
+    if (!st.running) {
+        fdc_debug_print("TRACK off, TIM3=%.3lk Hz\r\n", (long)TIM3_GetActualFreqMilliHz());
+        return;
+    }
+    if (st.lockin_status != LRA_LOCKIN_OK) {
+        fdc_debug_print("TRACK %s f=%.3lk Hz gain=%lu mHz/deg updates=%lu\r\n",
+                        (st.lockin_status == LRA_LOCKIN_ERR_PHASE) ? "phase not resolved (near k*SPS/2)"
+                                                                   : "no response",
+                        (long)st.f_mhz, (unsigned long)st.gain_mhz_per_deg, (unsigned long)st.updates);
+        return;
+    }
+    fdc_debug_print("TRACK %s f=%.3lk Hz ph=%.1k deg err=%.1k deg gain=%lu mHz/deg updates=%lu\r\n",
+                    st.locked ? "locked" : "tracking", (long)st.f_mhz, (int)st.phase_ddeg, (int)st.error_ddeg,
+                    (unsigned long)st.gain_mhz_per_deg, (unsigned long)st.updates);
+}
+
+/* track U:CH|adc [PHASE_DEG [GAIN_MHZ_PER_DEG]]：从当前驱动频率开始谐振跟踪；track off 停止；无参数显示状态 */
+static void cmd_track(int argc, char **argv)
+{
+    if (argc < 2) {
+        print_track_state();
+        return;
+    }
+    if (strcmp(argv[1], "off") == 0) {
+        lra_track_stop();
+        print_track_state();
+        return;
+    }
+
+    lra_track_cfg_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    if (!parse_source(argv[1], &cfg.use_adc, &cfg.dev, &cfg.ch, &cfg.delay_ns)) return;
+    int32_t sp = LRA_TRACK_SETPOINT_DDEG;
+    if ((argc > 2 && !parse_ddeg(argv[2], &sp)) || (argc > 3 && !parse_u32(argv[3], &cfg.gain_mhz_per_deg))) {
+        fdc_debug_print("usage: track U:CH|adc [PHASE_DEG [GAIN_MHZ_PER_DEG]] | off\r\n");
+        return;
+    }
+    cfg.setpoint_ddeg = (int16_t)sp;
+    cfg.settle_ms = LRA_TRACK_SETTLE_MS;
+    cfg.measure_ms = LRA_TRACK_MEASURE_MS;
+
+    if (lra_sweep_busy()) {
+        fdc_debug_print("SWEEP running, stop it first (sweep stop)\r\n");
+        return;
+    }
+    int r = lra_track_start(&cfg);
+    if (r == LRA_TRACK_ERR_STOPPED) {
+        fdc_debug_print("TRACK: drive is off, set a start frequency with freq\r\n");
+    } else if (r != LRA_TRACK_OK) {
+        fdc_debug_print("TRACK: invalid parameters\r\n");
+    }
+}
+
+static void cmd_duty(int argc, char **argv)
+{
+    set_duty(argv[1]);
+}
+
+static void cmd_pwmf(int argc, char **argv)
+{
+    uint32_t v;
+    if (!parse_u32(argv[1], &v) || v == 0U) {
+        fdc_debug_print("usage: pwmf HZ\r\n");
+        return;
+    }
+    uint32_t hz = TIM2_PWM_SetCarrierHz(v);
+    fdc_debug_print("PWM carrier %lu Hz, %lu steps\r\n", (unsigned long)hz, (unsigned long)TIM2_PWM_GetSteps());
+}
+
+static void cmd_freq(int argc, char **argv)
+{
+    set_freq(argv[1]);
+}
+
+/* 命令表：按名称精确匹配，min_args 不足时打印用法 */
+static const cmd_entry_t s_cmds[] = {
+    { "help", "", 0, cmd_help },
+    { "h", NULL, 0, cmd_help },
+    { "?", NULL, 0, cmd_help },
+    { "stat", "", 0, cmd_stat },
+    { "rd", "U REG", 2, cmd_rd },
+    { "wr", "U REG VAL", 3, cmd_wr },
+    { "sps", "U RATE", 2, cmd_sps },
+    { "seq", "U 2|3|4|c0..c3", 2, cmd_seq },
+    { "prof", "U fast|norm|fine", 2, cmd_prof },
+    { "stream", "off|text|bin", 1, cmd_stream },
+    { "dec", "N", 1, cmd_dec },
+    { "filt", "[KEY VAL|reset]", 0, cmd_filt },
+    { "duty", "PCT", 1, cmd_duty },
+    { "pwmf", "HZ", 1, cmd_pwmf },
+    { "freq", "HZ", 1, cmd_freq },
+    { "dead", "US", 1, cmd_dead },
+    { "dither", "on|off", 1, cmd_dither },
+    { "wave", "off|sine|tri|trap", 1, cmd_wave },
+    { "sweep", "SRC F0 F1 STEP|stop", 0, cmd_sweep },
+    { "track", "SRC [DEG [GAIN]]|off", 0, cmd_track },
+};
+
+static void cmd_help(int argc, char **argv)
+{
+    for (size_t i = 0; i < sizeof(s_cmds) / sizeof(s_cmds[0]); ++i) {
+        if (s_cmds[i].usage == NULL) continue;
+        fdc_debug_print("  %-6s %s\r\n", s_cmds[i].name, s_cmds[i].usage);
+    }
+    const drive_wave_t *w = TIM3_GetWaveform();
+    fdc_debug_print("STATUS: PWM duty=%.1k%% @%lu Hz, TIM3=%.3lk Hz %s dead=%lu us, stream=%s dec=%u\r\n",
+                    (int)TIM2_PWM_GetDutyPermille(), (unsigned long)TIM2_PWM_GetCarrierHz(),
+                    (long)TIM3_GetActualFreqMilliHz(), w != NULL ? w->name : "square",
+                    (unsigned long)TIM3_GetDeadTimeUs(),
+                    s_stream_names[s_ctx->stream < 3U ? s_ctx->stream : 0U], (unsigned)s_ctx->decimation);
+}
+
+void cmd_shell_init(cmd_shell_ctx_t *ctx)
+{
+    s_ctx = ctx;
+}
+
+void cmd_shell_exec(char *line)
+{
+    char *argv[CMD_ARGC_MAX];
+    int argc = 0;
+    if (s_ctx == NULL || line == NULL) return;
+
+    /* 就地切分：空格 / 制表符分隔，多余的参数忽略 */
+    char *p = line;
+    while (argc < CMD_ARGC_MAX) {
+        while (*p == ' ' || *p == '\t') ++p;
+        if (*p == '\0') break;
+        argv[argc++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t') ++p;
+        if (*p != '\0') *p++ = '\0';
+    }
+    if (argc == 0) return;
+
+    for (size_t i = 0; i < sizeof(s_cmds) / sizeof(s_cmds[0]); ++i) {
+        const cmd_entry_t *c = &s_cmds[i];
+        if (strcmp(argv[0], c->name) != 0) continue;
+        if (argc - 1 < c->min_args) {
+            fdc_debug_print("usage: %s %s\r\n", c->name, (c->usage != NULL) ? c->usage : "");
+            return;
+        }
+        c->fn(argc, argv);
+        return;
+    }
+
+    /* 兼容原命令：纯数字 = 占空比，f<数字> = TIM3 频率 */
+    if (argc == 1 && argv[0][0] >= '0' && argv[0][0] <= '9') {
+        set_duty(argv[0]);
+    } else if (argc == 1 && (argv[0][0] == 'f' || argv[0][0] == 'F') && argv[0][1] >= '0' && argv[0][1] <= '9') {
+        set_freq(&argv[0][1]);
+    } else {
+        fdc_debug_print("Invalid command: %s (try help)\r\n", argv[0]);
+    }
+}
+
+void cmd_shell_poll(void)
+{
+    char line[FDC_DEBUG_CMD_MAX];
+    while (fdc_debug_get_command(line, sizeof(line))) {
+        cmd_shell_exec(line);
+    }
+}
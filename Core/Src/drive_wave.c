@@ -0,0 +1,85 @@
+/*
+ * drive_wave.c
+ * LRA 驱动波形表（半个驱动周期的幅度包络），存放在 Flash
+ *
+ * 说明：样本取在每个区间的中点 (i + 0.5) / N，首尾两个样本接近 0 且对称，
+ * 换向（样本 0 之前）两侧的幅度连续；表由下式生成，新增表时按同样方式取点：
+ *   sine：32768 × sin(π·x)              正弦半波，驱动为正弦
+ *   tri ：32768 × (1 − |2x − 1|)         三角半波
+ *   trap：32768 × min(1, 3·min(x, 1−x))  梯形（上升 / 平顶 / 下降各 1/3），接近方波但边沿缓和
+ */
+
+#include "drive_wave.h"
+#include <string.h>
+
+static const uint16_t s_sine[128] = {
+      402,  1206,  2009,  2811,  3612,  4410,  5205,  5998,
+     6787,  7571,  8351,  9127,  9896, 10660, 11417, 12167,
+    12910, 13646, 14373, 15091, 15800, 16500, 17190, 17869,
+    18538, 19195, 19841, 20475, 21097, 21706, 22302, 22884,
+    23453, 24008, 24548, 25073, 25583, 26078, 26557, 27020,
+    27467, 27897, 28311, 28707, 29086, 29448, 29792, 30118,
+    30425, 30715, 30986, 31238, 31471, 31686, 31881, 32058,
+    32214, 32352, 32470, 32568, 32647, 32706, 32746, 32766,
+    32766, 32746, 32706, 32647, 32568, 32470, 32352, 32214,
+    32058, 31881, 31686, 31471, 31238, 30986, 30715, 30425,
+    30118, 29792, 29448, 29086, 28707, 28311, 27897, 27467,
+    27020, 26557, 26078, 25583, 25073, 24548, 24008, 23453,
+    22884, 22302, 21706, 21097, 20475, 19841, 19195, 18538,
+    17869, 17190, 16500, 15800, 15091, 14373, 13646, 12910,
+    12167, 11417, 10660,  9896,  9127,  8351,  7571,  6787,
+     5998,  5205,  4410,  3612,  2811,  2009,  1206,   402,
+};
+
+static const uint16_t s_tri[128] = {
+      256,   768,  1280,  1792,  2304,  2816,  3328,  3840,
+     4352,  4864,  5376,  5888,  6400,  6912,  7424,  7936,
+     8448,  8960,  9472,  9984, 10496, 11008, 11520, 12032,
+    12544, 13056, 13568, 14080, 14592, 15104, 15616, 16128,
+    16640, 17152, 17664, 18176, 18688, 19200, 19712, 20224,
+    20736, 21248, 21760, 22272, 22784, 23296, 23808, 24320,
+    24832, 25344, 25856, 26368, 26880, 27392, 27904, 28416,
+    28928, 29440, 29952, 30464, 30976, 31488, 32000, 32512,
+    32512, 32000, 31488, 30976, 30464, 29952, 29440, 28928,
+    28416, 27904, 27392, 26880, 26368, 25856, 25344, 24832,
+    24320, 23808, 23296, 22784, 22272, 21760, 21248, 20736,
+    20224, 19712, 19200, 18688, 18176, 17664, 17152, 16640,
+    16128, 15616, 15104, 14592, 14080, 13568, 13056, 12544,
+    12032, 11520, 11008, 10496,  9984,  9472,  8960,  8448,
+     7936,  7424,  6912,  6400,  5888,  5376,  4864,  4352,
+     3840,  3328,  2816,  2304,  1792,  1280,   768,   256,
+};
+
+static const uint16_t s_trap[128] = {
+      384,  1152,  1920,  2688,  3456,  4224,  4992,  5760,
+     6528,  7296,  8064,  8832,  9600, 10368, 11136, 11904,
+    12672, 13440, 14208, 14976, 15744, 16512, 17280, 18048,
+    18816, 19584, 20352, 21120, 21888, 22656, 23424, 24192,
+    24960, 25728, 26496, 27264, 28032, 28800, 29568, 30336,
+    31104, 31872, 32640, 32768, 32768, 32768, 32768, 32768,
+    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+    32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+    32768, 32768, 32768, 32768, 32768, 32640, 31872, 31104,
+    30336, 29568, 28800, 28032, 27264, 26496, 25728, 24960,
+    24192, 23424, 22656, 21888, 21120, 20352, 19584, 18816,
+    18048, 17280, 16512, 15744, 14976, 14208, 13440, 12672,
+    11904, 11136, 10368,  9600,  8832,  8064,  7296,  6528,
+     5760,  4992,  4224,  3456,  2688,  1920,  1152,   384,
+};
+
+const drive_wave_t drive_waves[] = {
+    { "sine", s_sine, 128U },
+    { "tri",  s_tri,  128U },
+    { "trap", s_trap, 128U },
+};
+const uint8_t drive_wave_count = (uint8_t)(sizeof(drive_waves) / sizeof(drive_waves[0]));
+
+const drive_wave_t *drive_wave_find(const char *name)
+{
+    for (uint8_t i = 0; i < drive_wave_count; ++i) {
+        if (strcmp(drive_waves[i].name, name) == 0) return &drive_waves[i];
+    }
+    return NULL;
+}
@@ -5,6 +5,7 @@
  * 说明：
  * - 本驱动使用 STM32 HAL 的阻塞 I2C 接口（HAL_I2C_Master_Transmit / Receive），
  *   实现读写寄存器、读取 24-bit 通道结果、设备初始化与基线校准等常用功能。
+ * - 所有接口以 fdc_dev_t 句柄区分芯片，同一总线上的多片芯片由异步调度器交错读取。
  * - 文件中仍然保留了一些占位寄存器值（请以手头的 FDC2214 数据手册为准）      //调###############
  * - 注释为逐行详细中文注释，解释每一行代码的目的、原因和实现注意点，便于阅读与移植。
  */
@@ -13,6 +14,7 @@
 #include "i2c.h"    /* 提供 extern I2C_HandleTypeDef hi2c1；由 CubeMX 在工程中生成 */
 #include "main.h"   /* 提供 HAL_Delay、以及工程级别的头文件包含 */
 #include <stdint.h>  /* 提供标准整型定义（uint8_t/uint16_t/uint32_t/uint64_t） */
+#include <string.h>
 #include "usart_debug.h"
 // #include <math.h>
 /* hi2c1 是在工程其他地方（通常由 CubeMX 生成的 i2c.c）声明并初始化的 I2C 句柄。
@@ -20,6 +22,62 @@
  */
 extern I2C_HandleTypeDef hi2c1;
 
+/* 板上两片芯片，共用 hi2c1；未焊第二片时 fdc_init(&fdc_dev1) 返回 I2C 错误即可 */
+fdc_dev_t fdc_dev0 = {
+    .hi2c = &hi2c1,
+    .addr_hal = FDC2214_ADDR_HAL,
+    .intb_port = FDC_INTB_GPIO_Port,
+    .intb_pin = FDC_INTB_Pin,
+    .intb_irqn = FDC_INTB_EXTI_IRQn,
+};
+fdc_dev_t fdc_dev1 = {
+    .hi2c = &hi2c1,
+    .addr_hal = FDC2214_ADDR2_HAL,
+    .intb_port = FDC2_INTB_GPIO_Port,
+    .intb_pin = FDC2_INTB_Pin,
+    .intb_irqn = FDC2_INTB_EXTI_IRQn,
+};
+
+/* 已初始化的芯片（fdc_init 成功后登记），供 EXTI / I2C 回调查找与调度器轮询 */
+static fdc_dev_t *s_devs[FDC_MAX_DEVICES];
+static volatile uint8_t s_dev_num = 0;
+/* 调度器轮询起点：上一次发起传输的芯片的下一个 */
+static uint8_t s_rr_next = 0;
+/* 阻塞访问总线时置位（可嵌套），期间调度器不发起新的中断传输 */
+static volatile uint8_t s_bus_hold = 0;
+/* 样本时间戳钩子（fdc_set_stamp_hook），在 INTB 边沿时调用 */
+static fdc_stamp_fn_t s_stamp_hook = NULL;
+
+static void bus_acquire(fdc_dev_t *dev);
+static void bus_release(fdc_dev_t *dev);
+static void sched_kick(I2C_HandleTypeDef *hi2c);
+
+/* 当前激活通道范围；尚未配置时按 4 通道处理 */
+static void active_range(const fdc_dev_t *dev, uint8_t *first, uint8_t *count)
+{
+    if (dev->cfg.channel_count == 0) {
+        *first = 0;
+        *count = 4;
+    } else {
+        *first = dev->cfg.first_channel;
+        *count = dev->cfg.channel_count;
+    }
+}
+
+/* 不可缓存（只读或不应回写）的寄存器：OFFSET_CH0..3(0x0C..0x0F，仅 FDC211x 有定义，FDC2214 手册未列出)、
+ * STATUS(0x18)、RESET_DEV(0x1C)、保留(0x1D) */
+#define FDC_SHADOW_EXCLUDE  ((0xFUL << (FDC2214_REG_OFFSET_CH0 - FDC2214_SHADOW_FIRST)) | \
+                             (1UL << (FDC2214_REG_STATUS - FDC2214_SHADOW_FIRST)) | \
+                             (1UL << (FDC2214_REG_RESET_DEV - FDC2214_SHADOW_FIRST)) | \
+                             (1UL << (0x1D - FDC2214_SHADOW_FIRST)))
+
+/* 寄存器是否在影子缓存中 */
+static int shadowed(uint8_t reg)
+{
+    if (reg < FDC2214_SHADOW_FIRST || reg > FDC2214_SHADOW_LAST) return 0;
+    return (FDC_SHADOW_EXCLUDE & (1UL << (reg - FDC2214_SHADOW_FIRST))) == 0;
+}
+
 
 /*
  * 内部工具函数：i2c_tx_retry
@@ -33,23 +91,26 @@ extern I2C_HandleTypeDef hi2c1;
  * 设计理由：I2C 总线在实际使用中会遇到偶发通信错误（仲裁、噪声、拉低等），
  * 使用短次数重试通常可以提高鲁棒性而不引入复杂的错误恢复逻辑。            //学###############
  */
-static int i2c_tx_retry(uint8_t *pData, uint16_t Size, uint32_t Timeout, int retries)
+static int i2c_tx_retry(fdc_dev_t *dev, uint8_t *pData, uint16_t Size, uint32_t Timeout, int retries)
 {
     /* HAL_StatusTypeDef 用于接收 HAL API 的返回状态（HAL_OK / HAL_ERROR / HAL_BUSY / HAL_TIMEOUT） */
-    HAL_StatusTypeDef st;                      //学###############
+    HAL_StatusTypeDef st = HAL_ERROR;          //学###############
+    bus_acquire(dev);
     /* 循环尝试发送，最多尝试 retries 次 */
     for (int i = 0; i < retries; ++i) {
-        /* 使用 HAL 的阻塞式主机发送函数：地址使用 FDC2214_ADDR_HAL（左移后）
+        /* 使用 HAL 的阻塞式主机发送函数：地址使用句柄中的 addr_hal（左移后）
          * 注意：HAL 接口的 DevAddress 参数期望的是 7-bit 地址左移一位后的值（即 8-bit 地址格式）
          */
-        st = HAL_I2C_Master_Transmit(&hi2c1, FDC2214_ADDR_HAL, pData, Size, Timeout);
+        st = HAL_I2C_Master_Transmit(dev->hi2c, dev->addr_hal, pData, Size, Timeout);
         /* 如果发送成功，立即返回 FDC_OK（0）表示驱动层成功 */
-        if (st == HAL_OK) return FDC_OK;
+        if (st == HAL_OK) break;
         /* 若非成功，等待少量时间再重试（短延时 5ms 可避免紧循环占用总线） */
+        dev->stats.i2c_retries++;
         HAL_Delay(5);
     }
+    bus_release(dev);
     /* 所有重试耗尽仍失败，则返回 I2C 错误码 */
-    return FDC_ERR_I2C;
+    return (st == HAL_OK) ? FDC_OK : FDC_ERR_I2C;
 }
 
 
@@ -58,17 +119,41 @@ static int i2c_tx_retry(uint8_t *pData, uint16_t Size, uint32_t Timeout, int ret
  * 说明：对 HAL_I2C_Master_Receive 做简单的重试封装，与 i2c_tx_retry 对称。
  * 参数与返回值语义与 i2c_tx_retry 相同。
  */
-static int i2c_rx_retry(uint8_t *pData, uint16_t Size, uint32_t Timeout, int retries)
+static int i2c_rx_retry(fdc_dev_t *dev, uint8_t *pData, uint16_t Size, uint32_t Timeout, int retries)
 {
-    HAL_StatusTypeDef st;
+    HAL_StatusTypeDef st = HAL_ERROR;
+    bus_acquire(dev);
     for (int i = 0; i < retries; ++i) {
         /* 接收数据：从设备读取 Size 字节到 pData 缓冲区 */
-        st = HAL_I2C_Master_Receive(&hi2c1, FDC2214_ADDR_HAL, pData, Size, Timeout);
-        if (st == HAL_OK) return FDC_OK;
+        st = HAL_I2C_Master_Receive(dev->hi2c, dev->addr_hal, pData, Size, Timeout);
+        if (st == HAL_OK) break;
         /* 收到非 OK 状态时短延时再重试 */
+        dev->stats.i2c_retries++;
         HAL_Delay(5);
     }
-    return FDC_ERR_I2C;
+    bus_release(dev);
+    return (st == HAL_OK) ? FDC_OK : FDC_ERR_I2C;
+}
+
+
+/*
+ * 内部工具函数：i2c_mem_read_retry
+ * 说明：对 HAL_I2C_Mem_Read 做重试封装。HAL 会先写 1 字节寄存器地址，
+ * 再以重复起始 (repeated start) 读出 Size 字节，整个过程只占用一次总线事务。
+ * FDC2214 在连续读时寄存器指针自动递增，因此可一次读出多个相邻寄存器。
+ */
+static int i2c_mem_read_retry(fdc_dev_t *dev, uint8_t reg, uint8_t *pData, uint16_t Size, uint32_t Timeout, int retries)
+{
+    HAL_StatusTypeDef st = HAL_ERROR;
+    bus_acquire(dev);
+    for (int i = 0; i < retries; ++i) {
+        st = HAL_I2C_Mem_Read(dev->hi2c, dev->addr_hal, reg, I2C_MEMADD_SIZE_8BIT, pData, Size, Timeout);
+        if (st == HAL_OK) break;
+        dev->stats.i2c_retries++;
+        HAL_Delay(5);
+    }
+    bus_release(dev);
+    return (st == HAL_OK) ? FDC_OK : FDC_ERR_I2C;
 }
 
 
@@ -77,11 +162,12 @@ static int i2c_rx_retry(uint8_t *pData, uint16_t Size, uint32_t Timeout, int ret
  * 写入一个 16-bit 寄存器到 FDC2214。
  * FDC2214 的 I2C 写操作协议通常为：先发送 1 字节的寄存器地址，随后发送 2 字节的数据（MSB 首）。
  * 我们将寄存器地址 + MSB + LSB 一次性放在发送缓冲区并调用 HAL 发送。
- * 参数：reg - 目标寄存器地址（8-bit）
+ * 参数：dev - 芯片句柄
+ *       reg - 目标寄存器地址（8-bit）
  *       value - 要写入的 16-bit 值（驱动将按大端顺序发送）
  * 返回：FDC_OK 或 FDC_ERR_I2C
  */
-int fdc_write_reg(uint8_t reg, uint16_t value)
+int fdc_write_reg(fdc_dev_t *dev, uint8_t reg, uint16_t value)
 {
     /* 发送缓冲区：第 0 字节为寄存器地址，第 1/2 字节为 16-bit 数据（MSB, LSB） */
     uint8_t buf[3]; 
@@ -90,7 +176,14 @@ int fdc_write_reg(uint8_t reg, uint16_t value)
     buf[2] = (uint8_t)(value & 0xFF);        /* 低 8 位（LSB） */
 
     /* 使用重试封装发送，超时使用驱动头文件定义的宏 */
-    return i2c_tx_retry(buf, 3, FDC2214_I2C_TIMEOUT_MS, 3);
+    int ret = i2c_tx_retry(dev, buf, 3, FDC2214_I2C_TIMEOUT_MS, 3);
+
+    /* 直接写入的寄存器同步到影子缓存，保证缓存与芯片一致 */
+    if (ret == FDC_OK && shadowed(reg)) {
+        dev->shadow[reg - FDC2214_SHADOW_FIRST] = value;
+        dev->shadow_dirty &= ~(1UL << (reg - FDC2214_SHADOW_FIRST));
+    }
+    return ret;
 }
 
 
@@ -102,7 +195,7 @@ int fdc_write_reg(uint8_t reg, uint16_t value)
  *       value - 输出指针，存放读取到的 16-bit 值（大端合成）
  * 返回：FDC_OK / 错误码
  */
-int fdc_read_reg(uint8_t reg, uint16_t *value)
+int fdc_read_reg(fdc_dev_t *dev, uint8_t reg, uint16_t *value)
 {
     /* 参数校验：禁止空指针 */
     if (value == NULL) return FDC_ERR_INVALID_PARAM;
@@ -111,12 +204,12 @@ int fdc_read_reg(uint8_t reg, uint16_t *value)
     uint8_t regb = reg;
 
     /* 将寄存器地址发送到设备（设置内部寄存器指针）。若失败直接返回错误码 */
-    int ret = i2c_tx_retry(&regb, 1, FDC2214_I2C_TIMEOUT_MS, 3);
+    int ret = i2c_tx_retry(dev, &regb, 1, FDC2214_I2C_TIMEOUT_MS, 3);
     if (ret != FDC_OK) return ret; /* 如果写地址阶段失败，则无需继续读取 */
 
     /* 读取 2 字节的数据（MSB, LSB） */
     uint8_t rx[2];   //从从机地址的寄存器（就是上面发送的寄存器）读取2个字节的数据到pData也就是rx缓冲区
-    ret = i2c_rx_retry(rx, 2, FDC2214_I2C_TIMEOUT_MS, 3);
+    ret = i2c_rx_retry(dev, rx, 2, FDC2214_I2C_TIMEOUT_MS, 3);
     if (ret != FDC_OK) return ret; /* 读取阶段失败，返回错误 */
 
     /* 按大端序合成 16-bit 值：rx[0] 为高字节，rx[1] 为低字节 */   //学###############
@@ -133,7 +226,7 @@ int fdc_read_reg(uint8_t reg, uint16_t *value)
  *       raw24 - 输出指针，返回合成后的 24-bit 无符号值（放入 32-bit 容器）
  * 返回：FDC_OK / 参数错误 / I2C 错误
  */
-int fdc_read_result_raw(fdc_channel_t ch, uint32_t *raw24)
+int fdc_read_result_raw(fdc_dev_t *dev, fdc_channel_t ch, uint32_t *raw24)
 {
     /* 验证输出指针不为 NULL */
     if (raw24 == NULL) return FDC_ERR_INVALID_PARAM;
@@ -152,17 +245,17 @@ int fdc_read_result_raw(fdc_channel_t ch, uint32_t *raw24)
     uint8_t addr_lsb = (uint8_t)(addr_msb + 1);
 
     /* 读 MSB 寄存器（2 字节） */
-    int ret = i2c_tx_retry(&addr_msb, 1, FDC2214_I2C_TIMEOUT_MS, 3); /* 设置寄存器地址 */
+    int ret = i2c_tx_retry(dev, &addr_msb, 1, FDC2214_I2C_TIMEOUT_MS, 3); /* 设置寄存器地址 */
     if (ret != FDC_OK) return ret;
     uint8_t msb_buf[2];
-    ret = i2c_rx_retry(msb_buf, 2, FDC2214_I2C_TIMEOUT_MS, 3); /* 读取 MSB 的两个字节 */
+    ret = i2c_rx_retry(dev, msb_buf, 2, FDC2214_I2C_TIMEOUT_MS, 3); /* 读取 MSB 的两个字节 */
     if (ret != FDC_OK) return ret;
 
     /* 读 LSB 寄存器（2 字节） */
-    ret = i2c_tx_retry(&addr_lsb, 1, FDC2214_I2C_TIMEOUT_MS, 3);
+    ret = i2c_tx_retry(dev, &addr_lsb, 1, FDC2214_I2C_TIMEOUT_MS, 3);
     if (ret != FDC_OK) return ret;
     uint8_t lsb_buf[2];
-    ret = i2c_rx_retry(lsb_buf, 2, FDC2214_I2C_TIMEOUT_MS, 3);
+    ret = i2c_rx_retry(dev, lsb_buf, 2, FDC2214_I2C_TIMEOUT_MS, 3);
     if (ret != FDC_OK) return ret;
 
     /* 合成 28-bit 结果：MSB 的低 12-bit 为高位部分，LSB 提供低 16-bit
@@ -175,33 +268,494 @@ int fdc_read_result_raw(fdc_channel_t ch, uint32_t *raw24)
 }
 
 
+/*
+ * 内部工具函数：decode_data_burst
+ * 把从 DATA_CHx 开始连续读出的字节流解码为各通道 28-bit 结果，并检查结果是否可信。
+ * 每通道 4 字节：MSB 寄存器 2 字节 + LSB 寄存器 2 字节（大端）。
+ * raw 按通道下标写入（first..first+nch-1），返回可信通道位图：
+ * DATA 中 ERR_WD / ERR_AW 置位、或结果为 0 / 满量程的通道被剔除并计入统计。
+ */
+static uint8_t decode_data_burst(fdc_dev_t *dev, const uint8_t *rx, uint32_t raw[4], uint8_t first, uint8_t nch)
+{
+    uint8_t valid = 0;
+    for (uint8_t i = 0; i < nch; ++i) {
+        const uint8_t ch = (uint8_t)(first + i);
+        const uint8_t *p = &rx[i * 4];
+        uint32_t msb16 = ((uint16_t)p[0] << 8) | p[1];
+        uint32_t lsb16 = ((uint16_t)p[2] << 8) | p[3];
+        raw[ch] = ((msb16 & FDC2214_DATA_MSB_MASK) << 16) | lsb16;
+
+        if (msb16 & FDC2214_DATA_ERR_WD) {
+            dev->stats.err_wd[ch]++;
+        } else if (raw[ch] == 0 || raw[ch] == FDC2214_DATA_FULL_SCALE) {
+            dev->stats.range[ch]++;
+        } else if (!(msb16 & FDC2214_DATA_ERR_AW)) {
+            valid |= (uint8_t)(1U << ch);
+        }
+    }
+    return valid;
+}
+
+/*
+ * 内部工具函数：account_status
+ * STATUS 中振幅警告只对 ERR_CHAN 指示的通道有效，按通道累加计数，返回有振幅警告的通道位图。
+ * 看门狗超时改由 DATA_CHx.ERR_WD 逐通道统计，这里不重复计数。
+ */
+static uint8_t account_status(fdc_dev_t *dev, uint16_t status)
+{
+    const uint8_t ch = (uint8_t)((status & FDC2214_STATUS_ERR_CHAN_MASK) >> FDC2214_STATUS_ERR_CHAN_POS);
+    uint8_t warn = 0;
+    if (status & FDC2214_STATUS_ERR_AHW) {
+        dev->stats.err_ahw[ch]++;
+        warn = (uint8_t)(1U << ch);
+    }
+    if (status & FDC2214_STATUS_ERR_ALW) {
+        dev->stats.err_alw[ch]++;
+        warn = (uint8_t)(1U << ch);
+    }
+    return warn;
+}
+
+/*
+ * fdc_read_status
+ * 读取 STATUS（读操作会清除锁存的错误标志并释放 INTB），累加振幅警告计数。
+ */
+int fdc_read_status(fdc_dev_t *dev, uint16_t *status)
+{
+    if (status == NULL) return FDC_ERR_INVALID_PARAM;
+    int ret = fdc_read_reg(dev, FDC2214_REG_STATUS, status);
+    if (ret == FDC_OK) account_status(dev, *status);
+    return ret;
+}
+
+
+/*
+ * fdc_read_all_channels
+ * 一次性读出全部激活通道的转换结果：
+ * - 从第一个激活通道的 DATA_CHx 开始连续读 count*4 字节（4 通道时为 0x00..0x07 共 16 字节）；
+ * - 每个通道仍满足"先读 MSB 再读 LSB"的顺序要求；
+ * - 与 fdc_read_result_raw 逐通道读取相比，4 通道扫描从 16 次事务降为 1 次。
+ * 参数：raw - 输出数组，raw[ch] 为通道 ch 的 28-bit 结果
+ * 返回：FDC_OK / 参数错误 / I2C 错误
+ */
+int fdc_read_all_channels(fdc_dev_t *dev, uint32_t raw[4], uint8_t *valid_mask)
+{
+    if (raw == NULL) return FDC_ERR_INVALID_PARAM;
+
+    uint8_t first, count;
+    active_range(dev, &first, &count);
+
+    uint8_t rx[FDC2214_DATA_BURST_BYTES];
+    int ret = i2c_mem_read_retry(dev, (uint8_t)(FDC2214_REG_DATA_CH0 + first * 2U), rx, (uint16_t)(count * 4U),
+                                 FDC2214_I2C_TIMEOUT_MS, 3);
+    if (ret != FDC_OK) return ret;
+
+    for (int ch = 0; ch < 4; ++ch) raw[ch] = 0;
+    uint8_t valid = decode_data_burst(dev, rx, raw, first, count);
+    if (valid_mask != NULL) *valid_mask = valid;
+    return FDC_OK;
+}
+
+
 /*
  * fdc_read_device_id
  * 便捷函数：读取 DEVICE_ID 寄存器（16-bit）并返回
  */
-int fdc_read_device_id(uint16_t *did)
+int fdc_read_device_id(fdc_dev_t *dev, uint16_t *did)
 {
     /* 直接调用通用寄存器读取函数，寄存器地址由头文件宏定义 */
-    return fdc_read_reg(FDC2214_REG_DEVICE_ID, did);  //学###############
+    return fdc_read_reg(dev, FDC2214_REG_DEVICE_ID, did);  //学###############
 }
 
 
 /*
  * fdc_set_ref_clk_external
  * 将 CONFIG (0x1A) 的 REF_CLK_SRC 位设置为 1，以选择外部时钟源。
- * 实现使用读-改-写，确保不破坏 CONFIG 中的其他位。
+ * 在影子缓存上修改，只有一次写总线（睡眠模式下提交），不再先读 CONFIG。
+ */
+int fdc_set_ref_clk_external(fdc_dev_t *dev)
+{
+    int ret = fdc_shadow_modify(dev, FDC2214_REG_CONFIG, 0, FDC2214_CONFIG_REF_CLK_SRC_MASK);
+    if (ret != FDC_OK) return ret;
+    return fdc_commit(dev);
+}
+
+/* 打开 INTB 所在 GPIO 端口的时钟（EXTI 线路映射所需的 AFIO 时钟由 HAL_MspInit 打开） */
+static void intb_port_clk_enable(GPIO_TypeDef *port)
+{
+    if (port == GPIOA) __HAL_RCC_GPIOA_CLK_ENABLE();
+    else if (port == GPIOB) __HAL_RCC_GPIOB_CLK_ENABLE();
+    else if (port == GPIOC) __HAL_RCC_GPIOC_CLK_ENABLE();
+#ifdef GPIOD
+    else if (port == GPIOD) __HAL_RCC_GPIOD_CLK_ENABLE();
+#endif
+}
+
+/*
+ * fdc_intb_init
+ * 配置 INTB 引脚为下降沿外部中断（芯片 INTB 为低有效，空闲时为高）。
+ * 放在驱动中而不是 gpio.c，避免 CubeMX 重新生成代码时被覆盖。
+ */
+void fdc_intb_init(fdc_dev_t *dev)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    intb_port_clk_enable(dev->intb_port);
+    GPIO_InitStruct.Pin = dev->intb_pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    HAL_GPIO_Init(dev->intb_port, &GPIO_InitStruct);
+
+    HAL_NVIC_SetPriority(dev->intb_irqn, 1, 0);
+    HAL_NVIC_EnableIRQ(dev->intb_irqn);
+}
+
+/*
+ * fdc_enable_drdy_interrupt
+ * 让芯片在每轮转换完成后通过 INTB 通知主机：
+ * 1) STATUS_CONFIG.DRDY_2INT = 1（INTB 只用于数据就绪），并把看门狗超时与振幅警告
+ *    写入 DATA_CHx 的错误标志，读取路径据此逐通道剔除坏样本；
+ * 2) CONFIG.INTB_DIS = 0（在影子缓存上修改，保留 CONFIG 其余位）
+ */
+int fdc_enable_drdy_interrupt(fdc_dev_t *dev)
+{
+    int ret = fdc_shadow_write(dev, FDC2214_REG_STATUS_CONFIG,
+                               FDC2214_STATUS_CONFIG_DRDY_2INT | FDC2214_STATUS_CONFIG_WD_ERR2OUT |
+                               FDC2214_STATUS_CONFIG_AH_WARN2OUT | FDC2214_STATUS_CONFIG_AL_WARN2OUT);
+    if (ret != FDC_OK) return ret;
+    ret = fdc_shadow_modify(dev, FDC2214_REG_CONFIG, FDC2214_CONFIG_INTB_DIS_MASK, 0);
+    if (ret != FDC_OK) return ret;
+    ret = fdc_commit(dev);
+    if (ret != FDC_OK) return ret;
+
+    /* 使能前若 INTB 已经为低（错过了下降沿），读一次 STATUS 清除，保证后续边沿可被捕获 */
+    uint16_t status = 0;
+    return fdc_read_reg(dev, FDC2214_REG_STATUS, &status);
+}
+
+/*
+ * fdc_data_ready
+ * 主循环查询是否有新转换结果。除了 EXTI 置位的标志外，还检查 INTB 电平：
+ * 若 INTB 仍为低（例如标志被清除后没有读数据导致边沿丢失），同样视为数据就绪，
+ * 避免 INTB 一直保持低电平而再也产生不了下降沿。
+ */
+int fdc_data_ready(fdc_dev_t *dev)
+{
+    if (!dev->drdy_pending &&
+        HAL_GPIO_ReadPin(dev->intb_port, dev->intb_pin) == GPIO_PIN_SET) {
+        return 0;
+    }
+    dev->drdy_pending = 0;
+    return 1;
+}
+
+uint32_t fdc_get_drdy_count(const fdc_dev_t *dev)
+{
+    return dev->drdy_count;
+}
+
+/* ---------------- 异步采集（中断驱动 I2C + 样本环形缓冲区） ---------------- */
+
+/* 登记已初始化的芯片，供回调查找与调度器轮询 */
+static void dev_register(fdc_dev_t *dev)
+{
+    for (uint8_t i = 0; i < s_dev_num; ++i) {
+        if (s_devs[i] == dev) return;
+    }
+    if (s_dev_num < FDC_MAX_DEVICES) {
+        s_devs[s_dev_num] = dev;
+        s_dev_num++;
+    }
+}
+
+/* 总线上是否有进行中的中断传输 */
+static int bus_busy(I2C_HandleTypeDef *hi2c)
+{
+    for (uint8_t i = 0; i < s_dev_num; ++i) {
+        if (s_devs[i]->hi2c == hi2c && s_devs[i]->async_busy) return 1;
+    }
+    return 0;
+}
+
+/*
+ * 内部工具函数：bus_acquire / bus_release
+ * 阻塞接口访问总线前暂停调度器，并等待进行中的中断传输结束（超时后强行继续，
+ * 由 HAL 的忙状态与重试兜底）；释放后立即调度积压的 DRDY。只在主循环上下文调用。
+ */
+static void bus_acquire(fdc_dev_t *dev)
+{
+    s_bus_hold++;
+    uint32_t t0 = HAL_GetTick();
+    while (bus_busy(dev->hi2c) && (HAL_GetTick() - t0) < FDC2214_I2C_TIMEOUT_MS) {
+    }
+}
+
+static void bus_release(fdc_dev_t *dev)
+{
+    if (s_bus_hold > 0) s_bus_hold--;
+    if (s_bus_hold == 0) sched_kick(dev->hi2c);
+}
+
+/*
+ * 内部工具函数：sched_kick
+ * 交错调度器：若总线空闲，从上次服务的芯片之后开始轮询，选出第一片
+ * 处于异步模式且有 DRDY 挂起的芯片，发起一次中断方式读取（只读其激活通道）。
+ * 可在 ISR（EXTI / I2C 完成回调）与主循环中调用，选择与占用总线在关中断下完成，
+ * 保证同一时刻只有一次传输；一片读完后完成回调再次调用本函数，两片背靠背读取。
  */
-int fdc_set_ref_clk_external(void)
+static void sched_kick(I2C_HandleTypeDef *hi2c)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (s_bus_hold || bus_busy(hi2c)) {
+        __set_PRIMASK(primask);
+        return;
+    }
+    fdc_dev_t *dev = NULL;
+    const uint8_t n = s_dev_num;
+    for (uint8_t k = 0; k < n; ++k) {
+        uint8_t i = (uint8_t)((s_rr_next + k) % n);
+        fdc_dev_t *d = s_devs[i];
+        if (d->hi2c == hi2c && d->async_enabled && d->drdy_pending) {
+            dev = d;
+            s_rr_next = (uint8_t)((i + 1U) % n);
+            break;
+        }
+    }
+    if (dev == NULL) {
+        __set_PRIMASK(primask);
+        return;
+    }
+    dev->async_busy = 1;
+    dev->drdy_pending = 0;
+    dev->async_stamp = dev->drdy_stamp;
+    dev->async_cyc = dev->drdy_cyc;
+    __set_PRIMASK(primask);
+
+    dev->async_tick = HAL_GetTick();
+    active_range(dev, &dev->async_first, &dev->async_count);
+    /* 每轮先读 STATUS（2 字节），完成回调中再读 DATA */
+    dev->async_phase = 0;
+    if (HAL_I2C_Mem_Read_IT(hi2c, dev->addr_hal, FDC2214_REG_STATUS, I2C_MEMADD_SIZE_8BIT,
+                            dev->async_rx, 2U) != HAL_OK) {
+        /* 启动失败（总线忙等），留待 fdc_async_poll 重试 */
+        dev->stats.i2c_errors++;
+        dev->drdy_pending = 1;
+        dev->async_busy = 0;
+    }
+}
+
+/* 打开 DWT 周期计数器，INTB 时刻按 HCLK 周期记录（ms 的 HAL_GetTick 在 1 kSPS 时无法分辨相邻两轮） */
+static void cyccnt_enable(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+int fdc_async_start(fdc_dev_t *dev)
+{
+    cyccnt_enable();
+    dev->ring_head = 0;
+    dev->ring_tail = 0;
+    dev->async_busy = 0;
+    /* 覆盖轮数从启动后重新起算；启动前就挂起的 INTB 按启动时刻计，不计入同步模式下未读的转换 */
+    dev->last_valid = 0;
+    dev->drdy_cyc = DWT->CYCCNT;
+    dev->async_enabled = 1;
+    /* 启动时若已有未读数据（INTB 为低），立即读取以释放 INTB */
+    fdc_async_poll();
+    return FDC_OK;
+}
+
+void fdc_async_stop(fdc_dev_t *dev)
+{
+    dev->async_enabled = 0;
+    /* 等待进行中的传输结束 */
+    uint32_t t0 = HAL_GetTick();
+    while (dev->async_busy && (HAL_GetTick() - t0) < FDC2214_I2C_TIMEOUT_MS) {
+    }
+    dev->async_busy = 0;
+}
+
+int fdc_async_get(fdc_dev_t *dev, fdc_sample_t *out)
+{
+    if (out == NULL) return 0;
+    uint32_t tail = dev->ring_tail;
+    if (tail == dev->ring_head) return 0;
+    *out = dev->ring[tail & (FDC_SAMPLE_RING_LEN - 1U)];
+    dev->ring_tail = tail + 1U;
+    return 1;
+}
+
+/* 对全部芯片：INTB 仍为低而没有挂起标志（边沿丢失或 I2C 出错后）时补上标志，再调度 */
+void fdc_async_poll(void)
+{
+    for (uint8_t i = 0; i < s_dev_num; ++i) {
+        fdc_dev_t *d = s_devs[i];
+        if (!d->async_enabled || d->async_busy) continue;
+        if (HAL_GPIO_ReadPin(d->intb_port, d->intb_pin) == GPIO_PIN_RESET && !d->drdy_pending) {
+            /* 边沿丢失：时间戳只能取补读时刻 */
+            d->drdy_pending = 1;
+            d->drdy_cyc = DWT->CYCCNT;
+            if (s_stamp_hook != NULL) d->drdy_stamp = s_stamp_hook();
+        }
+        if (d->drdy_pending) sched_kick(d->hi2c);
+    }
+}
+
+void fdc_set_stamp_hook(fdc_stamp_fn_t fn)
+{
+    s_stamp_hook = fn;
+}
+
+uint32_t fdc_async_get_dropped(const fdc_dev_t *dev)
+{
+    return dev->stats.dropped;
+}
+
+uint32_t fdc_async_get_i2c_errors(const fdc_dev_t *dev)
+{
+    return dev->stats.i2c_errors;
+}
+
+void fdc_get_stats(const fdc_dev_t *dev, fdc_stats_t *out)
+{
+    if (dev == NULL || out == NULL) return;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = dev->stats;
+    __set_PRIMASK(primask);
+}
+
+void fdc_clear_stats(fdc_dev_t *dev)
+{
+    if (dev == NULL) return;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    __set_PRIMASK(primask);
+}
+
+/* CYCCNT 在 72 MHz 下约 59 s 回绕，间隔超过该值时改用 ms 时间戳 */
+#define FDC_OVERRUN_CYC_SPAN_MS  30000U
+
+/* 由相邻两组样本的 INTB 时刻与实际采样率估算中间被覆盖的转换轮数。
+ * 时刻取 EXTI 中断里记录的 CYCCNT：INTB 在读走前保持低电平，一组样本的时刻是它覆盖的第一轮
+ * 转换完成的时刻，相邻时刻之差正好是上一组读取前经过的轮数，与总线排队延迟无关 */
+static uint32_t estimate_overruns(const fdc_dev_t *dev, uint32_t dt_cyc, uint32_t dt_ms)
+{
+    const uint32_t msps = dev->cfg.actual_msps;
+    if (msps == 0) return 0;
+    uint64_t rounds;
+    if (dt_ms < FDC_OVERRUN_CYC_SPAN_MS) {
+        /* 轮数 = dt(周期) * msps / (HCLK * 1000)，四舍五入 */
+        const uint64_t div = (uint64_t)HAL_RCC_GetHCLKFreq() * 1000U;
+        rounds = ((uint64_t)dt_cyc * msps + div / 2U) / div;
+    } else {
+        rounds = ((uint64_t)dt_ms * msps + 500000U) / 1000000U;
+    }
+    return (rounds > 1U) ? (uint32_t)(rounds - 1U) : 0U;
+}
+
+/* 查找总线上正在进行中断传输的芯片 */
+static fdc_dev_t *busy_dev(I2C_HandleTypeDef *hi2c)
+{
+    for (uint8_t i = 0; i < s_dev_num; ++i) {
+        if (s_devs[i]->hi2c == hi2c && s_devs[i]->async_busy) return s_devs[i];
+    }
+    return NULL;
+}
+
+/* I2C 读完成回调（ISR）：
+ * 第一阶段读完 STATUS 后立即发起 DATA 读取；第二阶段解码并写入该芯片的环形缓冲区，
+ * 然后调度下一片有 DRDY 挂起的芯片 */
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
 {
-    uint16_t cfg = 0;
-    int ret = fdc_read_reg(FDC2214_REG_CONFIG, &cfg);
-    if (ret != FDC_OK) return ret; /* 读取失败，返回上层处理 */
+    fdc_dev_t *dev = busy_dev(hi2c);
+    if (dev == NULL) return;
+
+    if (dev->async_phase == 0) {
+        dev->async_status = (uint16_t)(((uint16_t)dev->async_rx[0] << 8) | dev->async_rx[1]);
+        dev->async_phase = 1;
+        if (HAL_I2C_Mem_Read_IT(hi2c, dev->addr_hal, (uint16_t)(FDC2214_REG_DATA_CH0 + dev->async_first * 2U),
+                                I2C_MEMADD_SIZE_8BIT, dev->async_rx, (uint16_t)(dev->async_count * 4U)) == HAL_OK) {
+            return;
+        }
+        /* DATA 读取启动失败：INTB 已被 STATUS 读取释放，但数据仍未读，由 fdc_async_poll 补读 */
+        dev->stats.i2c_errors++;
+        dev->drdy_pending = 1;
+        dev->async_busy = 0;
+        return;
+    }
+
+    const uint8_t first = dev->async_first;
+    const uint8_t count = dev->async_count;
+    const uint16_t status = dev->async_status;
+    const uint8_t active = (uint8_t)(((1U << count) - 1U) << first);
+
+    uint32_t raw[4] = {0, 0, 0, 0};
+    uint8_t valid = decode_data_burst(dev, dev->async_rx, raw, first, count);
+    valid &= (uint8_t)~account_status(dev, status);
+    for (uint8_t ch = first; ch < first + count; ++ch) {
+        /* STATUS 中没有该通道的未读转换：读到的是上一轮已读过的旧值 */
+        if (!(status & FDC2214_STATUS_UNREADCONV(ch))) {
+            dev->stats.stale[ch]++;
+            valid &= (uint8_t)~(1U << ch);
+        }
+    }
+    if (dev->last_valid) {
+        uint32_t lost = estimate_overruns(dev, dev->async_cyc - dev->last_cyc, dev->async_tick - dev->last_tick);
+        for (uint8_t ch = first; ch < first + count; ++ch) dev->stats.overruns[ch] += lost;
+    }
+    dev->last_tick = dev->async_tick;
+    dev->last_cyc = dev->async_cyc;
+    dev->last_valid = 1;
+    dev->stats.samples++;
 
-    /* 置位 REF_CLK_SRC（位 9） */
-    cfg |= FDC2214_CONFIG_REF_CLK_SRC_MASK;
+    uint32_t head = dev->ring_head;
+    if ((head - dev->ring_tail) < FDC_SAMPLE_RING_LEN) {
+        fdc_sample_t *smp = &dev->ring[head & (FDC_SAMPLE_RING_LEN - 1U)];
+        smp->tick = dev->async_tick;
+        smp->stamp = dev->async_stamp;
+        smp->seq = dev->sample_seq;
+        for (int ch = 0; ch < 4; ++ch) smp->raw[ch] = raw[ch];
+        smp->active_mask = active;
+        smp->valid_mask = valid;
+        smp->status = status;
+        dev->ring_head = head + 1U;
+    } else {
+        /* 主循环来不及取走，丢弃本组样本（seq 仍递增，上层可据此发现丢样） */
+        dev->stats.dropped++;
+    }
+    dev->sample_seq++;
+    dev->async_busy = 0;
+
+    sched_kick(hi2c);
+}
+
+/* I2C 错误回调（ISR）：释放总线占用标志，由 fdc_async_poll 根据 INTB 电平重新发起 */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    fdc_dev_t *dev = busy_dev(hi2c);
+    if (dev == NULL) return;
+    dev->stats.i2c_errors++;
+    dev->async_busy = 0;
+}
 
-    /* 写回 CONFIG 寄存器 */
-    return fdc_write_reg(FDC2214_REG_CONFIG, cfg);
+/* EXTI 回调：同步模式下仅置位标志，由主循环读取；
+ * 异步模式下交给调度器启动中断方式的 I2C 读取，不在 ISR 中做阻塞操作 */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    for (uint8_t i = 0; i < s_dev_num; ++i) {
+        fdc_dev_t *dev = s_devs[i];
+        if (GPIO_Pin == dev->intb_pin) {
+            dev->drdy_cyc = DWT->CYCCNT;
+            if (s_stamp_hook != NULL) dev->drdy_stamp = s_stamp_hook();
+            dev->drdy_pending = 1;
+            dev->drdy_count++;
+            if (dev->async_enabled) sched_kick(dev->hi2c);
+        }
+    }
 }
 
 /* 返回错误码对应的可读字符串，便于打印调试信息 */
@@ -213,6 +767,9 @@ const char *fdc_err_str(int e)
         case FDC_ERR_INVALID_PARAM: return "ERR_INVALID_PARAM";
         case FDC_ERR_TIMEOUT: return "ERR_TIMEOUT";
         case FDC_ERR_UNKNOWN: return "ERR_UNKNOWN";
+        case FDC_PLAN_ERR_PARAM: return "PLAN_ERR_PARAM";
+        case FDC_PLAN_ERR_FSENSOR: return "PLAN_ERR_FSENSOR";
+        case FDC_PLAN_ERR_RATE: return "PLAN_ERR_RATE";
         default: return "ERR_OTHER";
     }
 }
@@ -241,17 +798,211 @@ double fdc_freq_to_capacitance(double fsensor_hz, double L_h, double C0_f)
 
 /*
  * fdc_soft_reset
- * 软件复位设备的一个示例实现：
- * - 有些芯片通过写 RESET_DEV 或 CONFIG 寄存器的特定位实现复位。
- * - 这里演示写入一个占位复位命令（RESET_CMD），在投入实际硬件前请用 datasheet 中的确切命令替换该常量。
+ * 软件复位：向 RESET_DEV (0x1C) 的 bit15 写 1，芯片全部寄存器恢复默认值并进入睡眠模式。
+ * RESET_DEV 不在影子缓存中，复位后缓存内容作废：标记为无效，下次修改配置时先重新读取。
+ * I2C 报错时芯片也可能已经收到复位，因此无论结果都作废缓存。
+ * 之后需重新 fdc_init() 才能继续采集。
+ */
+int fdc_soft_reset(fdc_dev_t *dev)
+{
+    int ret = fdc_write_reg(dev, FDC2214_REG_RESET_DEV, FDC2214_RESET_DEV_RESET);
+    dev->shadow_valid = 0;
+    dev->shadow_dirty = 0;
+    return ret;
+}
+
+
+/* ---------------- 寄存器影子缓存 ---------------- */
+
+/*
+ * fdc_shadow_sync
+ * 一次连续读取 0x08..0x21 填充影子缓存并清除脏标记。
+ * 上电后或芯片复位后调用一次，此后配置修改都在缓存上进行，不再需要读-改-写。
+ */
+int fdc_shadow_sync(fdc_dev_t *dev)
+{
+    uint8_t buf[FDC2214_SHADOW_COUNT * 2];
+    int ret = i2c_mem_read_retry(dev, FDC2214_SHADOW_FIRST, buf, sizeof(buf), FDC2214_I2C_TIMEOUT_MS, 3);
+    if (ret != FDC_OK) return ret;
+
+    for (int i = 0; i < FDC2214_SHADOW_COUNT; ++i) {
+        dev->shadow[i] = (uint16_t)(((uint16_t)buf[2 * i] << 8) | buf[2 * i + 1]);
+    }
+    dev->shadow_dirty = 0;
+    dev->shadow_valid = 1;
+    return FDC_OK;
+}
+
+/* 修改缓存中的寄存器值；与缓存相同的值不会标记为脏 */
+int fdc_shadow_write(fdc_dev_t *dev, uint8_t reg, uint16_t value)
+{
+    if (!shadowed(reg)) return FDC_ERR_INVALID_PARAM;
+    if (!dev->shadow_valid) {
+        int ret = fdc_shadow_sync(dev);
+        if (ret != FDC_OK) return ret;
+    }
+    uint8_t idx = (uint8_t)(reg - FDC2214_SHADOW_FIRST);
+    if (dev->shadow[idx] != value) {
+        dev->shadow[idx] = value;
+        dev->shadow_dirty |= 1UL << idx;
+    }
+    return FDC_OK;
+}
+
+/* 在缓存上做读-改-写：先清除 clear_mask 再置位 set_mask */
+int fdc_shadow_modify(fdc_dev_t *dev, uint8_t reg, uint16_t clear_mask, uint16_t set_mask)
+{
+    uint16_t v = 0;
+    int ret = fdc_shadow_read(dev, reg, &v);
+    if (ret != FDC_OK) return ret;
+    return fdc_shadow_write(dev, reg, (uint16_t)((v & ~clear_mask) | set_mask));
+}
+
+/* 读取缓存中的寄存器值（可能包含尚未提交的修改），不访问总线 */
+int fdc_shadow_read(fdc_dev_t *dev, uint8_t reg, uint16_t *value)
+{
+    if (value == NULL || !shadowed(reg)) return FDC_ERR_INVALID_PARAM;
+    if (!dev->shadow_valid) {
+        int ret = fdc_shadow_sync(dev);
+        if (ret != FDC_OK) return ret;
+    }
+    *value = dev->shadow[reg - FDC2214_SHADOW_FIRST];
+    return FDC_OK;
+}
+
+/*
+ * fdc_commit
+ * 把影子缓存中的脏寄存器写入芯片（按手册要求在睡眠模式下修改配置）：
+ * 1) CONFIG 写入缓存值 | SLEEP_MODE_EN，停止转换；
+ * 2) 每个脏寄存器单独一次 3 字节写（指针 + 16 位数据），CONFIG 仍保持 SLEEP_MODE_EN。
+ *    手册只给出了单寄存器写时序，多寄存器连续写的指针自增未经实测，因此不合并成突发写；
+ *    不缓存的寄存器（FDC_SHADOW_EXCLUDE，含 FDC2214 未定义的 0x0C..0x0F）不会被写到；
+ * 3) 写入最终 CONFIG，退出睡眠开始转换。
+ * 提交后覆盖轮数的估算基准作废，由下一组样本重新建立。
+ * 提交期间占用总线（bus_acquire），调度器暂停，全部寄存器写完后再恢复异步读取。
+ * 失败时保留脏标记，可再次调用 fdc_commit 重试。
+ */
+int fdc_commit(fdc_dev_t *dev)
+{
+    if (dev->shadow_dirty == 0) return FDC_OK;
+
+    bus_acquire(dev);
+    /* 采样率 / 通道可能改变，睡眠期间也没有转换：覆盖轮数的估算从提交后的第一组样本重新起算
+     * （fdc_configure / fdc_set_sequence 都经由这里） */
+    dev->last_valid = 0;
+
+    const uint8_t cfg_idx = FDC2214_REG_CONFIG - FDC2214_SHADOW_FIRST;
+    const uint16_t cfg_final = dev->shadow[cfg_idx];
+    uint8_t cmd[3] = { FDC2214_REG_CONFIG,
+                       (uint8_t)((cfg_final | FDC2214_CONFIG_SLEEP_MODE_EN) >> 8),
+                       (uint8_t)(cfg_final & 0xFF) };
+    int ret = i2c_tx_retry(dev, cmd, 3, FDC2214_I2C_TIMEOUT_MS, 3);
+
+    for (uint8_t i = 0; ret == FDC_OK && i < FDC2214_SHADOW_COUNT; ++i) {
+        if (!(dev->shadow_dirty & (1UL << i))) continue;
+        uint16_t v = dev->shadow[i];
+        if (i == cfg_idx) v |= FDC2214_CONFIG_SLEEP_MODE_EN;
+        uint8_t wr[3] = { (uint8_t)(FDC2214_SHADOW_FIRST + i), (uint8_t)(v >> 8), (uint8_t)(v & 0xFF) };
+        ret = i2c_tx_retry(dev, wr, 3, FDC2214_I2C_TIMEOUT_MS, 3);
+    }
+
+    if (ret == FDC_OK) {
+        cmd[1] = (uint8_t)(cfg_final >> 8);
+        cmd[2] = (uint8_t)(cfg_final & 0xFF);
+        ret = i2c_tx_retry(dev, cmd, 3, FDC2214_I2C_TIMEOUT_MS, 3);
+    }
+    if (ret == FDC_OK) dev->shadow_dirty = 0;
+    /* 睡眠前已挂起、尚未读取的样本按退出睡眠的时刻计，不把提交耗时算作覆盖 */
+    if (dev->drdy_pending) dev->drdy_cyc = DWT->CYCCNT;
+
+    bus_release(dev);
+    return ret;
+}
+
+
+/*
+ * fdc_apply_config
+ * 把规划结果写入影子缓存（各激活通道的 RCOUNT / SETTLECOUNT / CLOCK_DIVIDERS /
+ * DRIVE_CURRENT，以及 MUX_CONFIG 与 CONFIG），再由 fdc_commit 在睡眠模式下
+ * 一次性写入。CONFIG 中 INTB_DIS 保持当前设置，其余位取规划值。
  */
-int fdc_soft_reset(void)
+int fdc_apply_config(fdc_dev_t *dev, const fdc_config_t *cfg)
 {
-    /* 占位的复位命令：高位 0x8000 表示触发某个复位位（仅示例）
-     * 实际上请以 datasheet 的 RESET_DEV 或 CONFIG 字段为准。 */
-    const uint16_t RESET_CMD = 0x8000; /* 占位值，切勿直接用于生产 */
-    /* 调用通用写寄存器函数写入 CONFIG（或 RESET_DEV）寄存器触发复位 */
-    return fdc_write_reg(FDC2214_REG_CONFIG, RESET_CMD);
+    if (cfg == NULL || cfg->channel_count < 1 ||
+        cfg->first_channel + cfg->channel_count > 4) return FDC_ERR_INVALID_PARAM;
+
+    int ret = FDC_OK;
+    for (uint8_t ch = cfg->first_channel; ch < cfg->first_channel + cfg->channel_count && ret == FDC_OK; ++ch) {
+        ret = fdc_shadow_write(dev, FDC2214_REG_RCOUNT_CH0 + ch, cfg->rcount);
+        if (ret == FDC_OK) ret = fdc_shadow_write(dev, FDC2214_REG_SETTLECOUNT_CH0 + ch, cfg->settlecount);
+        if (ret == FDC_OK) ret = fdc_shadow_write(dev, FDC2214_REG_CLOCK_DIVIDERS_CH0 + ch, cfg->clock_dividers);
+        if (ret == FDC_OK) ret = fdc_shadow_write(dev, FDC2214_REG_DRIVE_CURRENT_CH0 + ch, cfg->drive_current);
+    }
+    if (ret == FDC_OK) ret = fdc_shadow_write(dev, FDC2214_REG_MUX_CONFIG, cfg->mux_config);
+    /* INTB_DIS 由 fdc_enable_drdy_interrupt 管理，重新规划时保留当前设置 */
+    if (ret == FDC_OK) ret = fdc_shadow_modify(dev, FDC2214_REG_CONFIG, (uint16_t)~FDC2214_CONFIG_INTB_DIS_MASK,
+                                               (uint16_t)(cfg->config & ~FDC2214_CONFIG_INTB_DIS_MASK));
+    if (ret == FDC_OK) ret = fdc_commit(dev);
+    if (ret != FDC_OK) return ret;
+
+    dev->cfg = *cfg;
+    return FDC_OK;
+}
+
+const fdc_config_t *fdc_get_config(const fdc_dev_t *dev)
+{
+    return &dev->cfg;
+}
+
+/*
+ * fdc_configure
+ * 规划 + 应用 + 记住请求。提交期间的总线仲裁由 fdc_commit 负责。
+ */
+int fdc_configure(fdc_dev_t *dev, const fdc_plan_req_t *req)
+{
+    fdc_config_t cfg;
+    int ret = fdc_plan_config(req, &cfg);
+    if (ret != FDC_PLAN_OK) return ret;
+
+    ret = fdc_apply_config(dev, &cfg);
+    if (ret == FDC_OK) dev->req = *req;
+    return ret;
+}
+
+const fdc_plan_req_t *fdc_get_plan_request(const fdc_dev_t *dev)
+{
+    return &dev->req;
+}
+
+/*
+ * fdc_set_sequence
+ * 在上一次规划请求的基础上修改通道数/单通道选择，保持目标采样率不变重新规划，
+ * 通道越少，每个通道分到的 RCOUNT 越大（分辨率越高）。
+ */
+int fdc_set_sequence(fdc_dev_t *dev, fdc_sequence_t seq)
+{
+    fdc_plan_req_t req = dev->req;
+    switch (seq) {
+        case FDC_SEQ_CH0_1: req.channel_count = 2; req.active_channel = 0; break;
+        case FDC_SEQ_CH0_2: req.channel_count = 3; req.active_channel = 0; break;
+        case FDC_SEQ_CH0_3: req.channel_count = 4; req.active_channel = 0; break;
+        case FDC_SEQ_SINGLE_CH0:
+        case FDC_SEQ_SINGLE_CH1:
+        case FDC_SEQ_SINGLE_CH2:
+        case FDC_SEQ_SINGLE_CH3:
+            req.channel_count = 1;
+            req.active_channel = (uint8_t)(seq - FDC_SEQ_SINGLE_CH0);
+            break;
+        default: return FDC_ERR_INVALID_PARAM;
+    }
+    return fdc_configure(dev, &req);
+}
+
+uint8_t fdc_get_active_mask(const fdc_dev_t *dev)
+{
+    uint8_t first, count;
+    active_range(dev, &first, &count);
+    return (uint8_t)(((1U << count) - 1U) << first);
 }
 
 
@@ -263,66 +1014,47 @@ int fdc_soft_reset(void)
  * 3) 写入若干默认配置寄存器以使能测量
  * 注意：本函数所写入的寄存器值为占位值，请在使用前用手册中的建议值替换           //调###############
  */
-int fdc_init(void)
+int fdc_init(fdc_dev_t *dev)
 {
+    if (dev == NULL || dev->hi2c == NULL) return FDC_ERR_INVALID_PARAM;
+
     /* 读取设备 ID，确保 I2C 通信正常。如果读失败，返回 I2C 错误 */
     uint16_t did = 0;//value - 输出指针，存放读取到的 16-bit 值（大端合成）,就是did，用于存放设备ID
-    if (fdc_read_device_id(&did) != FDC_OK) {
+    if (fdc_read_device_id(dev, &did) != FDC_OK) {
         /* 设备未响应或 I2C 错误 */
         return FDC_ERR_I2C;
     }
     if (did != FDC2214_EXPECTED_DEVICE_ID) {
-        fdc_debug_print("Warning: unexpected DEVICE_ID=0x%04X, continuing\r\n", did);
+        fdc_debug_print("Warning: FDC@0x%02X unexpected DEVICE_ID=0x%04X, continuing\r\n",
+                        (unsigned)(dev->addr_hal >> 1), did);
         /* 可选择不返回错误，继续初始化 */
     }
     /* 可选：检查设备 ID 是否为期望值。如果你知道确切的 DEVICE_ID，可以启用下面的检查。 */
     /* if (did != FDC2214_EXPECTED_DEVICE_ID) return FDC_ERR_UNKNOWN; */
-    /* 根据用户要求写入一组初始化寄存器值（顺序：CLOCK_DIVIDERS, DRIVE_CURRENT, SETTLECOUNT,
-     * RCOUNT, MUX_CONFIG, 最后写入 CONFIG）。这些值均由用户指定以覆盖之前的 REF_CLK_SRC 单个位设置。
-     * 注意：此处对某些寄存器使用了显式地址（例如 0x1E/0x1F），这是按照用户指示写入。
-     */
 
-    /* 1)分频器配置 CLOCK_DIVIDERS CH0..CH3 = 0x2001 */
-    if (fdc_write_reg(FDC2214_REG_CLOCK_DIVIDERS_CH0, 0x2001) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_CLOCK_DIVIDERS_CH1, 0x2001) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_CLOCK_DIVIDERS_CH2, 0x2001) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_CLOCK_DIVIDERS_CH3, 0x2001) != FDC_OK) return FDC_ERR_I2C;
-
-    /* 2) DRIVE_CURRENT registers: 按用户要求写入到 0x1E,0x1F,0x20,0x21 = 0x7800
-     * 说明：头文件中常见的 DRIVE_CURRENT_CH0..CH3 为 0x20..0x23，
-     * 这里仍按用户指定的地址写入（包括 0x1E/0x1F）。
-     * 
-    传感器驱动电流 */
-    if (fdc_write_reg(0x1E, 0x7800) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(0x1F, 0x7800) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(0x20, 0x7800) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(0x21, 0x7800) != FDC_OK) return FDC_ERR_I2C;
-
-    /* 3)各通道所需时间 SETTLECOUNT CH0..CH3 = 0x000A */
-    if (fdc_write_reg(FDC2214_REG_SETTLECOUNT_CH0, 0x000A) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_SETTLECOUNT_CH1, 0x000A) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_SETTLECOUNT_CH2, 0x000A) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_SETTLECOUNT_CH3, 0x000A) != FDC_OK) return FDC_ERR_I2C;
-
-    /* 5)转换时间 RCOUNT CH0..CH3 = 0x1866 */
-    if (fdc_write_reg(FDC2214_REG_RCOUNT_CH0, 0x1866) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_RCOUNT_CH1, 0x1866) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_RCOUNT_CH2, 0x1866) != FDC_OK) return FDC_ERR_I2C;
-    if (fdc_write_reg(FDC2214_REG_RCOUNT_CH3, 0x1866) != FDC_OK) return FDC_ERR_I2C;
-
-    /* 6) MUX_CONFIG (0x1B) = 0xC20D */
-    if (fdc_write_reg(FDC2214_REG_MUX_CONFIG, 0xC20D) != FDC_OK) return FDC_ERR_I2C;
-
-    /* 7) CONFIG (0x1A) = 0x1601 - 按用户要求一次性写入（替换掉之前只设置 REF_CLK_SRC 的逻辑） */
-    if (fdc_write_reg(FDC2214_REG_CONFIG, 0x1601) != FDC_OK) return FDC_ERR_I2C;
-
-    /* 如果需要进一步配置测量参数（例如 RCOUNT、SETTLECOUNT、DRIVE_CURRENT 等），   //调###############
-     * 请在这里分别写入对应寄存器：
-     *   fdc_write_reg(FDC2214_REG_RCOUNT_CH0, value);
-     *   fdc_write_reg(FDC2214_REG_SETTLECOUNT_CH0, value);
-     *   fdc_write_reg(FDC2214_REG_DRIVE_CURRENT_CH0, value);
-     * 这些都是按通道逐个配置的，不同应用会有不同的推荐值，务必参照 datasheet。
+    /* 读取全部配置寄存器建立影子缓存，之后的配置修改只写不读 */
+    if (fdc_shadow_sync(dev) != FDC_OK) return FDC_ERR_I2C;
+
+    /* 由规划器根据目标采样率计算 RCOUNT/SETTLECOUNT/CLOCK_DIVIDERS 等寄存器值，
+     * 默认参数得到的结果与原先写死的 0x1866/0x000A/0x2001/0xC20D/0x1601 基本一致
+     * （RCOUNT 额外扣除了激活时间与切换延时，保证 100 SPS 真正可达）。
      */
+    const fdc_plan_req_t req = {
+        .channel_count = FDC_DEFAULT_CHANNELS,
+        .active_channel = 0,
+        .single_ended = 1,
+        .ref_external = 1,
+        .target_sps = FDC_DEFAULT_SPS,
+        .fclk_hz = FDC_DEFAULT_FCLK_HZ,
+        .fsensor_hz = FDC_DEFAULT_FSENSOR_HZ,
+        .settlecount = 0,
+        .drive_current = 0,
+    };
+    int ret = fdc_configure(dev, &req);
+    if (ret != FDC_OK) return ret;
+
+    /* 登记到调度器，之后 EXTI / I2C 回调可以找到这片芯片 */
+    dev_register(dev);
 
     /* 等待小段时间，让设备内部电路收敛并使配置生效（例如内部参考/振荡器等） */
     HAL_Delay(10);
@@ -350,7 +1082,7 @@ int fdc_init(void)
  *       baseline_out - 输出平均值
  *       samples - 采样次数（建议至少 8+）
  */
-int fdc_calibrate_baseline(fdc_channel_t ch, uint32_t *baseline_out, uint8_t samples)
+int fdc_calibrate_baseline(fdc_dev_t *dev, fdc_channel_t ch, uint32_t *baseline_out, uint8_t samples)
 {
     /* 参数验证：baseline_out 不可为 NULL，samples 不可为 0 */
     if (baseline_out == NULL || samples == 0) return FDC_ERR_INVALID_PARAM;
@@ -360,7 +1092,7 @@ int fdc_calibrate_baseline(fdc_channel_t ch, uint32_t *baseline_out, uint8_t sam
     for (uint8_t i = 0; i < samples; ++i) {
         uint32_t v = 0;
         /* 读取当前通道的原始值；若读取失败则把错误直接返回给上层（调用者可决定重试策略） */
-        int ret = fdc_read_result_raw(ch, &v);
+        int ret = fdc_read_result_raw(dev, ch, &v);
         if (ret != FDC_OK) return ret;
         /* 累加采样值 */
         acc += v;
@@ -0,0 +1,91 @@
+/*
+ * fdc_baseline.c
+ * 流式基线跟踪实现（算法说明见 fdc_baseline.h）
+ */
+
+#include "fdc_baseline.h"
+#include <stddef.h>
+
+void fdc_baseline_init(fdc_baseline_t *bl, const fdc_baseline_param_t *param)
+{
+    if (bl == NULL) return;
+    if (param != NULL) {
+        bl->param = *param;
+    } else {
+        bl->param.ema_shift = FDC_BASELINE_DEFAULT_EMA_SHIFT;
+        bl->param.touch_threshold = FDC_BASELINE_DEFAULT_TOUCH;
+        bl->param.release_threshold = FDC_BASELINE_DEFAULT_RELEASE;
+        bl->param.max_step = FDC_BASELINE_DEFAULT_MAX_STEP;
+        bl->param.max_freeze = FDC_BASELINE_DEFAULT_MAX_FREEZE;
+    }
+    for (uint8_t ch = 0; ch < 4; ++ch) fdc_baseline_reset(bl, ch);
+}
+
+void fdc_baseline_reset(fdc_baseline_t *bl, uint8_t ch)
+{
+    if (bl == NULL || ch > 3) return;
+    bl->ch[ch].base_q = 0;
+    bl->ch[ch].frozen_count = 0;
+    bl->ch[ch].seeded = 0;
+    bl->ch[ch].touched = 0;
+}
+
+int32_t fdc_baseline_update(fdc_baseline_t *bl, uint8_t ch, uint32_t raw28)
+{
+    if (bl == NULL || ch > 3) return 0;
+    fdc_baseline_ch_t *c = &bl->ch[ch];
+    const fdc_baseline_param_t *p = &bl->param;
+    const uint32_t raw_q = (raw28 & 0x0FFFFFFFU) << FDC_BASELINE_FRAC_BITS;
+
+    if (!c->seeded) {
+        c->base_q = raw_q;
+        c->seeded = 1;
+        return 0;
+    }
+
+    /* 触摸判定使用更新前的基线 */
+    int32_t diff_q = (int32_t)(raw_q - c->base_q);
+    int32_t delta = (diff_q >= 0) ? (diff_q >> FDC_BASELINE_FRAC_BITS)
+                                  : -((-diff_q) >> FDC_BASELINE_FRAC_BITS);
+    uint32_t mag = (uint32_t)(delta >= 0 ? delta : -delta);
+
+    if (c->touched) {
+        if (mag < p->release_threshold) {
+            c->touched = 0;
+            c->frozen_count = 0;
+        } else if (p->max_freeze != 0 && ++c->frozen_count >= p->max_freeze) {
+            /* 冻结过久：认为环境已经变化（或上电时就有物体），以当前值重新起算 */
+            c->base_q = raw_q;
+            c->touched = 0;
+            c->frozen_count = 0;
+            return 0;
+        }
+        if (c->touched) return delta;
+    } else if (mag > p->touch_threshold) {
+        c->touched = 1;
+        c->frozen_count = 0;
+        return delta;
+    }
+
+    /* 慢速 EMA，步长按 max_step 限幅（负数按幅值移位，避免向负无穷取整造成偏置） */
+    int32_t step = (diff_q >= 0) ? (diff_q >> p->ema_shift) : -((-diff_q) >> p->ema_shift);
+    if (p->max_step != 0) {
+        const int32_t lim = (int32_t)(p->max_step << FDC_BASELINE_FRAC_BITS);
+        if (step > lim) step = lim;
+        if (step < -lim) step = -lim;
+    }
+    c->base_q = (uint32_t)((int32_t)c->base_q + step);
+    return delta;
+}
+
+uint32_t fdc_baseline_get(const fdc_baseline_t *bl, uint8_t ch)
+{
+    if (bl == NULL || ch > 3 || !bl->ch[ch].seeded) return 0;
+    return (bl->ch[ch].base_q + (1U << (FDC_BASELINE_FRAC_BITS - 1U))) >> FDC_BASELINE_FRAC_BITS;
+}
+
+int fdc_baseline_is_touched(const fdc_baseline_t *bl, uint8_t ch)
+{
+    if (bl == NULL || ch > 3) return 0;
+    return bl->ch[ch].touched;
+}
@@ -0,0 +1,137 @@
+/*
+ * fdc_config.c
+ * FDC2214 采样配置规划器实现
+ *
+ * 说明：
+ * - 只用整数运算（64-bit 中间量），不依赖 HAL，可直接在 PC 上编译调用；
+ * - 时间统一以 fREF 周期为单位计算，避免浮点与舍入误差；
+ * - 规划结果由 fdc2214.c 中的 fdc_apply_config() 写入芯片。
+ */
+
+#include "fdc_config.h"
+#include <stddef.h>
+
+/* 通道切换延时（fREF 周期，向上取整）：tSW = 692 ns + 5 / fREF */
+static uint32_t switch_delay_cycles(uint32_t fref_hz)
+{
+    uint64_t ns_part = ((uint64_t)692U * fref_hz + 999999999ULL) / 1000000000ULL;
+    return (uint32_t)ns_part + 5U;
+}
+
+/* 选择最低的、但高于传感器频率的输入去毛刺带宽（手册 7.3.6 推荐） */
+static uint16_t pick_deglitch(uint32_t fsensor_hz)
+{
+    if (fsensor_hz < 1000000UL) return FDC2214_MUX_CONFIG_DEGLITCH_1MHZ;
+    if (fsensor_hz < 3300000UL) return FDC2214_MUX_CONFIG_DEGLITCH_3M3HZ;
+    if (fsensor_hz < 10000000UL) return FDC2214_MUX_CONFIG_DEGLITCH_10MHZ;
+    return FDC2214_MUX_CONFIG_DEGLITCH_33MHZ;
+}
+
+/* floor(log2(v))，v > 0 */
+static uint8_t ilog2_u32(uint32_t v)
+{
+    uint8_t n = 0;
+    while (v >>= 1) ++n;
+    return n;
+}
+
+/*
+ * fdc_plan_config
+ * 计算步骤：
+ * 1) FREF_DIVIDER：取使 fREF 不超过上限的最小分频（fREF 越高，同样时间内计数越多）；
+ * 2) FIN_SEL：单端传感器固定 ÷2；差分传感器 fSENSOR ≤ 8.75 MHz 时 ÷1，否则 ÷2；
+ *    并检查 fIN < fREF / 4；
+ * 3) 每通道时间预算 B = fREF / (sps * N) 个周期，扣除激活时间与切换延时后
+ *    RCOUNT = (B - SETTLECOUNT*16 - tSW - 4) / 16，上限 0xFFFF；
+ * 4) 单通道模式通过 CONFIG.ACTIVE_CHAN 选择通道，多通道模式通过 MUX_CONFIG.RR_SEQUENCE
+ *    选择 CH0..CH(n-1)，两者都只把转换时间花在真正接线的通道上；
+ * 5) 由最终寄存器值反算实际采样率与 ENOB。
+ */
+int fdc_plan_config(const fdc_plan_req_t *req, fdc_config_t *cfg)
+{
+    if (req == NULL || cfg == NULL) return FDC_PLAN_ERR_PARAM;
+    if (req->channel_count < 1 || req->channel_count > 4) return FDC_PLAN_ERR_PARAM;
+    if (req->channel_count == 1 && req->active_channel > 3) return FDC_PLAN_ERR_PARAM;
+    if (req->target_sps == 0 || req->fclk_hz == 0 || req->fsensor_hz == 0) return FDC_PLAN_ERR_PARAM;
+    if (req->fsensor_hz > FDC_PLAN_FSENSOR_MAX_HZ) return FDC_PLAN_ERR_FSENSOR;
+
+    const uint8_t n = req->channel_count;
+    const uint16_t settle = req->settlecount ? req->settlecount : FDC_PLAN_DEFAULT_SETTLECOUNT;
+    if (settle < FDC_PLAN_SETTLECOUNT_MIN) return FDC_PLAN_ERR_PARAM;
+
+    /* 1) 参考分频 */
+    const uint32_t fref_max = (n > 1) ? FDC_PLAN_FREF_MAX_MULTI_HZ : FDC_PLAN_FREF_MAX_SINGLE_HZ;
+    uint32_t divider = (req->fclk_hz + fref_max - 1U) / fref_max;
+    if (divider < 1U) divider = 1U;
+    if (divider > FDC_PLAN_FREF_DIVIDER_MAX) return FDC_PLAN_ERR_PARAM;
+    const uint32_t fref = req->fclk_hz / divider;
+
+    /* 2) 输入分频与 fIN < fREF/4 检查 */
+    uint16_t fin_sel;
+    uint32_t fin_hz;
+    if (req->single_ended || req->fsensor_hz > FDC_PLAN_FIN_DIFF_MAX_HZ) {
+        fin_sel = FDC2214_CLOCK_DIVIDERS_FIN_DIV2;
+        fin_hz = req->fsensor_hz / 2U;
+    } else {
+        fin_sel = FDC2214_CLOCK_DIVIDERS_FIN_DIV1;
+        fin_hz = req->fsensor_hz;
+    }
+    if ((uint64_t)fin_hz * 4U >= fref) return FDC_PLAN_ERR_FSENSOR;
+
+    /* 3) 时间预算（fREF 周期） */
+    const uint64_t budget = (uint64_t)fref / ((uint64_t)req->target_sps * n);
+    uint64_t overhead = 4U;
+    uint32_t tsw = 0;
+    if (n > 1) {
+        tsw = switch_delay_cycles(fref);
+        overhead += (uint64_t)settle * 16U + tsw;
+    }
+    if (budget <= overhead) return FDC_PLAN_ERR_RATE;
+    uint64_t rcount = (budget - overhead) / 16U;
+    if (rcount > 0xFFFFU) rcount = 0xFFFFU;
+    if (rcount < FDC_PLAN_RCOUNT_MIN) return FDC_PLAN_ERR_RATE;
+
+    /* 4) 输出寄存器值与指标 */
+    cfg->channel_count = n;
+    cfg->first_channel = (n == 1) ? req->active_channel : 0U;
+    cfg->rcount = (uint16_t)rcount;
+    cfg->settlecount = settle;
+    cfg->clock_dividers = (uint16_t)(fin_sel | divider);
+    cfg->drive_current = req->drive_current ? req->drive_current : FDC_PLAN_DEFAULT_DRIVE;
+    cfg->mux_config = (uint16_t)(FDC2214_MUX_CONFIG_RESERVED | pick_deglitch(req->fsensor_hz));
+    if (n > 1) {
+        cfg->mux_config |= (uint16_t)(FDC2214_MUX_CONFIG_AUTOSCAN_EN |
+                                      ((uint16_t)(n - 2U) << FDC2214_MUX_CONFIG_RR_SEQUENCE_POS));
+    }
+    cfg->config = (uint16_t)(FDC2214_CONFIG_RESERVED |
+                             (req->ref_external ? (1U << 9) /* REF_CLK_SRC */ : 0U) |
+                             ((uint16_t)cfg->first_channel << FDC2214_CONFIG_ACTIVE_CHAN_POS));
+    cfg->fref_hz = fref;
+
+    uint64_t period = rcount * 16U + 4U;
+    if (n > 1) period = ((uint64_t)settle * 16U + period + tsw) * n;
+    cfg->actual_msps = (uint32_t)(((uint64_t)fref * 1000U) / period);
+    cfg->enob = ilog2_u32((uint32_t)rcount * 16U);
+    return FDC_PLAN_OK;
+}
+
+uint32_t fdc_plan_data_fref_hz(const fdc_config_t *cfg)
+{
+    if (cfg == NULL) return 0;
+    const uint16_t fin_sel = cfg->clock_dividers & (3U << FDC2214_CLOCK_DIVIDERS_FIN_SEL_POS);
+    return (fin_sel == FDC2214_CLOCK_DIVIDERS_FIN_DIV2) ? cfg->fref_hz * 2U : cfg->fref_hz;
+}
+
+uint32_t fdc_plan_sample_delay_ns(const fdc_config_t *cfg, uint8_t ch)
+{
+    if (cfg == NULL || cfg->fref_hz == 0U || cfg->channel_count == 0U) return 0;
+    if (ch < cfg->first_channel || ch >= cfg->first_channel + cfg->channel_count) return 0;
+    const uint32_t n = cfg->channel_count;
+    const uint32_t later = cfg->first_channel + n - 1U - ch;   /* 本通道之后还要转换的通道数 */
+    uint64_t conv = (uint64_t)cfg->rcount * 16U + 4U;
+    uint64_t per_ch = conv;
+    if (n > 1U) per_ch += (uint64_t)cfg->settlecount * 16U + switch_delay_cycles(cfg->fref_hz);
+    /* 以半个 fREF 周期为单位：2 × 后续通道耗时 + 本通道转换时间（中点到结束） */
+    uint64_t half_cycles = 2U * later * per_ch + conv;
+    return (uint32_t)((half_cycles * 1000000000ULL) / (2ULL * cfg->fref_hz));
+}
@@ -0,0 +1,94 @@
+/*
+ * fdc_fixed.c
+ * FDC2214 原始值 -> 频率 / 电容的定点换算实现（推导与误差说明见 fdc_fixed.h）
+ */
+
+#include "fdc_fixed.h"
+#include <stddef.h>
+
+/* 1/u 初值表：u = (64 + i + 0.5) / 128 取区间中点，值为 round(2^30 / u)（Q2.30）。
+ * 由 round(2^30 * 256 / (129 + 2*i)) 离线生成。 */
+static const uint32_t s_recip_q30[64] = {
+    0x7F01FC08U, 0x7D119679U, 0x7B301ECCU, 0x795CEB24U,
+    0x77975B90U, 0x75DED953U, 0x7432D63EU, 0x7292CC15U,
+    0x70FE3C07U, 0x6F74AE26U, 0x6DF5B0F7U, 0x6C80D902U,
+    0x6B15C06BU, 0x69B4069BU, 0x685B4FE6U, 0x670B453CU,
+    0x65C393E0U, 0x6483ED27U, 0x634C0635U, 0x621B97C3U,
+    0x60F25DEBU, 0x5FD017F4U, 0x5EB48824U, 0x5D9F7391U,
+    0x5C90A1FDU, 0x5B87DDADU, 0x5A84F345U, 0x5987B1A9U,
+    0x588FE9DCU, 0x579D6EE3U, 0x56B015ACU, 0x55C7B4F1U,
+    0x54E42524U, 0x54054054U, 0x532AE21DU, 0x5254E78FU,
+    0x51832F20U, 0x50B59897U, 0x4FEC04FFU, 0x4F265692U,
+    0x4E6470B0U, 0x4DA637CFU, 0x4CEB916DU, 0x4C346405U,
+    0x4B809701U, 0x4AD012B4U, 0x4A22C04AU, 0x497889C2U,
+    0x48D159E2U, 0x482D1C32U, 0x478BBCEDU, 0x46ED2901U,
+    0x46514E02U, 0x45B81A25U, 0x45217C38U, 0x448D639DU,
+    0x43FBC044U, 0x436C82A2U, 0x42DF9BB1U, 0x4254FCE4U,
+    0x41CC9829U, 0x41465FDFU, 0x40C246D4U, 0x40404040U,
+};
+
+int fdc_fixed_init(fdc_fixed_cal_t *cal, uint32_t fref_hz, uint32_t L_nh, int32_t C0_ff)
+{
+    if (cal == NULL || fref_hz == 0 || L_nh == 0) return -1;
+
+    /* K(fF) = 1e15 * 2^56 / (4*pi^2 * L * fREF^2)，L = L_nh * 1e-9 */
+    const double pi = 3.14159265358979323846;
+    double k = 1e24 * 72057594037927936.0 /* 2^56 */ /
+               (4.0 * pi * pi * (double)L_nh * (double)fref_hz * (double)fref_hz);
+
+    /* 归一化到 [2^31, 2^32)，只在初始化时执行 */
+    int16_t e = 0;
+    while (k >= 4294967296.0) { k *= 0.5; ++e; }
+    while (k < 2147483648.0) { k *= 2.0; --e; }
+
+    cal->k_mant = (uint32_t)(k + 0.5);
+    if (cal->k_mant == 0) { cal->k_mant = 0x80000000U; ++e; } /* 舍入进位到 2^32 */
+    cal->k_exp = e;
+    cal->c0_ff = C0_ff;
+    cal->fref_hz = fref_hz;
+    return 0;
+}
+
+uint32_t fdc_fixed_raw_to_freq_hz(uint32_t raw28, uint32_t fref_hz)
+{
+    return (uint32_t)(((uint64_t)raw28 * fref_hz + (1ULL << 27)) >> 28);
+}
+
+int32_t fdc_fixed_raw_to_ff(const fdc_fixed_cal_t *cal, uint32_t raw28)
+{
+    if (cal == NULL || raw28 == 0 || cal->k_mant == 0) return FDC_FIXED_C_INVALID;
+
+    /* 1) 归一化：m = DATA << s，最高位为 1，u = m / 2^32 ∈ [0.5, 1) */
+    const int s = __builtin_clz(raw28);
+    const uint32_t m = raw28 << s;
+
+    /* 2) 查表 + 两次牛顿迭代求 y ≈ 1/u（Q2.30，y ∈ (2^30, 2^31]） */
+    uint32_t y = s_recip_q30[(m >> 25) & 0x3FU];
+    for (int i = 0; i < 2; ++i) {
+        uint32_t uy = (uint32_t)(((uint64_t)m * y) >> 32);     /* u*y，Q2.30，≈ 2^30 */
+        uint32_t t = 0x80000000U - uy;                         /* 2 - u*y，Q2.30 */
+        y = (uint32_t)(((uint64_t)y * t) >> 30);
+    }
+
+    /* 3) 1/u^2 = y2 / 2^29（y2 ∈ (2^29, 2^31]） */
+    const uint32_t y2 = (uint32_t)(((uint64_t)y * y) >> 31);
+
+    /* C = K / DATA^2 = k_mant * 2^k_exp * (y2 / 2^29) / 2^(64 - 2s) */
+    const uint64_t prod = (uint64_t)cal->k_mant * y2;          /* < 2^63 */
+    const int shift = cal->k_exp - 93 + 2 * s;
+    uint64_t c;
+    if (shift >= 0) {
+        if (shift >= 32 || (prod >> (63 - shift)) != 0) return INT32_MAX;
+        c = prod << shift;
+    } else if (shift > -64) {
+        c = (prod + (1ULL << (-shift - 1))) >> -shift;
+    } else {
+        c = 0;
+    }
+    if (c > (uint64_t)INT32_MAX * 2U) return INT32_MAX;
+
+    int64_t r = (int64_t)c - cal->c0_ff;
+    if (r > INT32_MAX) return INT32_MAX;
+    if (r <= INT32_MIN) return INT32_MIN + 1;
+    return (int32_t)r;
+}
@@ -0,0 +1,253 @@
+/*
+ * fdc_fmt.c
+ * 轻量格式化输出实现（支持范围见 fdc_fmt.h）
+ */
+
+#include "fdc_fmt.h"
+#include <stdint.h>
+#include <string.h>
+
+#define F_LEFT   0x01U   /* '-' 左对齐 */
+#define F_ZERO   0x02U   /* '0' 用 0 填充 */
+#define F_PLUS   0x04U   /* '+' 正数带 + */
+#define F_SPACE  0x08U   /* ' ' 正数前留空格 */
+#define F_ALT    0x10U   /* '#' 十六进制加 0x，八进制加 0 */
+
+enum { LEN_INT, LEN_CHAR, LEN_SHORT, LEN_LONG, LEN_LLONG, LEN_SIZE, LEN_MAX };
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t n;        /* 完整输出长度（可能超过 size） */
+} fmt_out_t;
+
+static void out_c(fmt_out_t *o, char c)
+{
+    if (o->n + 1U < o->size) o->buf[o->n] = c;
+    o->n++;
+}
+
+static void out_pad(fmt_out_t *o, char c, int count)
+{
+    while (count-- > 0) out_c(o, c);
+}
+
+/* 无符号数逆序转为数字串，至少 min_digits 位（值为 0 且 min_digits = 0 时不输出数字） */
+static int utoa_rev(char *tmp, uint64_t v, uint32_t base, int upper, int min_digits)
+{
+    const char *dig = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    int n = 0;
+    while (v > UINT32_MAX) {
+        tmp[n++] = dig[v % base];
+        v /= base;
+    }
+    uint32_t w = (uint32_t)v;
+    while (w != 0U) {
+        tmp[n++] = dig[w % base];
+        w /= base;
+    }
+    while (n < min_digits) tmp[n++] = '0';
+    return n;
+}
+
+/* 输出一个数值字段：前缀（符号 / 0x）+ 逆序数字，frac > 0 时在最后 frac 位数字前插入小数点 */
+static void emit_number(fmt_out_t *o, const char *pre, const char *rev, int n, int frac,
+                        uint32_t flags, int width)
+{
+    int pad = width - ((int)strlen(pre) + n + (frac > 0 ? 1 : 0));
+    if (!(flags & F_LEFT) && !(flags & F_ZERO)) out_pad(o, ' ', pad);
+    while (*pre != '\0') out_c(o, *pre++);
+    if (!(flags & F_LEFT) && (flags & F_ZERO)) out_pad(o, '0', pad);
+    while (n > 0) {
+        if (n == frac) out_c(o, '.');
+        out_c(o, rev[--n]);
+    }
+    if (flags & F_LEFT) out_pad(o, ' ', pad);
+}
+
+static void emit_str(fmt_out_t *o, const char *s, int prec, uint32_t flags, int width)
+{
+    if (s == NULL) s = "(null)";
+    int len = 0;
+    while (s[len] != '\0' && (prec < 0 || len < prec)) len++;
+    if (!(flags & F_LEFT)) out_pad(o, ' ', width - len);
+    for (int i = 0; i < len; ++i) out_c(o, s[i]);
+    if (flags & F_LEFT) out_pad(o, ' ', width - len);
+}
+
+static int64_t arg_signed(va_list *ap, int len)
+{
+    switch (len) {
+    case LEN_CHAR:  return (signed char)va_arg(*ap, int);
+    case LEN_SHORT: return (short)va_arg(*ap, int);
+    case LEN_LONG:  return va_arg(*ap, long);
+    case LEN_LLONG: return va_arg(*ap, long long);
+    case LEN_SIZE:  return (int64_t)va_arg(*ap, size_t);
+    case LEN_MAX:   return va_arg(*ap, intmax_t);
+    default:        return va_arg(*ap, int);
+    }
+}
+
+static uint64_t arg_unsigned(va_list *ap, int len)
+{
+    switch (len) {
+    case LEN_CHAR:  return (unsigned char)va_arg(*ap, unsigned int);
+    case LEN_SHORT: return (unsigned short)va_arg(*ap, unsigned int);
+    case LEN_LONG:  return va_arg(*ap, unsigned long);
+    case LEN_LLONG: return va_arg(*ap, unsigned long long);
+    case LEN_SIZE:  return va_arg(*ap, size_t);
+    case LEN_MAX:   return va_arg(*ap, uintmax_t);
+    default:        return va_arg(*ap, unsigned int);
+    }
+}
+
+int fdc_fmt_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap)
+{
+    fmt_out_t o = { buf, size, 0 };
+    va_list args;
+    va_copy(args, ap);   /* 传 &args 给取参函数；va_list 为数组类型的平台上形参不能直接取地址 */
+
+    for (const char *p = fmt; *p != '\0'; ++p) {
+        if (*p != '%') {
+            out_c(&o, *p);
+            continue;
+        }
+        const char *spec = p++;
+
+        uint32_t flags = 0;
+        for (;; ++p) {
+            if (*p == '-') flags |= F_LEFT;
+            else if (*p == '0') flags |= F_ZERO;
+            else if (*p == '+') flags |= F_PLUS;
+            else if (*p == ' ') flags |= F_SPACE;
+            else if (*p == '#') flags |= F_ALT;
+            else break;
+        }
+
+        int width = 0;
+        if (*p == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                flags |= F_LEFT;
+                width = -width;
+            }
+            ++p;
+        } else {
+            while (*p >= '0' && *p <= '9') width = width * 10 + (*p++ - '0');
+        }
+
+        int prec = -1;
+        if (*p == '.') {
+            ++p;
+            prec = 0;
+            if (*p == '*') {
+                prec = va_arg(args, int);
+                if (prec < 0) prec = -1;
+                ++p;
+            } else {
+                while (*p >= '0' && *p <= '9') prec = prec * 10 + (*p++ - '0');
+            }
+        }
+
+        int len = LEN_INT;
+        if (*p == 'h') {
+            len = LEN_SHORT;
+            if (*++p == 'h') {
+                len = LEN_CHAR;
+                ++p;
+            }
+        } else if (*p == 'l') {
+            len = LEN_LONG;
+            if (*++p == 'l') {
+                len = LEN_LLONG;
+                ++p;
+            }
+        } else if (*p == 'z') {
+            len = LEN_SIZE;
+            ++p;
+        } else if (*p == 'j') {
+            len = LEN_MAX;
+            ++p;
+        }
+
+        char tmp[24];
+        char pre[3] = { 0 };
+        int n;
+        switch (*p) {
+        case 'd':
+        case 'i':
+        case 'k': {
+            int64_t v = arg_signed(&args, len);
+            uint64_t mag = (v < 0) ? (uint64_t)0 - (uint64_t)v : (uint64_t)v;
+            pre[0] = (v < 0) ? '-' : (flags & F_PLUS) ? '+' : (flags & F_SPACE) ? ' ' : '\0';
+            if (*p == 'k') {
+                int frac = (prec < 0) ? 0 : (prec > 9) ? 9 : prec;
+                n = utoa_rev(tmp, mag, 10U, 0, frac + 1);
+                emit_number(&o, pre, tmp, n, frac, flags, width);
+            } else {
+                if (prec >= 0) flags &= ~F_ZERO;
+                n = utoa_rev(tmp, mag, 10U, 0, (prec < 0) ? 1 : prec);
+                emit_number(&o, pre, tmp, n, 0, flags, width);
+            }
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o': {
+            uint64_t v = arg_unsigned(&args, len);
+            uint32_t base = (*p == 'u') ? 10U : (*p == 'o') ? 8U : 16U;
+            if (prec >= 0) flags &= ~F_ZERO;
+            n = utoa_rev(tmp, v, base, *p == 'X', (prec < 0) ? 1 : prec);
+            if ((flags & F_ALT) && base == 16U && v != 0U) {
+                pre[0] = '0';
+                pre[1] = *p;
+            } else if ((flags & F_ALT) && base == 8U && (n == 0 || tmp[n - 1] != '0')) {
+                tmp[n++] = '0';
+            }
+            emit_number(&o, pre, tmp, n, 0, flags, width);
+            break;
+        }
+        case 'p': {
+            uintptr_t v = (uintptr_t)va_arg(args, void *);
+            pre[0] = '0';
+            pre[1] = 'x';
+            n = utoa_rev(tmp, v, 16U, 0, 1);
+            emit_number(&o, pre, tmp, n, 0, flags & ~F_ZERO, width);
+            break;
+        }
+        case 'c': {
+            char c = (char)va_arg(args, int);
+            if (!(flags & F_LEFT)) out_pad(&o, ' ', width - 1);
+            out_c(&o, c);
+            if (flags & F_LEFT) out_pad(&o, ' ', width - 1);
+            break;
+        }
+        case 's':
+            emit_str(&o, va_arg(args, const char *), prec, flags, width);
+            break;
+        case '%':
+            out_c(&o, '%');
+            break;
+        default:
+            /* 不支持的转换符：原样输出整个说明符 */
+            while (spec < p) out_c(&o, *spec++);
+            if (*p == '\0') --p;
+            else out_c(&o, *p);
+            break;
+        }
+    }
+
+    va_end(args);
+    if (size > 0U) buf[(o.n < size) ? o.n : size - 1U] = '\0';
+    return (int)o.n;
+}
+
+int fdc_fmt_snprintf(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int n = fdc_fmt_vsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
@@ -0,0 +1,85 @@
+/*
+ * fdc_log.c
+ * 令牌化日志记录的编码（记录格式见 fdc_log.h）
+ */
+
+#include "fdc_log.h"
+
+#if FDC_LOG_TOKENIZED
+
+#include <string.h>
+#include "fdc_telemetry.h"
+#include "usart_debug.h"
+
+/* 链接器为段 fdc_log_fmt 自动提供的起始符号；令牌为格式串相对它的偏移 */
+extern const char __start_fdc_log_fmt[];
+
+static void put_varint(fdc_log_rec_t *rec, uint64_t v)
+{
+    uint8_t tmp[10];
+    uint8_t n = 0;
+    do {
+        uint8_t b = (uint8_t)(v & 0x7FU);
+        v >>= 7;
+        tmp[n++] = (v != 0U) ? (uint8_t)(b | 0x80U) : b;
+    } while (v != 0U);
+    if (rec->full || n > (uint8_t)(FDC_LOG_PAYLOAD_MAX - rec->len)) {
+        rec->full = 1;
+        return;
+    }
+    memcpy(&rec->buf[rec->len], tmp, n);
+    rec->len = (uint8_t)(rec->len + n);
+}
+
+void fdc_log_begin(fdc_log_rec_t *rec, const char *fmt)
+{
+    rec->buf[0] = (uint8_t)(FDC_TLM_TYPE_LOG << 4);
+    rec->len = 1;
+    rec->full = 0;
+    put_varint(rec, (uint32_t)(fmt - __start_fdc_log_fmt));
+}
+
+void fdc_log_put_int(fdc_log_rec_t *rec, int64_t v)
+{
+    /* zigzag：0, -1, 1, -2 ... 映射为 0, 1, 2, 3 ...，小的负数也只占 1 字节 */
+    put_varint(rec, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+void fdc_log_put_uint(fdc_log_rec_t *rec, uint64_t v)
+{
+    put_varint(rec, v << 1);
+}
+
+void fdc_log_put_f32(fdc_log_rec_t *rec, double v)
+{
+    float f = (float)v;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    if (rec->full || 4U > (uint8_t)(FDC_LOG_PAYLOAD_MAX - rec->len)) {
+        rec->full = 1;
+        return;
+    }
+    for (uint8_t i = 0; i < 4U; ++i) rec->buf[rec->len++] = (uint8_t)(bits >> (8U * i));
+}
+
+void fdc_log_put_str(fdc_log_rec_t *rec, const char *s)
+{
+    size_t n = (s != NULL) ? strlen(s) : 0U;
+    if (n > FDC_LOG_STR_MAX) n = FDC_LOG_STR_MAX;
+    if (rec->full || n + 1U > (size_t)(FDC_LOG_PAYLOAD_MAX - rec->len)) {
+        rec->full = 1;
+        return;
+    }
+    rec->buf[rec->len++] = (uint8_t)n;
+    if (n > 0U) memcpy(&rec->buf[rec->len], s, n);
+    rec->len = (uint8_t)(rec->len + n);
+}
+
+void fdc_log_end(fdc_log_rec_t *rec)
+{
+    uint8_t frame[FDC_TLM_FRAME_LEN(FDC_LOG_PAYLOAD_MAX)];
+    size_t n = fdc_tlm_encode_frame(rec->buf, rec->len, frame, sizeof(frame));
+    if (n > 0U) (void)fdc_debug_write(frame, (uint16_t)n);
+}
+
+#endif /* FDC_LOG_TOKENIZED */
@@ -0,0 +1,84 @@
+/*
+ * fdc_telemetry.c
+ * 二进制遥测帧编码实现（帧格式见 fdc_telemetry.h）
+ */
+
+#include "fdc_telemetry.h"
+
+uint16_t fdc_tlm_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFFU;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)((uint16_t)data[i] << 8);
+        for (uint8_t b = 0; b < 8U; ++b) {
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t fdc_tlm_cobs_encode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t code_pos = 0;   /* 当前段长度字节的位置 */
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; ++i) {
+        if (in[i] == 0U) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+            continue;
+        }
+        out[o++] = in[i];
+        if (++code == 0xFFU) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return o;
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/* 4 个 28-bit 值紧密排列为 14 字节（小端位序） */
+static void pack_raw28(uint8_t *p, const uint32_t raw[4])
+{
+    uint64_t lo = ((uint64_t)(raw[0] & 0x0FFFFFFFU)) | ((uint64_t)(raw[1] & 0x0FFFFFFFU) << 28);
+    uint64_t hi = ((uint64_t)(raw[2] & 0x0FFFFFFFU)) | ((uint64_t)(raw[3] & 0x0FFFFFFFU) << 28);
+    for (uint8_t i = 0; i < 7U; ++i) {
+        p[i] = (uint8_t)(lo >> (8U * i));
+        p[7U + i] = (uint8_t)(hi >> (8U * i));
+    }
+}
+
+size_t fdc_tlm_encode_frame(uint8_t *buf, size_t len, uint8_t *out, size_t cap)
+{
+    if (buf == NULL || out == NULL || cap < FDC_TLM_FRAME_LEN(len)) return 0;
+    put_le16(&buf[len], fdc_tlm_crc16(buf, len));
+
+    out[0] = 0x00U;
+    size_t n = fdc_tlm_cobs_encode(buf, len + 2U, &out[1]);
+    out[1U + n] = 0x00U;
+    return n + 2U;
+}
+
+size_t fdc_tlm_encode_sample(uint8_t dev, const fdc_sample_t *smp, uint8_t *out, size_t cap)
+{
+    uint8_t buf[FDC_TLM_SAMPLE_PAYLOAD + 2U];
+    if (smp == NULL) return 0;
+
+    buf[0] = (uint8_t)((FDC_TLM_TYPE_SAMPLE << 4) | (dev & 0x0FU));
+    put_le16(&buf[1], (uint16_t)smp->seq);
+    put_le16(&buf[3], (uint16_t)smp->tick);
+    put_le16(&buf[5], (uint16_t)(smp->tick >> 16));
+    pack_raw28(&buf[7], smp->raw);
+    buf[21] = (uint8_t)(((smp->active_mask & 0x0FU) << 4) | (smp->valid_mask & 0x0FU));
+    put_le16(&buf[22], smp->status);
+    return fdc_tlm_encode_frame(buf, FDC_TLM_SAMPLE_PAYLOAD, out, cap);
+}
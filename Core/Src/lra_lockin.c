@@ -0,0 +1,183 @@
+/*
+ * lra_lockin.c
+ * 锁相（同步）检测实现（原理见 lra_lockin.h）
+ */
+
+#include "lra_lockin.h"
+#include <stddef.h>
+
+/* 一个周期 256 点的正弦表，Q15：s_sin[i] = 32767 × sin(2π·i / 256)；cos 取 i + 64 */
+static const int16_t s_sin[256] = {
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,
+      6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+     12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+     18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+     23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+     27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+     30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,
+     32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+     32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+     32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+     30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,
+     27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+     23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,
+     18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+     12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+      6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+         0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,
+     -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+    -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+    -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,
+     -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+};
+
+/* 单个样本相对第一个样本的最大偏离：限制累加值，保证 64-bit 不溢出（见 lra_lockin.h） */
+#define LOCKIN_DX_MAX  ((1L << 22) - 1)
+
+void lra_lockin_reset(lra_lockin_t *l)
+{
+    l->n = 0;
+    l->x0 = 0;
+    l->sx = l->ss = l->sc = 0;
+    l->sxs = l->sxc = l->sss = l->scc = l->ssc = 0;
+}
+
+void lra_lockin_add(lra_lockin_t *l, int32_t x, uint32_t phase)
+{
+    if (l->n >= LRA_LOCKIN_N_MAX) return;
+    if (l->n == 0U) l->x0 = x;
+    int32_t dx = x - l->x0;
+    if (dx > LOCKIN_DX_MAX) dx = LOCKIN_DX_MAX;
+    if (dx < -LOCKIN_DX_MAX) dx = -LOCKIN_DX_MAX;
+    const uint32_t i = (phase + (1UL << 23)) >> 24;     /* 就近取表，相位量化误差 ≤ 0.7° */
+    const int32_t s = s_sin[i & 0xFFU];
+    const int32_t c = s_sin[(i + 64U) & 0xFFU];
+    l->n++;
+    l->sx += dx;
+    l->ss += s;
+    l->sc += c;
+    l->sxs += (int64_t)dx * s;
+    l->sxc += (int64_t)dx * c;
+    l->sss += (int64_t)s * s;
+    l->scc += (int64_t)c * c;
+    l->ssc += (int64_t)s * c;
+}
+
+/* 按样本数平均的协方差 / 方差（取整误差 < 1）。|dx| < 2^22、|sin|,|cos| ≤ 2^15，协方差 ≤ 2^37，Q15 的方差 ≤ 2^30。
+ * 协方差中 sx·sr 可达 2^69，把 sx 拆成 q·n + r 后分别乘：r < n ≤ 2^16，r·sr ≤ 2^47 */
+static int64_t cov_mean(const lra_lockin_t *l, int64_t sxr, int64_t sr)
+{
+    const int64_t n = (int64_t)l->n;
+    return (sxr - (l->sx / n) * sr - ((l->sx % n) * sr) / n) / n;
+}
+
+static int64_t var_mean(const lra_lockin_t *l, int64_t srq, int64_t sr, int64_t sq)
+{
+    return (srq - (sr * sq) / (int64_t)l->n) / (int64_t)l->n;
+}
+
+/* num × 2^k / den（向零取整），|num / den| × 2^k 超出 int32 时饱和；den > 0、den ≤ 2^28、k ≤ 23 */
+static int32_t div_shift(int64_t num, int64_t den, int k)
+{
+    const int64_t q = num / den, r = num % den;
+    if (q > (INT32_MAX >> k)) return INT32_MAX;
+    if (q < -(INT32_MAX >> k)) return -INT32_MAX;
+    const int64_t v = q * ((int64_t)1 << k) + (r * ((int64_t)1 << k)) / den;
+    return (v > INT32_MAX) ? INT32_MAX : (v < -INT32_MAX) ? -INT32_MAX : (int32_t)v;
+}
+
+/* 最小二乘解 [vss vsc; vsc vcc]·[b; c] = [cxs; cxc]，sin / cos 为 Q15，结果换算为样本计数 × 256。
+ * 相位在周期内分布不均时 sin 与 cos 相关（vsc ≠ 0），联立求解仍不偏；det 过小（相位几乎不变）时失败。
+ * 门限 det > vss·vcc / 16，用未缩放的方差（≤ 2^30，乘积 ≤ 2^60）判定：相位只在一段弧上漂移时约需 0.16 周期，
+ * 更窄时噪声被放大数倍以上，结果不可信。
+ * 求解前方差右移 s 位到 14 位以内（相位集中时方差很小，s 随之减小，不损失精度），
+ * 分子 cxs·vcc − cxc·vsc ≤ 2^52；b = 分子 / det × 2^(15 + 8 − s)，由 div_shift 分两步完成不溢出 */
+static int solve_q8(const lra_lockin_t *l, int32_t *b, int32_t *c)
+{
+    const int64_t cxs = cov_mean(l, l->sxs, l->ss);
+    const int64_t cxc = cov_mean(l, l->sxc, l->sc);
+    int64_t vss = var_mean(l, l->sss, l->ss, l->ss);
+    int64_t vcc = var_mean(l, l->scc, l->sc, l->sc);
+    int64_t vsc = var_mean(l, l->ssc, l->ss, l->sc);
+    if (vss <= 0 || vcc <= 0 || vss * vcc - vsc * vsc <= (vss * vcc) >> 4) return 0;
+    int s = 0;
+    while ((vss >> s) >= (1 << 14) || (vcc >> s) >= (1 << 14)) ++s;
+    vss >>= s;
+    vcc >>= s;
+    vsc >>= s;
+    const int64_t det = vss * vcc - vsc * vsc;
+    if (det <= 0) return 0;
+    *b = div_shift(cxs * vcc - cxc * vsc, det, 23 - s);
+    *c = div_shift(cxc * vss - cxs * vsc, det, 23 - s);
+    return 1;
+}
+
+static uint32_t isqrt64(uint64_t v)
+{
+    uint64_t r = 0, bit = 1ULL << 62;
+    while (bit > v) bit >>= 2;
+    while (bit != 0U) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+/* atan2，单位 0.1°，-1800..1800。第一象限 atan(z) ≈ z·(45° + 15.64°·(1 − z))，z ≤ 1，误差 < 0.3° */
+static int32_t atan2_ddeg(int64_t y, int64_t x)
+{
+    uint64_t ax = (x < 0) ? (uint64_t)(-x) : (uint64_t)x;
+    uint64_t ay = (y < 0) ? (uint64_t)(-y) : (uint64_t)y;
+    if (ax == 0U && ay == 0U) return 0;
+    const int swap = ay > ax;
+    uint32_t z = (uint32_t)(((swap ? ax : ay) << 15) / (swap ? ay : ax));     /* Q15，0..32768 */
+    uint32_t k = 450U * 32768U + (1564U * (32768U - z)) / 10U;
+    int32_t a = (int32_t)(((uint64_t)z * k) >> 30);
+    if (swap) a = 900 - a;
+    if (x < 0) a = 1800 - a;
+    return (y < 0) ? -a : a;
+}
+
+int lra_lockin_result(const lra_lockin_t *l, lra_lockin_result_t *out)
+{
+    if (l == NULL || out == NULL || l->n < LRA_LOCKIN_N_MIN) return LRA_LOCKIN_ERR_SAMPLES;
+    int32_t b, c;   /* sin 分量 A·cosθ，cos 分量 A·sinθ */
+    if (!solve_q8(l, &b, &c)) return LRA_LOCKIN_ERR_PHASE;
+    out->in_phase_q8 = b;
+    out->quadrature_q8 = c;
+    out->amp_q8 = isqrt64((uint64_t)((int64_t)b * b + (int64_t)c * c));
+    out->phase_ddeg = (int16_t)atan2_ddeg(c, b);
+    out->n = l->n;
+    return LRA_LOCKIN_OK;
+}
+
+uint32_t lra_lockin_detune_mhz(uint32_t window_ms)
+{
+    /* 1/4 周期 / 窗口时长：250 / window_ms Hz；相位在弧上只漂移 1/4 周期时 det / (vss·vcc) 最差约 0.16，
+     * 高于 solve_q8 的 1/16 门限 */
+    if (window_ms == 0U) window_ms = 1U;
+    return (250000U + window_ms - 1U) / window_ms;
+}
+
+uint32_t lra_phase_of_delay(uint32_t f_mhz, uint32_t delay_ns)
+{
+    /* f × t 以 1e-12 周期为单位，只保留小数周期；× 2^32 / 10^12 = × 2^20 / 5^12 */
+    uint64_t cyc = ((uint64_t)f_mhz * delay_ns) % 1000000000000ULL;
+    return (uint32_t)((cyc << 20) / 244140625ULL);
+}
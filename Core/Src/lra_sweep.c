@@ -0,0 +1,351 @@
+/*
+ * lra_sweep.c
+ * LRA 频率响应扫描与谐振点查找（流程与输出格式见 lra_sweep.h）
+ */
+
+#include "lra_sweep.h"
+#include "lra_lockin.h"
+#include "tim_control.h"
+#include "fdc_telemetry.h"
+#include "usart_debug.h"
+#include "adc.h"
+#include "main.h"
+#include <string.h>
+
+typedef enum {
+    SWEEP_IDLE = 0,
+    SWEEP_SETTLE,       /* 已切到本点频率，等待瞬态衰减 */
+    SWEEP_MEASURE,      /* 累加样本 */
+} sweep_state_t;
+
+typedef struct {
+    uint32_t f_mhz;     /* 实际驱动频率 */
+    uint32_t amp_q8;
+    int16_t phase_ddeg;
+    int8_t status;      /* lra_lockin_result() 的返回码，LRA_LOCKIN_OK 为有效点 */
+} sweep_point_t;
+
+static lra_sweep_cfg_t s_cfg;
+static sweep_state_t s_state = SWEEP_IDLE;
+static uint8_t s_points;            /* 本次扫描的频点数 */
+static uint8_t s_index;             /* 当前频点 */
+static uint32_t s_t0;               /* 当前阶段开始的 HAL_GetTick() */
+static uint32_t s_adc_tick;         /* ADC 源上次取样的 ms */
+static uint32_t s_phase_lag;        /* 采样延迟对应的相位（Q32），每个频点按实际频率计算 */
+static uint32_t s_prev_mhz;         /* 扫描前的驱动频率，中止时恢复 */
+static uint8_t s_detuned;           /* 当前频点已因相位没有分布开而偏开频率重测 */
+static lra_lockin_t s_lockin;
+static sweep_point_t s_pt[LRA_SWEEP_POINTS_MAX];
+static lra_sweep_result_t s_result;
+static uint8_t s_result_valid;
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, (uint16_t)v);
+    put_le16(&p[2], (uint16_t)(v >> 16));
+}
+
+static uint8_t source_id(void)
+{
+    return s_cfg.use_adc ? (uint8_t)LRA_SWEEP_SRC_ADC : (uint8_t)(s_cfg.dev * 4U + s_cfg.ch);
+}
+
+static uint32_t point_freq_mhz(uint8_t i)
+{
+    uint32_t d = (uint32_t)i * s_cfg.f_step_mhz;
+    return (s_cfg.f_stop_mhz >= s_cfg.f_start_mhz) ? s_cfg.f_start_mhz + d : s_cfg.f_start_mhz - d;
+}
+
+/* Q8 幅度 -> 0.01 计数，供 %.2lk 打印 */
+static long amp_centi(uint32_t amp_q8)
+{
+    return (long)(((uint64_t)amp_q8 * 100U + 128U) >> 8);
+}
+
+static void enter_freq(uint32_t f_mhz)
+{
+    TIM3_SetSquareFreqMilliHz(f_mhz);
+    s_t0 = HAL_GetTick();
+    s_state = SWEEP_SETTLE;
+}
+
+static void enter_point(uint8_t i)
+{
+    s_index = i;
+    s_detuned = 0;
+    enter_freq(point_freq_mhz(i));
+}
+
+/* 相位没有分布开时的重测频率：沿扫描方向偏开 lra_lockin_detune_mhz()，不超过半个步长以保持频点顺序 */
+static uint32_t detuned_freq_mhz(uint8_t i)
+{
+    uint32_t d = lra_lockin_detune_mhz(s_cfg.measure_ms);
+    if (d > s_cfg.f_step_mhz / 2U) d = s_cfg.f_step_mhz / 2U;
+    const uint32_t f = point_freq_mhz(i);
+    if (s_cfg.f_stop_mhz >= s_cfg.f_start_mhz) return (f + d <= TIM3_FREQ_MAX_MHZ) ? f + d : f - d;
+    return (f >= TIM3_FREQ_MIN_MHZ + d) ? f - d : f + d;
+}
+
+static void report_point(uint8_t i, uint32_t n)
+{
+    const sweep_point_t *p = &s_pt[i];
+    const int valid = (p->status == LRA_LOCKIN_OK);
+    if (s_cfg.binary) {
+        uint8_t buf[LRA_SWEEP_POINT_PAYLOAD + 2U];
+        uint8_t frame[FDC_TLM_FRAME_LEN(LRA_SWEEP_POINT_PAYLOAD)];
+        buf[0] = (uint8_t)((FDC_TLM_TYPE_SWEEP << 4) | source_id());
+        buf[1] = LRA_SWEEP_KIND_POINT;
+        put_le16(&buf[2], i);
+        put_le32(&buf[4], p->f_mhz);
+        put_le32(&buf[8], valid ? p->amp_q8 : 0U);
+        put_le16(&buf[12], (uint16_t)(valid ? p->phase_ddeg : LRA_SWEEP_PHASE_INVALID));
+        put_le16(&buf[14], (uint16_t)(n > 0xFFFFU ? 0xFFFFU : n));
+        size_t len = fdc_tlm_encode_frame(buf, LRA_SWEEP_POINT_PAYLOAD, frame, sizeof(frame));
+        (void)fdc_debug_write(frame, (uint16_t)len);
+        return;
+    }
+    if (!valid) {
+        fdc_debug_print("SWEEP %u/%u f=%.3lk Hz invalid: %s n=%lu\r\n", (unsigned)i + 1U, (unsigned)s_points,
+                        (long)p->f_mhz, (p->status == LRA_LOCKIN_ERR_PHASE) ? "phase not spread" : "no samples",
+                        (unsigned long)n);
+        return;
+    }
+    fdc_debug_print("SWEEP %u/%u f=%.3lk Hz amp=%.2lk ph=%.1k deg n=%lu\r\n", (unsigned)i + 1U, (unsigned)s_points,
+                    (long)p->f_mhz, amp_centi(p->amp_q8), (int)p->phase_ddeg, (unsigned long)n);
+}
+
+static int point_valid(int i)
+{
+    return s_pt[i].status == LRA_LOCKIN_OK;
+}
+
+/* 幅度下降到 level 的交点频率：从峰值点 k 向 dir（±1）方向找第一个低于 level 的有效点，与前一个有效点
+ * 线性插值（跳过无效点）；扫描范围内没有交点返回 0 */
+static uint32_t crossing_mhz(uint8_t k, int dir, uint32_t level)
+{
+    const sweep_point_t *hi = &s_pt[k];
+    for (int i = (int)k + dir; i >= 0 && i < (int)s_points; i += dir) {
+        if (!point_valid(i)) continue;
+        const sweep_point_t *lo = &s_pt[i];
+        if (lo->amp_q8 >= level) {
+            hi = lo;
+            continue;
+        }
+        int64_t df = (int64_t)hi->f_mhz - (int64_t)lo->f_mhz;
+        int64_t da = (int64_t)hi->amp_q8 - (int64_t)lo->amp_q8;
+        return (uint32_t)((int64_t)lo->f_mhz + df * ((int64_t)level - (int64_t)lo->amp_q8) / da);
+    }
+    return 0;
+}
+
+/* 三点抛物线的顶点（点间距可不等，重测偏开的点或跳过无效点后）：以中间点为原点，
+ * a = x1 - x0、b = x2 - x1、d0 = y1 - y0、d2 = y1 - y2，顶点 x1 - (a²·d2 - b²·d0) / (2 (a·d2 + b·d0))。
+ * 间距先缩到 15 位以内，使 a²·d 留在 int64（幅度 < 2^32）；缩放带来的误差约为间距的 2^-15 */
+static uint32_t parabola_peak_mhz(const sweep_point_t *p0, const sweep_point_t *p1, const sweep_point_t *p2)
+{
+    int64_t a = (int64_t)p1->f_mhz - (int64_t)p0->f_mhz;
+    int64_t b = (int64_t)p2->f_mhz - (int64_t)p1->f_mhz;
+    const int64_t d0 = (int64_t)p1->amp_q8 - (int64_t)p0->amp_q8;
+    const int64_t d2 = (int64_t)p1->amp_q8 - (int64_t)p2->amp_q8;
+    int64_t scale = 1;
+    while (a > 0x7FFF || a < -0x7FFF || b > 0x7FFF || b < -0x7FFF) {
+        a /= 2;
+        b /= 2;
+        scale *= 2;
+    }
+    const int64_t den = a * d2 + b * d0;
+    if (den == 0) return p1->f_mhz;
+    const int64_t num = a * a * d2 - b * b * d0;
+    return (uint32_t)((int64_t)p1->f_mhz - num / (2 * den) * scale);
+}
+
+/* 峰值、抛物线插值的 f0、-3 dB 带宽与 Q（只用有效点）；返回有效点数，为 0 时 r 中没有结果 */
+static uint8_t analyse(lra_sweep_result_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->points = s_points;
+    int k = -1;
+    for (int i = 0; i < (int)s_points; ++i) {
+        if (!point_valid(i)) continue;
+        r->valid_points++;
+        if (k < 0 || s_pt[i].amp_q8 > s_pt[k].amp_q8) k = i;
+    }
+    if (k < 0) return 0;
+    r->f0_mhz = s_pt[k].f_mhz;
+    r->amp_q8 = s_pt[k].amp_q8;
+    r->phase_ddeg = s_pt[k].phase_ddeg;
+    /* 两侧最近的有效点 */
+    int kp = k - 1, kn = k + 1;
+    while (kp >= 0 && !point_valid(kp)) --kp;
+    while (kn < (int)s_points && !point_valid(kn)) ++kn;
+    if (kp >= 0 && kn < (int)s_points) r->f0_mhz = parabola_peak_mhz(&s_pt[kp], &s_pt[k], &s_pt[kn]);
+    uint32_t level = (uint32_t)(((uint64_t)r->amp_q8 * 46341U) >> 16);    /* 峰值 / √2 */
+    uint32_t f_lo = crossing_mhz((uint8_t)k, -1, level), f_hi = crossing_mhz((uint8_t)k, 1, level);
+    if (f_lo != 0U && f_hi != 0U && f_lo != f_hi) {
+        r->bw_mhz = (f_hi > f_lo) ? f_hi - f_lo : f_lo - f_hi;
+        uint64_t q = ((uint64_t)r->f0_mhz * 100U + r->bw_mhz / 2U) / r->bw_mhz;
+        r->q_x100 = (uint16_t)(q > 0xFFFFU ? 0xFFFFU : q);
+    }
+    return r->valid_points;
+}
+
+static void report_result(const lra_sweep_result_t *r)
+{
+    if (s_cfg.binary) {
+        uint8_t buf[LRA_SWEEP_RESULT_PAYLOAD + 2U];
+        uint8_t frame[FDC_TLM_FRAME_LEN(LRA_SWEEP_RESULT_PAYLOAD)];
+        buf[0] = (uint8_t)((FDC_TLM_TYPE_SWEEP << 4) | source_id());
+        buf[1] = LRA_SWEEP_KIND_RESULT;
+        put_le16(&buf[2], r->points);
+        put_le32(&buf[4], r->f0_mhz);
+        put_le32(&buf[8], r->amp_q8);
+        put_le32(&buf[12], r->bw_mhz);
+        put_le16(&buf[16], r->q_x100);
+        put_le16(&buf[18], (uint16_t)r->phase_ddeg);
+        size_t len = fdc_tlm_encode_frame(buf, LRA_SWEEP_RESULT_PAYLOAD, frame, sizeof(frame));
+        (void)fdc_debug_write(frame, (uint16_t)len);
+        return;
+    }
+    if (r->valid_points < r->points) {
+        fdc_debug_print("SWEEP %u of %u points invalid, excluded from the fit\r\n",
+                        (unsigned)(r->points - r->valid_points), (unsigned)r->points);
+    }
+    if (r->bw_mhz == 0U) {
+        fdc_debug_print("SWEEP peak f0=%.3lk Hz amp=%.2lk ph=%.1k deg (-3 dB points outside range)\r\n",
+                        (long)r->f0_mhz, amp_centi(r->amp_q8), (int)r->phase_ddeg);
+        return;
+    }
+    fdc_debug_print("SWEEP peak f0=%.3lk Hz amp=%.2lk ph=%.1k deg bw=%.3lk Hz Q=%.2k\r\n", (long)r->f0_mhz,
+                    amp_centi(r->amp_q8), (int)r->phase_ddeg, (long)r->bw_mhz, (int)r->q_x100);
+}
+
+/* 一个频点测量结束：保存、输出，进入下一点或结束扫描 */
+static void finish_point(void)
+{
+    lra_lockin_result_t lr;
+    sweep_point_t *p = &s_pt[s_index];
+    p->f_mhz = TIM3_GetActualFreqMilliHz();
+    const int st = lra_lockin_result(&s_lockin, &lr);
+    if (st == LRA_LOCKIN_ERR_PHASE && !s_detuned) {
+        /* 驱动频率与样本率相干：偏开一点重测一次，该点以重测的实际频率记录 */
+        const uint32_t f = detuned_freq_mhz(s_index);
+        if (f != point_freq_mhz(s_index)) {
+            s_detuned = 1;
+            fdc_debug_print("SWEEP %u/%u f=%.3lk Hz phase not spread, re-measuring at %.3lk Hz\r\n",
+                            (unsigned)s_index + 1U, (unsigned)s_points, (long)p->f_mhz, (long)f);
+            enter_freq(f);
+            return;
+        }
+    }
+    p->status = (int8_t)st;
+    p->amp_q8 = (st == LRA_LOCKIN_OK) ? lr.amp_q8 : 0U;
+    p->phase_ddeg = (st == LRA_LOCKIN_OK) ? lr.phase_ddeg : 0;
+    report_point(s_index, s_lockin.n);
+
+    if (s_index + 1U < s_points) {
+        enter_point((uint8_t)(s_index + 1U));
+        return;
+    }
+    s_state = SWEEP_IDLE;
+    if (analyse(&s_result) == 0U) {
+        /* 没有任何有效点：不给出结果，恢复扫描前的频率 */
+        s_result_valid = 0;
+        fdc_debug_print("SWEEP: no valid point, drive restored to %.3lk Hz\r\n", (long)s_prev_mhz);
+        TIM3_SetSquareFreqMilliHz(s_prev_mhz);
+        return;
+    }
+    s_result_valid = 1;
+    report_result(&s_result);
+    /* 谐振点查找：驱动停在 f0 */
+    TIM3_SetSquareFreqMilliHz(s_result.f0_mhz);
+}
+
+int lra_sweep_start(const lra_sweep_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->f_step_mhz == 0U || cfg->settle_ms == 0U || cfg->measure_ms == 0U) {
+        return LRA_SWEEP_ERR_PARAM;
+    }
+    if (cfg->f_start_mhz < TIM3_FREQ_MIN_MHZ || cfg->f_start_mhz > TIM3_FREQ_MAX_MHZ ||
+        cfg->f_stop_mhz < TIM3_FREQ_MIN_MHZ || cfg->f_stop_mhz > TIM3_FREQ_MAX_MHZ) {
+        return LRA_SWEEP_ERR_PARAM;
+    }
+    if (!cfg->use_adc && (cfg->dev >= FDC_MAX_DEVICES || cfg->ch > 3U)) return LRA_SWEEP_ERR_PARAM;
+    uint32_t span = (cfg->f_stop_mhz >= cfg->f_start_mhz) ? cfg->f_stop_mhz - cfg->f_start_mhz
+                                                          : cfg->f_start_mhz - cfg->f_stop_mhz;
+    uint32_t points = span / cfg->f_step_mhz + 1U;
+    if (points > LRA_SWEEP_POINTS_MAX) return LRA_SWEEP_ERR_POINTS;
+
+    if (s_state == SWEEP_IDLE) s_prev_mhz = TIM3_GetSquareFreqMilliHz();
+    s_cfg = *cfg;
+    s_points = (uint8_t)points;
+    if (s_cfg.use_adc) {
+        fdc_debug_print("SWEEP ADC1 %.3lk..%.3lk Hz step %.3lk Hz, %u points, settle %u ms, measure %u ms\r\n",
+                        (long)s_cfg.f_start_mhz, (long)s_cfg.f_stop_mhz, (long)s_cfg.f_step_mhz, (unsigned)s_points,
+                        (unsigned)s_cfg.settle_ms, (unsigned)s_cfg.measure_ms);
+    } else {
+        fdc_debug_print("SWEEP CH%u %.3lk..%.3lk Hz step %.3lk Hz, %u points, settle %u ms, measure %u ms\r\n",
+                        (unsigned)source_id(), (long)s_cfg.f_start_mhz, (long)s_cfg.f_stop_mhz,
+                        (long)s_cfg.f_step_mhz, (unsigned)s_points, (unsigned)s_cfg.settle_ms,
+                        (unsigned)s_cfg.measure_ms);
+    }
+    enter_point(0);
+    return LRA_SWEEP_OK;
+}
+
+void lra_sweep_stop(void)
+{
+    if (s_state == SWEEP_IDLE) return;
+    s_state = SWEEP_IDLE;
+    TIM3_SetSquareFreqMilliHz(s_prev_mhz);
+}
+
+int lra_sweep_busy(void)
+{
+    return s_state != SWEEP_IDLE;
+}
+
+void lra_sweep_feed(uint8_t dev, const fdc_sample_t *smp)
+{
+    if (s_state != SWEEP_MEASURE || s_cfg.use_adc || dev != s_cfg.dev) return;
+    if (!(smp->valid_mask & (1U << s_cfg.ch))) return;
+    lra_lockin_add(&s_lockin, (int32_t)smp->raw[s_cfg.ch], smp->stamp - s_phase_lag);
+}
+
+void lra_sweep_poll(void)
+{
+    if (s_state == SWEEP_IDLE) return;
+    if (TIM3_GetSquareFreqMilliHz() == 0U) {
+        /* freq 0 停止了驱动：中止扫描，不再恢复频率 */
+        s_state = SWEEP_IDLE;
+        fdc_debug_print("SWEEP aborted: drive off\r\n");
+        return;
+    }
+    const uint32_t now = HAL_GetTick();
+    if (s_state == SWEEP_SETTLE) {
+        if (now - s_t0 < s_cfg.settle_ms) return;
+        lra_lockin_reset(&s_lockin);
+        s_phase_lag = lra_phase_of_delay(TIM3_GetActualFreqMilliHz(), s_cfg.delay_ns);
+        s_adc_tick = now - 1U;
+        s_t0 = now;
+        s_state = SWEEP_MEASURE;
+    }
+    if (s_cfg.use_adc && now != s_adc_tick) {
+        /* ADC1 连续转换，取最近一次结果；转换时间为 us 级，不做延迟补偿 */
+        s_adc_tick = now;
+        lra_lockin_add(&s_lockin, (int32_t)HAL_ADC_GetValue(&hadc1), TIM3_GetDrivePhase());
+    }
+    if (now - s_t0 >= s_cfg.measure_ms) finish_point();
+}
+
+int lra_sweep_get_result(lra_sweep_result_t *out)
+{
+    if (!s_result_valid || out == NULL) return 0;
+    *out = s_result;
+    return 1;
+}
@@ -0,0 +1,336 @@
+/*
+ * lra_track.c
+ * LRA 谐振跟踪（锁相环原理与参数见 lra_track.h）
+ */
+
+#include "lra_track.h"
+#include "lra_lockin.h"
+#include "lra_sweep.h"
+#include "tim_control.h"
+#include "usart_debug.h"
+#include "adc.h"
+#include "main.h"
+#include <string.h>
+
+typedef enum {
+    TRACK_IDLE = 0,
+    TRACK_SETTLE,       /* 刚改过频率，等待瞬态衰减 */
+    TRACK_MEASURE,      /* 累加样本 */
+} track_phase_t;
+
+static lra_track_cfg_t s_cfg;
+static track_phase_t s_phase = TRACK_IDLE;
+static uint32_t s_t0;               /* 当前阶段开始的 HAL_GetTick() */
+static uint32_t s_adc_tick;         /* ADC 源上次取样的 ms */
+static uint32_t s_report_tick;      /* 上次打印状态的 ms */
+static uint32_t s_phase_lag;        /* 采样延迟对应的相位（Q32），按当前实际频率计算 */
+static uint32_t s_f_mhz;            /* 本模块最近一次设置的驱动频率 */
+static uint32_t s_f_lo, s_f_hi;     /* 跟踪范围 */
+static uint8_t s_lock_count;
+static uint8_t s_at_limit;
+static uint8_t s_held;              /* 环路要求的频率落在盲区内，停在盲区边缘 */
+static uint32_t s_blind_mhz;        /* 盲区中心 k·SPS/2（由窗口内的相位漂移推算），0 = 无 */
+static uint32_t s_win_ms;           /* 当前测量窗口：measure_ms，盲区附近加长 */
+static uint32_t s_ph_first, s_ph_last;      /* 窗口内第一个 / 最后一个样本的驱动相位（Q32） */
+static uint32_t s_tick_first, s_tick_last;  /* 对应的 HAL_GetTick() */
+static lra_lockin_t s_lockin;
+static lra_track_state_t s_st;
+
+/* 默认增益：上次扫频给出 Q 时取相位斜率倒数的一半，π·f0 / (720·Q) Hz/°；否则用固定值 */
+static uint32_t default_gain(void)
+{
+    lra_sweep_result_t r;
+    if (lra_sweep_get_result(&r) && r.q_x100 != 0U) {
+        uint64_t g = ((uint64_t)r.f0_mhz * 31416U) / (72000U * (uint64_t)r.q_x100);
+        if (g != 0U) return (uint32_t)g;
+    }
+    return LRA_TRACK_GAIN_MHZ_PER_DEG;
+}
+
+/* 跟踪范围：f0 ± span，限制在 TIM3 可设范围内 */
+static void set_range(uint32_t f0)
+{
+    s_f_lo = (f0 > TIM3_FREQ_MIN_MHZ + s_cfg.span_mhz) ? f0 - s_cfg.span_mhz : TIM3_FREQ_MIN_MHZ;
+    s_f_hi = (f0 < TIM3_FREQ_MAX_MHZ - s_cfg.span_mhz) ? f0 + s_cfg.span_mhz : TIM3_FREQ_MAX_MHZ;
+}
+
+static void enter_settle(uint32_t now)
+{
+    s_t0 = now;
+    s_phase = TRACK_SETTLE;
+}
+
+static void enter_measure(uint32_t now)
+{
+    lra_lockin_reset(&s_lockin);
+    s_phase_lag = lra_phase_of_delay(TIM3_GetActualFreqMilliHz(), s_cfg.delay_ns);
+    s_adc_tick = now - 1U;
+    s_t0 = now;
+    s_phase = TRACK_MEASURE;
+}
+
+static void add_sample(int32_t x, uint32_t phase)
+{
+    const uint32_t now = HAL_GetTick();
+    if (s_lockin.n == 0U) {
+        s_ph_first = phase;
+        s_tick_first = now;
+    }
+    s_ph_last = phase;
+    s_tick_last = now;
+    lra_lockin_add(&s_lockin, x, phase);
+}
+
+/* 驱动频率相对最近的 k·SPS/2 的偏差（mHz）：窗口内相位漂移（按半周期折回 ±1/4 周期）/ 窗口时长。
+ * 只在相位解不出（漂移 < 1/4 周期）时使用，此时折回无歧义 */
+static int32_t blind_offset_mhz(void)
+{
+    const uint32_t dt = s_tick_last - s_tick_first;
+    if (dt == 0U) return 0;
+    /* 2 × 漂移，Q32 有符号：漂移 = d2 / 2^33 周期，偏差 = 漂移 × 10^6 / dt mHz */
+    const int32_t d2 = (int32_t)((s_ph_last - s_ph_first) << 1);
+    return (int32_t)(((int64_t)d2 * 1000000) / ((int64_t)dt << 33));
+}
+
+/* 相位误差折回 -1800..1800 */
+static int32_t wrap_ddeg(int32_t e)
+{
+    while (e > 1800) e -= 3600;
+    while (e < -1800) e += 3600;
+    return e;
+}
+
+static void report(void)
+{
+    if (s_st.lockin_status == LRA_LOCKIN_ERR_PHASE) {
+        fdc_debug_print("TRACK f=%.3lk Hz phase not resolved (near k*SPS/2), detuning\r\n", (long)s_st.f_mhz);
+        return;
+    }
+    if (s_st.lockin_status != LRA_LOCKIN_OK) {
+        fdc_debug_print("TRACK f=%.3lk Hz no response\r\n", (long)s_st.f_mhz);
+        return;
+    }
+    fdc_debug_print("TRACK f=%.3lk Hz ph=%.1k deg err=%.1k deg amp=%.2lk %s%s\r\n", (long)s_st.f_mhz,
+                    (int)s_st.phase_ddeg, (int)s_st.error_ddeg, (long)(((uint64_t)s_st.amp_q8 * 100U + 128U) >> 8),
+                    s_at_limit ? "(range limit)" : s_st.locked ? "locked" : "tracking",
+                    s_held ? " (held off k*SPS/2)" : "");
+}
+
+static void set_drive(uint32_t now, uint32_t f)
+{
+    s_f_mhz = f;
+    TIM3_SetSquareFreqMilliHz(s_f_mhz);
+    s_st.f_mhz = TIM3_GetActualFreqMilliHz();
+    enter_settle(now);
+}
+
+static void lose_lock(const char *why)
+{
+    s_lock_count = 0;
+    if (s_st.locked) {
+        s_st.locked = 0;
+        fdc_debug_print("TRACK lost: %s at %.3lk Hz\r\n", why, (long)s_st.f_mhz);
+    }
+}
+
+/* 相位解不出（驱动频率接近 k·SPS/2，窗口内相位几乎不变）：由相位漂移推算盲区中心，
+ * 测量窗口加长到 LRA_TRACK_BLIND_WIN_MUL 倍以缩小盲区，再移到当前一侧的盲区边缘（中心 ± 失调量）；
+ * 该侧超出跟踪范围时换到另一侧 */
+static void detune(uint32_t now)
+{
+    const int first = (s_st.lockin_status != LRA_LOCKIN_ERR_PHASE);
+    const int64_t b = (int64_t)s_st.f_mhz - blind_offset_mhz();
+    s_win_ms = (uint32_t)s_cfg.measure_ms * LRA_TRACK_BLIND_WIN_MUL;
+    const int64_t d = lra_lockin_detune_mhz(s_win_ms);
+    int64_t f = ((int64_t)s_st.f_mhz >= b) ? b + d : b - d;
+    if (f > (int64_t)s_f_hi) f = b - d;
+    if (f < (int64_t)s_f_lo) f = b + d;
+    if (f < (int64_t)s_f_lo) f = s_f_lo;
+    if (f > (int64_t)s_f_hi) f = s_f_hi;
+    s_st.lockin_status = LRA_LOCKIN_ERR_PHASE;
+    lose_lock("phase not resolved");
+    s_blind_mhz = (b > 0) ? (uint32_t)b : 1U;
+    s_held = 0;
+    if (first) {
+        fdc_debug_print("TRACK phase not resolved at %.3lk Hz (k*SPS/2 = %.3lk Hz), moving to %.3lk Hz, "
+                        "window %lu ms\r\n", (long)s_st.f_mhz, (long)b, (long)f, (unsigned long)s_win_ms);
+    }
+    set_drive(now, (uint32_t)f);
+}
+
+/* 环路要求的频率落在盲区（中心 ± 失调量）内时停在当前一侧的边缘；
+ * 远离盲区（4 倍失调量）后清除记录，窗口恢复 measure_ms */
+static int64_t avoid_blind(int64_t f)
+{
+    s_held = 0;
+    if (s_blind_mhz == 0U) return f;
+    const int64_t d = lra_lockin_detune_mhz(s_win_ms);
+    const int64_t b = s_blind_mhz;
+    if (f - b >= 4 * d || b - f >= 4 * d) {
+        s_blind_mhz = 0;
+        s_win_ms = s_cfg.measure_ms;
+        return f;
+    }
+    if (f - b < d && b - f < d) {
+        s_held = 1;
+        return ((int64_t)s_f_mhz >= b) ? b + d : b - d;
+    }
+    return f;
+}
+
+/* 一个窗口结束：按相位误差调整频率 */
+static void update(uint32_t now)
+{
+    lra_lockin_result_t lr;
+    s_st.updates++;
+    const int st = lra_lockin_result(&s_lockin, &lr);
+    if (st == LRA_LOCKIN_ERR_PHASE) {
+        detune(now);
+        return;
+    }
+    if (st != LRA_LOCKIN_OK || lr.amp_q8 == 0U) {
+        /* 没有响应（传感器未接、驱动幅度为 0）：保持频率 */
+        s_st.lockin_status = LRA_LOCKIN_ERR_SAMPLES;
+        s_st.amp_q8 = 0;
+        lose_lock("no response");
+        enter_measure(now);
+        return;
+    }
+
+    const int32_t err = wrap_ddeg((int32_t)lr.phase_ddeg - s_cfg.setpoint_ddeg);
+    s_st.lockin_status = LRA_LOCKIN_OK;
+    s_st.phase_ddeg = lr.phase_ddeg;
+    s_st.error_ddeg = (int16_t)err;
+    s_st.amp_q8 = lr.amp_q8;
+
+    if (err < LRA_TRACK_LOCK_DDEG && err > -LRA_TRACK_LOCK_DDEG) {
+        if (s_lock_count < LRA_TRACK_LOCK_COUNT) s_lock_count++;
+        if (s_lock_count == LRA_TRACK_LOCK_COUNT && !s_st.locked) {
+            s_st.locked = 1;
+            fdc_debug_print("TRACK locked f=%.3lk Hz ph=%.1k deg\r\n", (long)s_st.f_mhz, (int)lr.phase_ddeg);
+        }
+    } else {
+        s_lock_count = 0;
+        if (s_st.locked) {
+            s_st.locked = 0;
+            fdc_debug_print("TRACK unlocked: err=%.1k deg at %.3lk Hz\r\n", (int)err, (long)s_st.f_mhz);
+        }
+    }
+
+    /* Δf = gain × e（e 为 0.1°），低于谐振时 θ 偏大（滞后少），e > 0，升频 */
+    int64_t step = (int64_t)s_st.gain_mhz_per_deg * err / 10;
+    if (step > (int64_t)LRA_TRACK_STEP_MAX_MHZ) step = LRA_TRACK_STEP_MAX_MHZ;
+    if (step < -(int64_t)LRA_TRACK_STEP_MAX_MHZ) step = -(int64_t)LRA_TRACK_STEP_MAX_MHZ;
+    int64_t f = avoid_blind((int64_t)s_f_mhz + step);
+    s_at_limit = (f <= (int64_t)s_f_lo || f >= (int64_t)s_f_hi);
+    if (f < (int64_t)s_f_lo) f = s_f_lo;
+    if (f > (int64_t)s_f_hi) f = s_f_hi;
+    if ((uint32_t)f == s_f_mhz) {
+        enter_measure(now);
+        return;
+    }
+    set_drive(now, (uint32_t)f);
+}
+
+int lra_track_start(const lra_track_cfg_t *cfg)
+{
+    if (cfg == NULL || cfg->settle_ms == 0U || cfg->measure_ms == 0U || cfg->setpoint_ddeg > 1800 ||
+        cfg->setpoint_ddeg < -1800) {
+        return LRA_TRACK_ERR_PARAM;
+    }
+    if (!cfg->use_adc && (cfg->dev >= FDC_MAX_DEVICES || cfg->ch > 3U)) return LRA_TRACK_ERR_PARAM;
+    const uint32_t f0 = TIM3_GetSquareFreqMilliHz();
+    if (f0 == 0U) return LRA_TRACK_ERR_STOPPED;
+
+    s_cfg = *cfg;
+    if (s_cfg.span_mhz == 0U) s_cfg.span_mhz = LRA_TRACK_SPAN_MHZ;
+    s_f_mhz = f0;
+    set_range(f0);
+    s_lock_count = 0;
+    s_at_limit = 0;
+    s_held = 0;
+    s_blind_mhz = 0;
+    s_win_ms = s_cfg.measure_ms;
+    memset(&s_st, 0, sizeof(s_st));
+    s_st.running = 1;
+    s_st.f_mhz = TIM3_GetActualFreqMilliHz();
+    s_st.gain_mhz_per_deg = s_cfg.gain_mhz_per_deg ? s_cfg.gain_mhz_per_deg : default_gain();
+
+    const uint32_t now = HAL_GetTick();
+    s_report_tick = now;
+    enter_settle(now);
+    if (s_cfg.use_adc) {
+        fdc_debug_print("TRACK ADC1 from %.3lk Hz, %.3lk..%.3lk Hz, setpoint %.1k deg, gain %lu mHz/deg\r\n",
+                        (long)s_st.f_mhz, (long)s_f_lo, (long)s_f_hi, (int)s_cfg.setpoint_ddeg,
+                        (unsigned long)s_st.gain_mhz_per_deg);
+    } else {
+        fdc_debug_print("TRACK CH%u from %.3lk Hz, %.3lk..%.3lk Hz, setpoint %.1k deg, gain %lu mHz/deg\r\n",
+                        (unsigned)(s_cfg.dev * 4U + s_cfg.ch), (long)s_st.f_mhz, (long)s_f_lo, (long)s_f_hi,
+                        (int)s_cfg.setpoint_ddeg, (unsigned long)s_st.gain_mhz_per_deg);
+    }
+    return LRA_TRACK_OK;
+}
+
+/* 停止跟踪，驱动保持在当前频率 */
+void lra_track_stop(void)
+{
+    s_phase = TRACK_IDLE;
+    s_st.running = 0;
+    s_st.locked = 0;
+}
+
+int lra_track_busy(void)
+{
+    return s_phase != TRACK_IDLE;
+}
+
+void lra_track_feed(uint8_t dev, const fdc_sample_t *smp)
+{
+    if (s_phase != TRACK_MEASURE || s_cfg.use_adc || dev != s_cfg.dev) return;
+    if (!(smp->valid_mask & (1U << s_cfg.ch))) return;
+    add_sample((int32_t)smp->raw[s_cfg.ch], smp->stamp - s_phase_lag);
+}
+
+void lra_track_poll(void)
+{
+    if (s_phase == TRACK_IDLE) return;
+    const uint32_t now = HAL_GetTick();
+    const uint32_t target = TIM3_GetSquareFreqMilliHz();
+    if (target == 0U) {
+        lra_track_stop();
+        fdc_debug_print("TRACK stopped: drive off\r\n");
+        return;
+    }
+    if (target != s_f_mhz) {
+        /* 频率被 freq 等命令改动：从新的频率继续，跟踪范围随之平移 */
+        s_f_mhz = target;
+        set_range(target);
+        s_blind_mhz = 0;
+        s_held = 0;
+        s_win_ms = s_cfg.measure_ms;
+        s_st.f_mhz = TIM3_GetActualFreqMilliHz();
+        s_lock_count = 0;
+        s_st.locked = 0;
+        enter_settle(now);
+    }
+    if (now - s_report_tick >= LRA_TRACK_REPORT_MS) {
+        s_report_tick = now;
+        if (s_st.updates != 0U) report();
+    }
+
+    if (s_phase == TRACK_SETTLE) {
+        if (now - s_t0 < s_cfg.settle_ms) return;
+        enter_measure(now);
+    }
+    if (s_cfg.use_adc && now != s_adc_tick) {
+        /* ADC1 连续转换，取最近一次结果（同扫频） */
+        s_adc_tick = now;
+        add_sample((int32_t)HAL_ADC_GetValue(&hadc1), TIM3_GetDrivePhase());
+    }
+    if (now - s_t0 >= s_win_ms) update(now);
+}
+
+void lra_track_get_state(lra_track_state_t *out)
+{
+    if (out != NULL) *out = s_st;
+}
@@ -33,6 +33,17 @@
 #include "usart_debug.h"
 /* TIM2/3 控制封装 */
 #include "tim_control.h"
+/* 原始值 -> 频率/电容的定点换算 */
+#include "fdc_fixed.h"
+/* 流式基线跟踪 */
+#include "fdc_baseline.h"
+/* 二进制遥测帧 */
+#include "fdc_telemetry.h"
+/* 串口命令解释器 */
+#include "cmd_shell.h"
+/* LRA 扫频与谐振点查找、谐振跟踪 */
+#include "lra_sweep.h"
+#include "lra_track.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -42,6 +53,25 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+/* 串口打印抽取因子（上电默认值，运行中可用 "dec N" 修改）：100 SPS 时每 10 轮打印一次（约 10 次/秒），避免串口阻塞拖慢采样 */
+#define FDC_PRINT_DECIMATION  10U
+/* 样本输出格式：0 = 抽取后的文本打印（串口助手直接看），1 = 每组样本一帧二进制遥测
+ * （fdc_telemetry.h，约 28 字节/组，主机用 tools/fdc_telemetry.py 解码）。编译时 -DFDC_STREAM_BINARY=1 切换上电默认值，
+ * 运行中可用 "stream off|text|bin" 切换 */
+#ifndef FDC_STREAM_BINARY
+#define FDC_STREAM_BINARY     0
+#endif
+/* 本板实际接线的电极通道：只接两路电极的板子改为 FDC_SEQ_CH0_1，转换时间全部分给这两路 */
+#define FDC_BOARD_SEQUENCE    FDC_SEQ_CH0_3
+/* 板上 FDC2214 数量：第二片（0x2B）未焊接时初始化失败，自动只用第一片 */
+#define FDC_DEV_COUNT         2U
+/* LC 谐振电路参数：线圈电感 18 uH、并联固定电容 20 pF（请按实际硬件修改） */
+#define FDC_COIL_L_NH         18000U
+#define FDC_TANK_C0_FF        20000
+/* 1 = 初始化后用 DWT 周期计数器对比 double 与定点电容换算的耗时并打印（编译时 -DFDC_FIXED_BENCH=1） */
+#ifndef FDC_FIXED_BENCH
+#define FDC_FIXED_BENCH       0
+#endif
 
 /* USER CODE END PD */
 
@@ -54,11 +84,35 @@
 
 /* USER CODE BEGIN PV */
 
-/* TIM3 中断请求翻转标志 */
-// static volatile uint8_t tim3_toggle_flag = 0;
-
-/* 基线数组（每通道），在启动时可以通过 fdc_calibrate_baseline 填充或动态更新 */
-// static uint32_t baseline[4] = {0, 0, 0, 0};
+/* 板上的 FDC2214：芯片 u 的通道 ch 在打印中编号为 CH(u*4+ch)，共 8 通道 */
+static fdc_dev_t *const s_fdc[FDC_DEV_COUNT] = { &fdc_dev0, &fdc_dev1 };
+/* 初始化成功的芯片 */
+static uint8_t s_fdc_ok[FDC_DEV_COUNT];
+
+/* 每通道基线跟踪器：每个样本 O(1) 更新，delta = raw - baseline 用于判断触摸/接近 */
+static fdc_baseline_t s_baseline[FDC_DEV_COUNT];
+
+/* 打印抽取计数：每 s_shell.decimation 轮采样打印一次 */
+static uint32_t s_print_div[FDC_DEV_COUNT];
+/* 上次打印时的 I2C 错误计数，用于发现新的读取失败 */
+static uint32_t s_last_i2c_err[FDC_DEV_COUNT];
+/* 上次打印时的覆盖（丢转换）与丢样总数，用于发现主循环处理太慢 */
+static uint32_t s_last_lost[FDC_DEV_COUNT];
+/* 上次打印时串口发送缓冲区丢弃的消息数，用于发现打印量超过串口带宽 */
+static uint32_t s_last_log_drop;
+/* 电容换算常数（fdc_init 成功后按实际 fREF 计算） */
+static fdc_fixed_cal_t s_cap_cal[FDC_DEV_COUNT];
+/* 串口命令可修改的运行参数（样本输出方式、抽取因子等） */
+static void App_OnReconfig(uint8_t u);
+static cmd_shell_ctx_t s_shell = {
+  .dev = s_fdc,
+  .dev_ok = s_fdc_ok,
+  .baseline = s_baseline,
+  .dev_count = FDC_DEV_COUNT,
+  .stream = FDC_STREAM_BINARY ? CMD_STREAM_BINARY : CMD_STREAM_TEXT,
+  .decimation = FDC_PRINT_DECIMATION,
+  .on_reconfig = App_OnReconfig,
+};
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -70,6 +124,46 @@ void SystemClock_Config(void);
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
 
+/* 命令修改了芯片 u 的采样配置：fREF 与通道可能变化，重算电容换算常数并让基线重新起算 */
+static void App_OnReconfig(uint8_t u)
+{
+  fdc_fixed_init(&s_cap_cal[u], fdc_plan_data_fref_hz(fdc_get_config(s_fdc[u])), FDC_COIL_L_NH, FDC_TANK_C0_FF);
+  for (uint8_t ch = 0; ch < 4; ++ch) fdc_baseline_reset(&s_baseline[u], ch);
+  s_print_div[u] = 0;
+}
+
+#if FDC_FIXED_BENCH
+/* 换算耗时基准：DWT CYCCNT 分别计量 fdc_raw_to_freq + fdc_freq_to_capacitance（软件浮点）与
+ * fdc_fixed_raw_to_ff 每样本的 CPU 周期数。输入取 fSENSOR 3..6 MHz 对应的 DATA，避免常量折叠 */
+static void App_BenchCapConv(uint8_t u)
+{
+  enum { BENCH_N = 64 };
+  const fdc_fixed_cal_t *cal = &s_cap_cal[u];
+  const uint32_t raw0 = (uint32_t)((3000000ULL << 28) / cal->fref_hz);
+  const uint32_t step = raw0 / BENCH_N;
+  volatile int32_t sink = 0;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  uint32_t t0 = DWT->CYCCNT;
+  for (uint32_t i = 0; i < BENCH_N; ++i) {
+    double f = fdc_raw_to_freq(raw0 + i * step, (double)cal->fref_hz);
+    double c = fdc_freq_to_capacitance(f, FDC_COIL_L_NH * 1e-9, FDC_TANK_C0_FF * 1e-15);
+    sink = (int32_t)(c * 1e15);
+  }
+  uint32_t t1 = DWT->CYCCNT;
+  for (uint32_t i = 0; i < BENCH_N; ++i) {
+    sink = fdc_fixed_raw_to_ff(cal, raw0 + i * step);
+  }
+  uint32_t t2 = DWT->CYCCNT;
+  (void)sink;
+
+  fdc_debug_print("U%u C conv cycles/sample: double=%lu fixed=%lu\r\n", (unsigned)u,
+                  (unsigned long)((t1 - t0) / BENCH_N), (unsigned long)((t2 - t1) / BENCH_N));
+}
+#endif
+
 /* USER CODE END 0 */
 
 /**
@@ -110,49 +204,53 @@ int main(void)
   
   /* 1. 初始化串口接收以接收命令 */
   fdc_debug_init();  /* 这会启动串口中断接收 */
+  cmd_shell_init(&s_shell);
   
-  // /* 2. 启动TIM2 PWM输出（占空比可通过串口设置）*/
-  // TIM2_Control_Init();
-  // TIM2_PWM_SetDutyPercent(90);  /* 设置默认占空比50% */                //改接收再振动################
+  /* 2. 启动TIM2 PWM输出：打开 ARR/CCR1 预装载并按载波频率重设 PSC/ARR。
+   *    占空比保持 0，收到串口 duty 命令后再振动 */
+  TIM2_Control_Init();
 
-  // /* 3. 启动TIM3并设置默认频率（20Hz）*/
-  // HAL_TIM_Base_Start_IT(&htim3);  /* 启动定时器中断 */
-  // TIM3_SetSquareFreqHz(100);       /* 设置默认频率 */
+  /* 3. TIM3 振动驱动：只配置不启动，由串口命令 freq 设置频率后开始换向 */
+  TIM3_Drive_Init();
+  /* 每组 FDC 样本在 INTB 时刻记录 TIM3 驱动相位，供扫频 / 谐振跟踪的锁相检测使用 */
+  fdc_set_stamp_hook(TIM3_GetDrivePhase);
 
   fdc_debug_print("PWMPercent FreqHz");
-  /* FDC2214 初始化（如果需要）*/
-  {
-    int r = fdc_init();
+  /* FDC2214 初始化（如果需要）：两片芯片共用 I2C1，分别初始化 */
+  for (uint8_t u = 0; u < FDC_DEV_COUNT; ++u) {
+    fdc_dev_t *dev = s_fdc[u];
+    int r = fdc_init(dev);
     if (r != FDC_OK) {
       /* 使用限频打印，避免初始化阶段反复打印导致串口占满 */
-      fdc_debug_print_limited("fdc_init failed: %s (%d)\r\n", fdc_err_str(r), r);
-    } else {
-      fdc_debug_print("fdc_init OK\r\n");
+      fdc_debug_print_limited("fdc_init U%u failed: %s (%d)\r\n", (unsigned)u, fdc_err_str(r), r);
+      continue;
     }
+    fdc_debug_print("fdc_init U%u OK\r\n", (unsigned)u);
+    s_fdc_ok[u] = 1;
+    r = fdc_set_sequence(dev, FDC_BOARD_SEQUENCE);
+    if (r != FDC_OK) {
+      fdc_debug_print("fdc_set_sequence U%u failed: %s (%d)\r\n", (unsigned)u, fdc_err_str(r), r);
+    }
+    /* 换算常数按规划后的最终 fREF 计算：fdc_set_sequence 重新规划时可能改变参考时钟 */
+    fdc_fixed_init(&s_cap_cal[u], fdc_plan_data_fref_hz(fdc_get_config(dev)), FDC_COIL_L_NH, FDC_TANK_C0_FF);
+#if FDC_FIXED_BENCH
+    App_BenchCapConv(u);
+#endif
+    /* 使能 INTB 数据就绪中断：先配置 EXTI，再让芯片输出 DRDY */
+    fdc_intb_init(dev);
+    r = fdc_enable_drdy_interrupt(dev);
+    if (r != FDC_OK) {
+      fdc_debug_print("fdc DRDY enable U%u failed: %s (%d)\r\n", (unsigned)u, fdc_err_str(r), r);
+    }
+    /* 进入异步采集模式：之后 FDC 读取全部由中断完成，两片芯片由驱动的调度器交错读取 */
+    fdc_async_start(dev);
   }
 
   HAL_ADC_Start(&hadc1); //启动ADC1
 
-  // /* 启动时对 4 个通道做基线校准（将结果写入上方定义的 baseline[] 数组）
-  //  * 说明：如果不做校准，baseline 默认为 0（在头部已初始化为 0），
-  //  *      那么 delta = raw - baseline 会等于 raw，本质上没有去偏移效果。
-  //  * 这里使用  次采样取平均，必要时可调整 samples 的值。
-  //  */
-  // {
-  //   const uint8_t samples = 100; /* 建议 8..64，根据噪声与时间权衡 */
-  //   for (int ch = 0; ch < 4; ++ch) {
-  //     int rc = fdc_calibrate_baseline((fdc_channel_t)ch, &baseline[ch], samples);
-  //     if (rc != FDC_OK) {
-  //       /* 校准失败时限频打印错误，避免串口刷屏 */
-  //       fdc_debug_print_limited("calibrate CH%d failed: %s (%d)\r\n", ch, fdc_err_str(rc), rc);
-  //     } else {
-  //       /* 成功打印基线值一次（调试用），随后主循环会使用 baseline[] */
-  //       fdc_debug_print("calibrate CH%d baseline=%lu\r\n", ch, (unsigned long)baseline[ch]);
-  //     }
-  //     /* 小延时，给总线和传感器一点恢复时间 */
-  //     HAL_Delay(50);
-  //   }
-  // }
+  /* 基线不再在启动时阻塞校准（原 4 通道 × 100 次 fdc_calibrate_baseline 需要数秒），
+   * 改为流式跟踪：第一个样本即作为初始基线，之后随每个样本慢速收敛并补偿漂移。 */
+  for (uint8_t u = 0; u < FDC_DEV_COUNT; ++u) fdc_baseline_init(&s_baseline[u], NULL);
 
   /* USER CODE END 2 */
 
@@ -164,74 +262,110 @@ int main(void)
 
     /* USER CODE BEGIN 3 */
 
-    
-  // /* 处理由TIM3 Update 触发的安全翻转请求（带软件死区） */
-  // TIM3_HandlePendingToggle();
 
   
-     /* 2. FDC2214采样（如需要） */
-  for (int ch = 0; ch < 4; ++ch) {
-    /* 声明一个局部变量用于保存本次读取到的原始值（32-bit 容器）
-     * 注意：FDC2214 的有效位可能高达 28 位，使用 32-bit 容器以免溢出
-     */
-    uint32_t raw = 0;
-
-    /* 调用驱动函数读取指定通道的原始值
-     * fdc_read_result_raw 会按手册要求先读取 DATA_CHx（MSB）再读取 DATA_LSB_CHx（LSB）
-     * 返回 FDC_OK 表示读取成功；若返回错误码，则代表 I2C 通信或设备状态异常
-     */
-    if (fdc_read_result_raw((fdc_channel_t)ch, &raw) == FDC_OK) {
-      /* 成功读取后：
-       * 根据 datasheet 将 RAW(DATAx) 转换为振荡频率 f_sensor，再由已知电感 L 和并联电容 C0
-       * 计算被测电容值（单位 F），这里演示使用 fref = 40 MHz, C0 = 20 pF。
-       * 注意：L 必须由硬件线圈实际测量或由电路设计提供 -- 下面使用示例值 L = 1e-6 H （1 uH），请根据实际测量修改。
-       */
-      const double fref_hz = 40e6; /* 40 MHz */
-      const double C0_f = 20e-12;  /* 20 pF */
-      const double L_h = 18e-6;     /* 18 uH, 请根据实际线圈电感替换 */
-      double fsensor = fdc_raw_to_freq(raw, fref_hz); 
-      double C_f = fdc_freq_to_capacitance(fsensor, L_h, C0_f);
-      /* 将电容转换为 pF 便于阅读 */
-      double C_pf = (C_f > 0.0) ? (C_f * 1e12) : -1.0;//三元条件运算符:条件表达式 ? 表达式1 : 表达式2;先判断「条件表达式」的真假，然后根据判断结果分别执行表达式1或表达式2。如果条件为真（非0），则返回表达式1的结果；否则，返回表达式2的结果。
-
-
-      /* 打印通道、原始值、频率与电容（pF）。限频打印已在初始化时用于错误，主循环打印频率较低（每轮 50ms）。 */
-      if (C_pf >= 0.0) {//printf 的浮点支持被禁用了（在 STM32 的 newlib/nano printf 默认不含 %f）
-          uint32_t f_hz = (uint32_t)(fsensor + 0.5);           /* 四舍五入 整数 Hz */
-          uint32_t C_milli_pf = (uint32_t)(C_pf + 0.5); /* 四舍五入 */
-          fdc_debug_print("CH%d raw=%lu f=%luHz C=%lu m-pF\r\n",ch, (unsigned long)raw, (unsigned long)f_hz, (unsigned long)C_milli_pf);
-      } else {
-          fdc_debug_print("CH%d raw=%lu   f=%.1f Hz   C=ERR\r\n", ch, (unsigned long)raw, fsensor);
+     /* 2. FDC2214采样：由 INTB(DRDY) 中断驱动的异步读取
+      * 芯片每完成一轮转换拉低 INTB，EXTI 回调直接启动中断方式的 I2C 读取，
+      * 完成回调把 4 通道结果写入样本环形缓冲区；主循环只负责取样本做换算和打印，
+      * 总线传输与主循环计算重叠进行，CPU 不再阻塞等待 I2C。
+      */
+  fdc_async_poll();
+  for (uint8_t u = 0; u < FDC_DEV_COUNT; ++u) {
+    if (!s_fdc_ok[u]) continue;
+    fdc_dev_t *dev = s_fdc[u];
+    uint32_t i2c_err = fdc_async_get_i2c_errors(dev);
+    if (i2c_err != s_last_i2c_err[u]) {
+      /* 读取失败：打印错误信息（限频打印以避免循环刷屏） */
+      s_last_i2c_err[u] = i2c_err;
+      fdc_debug_print_limited("Read U%u failed (i2c errors=%lu)\r\n", (unsigned)u, (unsigned long)i2c_err);
+    }
+    {
+      fdc_stats_t st;
+      fdc_get_stats(dev, &st);
+      uint32_t lost = st.dropped;
+      for (int ch = 0; ch < 4; ++ch) lost += st.overruns[ch];
+      if (lost != s_last_lost[u]) {
+        s_last_lost[u] = lost;
+        fdc_debug_print_limited("U%u conversions lost: overrun=%lu/%lu/%lu/%lu dropped=%lu\r\n", (unsigned)u,
+                                (unsigned long)st.overruns[0], (unsigned long)st.overruns[1],
+                                (unsigned long)st.overruns[2], (unsigned long)st.overruns[3],
+                                (unsigned long)st.dropped);
       }
-    } else {
-      /* 读取失败：打印错误信息（此处可改用限频打印以避免循环刷屏） */
-      fdc_debug_print_limited("Read CH%d failed\r\n", ch);//  fdc_debug_print_limited("PWMPercent FreqHz_limit");
     }
 
-    /* 在读取通道之间加入短延时：
-     * - 避免 I2C 总线上的紧凑访问导致从机忙或总线争用
-     * - 给被测电路/传感器一点时间稳定（视测量速率与硬件而定可调整）//调###############
-     */
-    HAL_Delay(5);
-  } 
+    fdc_sample_t smp;
+    while (fdc_async_get(dev, &smp)) {
+      int32_t delta[4] = {0, 0, 0, 0};
+      for (uint8_t ch = 0; ch < 4; ++ch) {
+        /* 只把可信结果喂给基线，避免看门狗超时/振幅异常/旧值被平均进基线 */
+        if (smp.valid_mask & (1U << ch)) delta[ch] = fdc_baseline_update(&s_baseline[u], ch, smp.raw[ch]);
+      }
+      lra_sweep_feed(u, &smp);
+      lra_track_feed(u, &smp);
+      if (s_shell.stream == CMD_STREAM_OFF) continue;
+      if (s_shell.stream == CMD_STREAM_BINARY) {
+        /* 二进制模式不抽取：每组样本一帧，发送缓冲区满时整帧丢弃，主机按 seq 跳号发现 */
+        uint8_t frame[FDC_TLM_FRAME_MAX];
+        size_t n = fdc_tlm_encode_sample(u, &smp, frame, sizeof(frame));
+        (void)fdc_debug_write(frame, (uint16_t)n);
+        continue;
+      }
+      if (++s_print_div[u] < s_shell.decimation) continue;
+      /* 打印不阻塞采样（DMA 后台发送），但 115200 bps 约 11 KB/s 的带宽装不下每轮的结果，
+       * 每 s_shell.decimation 轮才打印一次，超出带宽的部分会被发送缓冲区丢弃 */
+      s_print_div[u] = 0;
+      for (int ch = 0; ch < 4; ++ch) {
+        if (!(smp.active_mask & (1U << ch))) continue; /* 跳过未接线（未扫描）的通道 */
+        uint32_t raw = smp.raw[ch];
+        /* 成功读取后：
+         * 根据 datasheet 将 RAW(DATAx) 转换为振荡频率 f_sensor，再由已知电感 L 和并联电容 C0
+         * 计算被测电容值。M3 没有 FPU，这里使用 fdc_fixed 的定点换算（整数 Hz 与 fF），
+         * 不再每通道每样本调用 double 版本的 fdc_raw_to_freq / fdc_freq_to_capacitance。
+         * 注意：L 必须由硬件线圈实际测量或由电路设计提供，见 FDC_COIL_L_NH。
+         */
+        uint32_t f_hz = fdc_fixed_raw_to_freq_hz(raw, s_cap_cal[u].fref_hz);
+        int32_t c_ff = fdc_fixed_raw_to_ff(&s_cap_cal[u], raw);
+        int gch = u * 4 + ch;
+
+        /* 打印通道、原始值、频率与电容（pF，保留 3 位小数）。主循环按 s_shell.decimation 抽取打印。 */
+        if (!(smp.valid_mask & (1U << ch))) {
+            fdc_debug_print("CH%d raw=%lu BAD status=0x%04X\r\n", gch, (unsigned long)raw, (unsigned)smp.status);
+        } else if (c_ff >= 0) {
+            fdc_debug_print("CH%d raw=%lu d=%ld%s f=%luHz C=%.3lk pF\r\n", gch, (unsigned long)raw,
+                            (long)delta[ch], fdc_baseline_is_touched(&s_baseline[u], (uint8_t)ch) ? "(T)" : "",
+                            (unsigned long)f_hz, (long)c_ff);
+        } else {
+            fdc_debug_print("CH%d raw=%lu d=%ld f=%luHz C=ERR\r\n", gch, (unsigned long)raw,
+                            (long)delta[ch], (unsigned long)f_hz);
+        }
+      }
 
+      if (u == 0) {
+        HAL_ADC_PollForConversion(&hadc1, 100);
+        uint32_t adcValue = HAL_ADC_GetValue(&hadc1);
+        /* 电压（0.01 V，参考电压 3.3 V，四舍五入），用定点打印，不依赖浮点 printf */
+        uint32_t adc_cv = (adcValue * 330U + 2047U) / 4095U;
+        fdc_debug_print("ADC1 Value: %.2lk\r\n", (long)adc_cv);
+      }
+    }
+  }
 
-  
-  HAL_ADC_PollForConversion(&hadc1, 100);
-  uint32_t adcValue = HAL_ADC_GetValue(&hadc1);
-  float voltage = (adcValue / 4095.0f) * 3.3f; // Assuming a 3.3V reference voltage
-  float test_value = 0.666666666;
-  fdc_debug_print("test: %1.2f\r\n", test_value);
-  fdc_debug_print("ADC1 Value: %1.2f\r\n", voltage);
-
-  // /* 先处理串口命令（如果有），把命令放在主循环处理，避免在ISR中调用HAL函数 */
-  // {
-  //   char cmd[32];
-  //   if (fdc_debug_get_command(cmd, sizeof(cmd))) {
-  //     /* 由主循环调用命令处理，安全执行TIM相关的HAL操作 */
-  //     HandleTIM3Command(cmd);
-  //   }
-  // }
+  {
+    fdc_debug_tx_stats_t tx;
+    fdc_debug_get_tx_stats(&tx);
+    if (tx.dropped_msgs != s_last_log_drop) {
+      s_last_log_drop = tx.dropped_msgs;
+      fdc_debug_print_limited("log dropped %lu msgs (%lu B)\r\n", (unsigned long)tx.dropped_msgs,
+                              (unsigned long)tx.dropped_bytes);
+    }
+  }
+
+  /* 处理串口命令，把命令放在主循环处理，避免在ISR中调用HAL函数。
+   * 接收回调按行排队，连续到达的多条命令在这里逐条取出，由命令表（cmd_shell.c）解释执行 */
+  cmd_shell_poll();
+  /* 扫频：推进频点、输出结果；谐振跟踪：每个测量窗口调整一次频率（样本都在上面的采集循环中送入） */
+  lra_sweep_poll();
+  lra_track_poll();
 
 
 
@@ -246,8 +380,7 @@ int main(void)
   //   }
   // }
 
-  // /* 在一轮四通道读取完成后再等待较长的周期，控制总体采样率 */
-  HAL_Delay(50);
+  /* 不再用 HAL_Delay(50) 控制采样率：采样节拍由 FDC2214 的 DRDY 中断决定 */
   }
   /* USER CODE END 3 */
 }
@@ -307,15 +440,6 @@ void SystemClock_Config(void)
 //   }
 // }
 
-/* 基本更新中断回调：用于 TIM3 的半周期计时（在 MX_TIM3_Init 中启用了 Update IRQ）
- * 我们在这里设置同样的请求标志，由主循环执行带死区的翻转处理。
- */
-/* TIM3更新中断回调：请求翻转IN1/IN2（在主循环中执行带死区保护的翻转）*/
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim){
-  if (htim->Instance == TIM3) {
-    tim3_toggle_flag = 1;  /* TIM3_HandlePendingToggle处理 */
-  }
-}
 /* USER CODE END 4 */
 
 /**
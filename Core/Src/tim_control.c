@@ -1,164 +1,576 @@
 /*
  * tim_control.c
  * 1) TIM2 CH1: PWM输出控制（占空比可调）
- * 2) TIM3: 产生低频振动（20/60/100Hz），由中断翻转IN1/IN2
- * 支持串口命令配置PWM占空比和振动频率
+ * 2) TIM3: 产生低频振动（20/60/100Hz），IN1/IN2 的换向与死区由 TIM3 触发 DMA 写 BSRR 完成
+ * 3) 波形模式：TIM2 占空比按 Flash 中的幅度表逐周期变化（DMA 写 CCR1），TIM3 由 TIM2 计数换向
+ * 串口命令（cmd_shell.c）通过下面的接口配置PWM占空比和振动频率
  */
 #include "tim_control.h"
 #include "tim.h"      /* 提供 htim2 的 extern */
 #include "main.h"     /* 提供 IN1/IN2 引脚定义 */
 #include "gpio.h"
-#include "usart_debug.h"
+#include "drive_wave.h"
 #include "stm32f1xx_hal.h"
-#include <string.h>
-#include <stdlib.h>
+#include <stdint.h>
 
 
-/* 由TIM3中断设置，主循环处理IN1/IN2翻转请求 */
-volatile uint8_t tim3_toggle_flag = 0;
+/* 换向时序（一个 TIM3 周期 = 驱动的半个周期，计数 0..ARR）：
+ *   更新事件（CNT 回到 0）-> DMA1_Ch3 写 s_bsrr_phase[k]：一路置高、另一路拉低，k 在 0/1 间循环
+ *   CC1 比较（CNT == CCR1）-> DMA1_Ch6 写 s_bsrr_off：两路同时拉低，进入死区
+ * 死区 = ARR+1-CCR1 个 tick，正好在下一次更新事件（换向）处结束。
+ * BSRR 的置位 / 复位在同一次总线写中完成，任何时刻都不会两路同时为高。
+ * IN1、IN2 必须在同一个 GPIO 端口（当前均为 GPIOB）。 */
+static uint32_t s_bsrr_phase[2];
+static uint32_t s_bsrr_off;
 
-/* IN1/IN2翻转的软件死区（毫秒） */
-static const uint32_t TOGGLE_DEADTIME_MS = 2;
+/* 不抖动时 PSC 的搜索个数 */
+#ifndef TIM3_SYNTH_SEARCH
+#define TIM3_SYNTH_SEARCH  256U
+#endif
 
-/* 当前状态变量（供帮助命令打印） */
-static volatile uint8_t s_current_duty_percent = 0;
-static volatile uint32_t s_current_tim3_freq_hz = 0;
+/* 频率合成结果：半周期 = (PSC+1) × (ARR+1 + frac/65536) 个定时器时钟。
+ * frac != 0 时由更新中断逐周期在 ARR 与 ARR+1 之间抖动（一阶 Σ-Δ），平均值即为上式 */
+typedef struct {
+    uint16_t psc;
+    uint16_t arr;
+    uint16_t frac;      /* Q16 小数 tick */
+    uint16_t dead;      /* 死区 tick */
+} tim3_timing_t;
 
-/* 初始化TIM2的PWM输出 */
+/* TIM3 计数时钟（Hz），TIM3_Drive_Init 时按 RCC 配置得出 */
+static uint32_t s_tim3_clk_hz;
+/* 波形模式：TIM2 每个 PWM 周期输出一个幅度样本，更新事件触发 DMA1_Ch2 把下一个 CCR1 写入预装载寄存器；
+ * 同一个更新事件作为 TRGO 送到 TIM3 的 ITR1，TIM3 工作在外部时钟模式 1，对 PWM 周期计数，
+ * ARR+1 = 表长，每放完一遍表正好换向一次。样本与换向的对齐由两个定时器的硬件串联保证，
+ * 不会漂移；CC1 / 更新事件的换向 DMA 与方波模式相同，运行中没有中断 */
+static const drive_wave_t *s_wave;                  /* NULL = 方波模式（TIM3 内部时钟） */
+static uint8_t s_wave_running;                      /* 驱动以波形模式运行中 */
+static uint16_t s_wave_ccr[DRIVE_WAVE_LEN_MAX];     /* 换算好的 CCR1，DMA 循环读取 */
+static uint32_t s_wave_steps;                       /* 波形模式下 TIM2 的 ARR+1 */
+/* 运行中的时序与抖动累加器，只在 TIM3 更新中断中修改 */
+static tim3_timing_t s_active;
+static uint32_t s_dither_acc;
+/* 主循环交给更新中断、在下一次换向后写入的新时序 */
+static tim3_timing_t s_pending;
+static volatile uint8_t s_pending_valid;
+
+/* 当前状态变量（供 help 命令查询） */
+static uint32_t s_duty_q16 = 0;             /* TIM2 占空比，Q16（65536 = 100%），改载波时据此重算 CCR1 */
+static uint32_t s_pwm_carrier_hz = 0;
+static uint32_t s_pwm_carrier_req = TIM2_PWM_CARRIER_HZ;   /* 方波模式的载波，波形模式结束后恢复 */
+static uint32_t s_current_tim3_mhz = 0;
+static uint32_t s_actual_tim3_mhz = 0;
+static uint32_t s_deadtime_us = TIM3_DEADTIME_US;
+static uint8_t s_dither = 0;
+
+/* TIM2 / TIM3 在 APB1 上：APB1 分频不为 1 时定时器时钟为 PCLK1 × 2 */
+static uint32_t apb1_timer_clock_hz(void)
+{
+    RCC_ClkInitTypeDef clk;
+    uint32_t latency;
+    HAL_RCC_GetClockConfig(&clk, &latency);
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+    return (clk.APB1CLKDivider == RCC_HCLK_DIV1) ? pclk1 : 2U * pclk1;
+}
+
+/* 占空比换算为 CCR1（PWM1：CNT < CCR1 时输出有效）；65536 时 CCR1 = ARR+1，输出常有效 */
+static uint32_t pwm_ccr(uint32_t arr)
+{
+    return (uint32_t)(((uint64_t)s_duty_q16 * (arr + 1U) + 0x8000U) >> 16);
+}
+
+/* 幅度表按当前占空比（满幅样本对应的占空比）与 TIM2 级数换算为 CCR1。
+ * 更新事件 k 搬运的值在第 k+1 次更新时装入影子寄存器，即晚两个 PWM 周期才输出；换向与第
+ * n 次更新同时发生，所以表向前错开两个位置存放，使换向后的第一个 PWM 周期输出样本 0。
+ * 运行中重算时 DMA 可能读到新旧混合的表，只影响一个半周期的幅度 */
+static void wave_build(uint32_t steps)
+{
+    const uint32_t n = s_wave->len;
+    uint32_t full = pwm_ccr(steps - 1U);
+    for (uint32_t j = 0; j < n; ++j) {
+        uint32_t ccr = (s_wave->table[(j + 2U) % n] * full + 0x4000U) >> 15;
+        s_wave_ccr[j] = (uint16_t)(ccr > 0xFFFFU ? 0xFFFFU : ccr);
+    }
+}
+
+/* 初始化TIM2的PWM输出：打开 ARR / CCR1 预装载，按 TIM2_PWM_CARRIER_HZ 重新选择 PSC/ARR 后启动 */
 void TIM2_Control_Init(void)
 {
+    htim2.Instance->CR1 |= TIM_CR1_ARPE;
+    htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    __HAL_TIM_ENABLE_OCxPRELOAD(&htim2, TIM_CHANNEL_1);
+    TIM2_PWM_SetCarrierHz(TIM2_PWM_CARRIER_HZ);
+    /* 启动前用 UG 把新的 PSC / ARR / CCR1 装入影子寄存器 */
+    htim2.Instance->EGR = TIM_EGR_UG;
     HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
 }
 
+/* 载波频率：取能放下 ARR 的最小 PSC，使一个周期的计数 ARR+1 最大（72 MHz 下 10 kHz 为 7200 级）。
+ * PSC / ARR / CCR1 都是预装载寄存器，写之前置 UDIS 暂停影子寄存器更新，三个值写完后
+ * 在下一次计数溢出时一起生效，期间 PWM 按旧参数照常输出，不会出现新旧混合的周期 */
+uint32_t TIM2_PWM_SetCarrierHz(uint32_t hz)
+{
+    s_pwm_carrier_req = hz;
+    /* 波形模式下载波由驱动频率决定，新值在回到方波模式时生效 */
+    if (s_wave_running) return s_pwm_carrier_hz;
+
+    uint32_t clk = apb1_timer_clock_hz();
+    uint32_t hz_max = clk / TIM2_PWM_MIN_STEPS;
+    if (hz == 0U) hz = 1U;
+    if (hz > hz_max) hz = hz_max;
+
+    uint32_t div = (clk + hz / 2U) / hz;            /* 一个 PWM 周期的定时器时钟数 */
+    uint32_t psc = (div - 1U) / 0x10000U;
+    if (psc > 0xFFFFU) psc = 0xFFFFU;
+    uint32_t steps = (div + (psc + 1U) / 2U) / (psc + 1U);
+    if (steps > 0x10000U) steps = 0x10000U;
+    uint32_t arr = steps - 1U;
+
+    htim2.Instance->CR1 |= TIM_CR1_UDIS;
+    __HAL_TIM_SET_PRESCALER(&htim2, psc);
+    __HAL_TIM_SET_AUTORELOAD(&htim2, arr);
+    __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, pwm_ccr(arr));
+    htim2.Instance->CR1 &= ~TIM_CR1_UDIS;
+    htim2.Init.Prescaler = psc;
+
+    uint32_t period = (psc + 1U) * steps;
+    s_pwm_carrier_hz = (clk + period / 2U) / period;
+    return s_pwm_carrier_hz;
+}
+
+uint32_t TIM2_PWM_GetCarrierHz(void)
+{
+    return s_pwm_carrier_hz;
+}
+
+uint32_t TIM2_PWM_GetSteps(void)
+{
+    return __HAL_TIM_GET_AUTORELOAD(&htim2) + 1U;
+}
+
+/* CCR1 预装载：新值在当前周期结束时生效，不会截断或拉长正在输出的脉冲 */
+void TIM2_PWM_SetDutyQ16(uint32_t q16)
+{
+    if (q16 > 0x10000U) q16 = 0x10000U;
+    s_duty_q16 = q16;
+    if (s_wave_running) {
+        wave_build(s_wave_steps);
+        return;
+    }
+    __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, pwm_ccr(__HAL_TIM_GET_AUTORELOAD(&htim2)));
+}
+
+void TIM2_PWM_SetDutyPermille(uint16_t permille)
+{
+    if (permille > 1000U) permille = 1000U;
+    TIM2_PWM_SetDutyQ16(((uint32_t)permille * 0x10000U + 500U) / 1000U);
+}
+
 void TIM2_PWM_SetDutyPercent(uint8_t percent)
 {
     if (percent > 100) percent = 100;
-    s_current_duty_percent = percent;
-    uint32_t arr = htim2.Init.Period;
-    uint32_t pulse = ((uint32_t)percent * (arr + 1)) / 100U;
-    if (pulse > arr) pulse = arr;
-    __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, pulse);
+    TIM2_PWM_SetDutyPermille((uint16_t)(percent * 10U));
 }
 
-/* 为 TIM3 生成低频方波：设置目标频率 hz（例如 20/60/100）
- * 逻辑：计算半周期对应的计数（ARR），并以 Update 中断翻转引脚。
- * 注意：计算使用 htim3.Init.Prescaler（请确保 CubeMX 中已正确设置 PSC）
- */
-void TIM3_SetSquareFreqHz(uint32_t hz)
+uint32_t TIM2_PWM_GetDutyQ16(void)
 {
-    if (hz == 0) return;
+    return s_duty_q16;
+}
 
-    /* 读取 TIM3 的 PSC（注意：Init 已由 MX_TIM3_Init 配置） */
-    uint32_t psc = htim3.Init.Prescaler;
-    /* 以 72 MHz 系统时钟为基准计算 tick 频率：f_tick = 72MHz / (PSC+1)
-     * （适用于 APB1 定时器在本工程中为 72 MHz 的情况）
-     */
-    uint64_t f_tick = 72000000ULL / (uint64_t)(psc + 1);
+uint16_t TIM2_PWM_GetDutyPermille(void)
+{
+    return (uint16_t)((s_duty_q16 * 1000U + 0x8000U) >> 16);
+}
 
-    /* half-period ticks = f_tick / (2 * hz) */
-    uint64_t half_ticks = f_tick / (2ULL * (uint64_t)hz);
-    if (half_ticks == 0) half_ticks = 1;
-    uint32_t arr = (uint32_t)(half_ticks - 1ULL);
-    if (arr > 0xFFFF) arr = 0xFFFF;
+uint8_t TIM2_PWM_GetDutyPercent(void)
+{
+    return (uint8_t)((s_duty_q16 * 100U + 0x8000U) >> 16);
+}
 
-    /* 安全更新：停止中断，写 ARR，清计数器，重启中断 */
-    HAL_TIM_Base_Stop_IT(&htim3); 
-    __HAL_TIM_SET_AUTORELOAD(&htim3, arr);
-    __HAL_TIM_SET_COUNTER(&htim3, 0);
-    HAL_TIM_Base_Start_IT(&htim3);
+void TIM3_Drive_Init(void)
+{
+    s_bsrr_phase[0] = (uint32_t)IN1_Pin | ((uint32_t)IN2_Pin << 16);
+    s_bsrr_phase[1] = (uint32_t)IN2_Pin | ((uint32_t)IN1_Pin << 16);
+    s_bsrr_off = ((uint32_t)IN1_Pin | (uint32_t)IN2_Pin) << 16;
+    s_tim3_clk_hz = apb1_timer_clock_hz();
 
-    /* 记录当前频率，供帮助命令查看 */
-    s_current_tim3_freq_hz = hz;
-}
-
-/* 内部通用切换实现：在主循环中被调用，假定调用者已清除对应的请求标志,必须在主循环中调用（不能在 ISR 中调用，因为包含延时）。 */
-static void perform_toggle(void)
-{
-    /* 读取当前 IN1/IN2 状态并决定目标方向
-     * 目标策略：在每次切换时，先把两个输入拉低（死区），等待短暂时间，
-     * 然后写入目标方向（仅一个输入为高，另一个低）。
-     */
-    GPIO_PinState in1 = HAL_GPIO_ReadPin(IN1_GPIO_Port, IN1_Pin);
-    GPIO_PinState in2 = HAL_GPIO_ReadPin(IN2_GPIO_Port, IN2_Pin);
-
-    GPIO_PinState target_in1 = GPIO_PIN_RESET;
-    GPIO_PinState target_in2 = GPIO_PIN_RESET;
-
-    if (in1 == GPIO_PIN_SET && in2 == GPIO_PIN_RESET) {
-        /* 当前为 IN1 正向 -> 切换到 IN2 */
-        target_in1 = GPIO_PIN_RESET;
-        target_in2 = GPIO_PIN_SET;
-    } else if (in1 == GPIO_PIN_RESET && in2 == GPIO_PIN_SET) {
-        /* 当前为 IN2 正向 -> 切换到 IN1 */
-        target_in1 = GPIO_PIN_SET;
-        target_in2 = GPIO_PIN_RESET;
-    } else if (in1 == GPIO_PIN_RESET && in2 == GPIO_PIN_RESET) {
-        /* 双低：默认设为 IN1 正向 */
-        target_in1 = GPIO_PIN_SET;
-        target_in2 = GPIO_PIN_RESET;
-    } else {
-        /* 双高（理论上不应出现），先拉低后设为 IN1 */
-        target_in1 = GPIO_PIN_SET;
-        target_in2 = GPIO_PIN_RESET;
+    /* 打开 ARR 预装载（PSC 硬件上总是预装载）：新时序在更新事件整体生效，不会截断当前半周期 */
+    htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    if (HAL_TIM_Base_Init(&htim3) != HAL_OK) {
+        Error_Handler();
+    }
+
+    /* CH1 只用作比较事件（冻结模式，不输出到引脚），CCR1 同样预装载 */
+    TIM_OC_InitTypeDef oc = {0};
+    oc.OCMode = TIM_OCMODE_TIMING;
+    oc.Pulse = 0;
+    oc.OCPolarity = TIM_OCPOLARITY_HIGH;
+    oc.OCFastMode = TIM_OCFAST_DISABLE;
+    if (HAL_TIM_OC_ConfigChannel(&htim3, &oc, TIM_CHANNEL_1) != HAL_OK) {
+        Error_Handler();
     }
+    __HAL_TIM_ENABLE_OCxPRELOAD(&htim3, TIM_CHANNEL_1);
 
-    /* 先拉低，保证在死区内无任何输入被驱动 */
-    HAL_GPIO_WritePin(IN1_GPIO_Port, IN1_Pin, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(IN2_GPIO_Port, IN2_Pin, GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(IN1_GPIO_Port, IN1_Pin | IN2_Pin, GPIO_PIN_RESET);
+}
 
-    /* 主循环内短延时作为软件死区（注意：不要在 ISR 中调用 HAL_Delay） */
-    HAL_Delay(TOGGLE_DEADTIME_MS);
+/* 频率合成：半周期 H = clk / (2f)，f 以 mHz 计，H 用 Q16 定时器时钟表示。
+ * - 不抖动：PSC 从能放下 ARR 的最小值起向上搜索 TIM3_SYNTH_SEARCH 个，取 (PSC+1)(ARR+1) 与 H
+ *   误差最小的组合（误差为 0 时提前结束）；PSC 越小分辨率越高，所以从小往大找；
+ * - 抖动：取最小 PSC，整数部分进 ARR，余下的小数 tick 由更新中断逐周期补偿，平均周期精确到 1/65536 tick
+ * 返回合成后的实际（平均）频率，mHz */
+static uint32_t tim3_synth(uint32_t mhz, tim3_timing_t *t)
+{
+    uint64_t h_q16 = (((uint64_t)s_tim3_clk_hz * 1000ULL) << 16) / (2ULL * mhz);
+    uint32_t psc_min = (uint32_t)((h_q16 - 1U) >> 32);     /* (ARR+1) <= 65536 */
+    if (psc_min > 0xFFFFU) psc_min = 0xFFFFU;
 
-    /* 设置目标方向，完成切换 */
-    HAL_GPIO_WritePin(IN1_GPIO_Port, IN1_Pin, target_in1);
-    HAL_GPIO_WritePin(IN2_GPIO_Port, IN2_Pin, target_in2);
+    uint32_t best_psc = psc_min;
+    uint64_t best_n_q16 = 0;
+    uint64_t best_err = UINT64_MAX;
+    uint32_t psc_end = s_dither ? psc_min : psc_min + TIM3_SYNTH_SEARCH - 1U;
+    if (psc_end > 0xFFFFU) psc_end = 0xFFFFU;
+    for (uint32_t psc = psc_min; psc <= psc_end; ++psc) {
+        uint64_t n_q16 = h_q16 / (psc + 1U);
+        if (!s_dither) n_q16 = (n_q16 + 0x8000U) & ~(uint64_t)0xFFFFU;   /* 四舍五入到整数 tick */
+        if (n_q16 < (2ULL << 16)) break;                                 /* 半周期至少 2 tick */
+        if (n_q16 > (0x10000ULL << 16)) continue;
+        uint64_t syn = n_q16 * (psc + 1U);
+        uint64_t err = (syn > h_q16) ? syn - h_q16 : h_q16 - syn;
+        if (err < best_err) {
+            best_err = err;
+            best_psc = psc;
+            best_n_q16 = n_q16;
+            if (err < (psc + 1U)) break;    /* 已在 1/65536 tick 之内 */
+        }
+    }
+    if (best_n_q16 == 0) best_n_q16 = 2ULL << 16;
+
+    t->psc = (uint16_t)best_psc;
+    t->arr = (uint16_t)((best_n_q16 >> 16) - 1U);
+    t->frac = (uint16_t)(best_n_q16 & 0xFFFFU);
+    if ((best_n_q16 >> 16) == 0x10000U) t->frac = 0;
+
+    /* 死区按 tick 取整，最多占半周期的一半 */
+    uint64_t dead = ((uint64_t)s_deadtime_us * s_tim3_clk_hz + 500000U) / (1000000ULL * (best_psc + 1U));
+    uint32_t dead_max = ((uint32_t)t->arr + 1U) / 2U;
+    t->dead = (uint16_t)(dead > dead_max ? dead_max : dead);
+
+    uint64_t period_q16 = 2ULL * (best_psc + 1U) * best_n_q16;
+    return (uint32_t)(((((uint64_t)s_tim3_clk_hz * 1000ULL) << 16) + period_q16 / 2U) / period_q16);
 }
 
-void TIM3_HandlePendingToggle(void)
+/* 波形模式的频率合成：半周期 = len 个 TIM2 PWM 周期。TIM2 PSC 固定为 0，只用 ARR 调频，
+ * 运行中改频率只写一个预装载寄存器，在下一个 PWM 周期整体生效。级数四舍五入并限制在
+ * TIM2_PWM_MIN_STEPS..65536，分辨率为半周期的 len 个定时器时钟（72 MHz、128 点、175 Hz 时约 0.1 Hz）。
+ * TIM3 的 PSC = 0、ARR = len-1，以 PWM 周期为 tick，死区按整 PWM 周期取整。
+ * 返回实际频率，mHz */
+static uint32_t wave_synth(uint32_t mhz, uint32_t *steps, tim3_timing_t *t)
 {
-    if (!tim3_toggle_flag) return;
-    tim3_toggle_flag = 0;
-    perform_toggle();
+    const uint32_t n = s_wave->len;
+    uint64_t clk_mhz = (uint64_t)s_tim3_clk_hz * 1000ULL;
+    uint64_t st = (clk_mhz + (uint64_t)n * mhz) / (2ULL * n * mhz);
+    if (st < TIM2_PWM_MIN_STEPS) st = TIM2_PWM_MIN_STEPS;
+    if (st > 0x10000U) st = 0x10000U;
+    *steps = (uint32_t)st;
+
+    t->psc = 0;
+    t->arr = (uint16_t)(n - 1U);
+    t->frac = 0;
+    uint64_t dead = ((uint64_t)s_deadtime_us * s_tim3_clk_hz + 500000ULL * st) / (1000000ULL * st);
+    t->dead = (uint16_t)(dead > n / 2U ? n / 2U : dead);
+
+    uint64_t period = 2ULL * n * st;
+    return (uint32_t)((clk_mhz + period / 2U) / period);
 }
 
-/* 解析串口命令：支持PWM占空比和TIM3频率设置
- * 格式：
- * 1. 纯数字（如"50"）：设置TIM2 PWM占空比为50%
- * 2. f开头（如"f20"）：设置TIM3频率为20Hz
- */
-void HandleTIM3Command(const char *cmd)
-{
-    if (cmd == NULL) return;
-    
-    /* 跳过前导空格 */
-    while (*cmd == ' ' || *cmd == '\t') ++cmd;
-    /* 检查帮助命令："h" 或 "?" */
-    if ((cmd[0] == 'h' || cmd[0] == 'H' || cmd[0] == '?') && (cmd[1] == '\0')) {
-        fdc_debug_print("STATUS: PWM duty=%u%%, TIM3=%lu Hz\r\n", (unsigned)s_current_duty_percent, (unsigned long)s_current_tim3_freq_hz);
+/* 按时序写预装载寄存器；carry 为本周期抖动补的 1 tick */
+static void tim3_write(const tim3_timing_t *t, uint32_t carry)
+{
+    uint32_t arr = (uint32_t)t->arr + carry;
+    __HAL_TIM_SET_PRESCALER(&htim3, t->psc);
+    htim3.Instance->ARR = arr;
+    __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, arr + 1U - t->dead);
+}
+
+/* TIM2 / TIM3 的串联（TRGO = 更新事件 -> ITR1 外部时钟）；off 时两者恢复独立的内部时钟 */
+static void wave_link(bool on)
+{
+    TIM_MasterConfigTypeDef master = {0};
+    master.MasterOutputTrigger = on ? TIM_TRGO_UPDATE : TIM_TRGO_RESET;
+    master.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &master) != HAL_OK) {
+        Error_Handler();
+    }
+    TIM_ClockConfigTypeDef clock = {0};
+    clock.ClockSource = on ? TIM_CLOCKSOURCE_ITR1 : TIM_CLOCKSOURCE_INTERNAL;
+    if (HAL_TIM_ConfigClockSource(&htim3, &clock) != HAL_OK) {
+        Error_Handler();
+    }
+}
+
+static void drive_stop(void)
+{
+    __HAL_TIM_DISABLE_IT(&htim3, TIM_IT_UPDATE);
+    s_pending_valid = 0;
+    HAL_TIM_Base_Stop(&htim3);
+    __HAL_TIM_DISABLE_DMA(&htim3, TIM_DMA_UPDATE | TIM_DMA_CC1);
+    HAL_DMA_Abort(htim3.hdma[TIM_DMA_ID_UPDATE]);
+    HAL_DMA_Abort(htim3.hdma[TIM_DMA_ID_CC1]);
+    HAL_GPIO_WritePin(IN1_GPIO_Port, IN1_Pin | IN2_Pin, GPIO_PIN_RESET);
+
+    if (s_wave_running) {
+        /* TIM2 继续运行，回到方波模式的载波与静态占空比 */
+        __HAL_TIM_DISABLE_DMA(&htim2, TIM_DMA_UPDATE);
+        HAL_DMA_Abort(htim2.hdma[TIM_DMA_ID_UPDATE]);
+        wave_link(false);
+        s_wave_running = 0;
+        TIM2_PWM_SetCarrierHz(s_pwm_carrier_req);
+    }
+}
+
+static void drive_start(const tim3_timing_t *t)
+{
+    s_active = *t;
+    s_dither_acc = 0;
+    tim3_write(t, 0U);
+    __HAL_TIM_SET_COUNTER(&htim3, 0);
+    /* UG 把 PSC / ARR / CCR1 装入影子寄存器；此时 DMA 请求尚未使能，不会提前写引脚 */
+    htim3.Instance->EGR = TIM_EGR_UG;
+    htim3.Instance->SR = 0;
+
+    HAL_DMA_Start(htim3.hdma[TIM_DMA_ID_UPDATE], (uintptr_t)s_bsrr_phase, (uintptr_t)&IN1_GPIO_Port->BSRR, 2U);
+    HAL_DMA_Start(htim3.hdma[TIM_DMA_ID_CC1], (uintptr_t)&s_bsrr_off, (uintptr_t)&IN1_GPIO_Port->BSRR, 1U);
+    __HAL_TIM_ENABLE_DMA(&htim3, TIM_DMA_UPDATE | TIM_DMA_CC1);
+    /* 抖动需要逐周期改 ARR，打开更新中断；不抖动时运行中没有任何中断 */
+    if (t->frac != 0U) __HAL_TIM_ENABLE_IT(&htim3, TIM_IT_UPDATE);
+    /* 第一个半周期两路均为低，第一次更新事件起开始换向 */
+    HAL_TIM_Base_Start(&htim3);
+}
+
+/* 波形模式启动：TIM2 停下重配，再与 TIM3 一起从计数 0 开始
+ * 1) TIM2 写好 PSC / ARR / CCR1 并用 UG 装入（此时 TRGO 仍为复位、UDE 未开，UG 不计数也不搬运）
+ * 2) TIM3 切到 ITR1 外部时钟，按方波模式的方式装好换向 DMA 并使能，等待 TIM2 的 TRGO
+ * 3) 启动样本 DMA、打开 UDE，最后启动 TIM2：第 len 个 PWM 周期结束时第一次换向 */
+static void wave_start(uint32_t steps, const tim3_timing_t *t)
+{
+    HAL_TIM_PWM_Stop(&htim2, TIM_CHANNEL_1);
+    htim2.Instance->CR1 |= TIM_CR1_ARPE;
+    htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    __HAL_TIM_ENABLE_OCxPRELOAD(&htim2, TIM_CHANNEL_1);
+    __HAL_TIM_SET_PRESCALER(&htim2, 0);
+    htim2.Init.Prescaler = 0;
+    __HAL_TIM_SET_AUTORELOAD(&htim2, steps - 1U);
+    __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, 0);
+    __HAL_TIM_SET_COUNTER(&htim2, 0);
+    htim2.Instance->EGR = TIM_EGR_UG;
+    s_wave_steps = steps;
+    s_pwm_carrier_hz = (s_tim3_clk_hz + steps / 2U) / steps;
+    wave_build(steps);
+
+    wave_link(true);
+    drive_start(t);
+
+    HAL_DMA_Start(htim2.hdma[TIM_DMA_ID_UPDATE], (uintptr_t)s_wave_ccr, (uintptr_t)&htim2.Instance->CCR1,
+                  s_wave->len);
+    __HAL_TIM_ENABLE_DMA(&htim2, TIM_DMA_UPDATE);
+    s_wave_running = 1;
+    HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
+}
+
+/* 波形模式运行中改频率 / 死区：TIM2 ARR 与 TIM3 CCR1 各只有一个预装载寄存器，
+ * 分别在下一个 PWM 周期和下一次换向处生效，不需要更新中断 */
+static void wave_retime(uint32_t steps, const tim3_timing_t *t)
+{
+    s_active = *t;
+    __HAL_TIM_SET_AUTORELOAD(&htim2, steps - 1U);
+    __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, (uint32_t)t->arr + 1U - t->dead);
+    s_wave_steps = steps;
+    s_pwm_carrier_hz = (s_tim3_clk_hz + steps / 2U) / steps;
+    wave_build(steps);
+}
+
+/* 运行中修改：PSC / ARR / CCR1 分三次写，若中间恰好发生更新事件，该半周期会用到新旧混合的组合。
+ * 所以不在这里直接写，而是交给更新中断：中断紧跟在更新事件之后，离下一次更新还有整整一个半周期，
+ * 三个寄存器写完后在同一次换向处一起生效。先关中断再改 s_pending，清掉旧的 UIF 再开中断，
+ * 保证中断只在下一次真实的更新事件后进入；新时序最迟在两个半周期后生效，期间每个半周期都完整 */
+static void drive_retime(const tim3_timing_t *t)
+{
+    __HAL_TIM_DISABLE_IT(&htim3, TIM_IT_UPDATE);
+    s_pending = *t;
+    s_pending_valid = 1;
+    htim3.Instance->SR = ~(uint32_t)TIM_SR_UIF;     /* rc_w0：只清 UIF */
+    __HAL_TIM_ENABLE_IT(&htim3, TIM_IT_UPDATE);
+}
+
+/* TIM3 更新中断：应用待写入的时序，并按抖动累加器决定下一周期是否多 1 tick。
+ * 写入的是预装载值，在下一次更新事件生效；没有抖动也没有待写入时序时关闭中断 */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance != TIM3) return;
+    if (s_pending_valid) {
+        s_active = s_pending;
+        s_pending_valid = 0;
+        s_dither_acc = 0;
+    }
+    uint32_t carry = 0;
+    if (s_active.frac != 0U) {
+        s_dither_acc += s_active.frac;
+        carry = s_dither_acc >> 16;
+        s_dither_acc &= 0xFFFFU;
+    } else {
+        __HAL_TIM_DISABLE_IT(&htim3, TIM_IT_UPDATE);
+    }
+    tim3_write(&s_active, carry);
+}
+
+void TIM3_SetSquareFreqMilliHz(uint32_t mhz)
+{
+    if (mhz == 0) {
+        drive_stop();
+        s_current_tim3_mhz = 0;
+        s_actual_tim3_mhz = 0;
         return;
     }
-    
-    /* 检查命令类型 */
-    if (*cmd == 'f' || *cmd == 'F') {
-        /* TIM3频率设置 */
-        cmd++; /* 跳过f字符 */
-        int val = atoi(cmd);// 将命令转换为整数（占空比百分比）
-        if (val <= 0) {
-            fdc_debug_print("Invalid TIM3 freq: %s\r\n", cmd);
-            return;
+    const uint32_t mhz_min = TIM3_GetFreqMinMilliHz();
+    if (mhz < mhz_min) mhz = mhz_min;
+    if (mhz > TIM3_FREQ_MAX_MHZ) mhz = TIM3_FREQ_MAX_MHZ;
+
+    tim3_timing_t t;
+    if (s_wave != NULL) {
+        uint32_t steps;
+        s_actual_tim3_mhz = wave_synth(mhz, &steps, &t);
+        if (s_current_tim3_mhz == 0) {
+            wave_start(steps, &t);
+        } else {
+            wave_retime(steps, &t);
         }
-        TIM3_SetSquareFreqHz((uint32_t)val);
-        fdc_debug_print("TIM3 freq set to %d Hz\r\n", val);
-    } else if (*cmd >= '0' && *cmd <= '9') {
-        /* PWM占空比设置 */
-        int val = atoi(cmd);
-        if (val < 0 || val > 100) {
-            fdc_debug_print("Invalid PWM duty: %s (0-100)\r\n", cmd);
-            return;
+    } else {
+        s_actual_tim3_mhz = tim3_synth(mhz, &t);
+        if (s_current_tim3_mhz == 0) {
+            drive_start(&t);
+        } else {
+            drive_retime(&t);
         }
-        TIM2_PWM_SetDutyPercent((uint8_t)val);
-        fdc_debug_print("PWM duty set to %d%%\r\n", val);
+    }
+
+    /* 记录当前频率，供帮助命令查看 */
+    s_current_tim3_mhz = mhz;
+}
+
+/* 为 TIM3 生成低频方波：设置目标频率 hz（例如 20/60/100），0 停止驱动 */
+void TIM3_SetSquareFreqHz(uint32_t hz)
+{
+    TIM3_SetSquareFreqMilliHz(hz > TIM3_FREQ_MAX_MHZ / 1000U ? TIM3_FREQ_MAX_MHZ : hz * 1000U);
+}
+
+uint32_t TIM3_GetFreqMinMilliHz(void)
+{
+    if (s_wave == NULL) return TIM3_FREQ_MIN_MHZ;
+    /* wave_synth 的级数上限 65536：f = clk / (2 × len × steps)，向上取整保证可达 */
+    const uint64_t period_max = 2ULL * s_wave->len * 0x10000U;
+    uint32_t mhz = (uint32_t)(((uint64_t)s_tim3_clk_hz * 1000ULL + period_max - 1U) / period_max);
+    return mhz > TIM3_FREQ_MIN_MHZ ? mhz : TIM3_FREQ_MIN_MHZ;
+}
+
+uint32_t TIM3_GetSquareFreqHz(void)
+{
+    return (s_current_tim3_mhz + 500U) / 1000U;
+}
+
+uint32_t TIM3_GetSquareFreqMilliHz(void)
+{
+    return s_current_tim3_mhz;
+}
+
+uint32_t TIM3_GetActualFreqMilliHz(void)
+{
+    return s_actual_tim3_mhz;
+}
+
+void TIM3_GetTiming(uint16_t *psc, uint16_t *arr, uint16_t *frac)
+{
+    if (s_wave_running) {
+        if (psc) *psc = 0;
+        if (arr) *arr = (uint16_t)(s_wave_steps - 1U);
+        if (frac) *frac = 0;
+        return;
+    }
+    const tim3_timing_t *t = s_pending_valid ? &s_pending : &s_active;
+    if (psc) *psc = t->psc;
+    if (arr) *arr = t->arr;
+    if (frac) *frac = t->frac;
+}
+
+/* 驱动相位直接由硬件状态换算，不依赖中断：
+ * - 换向 DMA（TIM3 更新事件，2 个数据循环）的剩余计数为 1 时刚写过 s_bsrr_phase[0]，处于 IN1 半周期，否则为 IN2；
+ * - 半周期内的位置：方波模式为 TIM3 计数 / (ARR+1)；波形模式 TIM3 数的是 PWM 周期，再加上 TIM2 计数细分。
+ * 先后读两次，中途发生换向（DMA 计数变化）或计数回绕 / 进位时重读。更新事件到换向 DMA 完成之间
+ * 有几个总线周期的窗口，此时读到的半周期可能差一个，概率可以忽略。
+ * 方波模式的死区截掉每个半周期的末尾 dead 个计数，基波的中心前移 dead / 2，一并补上，使驱动基波 ∝ sin(相位)；
+ * 波形模式的幅度表铺满整个半周期，死区只截掉末尾接近 0 的样本，基波中心不变 */
+uint32_t TIM3_GetDrivePhase(void)
+{
+    if (s_current_tim3_mhz == 0U) return 0U;
+    DMA_HandleTypeDef *hdma = htim3.hdma[TIM_DMA_ID_UPDATE];
+    uint32_t ndtr, cnt, sub = 0U;
+    for (;;) {
+        ndtr = __HAL_DMA_GET_COUNTER(hdma);
+        cnt = __HAL_TIM_GET_COUNTER(&htim3);
+        if (s_wave_running) sub = __HAL_TIM_GET_COUNTER(&htim2);
+        uint32_t cnt2 = __HAL_TIM_GET_COUNTER(&htim3);
+        if (__HAL_DMA_GET_COUNTER(hdma) == ndtr && (s_wave_running ? cnt2 == cnt : cnt2 >= cnt)) break;
+    }
+
+    uint32_t len, pos, dead;    /* 半周期长度、当前位置与基波中心的前移量 × 2，单位为计数（波形模式为 TIM2 计数） */
+    if (s_wave_running) {
+        len = (uint32_t)s_wave->len * s_wave_steps;
+        pos = cnt * s_wave_steps + sub;
+        dead = 0U;
     } else {
-        fdc_debug_print("Invalid command: %s\r\n", cmd);
+        len = (uint32_t)s_active.arr + 1U;
+        pos = cnt;
+        dead = s_active.dead;
     }
+    if (pos >= len) pos = len - 1U;     /* 运行中改频率后的第一个半周期，ARR 尚未换成新值 */
+    uint32_t half = (ndtr == 1U) ? 0U : 0x80000000U;
+    return half + (uint32_t)((((uint64_t)pos << 31) + ((uint64_t)dead << 30)) / len);
+}
+
+/* 运行中修改死区 / 抖动：按当前目标频率重新合成 */
+void TIM3_SetDeadTimeUs(uint32_t us)
+{
+    s_deadtime_us = us;
+    if (s_current_tim3_mhz != 0) TIM3_SetSquareFreqMilliHz(s_current_tim3_mhz);
+}
+
+uint32_t TIM3_GetDeadTimeUs(void)
+{
+    return s_deadtime_us;
+}
+
+void TIM3_SetDither(bool on)
+{
+    s_dither = on ? 1U : 0U;
+    if (s_current_tim3_mhz != 0) TIM3_SetSquareFreqMilliHz(s_current_tim3_mhz);
+}
+
+bool TIM3_GetDither(void)
+{
+    return s_dither != 0U;
+}
+
+/* 切换波形：运行中先停下，再按当前频率以新模式启动（第一个半周期两路为低） */
+void TIM3_SetWaveform(const drive_wave_t *wave)
+{
+    if (wave != NULL && (wave->len < 2U || wave->len > DRIVE_WAVE_LEN_MAX)) return;
+    uint32_t mhz = s_current_tim3_mhz;
+    if (mhz != 0) TIM3_SetSquareFreqMilliHz(0);
+    s_wave = wave;
+    if (mhz != 0) TIM3_SetSquareFreqMilliHz(mhz);
+}
+
+const drive_wave_t *TIM3_GetWaveform(void)
+{
+    return s_wave;
 }
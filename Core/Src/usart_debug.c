@@ -1,128 +1,271 @@
 /* usart_debug.c
- * 使用 huart1 (USART1) 的阻塞式 debug 打印封装
- * 说明：为简化调试，使用 vsnprintf 写入缓冲区，再用 HAL_UART_Transmit 发送
+ * 使用 huart1 (USART1) 的 debug 打印封装
+ * 说明：fdc_fmt_vsnprintf（轻量整数格式化，见 fdc_fmt.h）格式化后整条写入发送环形缓冲区立即返回，由 USART1 TX DMA（DMA1 Channel4）
+ * 在后台排空：每次发送环形缓冲区中连续的一段，发送完成回调里接着发下一段。
+ * 缓冲区放不下整条消息时丢弃该条并计数，打印方永远不等待串口；
+ * 115200 bps 下 40 字节的一行原本要阻塞 CPU 约 3.5 ms。
+ * FDC_LOG_TOKENIZED 模式下打印由 fdc_log.c 编码为日志帧，同样经 fdc_debug_write 进入该缓冲区。
  */
 
 #include "usart_debug.h"
 #include "tim_control.h"
 #include <stdarg.h>
-#include <stdio.h>
+#include "fdc_fmt.h"
 #include "main.h" // main.h 通常包含 HAL 的头文件和项目的外部句柄声明
 #include "stm32f1xx_hal_uart.h"
 #include <stdint.h>
+#include <string.h>
 
 /* 如果 main.h 没有声明 huart1，可以在工程中自行在 usart.c/h 中声明。
  * 这里仍然使用 extern 声明以避免依赖特定生成文件名。
  */
 extern UART_HandleTypeDef huart1; // CubeMX/工程生成的 USART1 句柄
 
-/* 串口接收缓冲区 */
-static char rx_buffer[32];
-static volatile uint8_t rx_idx = 0;
-
-/* 命令就绪缓冲区（ISR写入，主循环读取） */
-static char cmd_buffer[32];
-static volatile uint8_t cmd_ready = 0;
+/* 命令接收：USART1 RX DMA（DMA1 Channel5）循环写入 s_rx_dma，HAL 在 DMA 半满 / 满以及
+ * 线路空闲（IDLE，一串字节后停顿一个字符时间）时回调 HAL_UARTEx_RxEventCallback(Size)，
+ * Size 为 DMA 已写到的位置。回调把 s_rx_pos..Size 之间的新字节拼成行，完整的一行放入命令队列。
+ * 命令队列为单生产者（回调）单消费者（主循环）无锁队列：生产者只写 s_cmd_head，消费者只写 s_cmd_tail */
+static uint8_t s_rx_dma[FDC_DEBUG_RX_DMA_SIZE];
+static uint16_t s_rx_pos = 0;             /* 已处理到的 DMA 缓冲区位置 */
+static char s_line[FDC_DEBUG_CMD_MAX];    /* 正在拼接的一行 */
+static uint8_t s_line_len = 0;
+static uint8_t s_line_overlong = 0;       /* 当前行超长，丢弃到行尾 */
+static char s_cmd_q[FDC_DEBUG_CMD_QUEUE][FDC_DEBUG_CMD_MAX];
+static volatile uint8_t s_cmd_head = 0;
+static volatile uint8_t s_cmd_tail = 0;
+static fdc_debug_rx_stats_t s_rx_stats;
 
 /* 诊断：回调触发计数（主循环可读取并清零） */
 static volatile uint32_t s_rx_events = 0;
 
+/* 发送环形缓冲区：head/tail 为自由递增的下标，取模 FDC_DEBUG_TX_BUF_SIZE 得到位置
+ * head 由打印方在临界区内推进，tail 与 s_tx_inflight 只在 DMA 完成回调（或临界区）中修改 */
+static uint8_t s_tx_buf[FDC_DEBUG_TX_BUF_SIZE];
+static volatile uint16_t s_tx_head = 0;
+static volatile uint16_t s_tx_tail = 0;
+static volatile uint16_t s_tx_inflight = 0; /* 正在 DMA 发送的字节数，0 表示 DMA 空闲 */
+static fdc_debug_tx_stats_t s_tx_stats;
+
+/* 在 tail 处启动下一段 DMA 发送；调用方须已关中断（或处于 UART 中断上下文） */
+static void tx_kick(void)
+{
+    if (s_tx_inflight != 0U) return;
+    uint16_t used = (uint16_t)(s_tx_head - s_tx_tail);
+    if (used == 0U) return;
+    uint16_t pos = (uint16_t)(s_tx_tail % FDC_DEBUG_TX_BUF_SIZE);
+    uint16_t n = (uint16_t)(FDC_DEBUG_TX_BUF_SIZE - pos);  /* 回绕前的连续部分 */
+    if (n > used) n = used;
+    if (HAL_UART_Transmit_DMA(&huart1, &s_tx_buf[pos], n) == HAL_OK) {
+        s_tx_inflight = n;
+    }
+    /* 启动失败（句柄忙）时保持数据在缓冲区，下次打印或完成回调再试 */
+}
+
+/* 整条写入发送缓冲区；可在主循环与中断中调用。返回 0 成功，-1 缓冲区不足已丢弃 */
+static int tx_write(const uint8_t *data, uint16_t len)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint16_t used = (uint16_t)(s_tx_head - s_tx_tail);
+    if (len > (uint16_t)(FDC_DEBUG_TX_BUF_SIZE - used)) {
+        s_tx_stats.dropped_msgs++;
+        s_tx_stats.dropped_bytes += len;
+        __set_PRIMASK(primask);
+        return -1;
+    }
+    uint16_t pos = (uint16_t)(s_tx_head % FDC_DEBUG_TX_BUF_SIZE);
+    uint16_t first = (uint16_t)(FDC_DEBUG_TX_BUF_SIZE - pos);
+    if (first > len) first = len;
+    memcpy(&s_tx_buf[pos], data, first);
+    memcpy(&s_tx_buf[0], data + first, (size_t)(len - first));
+    s_tx_head = (uint16_t)(s_tx_head + len);
+    used = (uint16_t)(used + len);
+    if (used > s_tx_stats.high_water) s_tx_stats.high_water = used;
+    s_tx_stats.queued_bytes += len;
+    tx_kick();
+    __set_PRIMASK(primask);
+    return 0;
+}
+
+/* 格式化并写入发送缓冲区；超过 256 字节的部分被截断 */
+static void tx_vprintf(const char *fmt, va_list args)
+{
+    char buf[256];
+    int len = fdc_fmt_vsnprintf(buf, sizeof(buf), fmt, args);
+    if (len < 0) return;
+    if (len >= (int)sizeof(buf)) len = (int)sizeof(buf) - 1;
+    if (len > 0) (void)tx_write((const uint8_t *)buf, (uint16_t)len);
+}
+
+/* 启动循环 DMA 接收（IDLE 与半满 / 满时回调 HAL_UARTEx_RxEventCallback） */
+static HAL_StatusTypeDef rx_start(void)
+{
+    s_rx_pos = 0;
+    return HAL_UARTEx_ReceiveToIdle_DMA(&huart1, s_rx_dma, FDC_DEBUG_RX_DMA_SIZE);
+}
+
+/* 把新收到的字节拼成行；在接收回调（中断上下文）中调用 */
+static void rx_feed(const uint8_t *data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; ++i) {
+        char c = (char)data[i];
+        if (c != '\r' && c != '\n') {
+            if (s_line_len < FDC_DEBUG_CMD_MAX - 1U) s_line[s_line_len++] = c;
+            else s_line_overlong = 1;
+            continue;
+        }
+        if (s_line_overlong) {
+            s_rx_stats.overlong++;
+        } else if (s_line_len > 0U) {
+            uint8_t head = s_cmd_head;
+            if ((uint8_t)(head - s_cmd_tail) >= FDC_DEBUG_CMD_QUEUE) {
+                s_rx_stats.dropped_lines++;
+            } else {
+                char *slot = s_cmd_q[head % FDC_DEBUG_CMD_QUEUE];
+                memcpy(slot, s_line, s_line_len);
+                slot[s_line_len] = '\0';
+                __DMB();   /* 先写完槽位再发布 head */
+                s_cmd_head = (uint8_t)(head + 1U);
+                s_rx_stats.lines++;
+            }
+        }
+        s_line_len = 0;
+        s_line_overlong = 0;
+    }
+}
+
 void fdc_debug_init(void)
 {
-    /* 启动单字节接收，进入中断模式 */
-    if (HAL_UART_Receive_IT(&huart1, (uint8_t*)&rx_buffer[rx_idx], 1) != HAL_OK) {
+    /* 启动循环 DMA 接收 */
+    if (rx_start() != HAL_OK) {
         /* 若启动失败，尝试打印（若UART已可用）以便快速诊断 */
-        fdc_debug_print("fdc_debug_init: HAL_UART_Receive_IT failed\r\n");
-    }  
+        fdc_debug_print("fdc_debug_init: HAL_UARTEx_ReceiveToIdle_DMA failed\r\n");
+    }
 }
 
 /**
  * @brief 格式化打印调试信息到串口
  * @param fmt 格式化字符串，类似printf
  * @param ... 可变参数列表
- * @note 使用阻塞传输模式确保调试输出的可靠性
+ * @note 非阻塞：只写入发送缓冲区，缓冲区满时整条丢弃（见 fdc_debug_get_tx_stats）
+ * @note 函数名加括号：FDC_LOG_TOKENIZED 模式下同名宏不会展开到定义上
  */
-void fdc_debug_print(const char *fmt, ...)
+void (fdc_debug_print)(const char *fmt, ...)
 {
-    char buf[256];//将 fmt 格式串和可变参数组合后的完整字符串，先存到 buf 中
     va_list args;//用于后续 “遍历” 函数的可变参数
     va_start(args, fmt);//通过最后一个固定参数（这里是 fmt）的地址，定位到后续可变参数在内存中的位置，让 args 能正确访问到可变参数
-    int len = vsnprintf(buf, sizeof(buf), fmt, args);//将 fmt 格式串和 args 对应的可变参数，组合成完整的字符串，存入 buf 缓冲区；
+    tx_vprintf(fmt, args);
     va_end(args);//在 va_start 之后，必须配对调用 va_end,作用是 释放 va_list 相关的资源，结束可变参数的访问；
-    if (len < 0) return;
-    if (len > (int)sizeof(buf)) len = sizeof(buf);
-    /* 使用阻塞传输保持实现简单且可靠用于调试 */
-    HAL_UART_Transmit(&huart1, (uint8_t *)buf, (uint16_t)len, 200);
 }
 
-void fdc_debug_print_limited(const char *fmt, ...)
+/* 令牌桶：按经过的整周期数补充令牌，last_ms 只前进整周期，不足一个周期的时间留到下次累计 */
+int fdc_debug_limit_pass(fdc_debug_limit_t *lim, uint32_t *suppressed)
 {
-    /* 全局限频实现：同一个函数调用点在短时间内的重复打印会被抑制。
-     * 简单实现：使用一个静态最后打印时间戳（ms），限制为 1000 ms。
-     * 这是全局限频（适合大多数场景）。若需要更细粒度（按 tag 限频），可扩展实现。
-     */
-    static uint32_t last_tick = 0;
     uint32_t now = HAL_GetTick();
-    if ((now - last_tick) < 1000U) return; /* 少于 1s，跳过打印 */
-    last_tick = now;
+    uint32_t period = (lim->period_ms != 0U) ? lim->period_ms : 1U;
+    uint32_t add = (now - lim->last_ms) / period;
+    if (add >= (uint32_t)(lim->burst - lim->tokens)) {
+        lim->tokens = lim->burst;
+        lim->last_ms = now;       /* 桶已满：从现在起重新计时 */
+    } else if (add != 0U) {
+        lim->tokens = (uint8_t)(lim->tokens + add);
+        lim->last_ms += add * period;
+    }
+    if (lim->tokens == 0U) {
+        lim->suppressed++;
+        return 0;
+    }
+    lim->tokens--;
+    *suppressed = lim->suppressed;
+    lim->suppressed = 0;
+    return 1;
+}
 
-    char buf[256];
-    va_list args;
-    va_start(args, fmt);
-    int len = vsnprintf(buf, sizeof(buf), fmt, args);
-    va_end(args);
-    if (len < 0) return;
-    if (len > (int)sizeof(buf)) len = sizeof(buf);
-    HAL_UART_Transmit(&huart1, (uint8_t *)buf, (uint16_t)len, 200);
+void fdc_debug_report_suppressed(uint32_t suppressed)
+{
+    fdc_debug_print("  (%lu similar suppressed)\r\n", (unsigned long)suppressed);
+}
+
+int fdc_debug_write(const void *data, uint16_t len)
+{
+    if (data == NULL || len == 0U) return 0;
+    return tx_write((const uint8_t *)data, len);
 }
 
-/* UART接收中断回调：用于接收命令
- * 协议：以回车或换行结束一条命令
- * - 纯数字（如"50"): 设置TIM2 PWM占空比为50%
- * - "fNN" (如"f20"): 设置TIM3频率为NN Hz
+void fdc_debug_get_tx_stats(fdc_debug_tx_stats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = s_tx_stats;
+    __set_PRIMASK(primask);
+}
+
+/* DMA 发送完成：释放已发送的一段，继续发送缓冲区中剩余的数据 */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART1) return;
+    s_tx_tail = (uint16_t)(s_tx_tail + s_tx_inflight);
+    s_tx_inflight = 0;
+    tx_kick();
+}
+
+/* 错误回调：
+ * - 接收溢出/噪声等错误时 HAL 会中止 DMA 接收，这里丢弃半行并重新启动，保证命令口不会就此失效；
+ * - DMA 传输错误时 HAL 会结束发送，丢弃出错的一段并继续发送后面的数据 */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART1) return;
+    if (huart->gState == HAL_UART_STATE_READY && s_tx_inflight != 0U) {
+        s_tx_stats.dropped_bytes += s_tx_inflight;
+        s_tx_tail = (uint16_t)(s_tx_tail + s_tx_inflight);
+        s_tx_inflight = 0;
+        tx_kick();
+    }
+    if (huart->RxState == HAL_UART_STATE_READY) {
+        s_line_len = 0;
+        s_line_overlong = 0;
+        s_rx_stats.restarts++;
+        (void)rx_start();
+    }
+}
+
+/* 接收事件回调（DMA 半满 / 满、线路空闲）：Size 为 DMA 在 s_rx_dma 中已写到的位置
+ * 协议：以回车或换行结束一条命令，空行忽略；命令内容由主循环解释（cmd_shell.c）
  */
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
     if (huart->Instance != USART1) return;
+    if (Size > FDC_DEBUG_RX_DMA_SIZE) return;
 
-    char c = rx_buffer[rx_idx];// 获取刚接收到的字符
-    if (c == '\r' || c == '\n') {
-        if (rx_idx > 0) {
-            rx_buffer[rx_idx] = '\0';
-            /* 将命令复制到主循环可读取的缓冲区，并设置就绪标志（ISR安全） */
-            /* 注意：短命令拷贝，保持简单且原子性足够 */
-            for (int i = 0; i <= rx_idx && i < (int)sizeof(cmd_buffer)-1; ++i) cmd_buffer[i] = rx_buffer[i];
-            cmd_buffer[rx_idx < (int)sizeof(cmd_buffer)-1 ? rx_idx : (int)sizeof(cmd_buffer)-1] = '\0';
-            cmd_ready = 1;
-            rx_idx = 0;
-        }
-    } else {
-        if (rx_idx < (int)sizeof(rx_buffer) - 1) {
-            rx_idx++;// 移动索引准备接收下一个字符
+    if (Size != s_rx_pos) {
+        if (Size > s_rx_pos) {
+            rx_feed(&s_rx_dma[s_rx_pos], (uint16_t)(Size - s_rx_pos));
         } else {
-            /* 缓冲区溢出，重置 */
-            rx_idx = 0;
+            /* DMA 已回绕：先处理缓冲区尾部，再处理开头 */
+            rx_feed(&s_rx_dma[s_rx_pos], (uint16_t)(FDC_DEBUG_RX_DMA_SIZE - s_rx_pos));
+            rx_feed(&s_rx_dma[0], Size);
         }
+        s_rx_pos = (Size == FDC_DEBUG_RX_DMA_SIZE) ? 0U : Size;
     }
 
     /* 标记一个回调事件（主循环可查询），不在 ISR 中执行阻塞操作 */
     s_rx_events++;
-
-    /* 继续接收下一个字节；使用回调传入的 huart 指针以提高鲁棒性 */
-    HAL_UART_Receive_IT(&huart1, (uint8_t*)&rx_buffer[rx_idx], 1);
 }
 
-/* 主循环调用以非阻塞方式获取一条完整命令（若有） */
+/* 主循环调用以非阻塞方式取出一条完整命令（若有）；队列中可能有多条，循环调用直到返回 0 */
 int  fdc_debug_get_command(char *out, int maxlen)
 {
-    if (!cmd_ready) return 0;
-    /* 复制并清标志（简单原子操作） */
+    uint8_t tail = s_cmd_tail;
+    if (tail == s_cmd_head) return 0;
+    __DMB();   /* 看到 head 之后再读槽位 */
+    const char *slot = s_cmd_q[tail % FDC_DEBUG_CMD_QUEUE];
     int i = 0;
-    for (; i < maxlen-1 && i < (int)sizeof(cmd_buffer) && cmd_buffer[i] != '\0'; ++i) {
-        out[i] = cmd_buffer[i];
+    for (; i < maxlen-1 && i < (int)FDC_DEBUG_CMD_MAX && slot[i] != '\0'; ++i) {
+        out[i] = slot[i];
     }
     out[i] = '\0';
-    cmd_ready = 0;
+    __DMB();   /* 读完槽位再归还给生产者 */
+    s_cmd_tail = (uint8_t)(tail + 1U);
     return 1;
 }
 
@@ -133,3 +276,11 @@ int fdc_debug_get_rx_events(void)
     s_rx_events = 0;
     return v;
 }
+
+void fdc_debug_get_rx_stats(fdc_debug_rx_stats_t *out)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = s_rx_stats;
+    __set_PRIMASK(primask);
+}
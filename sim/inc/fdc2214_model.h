@@ -0,0 +1,90 @@
+/*
+ * fdc2214_model.h
+ * FDC2214 的寄存器级 I2C 从机模型（主机仿真用）
+ *
+ * 模型行为（按 SNOSCZ5B 手册）：
+ * - 寄存器 0x00..0x21 与 0x7E/0x7F，上电默认值与芯片相同（CONFIG = 0x2801，睡眠）；
+ *   读写都以 16-bit 大端为单位，寄存器指针在每个寄存器后自动递增，支持连续读写；
+ * - CONFIG.SLEEP_MODE_EN 清零后开始转换：MUX_CONFIG.AUTOSCAN_EN 选择 RR_SEQUENCE 的多通道
+ *   轮询，否则只转换 CONFIG.ACTIVE_CHAN；每通道耗时
+ *     多通道  (SETTLECOUNT*16 + RCOUNT*16 + 4) / fREF + 692 ns + 5 / fREF
+ *     单通道  (RCOUNT*16 + 4) / fREF（第一次额外加激活时间）
+ *   fREF = (REF_CLK_SRC ? CLKIN : 内部振荡器) / FREF_DIVIDER；
+ * - DATA = fSENSOR / FIN_SEL * 2^28 / fREF，叠加每次转换独立的高斯频率噪声，饱和到 28 bit；
+ * - 一轮扫描完成置 DRDY，DRDY_2INT = 1 且 INTB_DIS = 0 时拉低 INTB；读 STATUS 或任一
+ *   DATA_CHx 清除 DRDY 并释放 INTB；读 DATA_CHx（MSB）清除该通道 UNREADCONV 并锁存 LSB；
+ * - 读 STATUS 清除锁存的 ERR_CHAN / ERR_WD / ERR_AHW / ERR_ALW；
+ *   STATUS_CONFIG 的 WD_ERR2OUT / AH_WARN2OUT / AL_WARN2OUT 决定 DATA 中的 ERR_WD / ERR_AW；
+ * - 通道可挂接频率偏移函数（执行器位移等随时间变化的激励），按积分窗口（RCOUNT*16+4）/ fREF 的中点取值；
+ * - 通道可注入故障（看门狗超时 / 振幅过高 / 过低）；
+ * - RESET_DEV.bit15 复位全部寄存器。
+ * 统计量（完成的转换轮数、未读即被覆盖的转换数）是“真值”，可与驱动的估计对比。
+ */
+#ifndef __FDC2214_MODEL_H__
+#define __FDC2214_MODEL_H__
+
+#include <stdint.h>
+#include "sim_hal.h"
+
+#define FDC_MODEL_NREG          0x22U
+#define FDC_MODEL_INTOSC_HZ     43400000.0   /* 内部振荡器典型值 */
+
+typedef enum {
+    FDC_MODEL_FAULT_NONE = 0,
+    FDC_MODEL_FAULT_WD,       /* 传感器不起振：看门狗超时 */
+    FDC_MODEL_FAULT_AHW,      /* 振幅过高警告 */
+    FDC_MODEL_FAULT_ALW,      /* 振幅过低警告 */
+} fdc_model_fault_t;
+
+typedef struct {
+    double  freq_hz;          /* LC 振荡频率 fSENSOR（Hz），≤ 0 视为不起振 */
+    double  noise_ppm;        /* 每次转换的频率噪声（rms，ppm） */
+    uint8_t fault;            /* fdc_model_fault_t */
+    /* 可选：t_ns 时刻的相对频率偏移（如 LRA 位移引起的 Δf / f），取转换积分窗口中点的值 */
+    double (*offset)(void *ctx, uint64_t t_ns);
+    void *offset_ctx;
+} fdc_model_chan_t;
+
+typedef struct {
+    /* 外部连接与电路参数（fdc_model_init 后可修改） */
+    uint16_t addr_hal;
+    GPIO_TypeDef *intb_port;
+    uint16_t intb_pin;
+    double clkin_hz;          /* CLKIN 外部参考，板上为 40 MHz */
+    double intosc_hz;
+    fdc_model_chan_t ch[4];
+
+    /* 芯片内部状态 */
+    uint16_t reg[FDC_MODEL_NREG];
+    uint8_t  ptr;
+    uint32_t data[4];
+    uint16_t data_flags[4];   /* DATA_CHx 的 ERR_WD / ERR_AW */
+    uint16_t lsb_latch[4];
+    uint8_t  unread;          /* bit ch：该通道有未读转换 */
+    uint8_t  drdy;
+    uint16_t err;             /* 锁存的 STATUS 错误位（含 ERR_CHAN） */
+    uint8_t  running;
+    uint8_t  seq_idx;
+    sim_event_t conv_ev;      /* 当前通道转换完成事件 */
+    uint8_t  intb_low;
+    uint32_t rng;
+
+    /* 真值统计 */
+    uint64_t conversions;
+    uint64_t rounds;
+    uint64_t overwritten[4];  /* 未读就被新结果覆盖的转换 */
+    uint64_t status_reads;
+    uint64_t data_reads;
+
+    sim_i2c_slave_t slave;
+} fdc_model_t;
+
+/* 复位到上电状态；所有通道默认 6 MHz、无噪声、无故障，CLKIN = 40 MHz */
+void fdc_model_init(fdc_model_t *m, uint16_t addr_hal, GPIO_TypeDef *intb_port, uint16_t intb_pin, uint32_t seed);
+/* 挂到仿真 I2C 总线，INTB 初始为高；转换由 CONFIG 写入触发，以仿真事件推进 */
+void fdc_model_attach(fdc_model_t *m);
+
+/* LC 谐振频率：f = 1 / (2*pi*sqrt(L*C)) */
+double fdc_model_lc_freq(double L_h, double C_f);
+
+#endif /* __FDC2214_MODEL_H__ */
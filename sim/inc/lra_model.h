@@ -0,0 +1,38 @@
+/*
+ * lra_model.h
+ * 线性谐振执行器（LRA）的二阶模型（主机仿真用）：H 桥等效驱动电压 -> 位移 -> FDC2214 通道的频率偏移
+ *
+ * 模型：x'' + (ω0/Q)·x' + ω0²·x = ω0²·g·u(t)，u 为 sim_bridge_on_level 给出的驱动电平（-1..1），
+ * x 为相对频率偏移，g 为静态增益（满幅直流驱动时的偏移）。u 在两次电平变化之间为常数，
+ * 每段用解析解推进，没有积分步长误差；谐振时位移滞后驱动基波 90°，幅度为直流的 Q 倍。
+ * 保留最近 LRA_MODEL_SEGS 段的起始状态，可查询稍早时刻（转换积分窗口中点）的位移。
+ * 谐振频率可按 drift（Hz/s）线性漂移（模拟温度变化），每段取段起点的频率。
+ */
+#ifndef __LRA_MODEL_H__
+#define __LRA_MODEL_H__
+
+#include <stdint.h>
+
+#define LRA_MODEL_SEGS  1024U
+
+typedef struct {
+    double f0, q, drift;      /* 初始谐振频率（Hz）、品质因数、频率漂移（Hz/s） */
+    double gain;              /* g：相对频率偏移 / 满幅 */
+    struct {
+        uint64_t t_ns;        /* 段起点 */
+        double x, v;          /* 段起点的位移与速度 */
+        double u;             /* 本段驱动电平 */
+        double w0, sigma, wd; /* 本段的 ω0、衰减率 ω0/(2Q)、阻尼振荡角频率 */
+    } seg[LRA_MODEL_SEGS];    /* 环形，下标 = 段序号 % LRA_MODEL_SEGS */
+    uint32_t n;
+} lra_model_t;
+
+/* f0：谐振频率（Hz），q：品质因数（> 0.5），gain_ppm：静态增益（ppm），drift：谐振频率漂移（Hz/s）；
+ * 初始静止、驱动为 0 */
+void lra_model_init(lra_model_t *m, double f0, double q, double gain_ppm, double drift);
+/* sim_bridge_on_level 回调：t_ns 起驱动电平为 level */
+void lra_model_set_drive(void *ctx, uint64_t t_ns, double level);
+/* fdc_model_chan_t.offset 回调：t_ns 时刻的相对频率偏移 */
+double lra_model_offset(void *ctx, uint64_t t_ns);
+
+#endif /* __LRA_MODEL_H__ */
@@ -0,0 +1,117 @@
+/*
+ * sim_hal.h
+ * 主机仿真控制接口：虚拟时钟与事件队列、中断投递、I2C 从机挂接、UART 输入输出与外设参数
+ *
+ * 说明：
+ * - 固件只看到 stm32f1xx_hal.h；本头文件只给 sim_main.c 与外设模型使用；
+ * - 时间是离散事件虚拟时钟（纳秒，从 0 开始），与主机时间无关：
+ *   1) 外设模型（FDC2214 转换、I2C 传输结束、UART 字节、TIM 更新）以事件形式登记到期时刻，
+ *      事件只修改模型状态并挂起中断，不直接调用固件代码；
+ *   2) HAL_Delay、阻塞 I2C / UART 传输直接把时间推进到结束时刻，期间的事件与中断按时间顺序处理；
+ *   3) 固件每调用一次 HAL（含 __set_PRIMASK / __enable_irq）消耗 cpu_ns 的 CPU 时间；
+ *      连续多次调用都没有事件发生（主循环空转轮询）时直接跳到下一个事件，
+ *      效果等同于 CPU 在 WFI 中等待，因此空闲时段几乎不占主机时间；
+ * - 中断按 NVIC 优先级（数值小者先）在 PRIMASK = 0 且不在中断中时投递，不模拟抢占嵌套。
+ */
+#ifndef __SIM_HAL_H__
+#define __SIM_HAL_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include "stm32f1xx_hal.h"
+
+/* I2C 从机：write 收到一次写事务的全部字节（第一个字节通常是寄存器指针），
+ * read 按当前指针读出 n 字节；返回 0 为 ACK，非 0 为 NACK */
+typedef struct sim_i2c_slave {
+    uint16_t addr_hal;                                            /* 左移一位后的地址，与 HAL 一致 */
+    void *ctx;
+    int (*write)(void *ctx, const uint8_t *data, uint16_t n);
+    int (*read)(void *ctx, uint8_t *data, uint16_t n);
+} sim_i2c_slave_t;
+
+/* 事件：由模型持有（侵入式链表），同一事件同一时刻只在队列中出现一次 */
+typedef struct sim_event {
+    uint64_t t_ns;
+    void (*fn)(void *ctx);
+    void *ctx;
+    struct sim_event *next;
+    uint8_t queued;
+} sim_event_t;
+
+/* 初始化虚拟时钟与外设状态，必须在运行固件前调用 */
+void sim_hal_init(void);
+uint64_t sim_now_ns(void);
+/* 固件调用 HAL 时执行：消耗 CPU 时间、处理到期事件、投递中断 */
+void sim_service(void);
+/* 把时间推进到 t_ns（不早于当前时间），期间按顺序处理事件与中断 */
+void sim_advance_to(uint64_t t_ns);
+/* 每次 HAL 调用消耗的 CPU 时间（ns，默认 1000） */
+void sim_set_cpu_ns(uint32_t ns);
+/* 实时模式：虚拟时间不超前于主机时间（默认关闭，尽可能快地运行） */
+void sim_set_realtime(int on);
+/* sim_hal_init 以来的主机耗时（秒），用于报告加速比 */
+double sim_host_seconds(void);
+
+void sim_event_init(sim_event_t *ev, void (*fn)(void *ctx), void *ctx);
+/* 在 t_ns 时刻触发（已在队列中则改期） */
+void sim_event_schedule(sim_event_t *ev, uint64_t t_ns);
+void sim_event_cancel(sim_event_t *ev);
+/* 挂起一个中断（NVIC ISPR），使能且 PRIMASK = 0 时投递 */
+void sim_irq_pend(IRQn_Type irqn);
+
+/* 虚拟时间到达 ns 后调用 on_end（打印报告）并以其返回值退出进程 */
+void sim_set_deadline(uint64_t ns, int (*on_end)(void));
+
+void sim_i2c_attach(sim_i2c_slave_t *slave);
+/* 外部电路驱动输入引脚电平；下降/上升沿按 HAL_GPIO_Init 的 IT 模式挂起 EXTI */
+void sim_gpio_drive(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState level);
+
+/* 监视同一端口上的一对 H 桥输入（推挽两路），统计直通、死区与半周期，见 sim_hal_stats_t */
+void sim_gpio_watch_bridge(GPIO_TypeDef *port, uint16_t pin_a, uint16_t pin_b);
+/* 监视的 H 桥等效驱动电压（极性 × TIM2 CH1 占空比）在最近若干个整周期上的谐波幅度：
+ * mag[k-1] 为 k 次谐波，以满幅电压为 1；返回所用的周期数，换向记录不足时返回 0 */
+uint32_t sim_bridge_harmonics(double *mag, uint32_t kmax);
+/* 监视的 H 桥等效驱动电压每次变化时调用 fn（level：-1..1，以满幅为 1），供执行器模型使用；只有一个监听者 */
+void sim_bridge_on_level(void (*fn)(void *ctx, uint64_t t_ns, double level), void *ctx);
+
+/* I2C 总线速率覆盖（0 = 使用 hi2c->Init.ClockSpeed） */
+void sim_i2c_set_clock(uint32_t hz);
+/* UART：输出去向（NULL 丢弃）、理想串口（发送不耗时）、注入接收字节 */
+void sim_uart_set_sink(FILE *sink);
+void sim_uart_set_ideal(int ideal);
+void sim_uart_inject(const char *text);
+/* ADC1 转换结果（12-bit） */
+void sim_adc_set_value(uint16_t value);
+
+/* 运行统计（报告用） */
+typedef struct {
+    uint64_t i2c_busy_ns;       /* I2C 总线占用时间（阻塞 + 中断传输） */
+    uint32_t i2c_transfers;
+    uint32_t i2c_nacks;
+    uint64_t uart_tx_bytes;
+    uint64_t uart_block_ns;     /* HAL_UART_Transmit 阻塞 CPU 的时间 */
+    uint64_t uart_dma_ns;       /* HAL_UART_Transmit_DMA 占用发送线的时间（不占 CPU） */
+    uint32_t irq_exti;
+    uint32_t irq_i2c;
+    uint32_t irq_tim;
+    uint32_t irq_uart;
+    uint32_t irq_dma;
+    uint32_t uart_rx_overrun;   /* 上一个字节未被取走就收到新字节 */
+    uint64_t dma_xfers;         /* 外设请求触发的 DMA 搬运次数（HAL_DMA_Start 启动的通道） */
+    uint32_t bridge_edges;      /* 监视的 H 桥输入电平变化次数 */
+    uint32_t bridge_overlap;    /* 两路同时为高（直通）的次数 */
+    uint64_t bridge_dead_min_ns;    /* 换向死区：一路拉低到另一路置高（无记录时 min = UINT64_MAX） */
+    uint64_t bridge_dead_max_ns;
+    uint64_t bridge_half_min_ns;    /* 相邻两次换向的间隔 */
+    uint64_t bridge_half_max_ns;
+    uint32_t bridge_commutations;   /* 换向（置高的那一路改变）次数 */
+    uint64_t bridge_first_ns;       /* 第一次 / 最近一次换向的时刻 */
+    uint64_t bridge_last_ns;
+    uint64_t events;
+    uint64_t idle_skips;        /* 空转快进次数 */
+    uint64_t hal_calls;
+} sim_hal_stats_t;
+
+const sim_hal_stats_t *sim_hal_get_stats(void);
+
+#endif /* __SIM_HAL_H__ */
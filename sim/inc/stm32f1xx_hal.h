@@ -0,0 +1,640 @@
+/*
+ * stm32f1xx_hal.h（主机仿真替身）
+ * 只声明 Core/ 源文件实际用到的 HAL 类型、常量与函数，实现见 sim/src/hal_stub.c。
+ *
+ * 说明：
+ * - sim/inc 在包含路径中排在 Drivers/ 之前，固件源文件 #include "stm32f1xx_hal.h" 时得到本文件；
+ * - 结构体字段名、宏名与枚举值与真实 HAL / CMSIS 保持一致，固件代码不需要任何 #ifdef；
+ * - 外设寄存器块（GPIOB、TIM3、USART1 ...）是普通全局变量，仿真模型直接读写；
+ * - 外设按虚拟时钟产生事件，中断由 hal_stub.c 在 HAL 调用点投递，PRIMASK 置位时推迟投递。
+ */
+#ifndef __STM32F1xx_HAL_H
+#define __STM32F1xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ---------------- 公共定义（stm32f1xx_hal_def.h） ---------------- */
+
+typedef enum {
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum { HAL_UNLOCKED = 0x00U, HAL_LOCKED = 0x01U } HAL_LockTypeDef;
+typedef enum { DISABLE = 0U, ENABLE = !DISABLE } FunctionalState;
+typedef enum { RESET = 0U, SET = !RESET } FlagStatus, ITStatus;
+
+#define __IO            volatile
+#define __weak          __attribute__((weak))
+#define UNUSED(X)       (void)X
+#define HAL_MAX_DELAY   0xFFFFFFFFU
+
+/* ---------------- 中断号（stm32f103xb.h 子集） ---------------- */
+
+typedef enum {
+  SysTick_IRQn         = -1,
+  EXTI0_IRQn           = 6,
+  EXTI1_IRQn           = 7,
+  EXTI2_IRQn           = 8,
+  EXTI3_IRQn           = 9,
+  EXTI4_IRQn           = 10,
+  DMA1_Channel1_IRQn   = 11,
+  DMA1_Channel2_IRQn   = 12,
+  DMA1_Channel3_IRQn   = 13,
+  DMA1_Channel4_IRQn   = 14,
+  DMA1_Channel5_IRQn   = 15,
+  DMA1_Channel6_IRQn   = 16,
+  DMA1_Channel7_IRQn   = 17,
+  ADC1_2_IRQn          = 18,
+  EXTI9_5_IRQn         = 23,
+  TIM2_IRQn            = 28,
+  TIM3_IRQn            = 29,
+  I2C1_EV_IRQn         = 31,
+  I2C1_ER_IRQn         = 32,
+  USART1_IRQn          = 37,
+  EXTI15_10_IRQn       = 40
+} IRQn_Type;
+
+/* ---------------- 外设寄存器块 ---------------- */
+
+typedef struct {
+  __IO uint32_t CRL, CRH, IDR, ODR, BSRR, BRR, LCKR;
+} GPIO_TypeDef;
+
+typedef struct {
+  __IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR;
+  __IO uint32_t CCR1, CCR2, CCR3, CCR4, BDTR, DCR, DMAR;
+} TIM_TypeDef;
+
+typedef struct {
+  __IO uint32_t SR, DR, BRR, CR1, CR2, CR3, GTPR;
+} USART_TypeDef;
+
+typedef struct {
+  __IO uint32_t CR1, CR2, OAR1, OAR2, DR, SR1, SR2, CCR, TRISE;
+} I2C_TypeDef;
+
+typedef struct {
+  __IO uint32_t CCR, CNDTR, CPAR, CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+  __IO uint32_t SR, CR1, CR2, SMPR1, SMPR2, JOFR1, JOFR2, JOFR3, JOFR4, HTR, LTR;
+  __IO uint32_t SQR1, SQR2, SQR3, JSQR, JDR1, JDR2, JDR3, JDR4, DR;
+} ADC_TypeDef;
+
+extern GPIO_TypeDef sim_GPIOA, sim_GPIOB, sim_GPIOC;
+extern TIM_TypeDef sim_TIM2, sim_TIM3;
+extern USART_TypeDef sim_USART1;
+extern I2C_TypeDef sim_I2C1;
+extern ADC_TypeDef sim_ADC1;
+extern DMA_Channel_TypeDef sim_DMA1_Channel[7];
+
+#define GPIOA   (&sim_GPIOA)
+#define GPIOB   (&sim_GPIOB)
+#define GPIOC   (&sim_GPIOC)
+#define TIM2    (&sim_TIM2)
+#define TIM3    (&sim_TIM3)
+#define USART1  (&sim_USART1)
+#define I2C1    (&sim_I2C1)
+#define ADC1    (&sim_ADC1)
+#define DMA1_Channel1  (&sim_DMA1_Channel[0])
+#define DMA1_Channel2  (&sim_DMA1_Channel[1])
+#define DMA1_Channel3  (&sim_DMA1_Channel[2])
+#define DMA1_Channel4  (&sim_DMA1_Channel[3])
+#define DMA1_Channel5  (&sim_DMA1_Channel[4])
+#define DMA1_Channel6  (&sim_DMA1_Channel[5])
+#define DMA1_Channel7  (&sim_DMA1_Channel[6])
+
+/* ---------------- Cortex-M3 内核（CMSIS 子集） ---------------- */
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+void __WFI(void);
+#define __NOP()   do { } while (0)
+#define __DSB()   do { } while (0)
+#define __DMB()   do { } while (0)
+#define __ISB()   do { } while (0)
+
+/* DWT 周期计数器：CYCCNT 由虚拟时间按 72 MHz 折算（读 DWT 时刷新），与 SysTick / 外设事件同一时基，
+ * 可用于驱动中的时间戳；纯计算代码不推进虚拟时间，测得的周期数不代表 Cortex-M3 的耗时。写 CYCCNT 无效 */
+typedef struct {
+  __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+  __IO uint32_t CTRL, CYCCNT;
+} DWT_Type;
+
+extern CoreDebug_Type sim_CoreDebug;
+DWT_Type *sim_dwt(void);
+
+#define CoreDebug   (&sim_CoreDebug)
+#define DWT         (sim_dwt())
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+
+/* ---------------- HAL 公共 ---------------- */
+
+HAL_StatusTypeDef HAL_Init(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+/* ---------------- RCC ---------------- */
+
+typedef struct {
+  uint32_t PLLState;
+  uint32_t PLLSource;
+  uint32_t PLLMUL;
+} RCC_PLLInitTypeDef;
+
+typedef struct {
+  uint32_t OscillatorType;
+  uint32_t HSEState;
+  uint32_t HSEPredivValue;
+  uint32_t LSEState;
+  uint32_t HSIState;
+  uint32_t HSICalibrationValue;
+  uint32_t LSIState;
+  RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct {
+  uint32_t ClockType;
+  uint32_t SYSCLKSource;
+  uint32_t AHBCLKDivider;
+  uint32_t APB1CLKDivider;
+  uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+typedef struct {
+  uint32_t PeriphClockSelection;
+  uint32_t RTCClockSelection;
+  uint32_t AdcClockSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+#define RCC_OSCILLATORTYPE_HSE    0x00000001U
+#define RCC_OSCILLATORTYPE_HSI    0x00000002U
+#define RCC_HSE_ON                0x00010000U
+#define RCC_HSE_PREDIV_DIV1       0x00000000U
+#define RCC_HSI_ON                0x00000001U
+#define RCC_PLL_ON                0x00000002U
+#define RCC_PLLSOURCE_HSE         0x00010000U
+#define RCC_PLL_MUL9              0x001C0000U
+#define RCC_CLOCKTYPE_SYSCLK      0x00000001U
+#define RCC_CLOCKTYPE_HCLK        0x00000002U
+#define RCC_CLOCKTYPE_PCLK1       0x00000004U
+#define RCC_CLOCKTYPE_PCLK2       0x00000008U
+#define RCC_SYSCLKSOURCE_PLLCLK   0x00000002U
+#define RCC_SYSCLK_DIV1           0x00000000U
+#define RCC_HCLK_DIV1             0x00000000U
+#define RCC_HCLK_DIV2             0x00000400U
+#define RCC_PERIPHCLK_ADC         0x00000002U
+#define RCC_ADCPCLK2_DIV6         0x00008000U
+#define FLASH_LATENCY_2           0x00000002U
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency);
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit);
+uint32_t HAL_RCC_GetSysClockFreq(void);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t *pFLatency);
+
+#define __HAL_RCC_GPIOA_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_GPIOD_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_AFIO_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_I2C1_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_USART1_CLK_ENABLE()  do { } while (0)
+#define __HAL_RCC_TIM2_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_TIM3_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_ADC1_CLK_ENABLE()    do { } while (0)
+
+/* ---------------- GPIO ---------------- */
+
+typedef enum { GPIO_PIN_RESET = 0U, GPIO_PIN_SET } GPIO_PinState;
+
+typedef struct {
+  uint32_t Pin;
+  uint32_t Mode;
+  uint32_t Pull;
+  uint32_t Speed;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_0     ((uint16_t)0x0001)
+#define GPIO_PIN_1     ((uint16_t)0x0002)
+#define GPIO_PIN_2     ((uint16_t)0x0004)
+#define GPIO_PIN_3     ((uint16_t)0x0008)
+#define GPIO_PIN_4     ((uint16_t)0x0010)
+#define GPIO_PIN_5     ((uint16_t)0x0020)
+#define GPIO_PIN_6     ((uint16_t)0x0040)
+#define GPIO_PIN_7     ((uint16_t)0x0080)
+#define GPIO_PIN_8     ((uint16_t)0x0100)
+#define GPIO_PIN_9     ((uint16_t)0x0200)
+#define GPIO_PIN_10    ((uint16_t)0x0400)
+#define GPIO_PIN_11    ((uint16_t)0x0800)
+#define GPIO_PIN_12    ((uint16_t)0x1000)
+#define GPIO_PIN_13    ((uint16_t)0x2000)
+#define GPIO_PIN_14    ((uint16_t)0x4000)
+#define GPIO_PIN_15    ((uint16_t)0x8000)
+#define GPIO_PIN_All   ((uint16_t)0xFFFF)
+
+#define GPIO_MODE_INPUT               0x00000000U
+#define GPIO_MODE_OUTPUT_PP           0x00000001U
+#define GPIO_MODE_OUTPUT_OD           0x00000011U
+#define GPIO_MODE_AF_PP               0x00000002U
+#define GPIO_MODE_AF_OD               0x00000012U
+#define GPIO_MODE_AF_INPUT            GPIO_MODE_INPUT
+#define GPIO_MODE_ANALOG              0x00000003U
+#define GPIO_MODE_IT_RISING           0x10110000U
+#define GPIO_MODE_IT_FALLING          0x10210000U
+#define GPIO_MODE_IT_RISING_FALLING   0x10310000U
+#define GPIO_NOPULL                   0x00000000U
+#define GPIO_PULLUP                   0x00000001U
+#define GPIO_PULLDOWN                 0x00000002U
+#define GPIO_SPEED_FREQ_LOW           0x00000002U
+#define GPIO_SPEED_FREQ_MEDIUM        0x00000001U
+#define GPIO_SPEED_FREQ_HIGH          0x00000003U
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+/* ---------------- DMA ---------------- */
+
+typedef struct {
+  uint32_t Direction;
+  uint32_t PeriphInc;
+  uint32_t MemInc;
+  uint32_t PeriphDataAlignment;
+  uint32_t MemDataAlignment;
+  uint32_t Mode;
+  uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef enum {
+  HAL_DMA_STATE_RESET   = 0x00U,
+  HAL_DMA_STATE_READY   = 0x01U,
+  HAL_DMA_STATE_BUSY    = 0x02U,
+  HAL_DMA_STATE_TIMEOUT = 0x03U
+} HAL_DMA_StateTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+  DMA_Channel_TypeDef      *Instance;
+  DMA_InitTypeDef          Init;
+  HAL_LockTypeDef          Lock;
+  __IO HAL_DMA_StateTypeDef State;
+  void                     *Parent;
+  __IO uint32_t            ErrorCode;
+} DMA_HandleTypeDef;
+
+#define DMA_PERIPH_TO_MEMORY      0x00000000U
+#define DMA_MEMORY_TO_PERIPH      0x00000010U
+#define DMA_PINC_ENABLE           0x00000040U
+#define DMA_PINC_DISABLE          0x00000000U
+#define DMA_MINC_ENABLE           0x00000080U
+#define DMA_MINC_DISABLE          0x00000000U
+#define DMA_PDATAALIGN_BYTE       0x00000000U
+#define DMA_PDATAALIGN_HALFWORD   0x00000100U
+#define DMA_PDATAALIGN_WORD       0x00000200U
+#define DMA_MDATAALIGN_BYTE       0x00000000U
+#define DMA_MDATAALIGN_HALFWORD   0x00000400U
+#define DMA_MDATAALIGN_WORD       0x00000800U
+#define DMA_NORMAL                0x00000000U
+#define DMA_CIRCULAR              0x00000020U
+#define DMA_PRIORITY_LOW          0x00000000U
+#define DMA_PRIORITY_MEDIUM       0x00001000U
+#define DMA_PRIORITY_HIGH         0x00002000U
+#define DMA_PRIORITY_VERY_HIGH    0x00003000U
+
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+  do { \
+    (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); \
+    (__DMA_HANDLE__).Parent = (__HANDLE__); \
+  } while (0)
+#define __HAL_DMA_GET_COUNTER(__HANDLE__)  ((__HANDLE__)->Instance->CNDTR)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma);
+/* 真实 HAL 的地址参数是 uint32_t；主机指针为 64-bit，这里用 uintptr_t，
+ * 固件传 (uintptr_t) 转换后的地址，两边都能编译 */
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uintptr_t SrcAddress, uintptr_t DstAddress,
+                                uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+
+/* ---------------- I2C ---------------- */
+
+typedef struct {
+  uint32_t ClockSpeed;
+  uint32_t DutyCycle;
+  uint32_t OwnAddress1;
+  uint32_t AddressingMode;
+  uint32_t DualAddressMode;
+  uint32_t OwnAddress2;
+  uint32_t GeneralCallMode;
+  uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef enum {
+  HAL_I2C_STATE_RESET    = 0x00U,
+  HAL_I2C_STATE_READY    = 0x20U,
+  HAL_I2C_STATE_BUSY     = 0x24U,
+  HAL_I2C_STATE_BUSY_TX  = 0x21U,
+  HAL_I2C_STATE_BUSY_RX  = 0x22U
+} HAL_I2C_StateTypeDef;
+
+typedef struct __I2C_HandleTypeDef {
+  I2C_TypeDef              *Instance;
+  I2C_InitTypeDef          Init;
+  uint8_t                  *pBuffPtr;
+  uint16_t                 XferSize;
+  __IO uint16_t            XferCount;
+  HAL_LockTypeDef          Lock;
+  __IO HAL_I2C_StateTypeDef State;
+  __IO uint32_t            ErrorCode;
+  __IO uint32_t            Devaddress;
+  __IO uint32_t            Memaddress;
+} I2C_HandleTypeDef;
+
+#define I2C_DUTYCYCLE_2               0x00000000U
+#define I2C_ADDRESSINGMODE_7BIT       0x00004000U
+#define I2C_DUALADDRESS_DISABLE       0x00000000U
+#define I2C_GENERALCALL_DISABLE       0x00000000U
+#define I2C_NOSTRETCH_DISABLE         0x00000000U
+#define I2C_MEMADD_SIZE_8BIT          0x00000001U
+#define I2C_MEMADD_SIZE_16BIT         0x00000010U
+#define HAL_I2C_ERROR_NONE            0x00000000U
+#define HAL_I2C_ERROR_AF              0x00000004U
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                          uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                         uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                      uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+/* ---------------- UART ---------------- */
+
+typedef struct {
+  uint32_t BaudRate;
+  uint32_t WordLength;
+  uint32_t StopBits;
+  uint32_t Parity;
+  uint32_t Mode;
+  uint32_t HwFlowCtl;
+  uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef enum {
+  HAL_UART_STATE_RESET    = 0x00U,
+  HAL_UART_STATE_READY    = 0x20U,
+  HAL_UART_STATE_BUSY     = 0x24U,
+  HAL_UART_STATE_BUSY_TX  = 0x21U,
+  HAL_UART_STATE_BUSY_RX  = 0x22U
+} HAL_UART_StateTypeDef;
+
+typedef struct __UART_HandleTypeDef {
+  USART_TypeDef            *Instance;
+  UART_InitTypeDef         Init;
+  const uint8_t            *pTxBuffPtr;
+  uint16_t                 TxXferSize;
+  __IO uint16_t            TxXferCount;
+  uint8_t                  *pRxBuffPtr;
+  uint16_t                 RxXferSize;
+  __IO uint16_t            RxXferCount;
+  DMA_HandleTypeDef        *hdmatx;
+  DMA_HandleTypeDef        *hdmarx;
+  HAL_LockTypeDef          Lock;
+  __IO HAL_UART_StateTypeDef gState;
+  __IO HAL_UART_StateTypeDef RxState;
+  __IO uint32_t            ErrorCode;
+} UART_HandleTypeDef;
+
+#define UART_WORDLENGTH_8B        0x00000000U
+#define UART_STOPBITS_1           0x00000000U
+#define UART_PARITY_NONE          0x00000000U
+#define UART_MODE_TX_RX           0x0000000CU
+#define UART_HWCONTROL_NONE       0x00000000U
+#define UART_OVERSAMPLING_16      0x00000000U
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+/* ---------------- TIM ---------------- */
+
+typedef struct {
+  uint32_t Prescaler;
+  uint32_t CounterMode;
+  uint32_t Period;
+  uint32_t ClockDivision;
+  uint32_t RepetitionCounter;
+  uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef enum {
+  HAL_TIM_ACTIVE_CHANNEL_1        = 0x01U,
+  HAL_TIM_ACTIVE_CHANNEL_2        = 0x02U,
+  HAL_TIM_ACTIVE_CHANNEL_3        = 0x04U,
+  HAL_TIM_ACTIVE_CHANNEL_4        = 0x08U,
+  HAL_TIM_ACTIVE_CHANNEL_CLEARED  = 0x00U
+} HAL_TIM_ActiveChannel;
+
+typedef enum {
+  HAL_TIM_STATE_RESET  = 0x00U,
+  HAL_TIM_STATE_READY  = 0x01U,
+  HAL_TIM_STATE_BUSY   = 0x02U
+} HAL_TIM_StateTypeDef;
+
+typedef struct __TIM_HandleTypeDef {
+  TIM_TypeDef              *Instance;
+  TIM_Base_InitTypeDef     Init;
+  HAL_TIM_ActiveChannel    Channel;
+  DMA_HandleTypeDef        *hdma[7];
+  HAL_LockTypeDef          Lock;
+  __IO HAL_TIM_StateTypeDef State;
+} TIM_HandleTypeDef;
+
+typedef struct {
+  uint32_t OCMode;
+  uint32_t Pulse;
+  uint32_t OCPolarity;
+  uint32_t OCNPolarity;
+  uint32_t OCFastMode;
+  uint32_t OCIdleState;
+  uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+typedef struct {
+  uint32_t ClockSource;
+  uint32_t ClockPolarity;
+  uint32_t ClockPrescaler;
+  uint32_t ClockFilter;
+} TIM_ClockConfigTypeDef;
+
+typedef struct {
+  uint32_t MasterOutputTrigger;
+  uint32_t MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+#define TIM_CHANNEL_1                     0x00000000U
+#define TIM_CHANNEL_2                     0x00000004U
+#define TIM_CHANNEL_3                     0x00000008U
+#define TIM_CHANNEL_4                     0x0000000CU
+#define TIM_COUNTERMODE_UP                0x00000000U
+#define TIM_CLOCKDIVISION_DIV1            0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE    0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_ENABLE     0x00000080U
+#define TIM_OCMODE_TIMING                 0x00000000U
+#define TIM_OCPOLARITY_HIGH               0x00000000U
+#define TIM_OCFAST_DISABLE                0x00000000U
+#define TIM_CLOCKSOURCE_INTERNAL          0x00001000U
+#define TIM_CLOCKSOURCE_ITR1              0x00000010U
+#define TIM_TRGO_RESET                    0x00000000U
+#define TIM_TRGO_UPDATE                   0x00000020U
+#define TIM_MASTERSLAVEMODE_DISABLE       0x00000000U
+
+#define TIM_CR1_CEN     0x0001U
+#define TIM_CR1_UDIS    0x0002U
+#define TIM_CR1_ARPE    0x0080U
+#define TIM_CR2_MMS     0x0070U
+#define TIM_SMCR_SMS    0x0007U
+#define TIM_SMCR_TS     0x0070U
+#define TIM_SR_UIF      0x0001U
+#define TIM_SR_CC1IF    0x0002U
+#define TIM_DIER_UIE    0x0001U
+#define TIM_DIER_CC1IE  0x0002U
+#define TIM_EGR_UG      0x0001U
+#define TIM_CCMR1_OC1PE 0x0008U
+
+#define TIM_DMA_ID_UPDATE       0U
+#define TIM_DMA_ID_CC1          1U
+#define TIM_DMA_ID_CC2          2U
+#define TIM_DMA_ID_CC3          3U
+#define TIM_DMA_ID_CC4          4U
+#define TIM_DMA_ID_COMMUTATION  5U
+#define TIM_DMA_ID_TRIGGER      6U
+#define TIM_DMA_UPDATE          0x00000100U
+#define TIM_DMA_CC1             0x00000200U
+#define TIM_DMA_CC2             0x00000400U
+#define TIM_DMA_CC3             0x00000800U
+#define TIM_DMA_CC4             0x00001000U
+#define TIM_DMA_TRIGGER         0x00004000U
+
+#define TIM_IT_UPDATE           TIM_DIER_UIE
+
+#define __HAL_TIM_ENABLE_IT(__HANDLE__, __IT__)     ((__HANDLE__)->Instance->DIER |= (__IT__))
+#define __HAL_TIM_DISABLE_IT(__HANDLE__, __IT__)    ((__HANDLE__)->Instance->DIER &= ~(__IT__))
+#define __HAL_TIM_ENABLE_DMA(__HANDLE__, __DMA__)   ((__HANDLE__)->Instance->DIER |= (__DMA__))
+#define __HAL_TIM_DISABLE_DMA(__HANDLE__, __DMA__)  ((__HANDLE__)->Instance->DIER &= ~(__DMA__))
+#define __HAL_TIM_ENABLE_OCxPRELOAD(__HANDLE__, __CHANNEL__) \
+  (((__CHANNEL__) == TIM_CHANNEL_1) ? ((__HANDLE__)->Instance->CCMR1 |= TIM_CCMR1_OC1PE) : \
+   ((__CHANNEL__) == TIM_CHANNEL_2) ? ((__HANDLE__)->Instance->CCMR1 |= TIM_CCMR1_OC1PE << 8U) : \
+   ((__CHANNEL__) == TIM_CHANNEL_3) ? ((__HANDLE__)->Instance->CCMR2 |= TIM_CCMR1_OC1PE) : \
+   ((__HANDLE__)->Instance->CCMR2 |= TIM_CCMR1_OC1PE << 8U))
+
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+  (((__CHANNEL__) == TIM_CHANNEL_1) ? ((__HANDLE__)->Instance->CCR1 = (__COMPARE__)) : \
+   ((__CHANNEL__) == TIM_CHANNEL_2) ? ((__HANDLE__)->Instance->CCR2 = (__COMPARE__)) : \
+   ((__CHANNEL__) == TIM_CHANNEL_3) ? ((__HANDLE__)->Instance->CCR3 = (__COMPARE__)) : \
+   ((__HANDLE__)->Instance->CCR4 = (__COMPARE__)))
+#define __HAL_TIM_GET_COMPARE(__HANDLE__, __CHANNEL__) \
+  (((__CHANNEL__) == TIM_CHANNEL_1) ? ((__HANDLE__)->Instance->CCR1) : \
+   ((__CHANNEL__) == TIM_CHANNEL_2) ? ((__HANDLE__)->Instance->CCR2) : \
+   ((__CHANNEL__) == TIM_CHANNEL_3) ? ((__HANDLE__)->Instance->CCR3) : \
+   ((__HANDLE__)->Instance->CCR4))
+#define __HAL_TIM_SET_AUTORELOAD(__HANDLE__, __AUTORELOAD__) \
+  do { \
+    (__HANDLE__)->Instance->ARR = (__AUTORELOAD__); \
+    (__HANDLE__)->Init.Period = (__AUTORELOAD__); \
+  } while (0)
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__)   ((__HANDLE__)->Instance->ARR)
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__)  ((__HANDLE__)->Instance->CNT = (__COUNTER__))
+/* 内部时钟计数时 CNT 不随虚拟时间更新，读计数由替身按当前时刻换算 */
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)      sim_tim_get_counter((__HANDLE__)->Instance)
+uint32_t sim_tim_get_counter(TIM_TypeDef *tim);
+#define __HAL_TIM_SET_PRESCALER(__HANDLE__, __PRESC__)  ((__HANDLE__)->Instance->PSC = (__PRESC__))
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *sClockSourceConfig);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        TIM_MasterConfigTypeDef *sMasterConfig);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+/* ---------------- ADC ---------------- */
+
+typedef struct {
+  uint32_t DataAlign;
+  uint32_t ScanConvMode;
+  FunctionalState ContinuousConvMode;
+  uint32_t NbrOfConversion;
+  FunctionalState DiscontinuousConvMode;
+  uint32_t NbrOfDiscConversion;
+  uint32_t ExternalTrigConv;
+} ADC_InitTypeDef;
+
+typedef struct __ADC_HandleTypeDef {
+  ADC_TypeDef              *Instance;
+  ADC_InitTypeDef          Init;
+  HAL_LockTypeDef          Lock;
+  __IO uint32_t            State;
+  __IO uint32_t            ErrorCode;
+} ADC_HandleTypeDef;
+
+#define ADC_SCAN_DISABLE          0x00000000U
+#define ADC_SOFTWARE_START        0x000E0000U
+#define ADC_DATAALIGN_RIGHT       0x00000000U
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_Stop(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef *hadc, uint32_t Timeout);
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef *hadc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F1xx_HAL_H */
@@ -0,0 +1,10 @@
+/*
+ * stm32f1xx_hal_uart.h（主机仿真替身）
+ * 固件源文件直接包含了该模块头文件；仿真中全部声明都在 stm32f1xx_hal.h 里。
+ */
+#ifndef __STM32F1xx_HAL_UART_H
+#define __STM32F1xx_HAL_UART_H
+
+#include "stm32f1xx_hal.h"
+
+#endif /* __STM32F1xx_HAL_UART_H */
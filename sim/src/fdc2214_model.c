@@ -0,0 +1,280 @@
+/*
+ * fdc2214_model.c
+ * FDC2214 寄存器级模型实现，行为说明见 fdc2214_model.h
+ */
+
+#include "fdc2214_model.h"
+#include "fdc2214.h"
+#include <math.h>
+#include <string.h>
+
+#define REG_RESET_DEV   0x1CU
+#define RESET_DEV_BIT   (1U << 15)
+#define TSW_NS          692.0
+
+static const uint16_t s_reg_default[FDC_MODEL_NREG] = {
+    [FDC2214_REG_RCOUNT_CH0] = 0x0080, [FDC2214_REG_RCOUNT_CH1] = 0x0080,
+    [FDC2214_REG_RCOUNT_CH2] = 0x0080, [FDC2214_REG_RCOUNT_CH3] = 0x0080,
+    [FDC2214_REG_CONFIG] = 0x2801,
+    [FDC2214_REG_MUX_CONFIG] = 0x020F,
+};
+
+/* xorshift32 均匀分布 (0, 1] */
+static double rng_uniform(fdc_model_t *m)
+{
+    uint32_t x = m->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m->rng = x;
+    return ((double)x + 1.0) / 4294967296.0;
+}
+
+/* Box-Muller 标准正态 */
+static double rng_gauss(fdc_model_t *m)
+{
+    double u1 = rng_uniform(m);
+    double u2 = rng_uniform(m);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * 3.14159265358979323846 * u2);
+}
+
+double fdc_model_lc_freq(double L_h, double C_f)
+{
+    if (L_h <= 0.0 || C_f <= 0.0) return 0.0;
+    return 1.0 / (2.0 * 3.14159265358979323846 * sqrt(L_h * C_f));
+}
+
+static double fref_hz(const fdc_model_t *m, uint8_t ch)
+{
+    double fclk = (m->reg[FDC2214_REG_CONFIG] & FDC2214_CONFIG_REF_CLK_SRC_MASK) ? m->clkin_hz : m->intosc_hz;
+    uint16_t div = m->reg[FDC2214_REG_CLOCK_DIVIDERS_CH0 + ch] & 0x03FFU;
+    return fclk / (div ? div : 1U);
+}
+
+static int autoscan(const fdc_model_t *m)
+{
+    return (m->reg[FDC2214_REG_MUX_CONFIG] & FDC2214_MUX_CONFIG_AUTOSCAN_EN) != 0;
+}
+
+/* 当前扫描序列的通道数与第 idx 个通道 */
+static uint8_t seq_len(const fdc_model_t *m)
+{
+    if (!autoscan(m)) return 1;
+    switch ((m->reg[FDC2214_REG_MUX_CONFIG] & FDC2214_MUX_CONFIG_RR_SEQUENCE_MASK) >> FDC2214_MUX_CONFIG_RR_SEQUENCE_POS) {
+        case 1: return 3;
+        case 2: return 4;
+        default: return 2;
+    }
+}
+
+static uint8_t seq_chan(const fdc_model_t *m, uint8_t idx)
+{
+    if (!autoscan(m)) return (uint8_t)((m->reg[FDC2214_REG_CONFIG] & FDC2214_CONFIG_ACTIVE_CHAN_MASK) >> FDC2214_CONFIG_ACTIVE_CHAN_POS);
+    return idx;
+}
+
+/* 通道 ch 一次转换的耗时（ns）；with_settle：是否包含激活时间（多通道每次都包含） */
+static uint64_t conv_ns(const fdc_model_t *m, uint8_t ch, int with_settle)
+{
+    const double fref = fref_hz(m, ch);
+    uint16_t settle = m->reg[FDC2214_REG_SETTLECOUNT_CH0 + ch];
+    double cycles = (double)m->reg[FDC2214_REG_RCOUNT_CH0 + ch] * 16.0 + 4.0;
+    double ns = 0.0;
+    if (with_settle) cycles += (settle <= 1U) ? 32.0 : (double)settle * 16.0;
+    if (autoscan(m)) {
+        cycles += 5.0;
+        ns += TSW_NS;
+    }
+    ns += cycles * 1e9 / fref;
+    return (uint64_t)ns;
+}
+
+static void update_intb(fdc_model_t *m)
+{
+    uint8_t low = (uint8_t)(m->drdy && (m->reg[FDC2214_REG_STATUS_CONFIG] & FDC2214_STATUS_CONFIG_DRDY_2INT) &&
+                            !(m->reg[FDC2214_REG_CONFIG] & FDC2214_CONFIG_INTB_DIS_MASK));
+    if (low != m->intb_low) {
+        m->intb_low = low;
+        sim_gpio_drive(m->intb_port, m->intb_pin, low ? GPIO_PIN_RESET : GPIO_PIN_SET);
+    }
+}
+
+/* 完成通道 ch 的一次转换：计算 DATA 与错误标志，更新 UNREADCONV */
+static void finish_conversion(fdc_model_t *m, uint8_t ch)
+{
+    const fdc_model_chan_t *c = &m->ch[ch];
+    const uint16_t scfg = m->reg[FDC2214_REG_STATUS_CONFIG];
+    uint16_t flags = 0;
+
+    if (c->fault == FDC_MODEL_FAULT_WD || c->freq_hz <= 0.0) {
+        m->data[ch] = 0;
+        m->err = (uint16_t)(((uint16_t)ch << FDC2214_STATUS_ERR_CHAN_POS) | FDC2214_STATUS_ERR_WD);
+        if (scfg & FDC2214_STATUS_CONFIG_WD_ERR2OUT) flags |= FDC2214_DATA_ERR_WD;
+    } else {
+        uint16_t fin_sel = (uint16_t)((m->reg[FDC2214_REG_CLOCK_DIVIDERS_CH0 + ch] >> FDC2214_CLOCK_DIVIDERS_FIN_SEL_POS) & 3U);
+        double f = c->freq_hz * (1.0 + c->noise_ppm * 1e-6 * rng_gauss(m));
+        if (c->offset != NULL) {
+            double win_ns = ((double)m->reg[FDC2214_REG_RCOUNT_CH0 + ch] * 16.0 + 4.0) * 1e9 / fref_hz(m, ch);
+            f *= 1.0 + c->offset(c->offset_ctx, sim_now_ns() - (uint64_t)(win_ns / 2.0));
+        }
+        double code = f / (fin_sel == 2U ? 2.0 : 1.0) / fref_hz(m, ch) * 268435456.0 + 0.5;
+        m->data[ch] = (code >= (double)FDC2214_DATA_FULL_SCALE) ? FDC2214_DATA_FULL_SCALE :
+                      (code <= 0.0) ? 0U : (uint32_t)code;
+        if (c->fault == FDC_MODEL_FAULT_AHW) {
+            m->err = (uint16_t)(((uint16_t)ch << FDC2214_STATUS_ERR_CHAN_POS) | FDC2214_STATUS_ERR_AHW);
+            if (scfg & FDC2214_STATUS_CONFIG_AH_WARN2OUT) flags |= FDC2214_DATA_ERR_AW;
+        } else if (c->fault == FDC_MODEL_FAULT_ALW) {
+            m->err = (uint16_t)(((uint16_t)ch << FDC2214_STATUS_ERR_CHAN_POS) | FDC2214_STATUS_ERR_ALW);
+            if (scfg & FDC2214_STATUS_CONFIG_AL_WARN2OUT) flags |= FDC2214_DATA_ERR_AW;
+        }
+    }
+    m->data_flags[ch] = flags;
+
+    if (m->unread & (1U << ch)) m->overwritten[ch]++;
+    m->unread |= (uint8_t)(1U << ch);
+    m->conversions++;
+}
+
+static void start_conversions(fdc_model_t *m, uint64_t now)
+{
+    m->running = 1;
+    m->seq_idx = 0;
+    sim_event_schedule(&m->conv_ev, now + conv_ns(m, seq_chan(m, 0), 1));
+}
+
+static void stop_conversions(fdc_model_t *m)
+{
+    m->running = 0;
+    sim_event_cancel(&m->conv_ev);
+}
+
+static void reset_regs(fdc_model_t *m)
+{
+    memcpy(m->reg, s_reg_default, sizeof(m->reg));
+    memset(m->data, 0, sizeof(m->data));
+    memset(m->data_flags, 0, sizeof(m->data_flags));
+    memset(m->lsb_latch, 0, sizeof(m->lsb_latch));
+    m->ptr = 0;
+    m->unread = 0;
+    m->drdy = 0;
+    m->err = 0;
+    m->seq_idx = 0;
+    stop_conversions(m);
+}
+
+static uint16_t reg_read(fdc_model_t *m, uint8_t r)
+{
+    if (r <= FDC2214_REG_DATA_LSB_CH3) {
+        uint8_t ch = r / 2U;
+        if (r & 1U) return m->lsb_latch[ch];
+        m->lsb_latch[ch] = (uint16_t)(m->data[ch] & 0xFFFFU);
+        m->unread &= (uint8_t)~(1U << ch);
+        m->drdy = 0;
+        m->data_reads++;
+        return (uint16_t)(m->data_flags[ch] | ((m->data[ch] >> 16) & FDC2214_DATA_MSB_MASK));
+    }
+    if (r == FDC2214_REG_STATUS) {
+        uint16_t v = m->err;
+        if (m->drdy) v |= FDC2214_STATUS_DRDY;
+        for (uint8_t ch = 0; ch < 4; ++ch) {
+            if (m->unread & (1U << ch)) v |= (uint16_t)FDC2214_STATUS_UNREADCONV(ch);
+        }
+        m->err = 0;
+        m->drdy = 0;
+        m->status_reads++;
+        return v;
+    }
+    if (r == FDC2214_REG_MANUF_ID) return FDC2214_MANUFACTURER_ID;
+    if (r == FDC2214_REG_DEVICE_ID) return FDC2214_EXPECTED_DEVICE_ID;
+    if (r < FDC_MODEL_NREG) return m->reg[r];
+    return 0;
+}
+
+static void reg_write(fdc_model_t *m, uint8_t r, uint16_t v)
+{
+    const uint64_t now = sim_now_ns();
+    if (r <= FDC2214_REG_DATA_LSB_CH3 || r == FDC2214_REG_STATUS || r >= FDC_MODEL_NREG) return;
+    if (r == REG_RESET_DEV) {
+        if (v & RESET_DEV_BIT) reset_regs(m);
+        return;
+    }
+    m->reg[r] = v;
+    if (r == FDC2214_REG_CONFIG || r == FDC2214_REG_MUX_CONFIG) {
+        if (m->reg[FDC2214_REG_CONFIG] & FDC2214_CONFIG_SLEEP_MODE_EN) stop_conversions(m);
+        else start_conversions(m, now);
+    }
+}
+
+/* I2C 写事务：第一个字节为寄存器指针，之后每 2 字节写一个寄存器 */
+static int slave_write(void *ctx, const uint8_t *data, uint16_t n)
+{
+    fdc_model_t *m = (fdc_model_t *)ctx;
+    m->ptr = data[0];
+    for (uint16_t i = 1; i + 1U < n; i = (uint16_t)(i + 2U)) {
+        reg_write(m, m->ptr, (uint16_t)(((uint16_t)data[i] << 8) | data[i + 1]));
+        m->ptr++;
+    }
+    update_intb(m);
+    return 0;
+}
+
+/* I2C 读事务：从当前指针起按寄存器读出，MSB 在前 */
+static int slave_read(void *ctx, uint8_t *data, uint16_t n)
+{
+    fdc_model_t *m = (fdc_model_t *)ctx;
+    uint16_t v = 0;
+    for (uint16_t i = 0; i < n; ++i) {
+        if ((i & 1U) == 0) {
+            v = reg_read(m, m->ptr);
+            data[i] = (uint8_t)(v >> 8);
+        } else {
+            data[i] = (uint8_t)(v & 0xFFU);
+            m->ptr++;
+        }
+    }
+    update_intb(m);
+    return 0;
+}
+
+/* 转换完成事件：结束当前通道，一轮结束置 DRDY，并登记序列中下一个通道 */
+static void conv_event(void *ctx)
+{
+    fdc_model_t *m = (fdc_model_t *)ctx;
+    const uint8_t n = seq_len(m);
+    if (!m->running) return;
+    finish_conversion(m, seq_chan(m, m->seq_idx));
+    if (++m->seq_idx >= n) {
+        m->seq_idx = 0;
+        m->rounds++;
+        m->drdy = 1;
+    }
+    /* 单通道连续转换不再有激活时间 */
+    sim_event_schedule(&m->conv_ev, m->conv_ev.t_ns + conv_ns(m, seq_chan(m, m->seq_idx), n > 1));
+    update_intb(m);
+}
+
+void fdc_model_init(fdc_model_t *m, uint16_t addr_hal, GPIO_TypeDef *intb_port, uint16_t intb_pin, uint32_t seed)
+{
+    memset(m, 0, sizeof(*m));
+    m->addr_hal = addr_hal;
+    m->intb_port = intb_port;
+    m->intb_pin = intb_pin;
+    m->clkin_hz = 40e6;
+    m->intosc_hz = FDC_MODEL_INTOSC_HZ;
+    for (int ch = 0; ch < 4; ++ch) m->ch[ch].freq_hz = 6e6;
+    m->rng = seed ? seed : 0x2545F491U;
+    sim_event_init(&m->conv_ev, conv_event, m);
+    reset_regs(m);
+
+    m->slave.addr_hal = addr_hal;
+    m->slave.ctx = m;
+    m->slave.write = slave_write;
+    m->slave.read = slave_read;
+}
+
+void fdc_model_attach(fdc_model_t *m)
+{
+    sim_i2c_attach(&m->slave);
+    m->intb_low = 0;
+    sim_gpio_drive(m->intb_port, m->intb_pin, GPIO_PIN_SET);
+}
@@ -0,0 +1,1524 @@
+/*
+ * hal_stub.c
+ * 主机仿真用的 HAL 替身实现（虚拟时钟 / NVIC / I2C / UART / TIM / GPIO / ADC）
+ *
+ * 说明：
+ * - 只实现 Core/ 用到的函数，语义按 STM32F1 HAL 的可观察行为：返回值、句柄 State、
+ *   忙时返回 HAL_BUSY、中断传输完成后在“中断上下文”里调用弱回调；
+ * - 时间为离散事件虚拟时钟（见 sim_hal.h）：外设到期事件只置标志并挂起 NVIC，
+ *   由 deliver_irqs() 在 PRIMASK = 0 且不在中断中时按优先级调用对应的 IRQ 处理；
+ * - I2C 事务按字节转发给挂接的从机模型（sim_i2c_attach），地址无应答时返回 HAL_ERROR，
+ *   总线耗时按 9 bit/字节 + 起始/停止位计算；阻塞接口把时间推进到传输结束，
+ *   中断接口登记完成事件，到期后经 I2C1_EV（或 AF 时经 I2C1_ER）回调；
+ * - UART 发送写入 sink 并按 10 bit/字节计时：HAL_UART_Transmit 阻塞到发完；HAL_UART_Transmit_DMA
+ *   立即返回，发完后依次经 DMA 通道中断（TC）与 USART1 中断（TC）回调 HAL_UART_TxCpltCallback，
+ *   两个中断都必须在 NVIC 中使能，与真实 HAL 相同；接收字节由 sim_uart_inject() 注入，按字节时间
+ *   逐个到达 DR：与真实芯片一样，只有 NVIC 使能了 USART1_IRQn 才会取走，未取走时下一个字节记为溢出；
+ *   HAL_UARTEx_ReceiveToIdle_DMA 期间字节由 DMA 直接写入缓冲区，半满 / 满经 DMA 通道中断、
+ *   最后一个字节后空闲一个字符时间经 USART1 中断（IDLE）回调 HAL_UARTEx_RxEventCallback；
+ * - TIM 模拟更新事件与 CC1 比较事件：周期 = (PSC+1)(ARR+1) / 72 MHz，CC1 在更新后 CCR1 个 tick；
+ *   PSC / ARR / CCR1 按预装载处理，在更新事件（及启动时）锁存。事件置 SR 标志，UIE 挂起中断，
+ *   UDE / CC1DE 向 TIM_HandleTypeDef.hdma[] 链接的 DMA 通道发出一次请求；
+ * - HAL_DMA_Start 启动的通道每次请求按 CCR 的方向 / 位宽 / 递增搬运一个数据，循环模式计数归零后重装；
+ *   目标为 GPIOx->BSRR / BRR 时按置位 / 复位作用到 ODR，与 HAL_GPIO_WritePin 走同一路径，
+ *   sim_gpio_watch_bridge() 监视的 H 桥输入在这里统计直通、死区与半周期；
+ * - TIM2 的 CR2.MMS = 更新时，每次更新事件输出 TRGO；TIM3 处于外部时钟模式 1（SMS = 111、
+ *   TS = ITR1）时不按时间计数，而是每个 TRGO 计一次，计满 ARR+1 个产生更新事件，
+ *   计到 CCR1 产生 CC1 事件（两个定时器同源时钟串联，与芯片上的 ITR 连接相同）；
+ * - H 桥等效驱动电压 = 极性（IN1/IN2）× TIM2 CH1 当前周期的占空比，每次变化记录一段，
+ *   sim_bridge_harmonics() 按最近的整周期计算谐波。
+ */
+
+#include "sim_hal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+GPIO_TypeDef sim_GPIOA, sim_GPIOB, sim_GPIOC;
+TIM_TypeDef sim_TIM2, sim_TIM3;
+USART_TypeDef sim_USART1;
+I2C_TypeDef sim_I2C1;
+ADC_TypeDef sim_ADC1;
+DMA_Channel_TypeDef sim_DMA1_Channel[7];
+CoreDebug_Type sim_CoreDebug;
+static DWT_Type s_dwt;
+
+#define SIM_MAX_SLAVES   4U
+#define SIM_TIM_CLK_HZ   72000000ULL   /* APB1 = 36 MHz，定时器时钟 ×2 */
+#define SIM_I2C_BUF_LEN  260U
+#define SIM_NVIC_NUM     64
+#define SIM_TICK_NS      1000000ULL    /* SysTick 1 ms */
+/* 连续这么多次 HAL 调用没有任何事件或中断，视为主循环空转，快进到下一个事件 */
+#define SIM_IDLE_CALLS   32U
+
+/* ---------------- 虚拟时钟、事件队列与 NVIC ---------------- */
+
+static uint64_t s_now;
+static sim_event_t *s_evq;          /* 按到期时间升序，同一时刻先登记先执行 */
+static uint32_t s_cpu_ns = 1000U;
+static uint32_t s_idle_calls;
+
+static uint32_t s_primask;
+/* 正在执行 IRQ 处理（不模拟抢占，期间不再投递） */
+static uint8_t s_in_isr;
+static uint8_t s_nvic_prio[SIM_NVIC_NUM];
+static uint64_t s_nvic_enabled;
+static uint64_t s_nvic_pending;
+
+static uint64_t s_deadline_ns = UINT64_MAX;
+static int (*s_on_end)(void);
+static uint8_t s_ending;
+static int s_realtime;
+static struct timespec s_host_t0;
+
+static sim_hal_stats_t s_stats;
+
+/* ---------------- GPIO / EXTI ---------------- */
+
+static GPIO_TypeDef *const s_ports[] = { &sim_GPIOA, &sim_GPIOB, &sim_GPIOC };
+/* 被外部模型驱动的引脚，上拉配置不会覆盖其电平 */
+static uint16_t s_driven[3];
+static GPIO_TypeDef *s_exti_port[16];
+static uint16_t s_exti_rising;
+static uint16_t s_exti_falling;
+static uint16_t s_exti_pending;     /* EXTI->PR */
+
+/* ---------------- I2C ---------------- */
+
+static sim_i2c_slave_t *s_slaves[SIM_MAX_SLAVES];
+static uint8_t s_slave_num;
+static uint32_t s_i2c_clock_hz;
+/* 进行中的中断方式传输（单总线） */
+static struct {
+    I2C_HandleTypeDef *h;
+    sim_event_t ev;
+    uint8_t nack;
+    uint8_t done;
+} s_i2c_it;
+
+/* ---------------- UART ---------------- */
+
+static FILE *s_uart_sink;
+static int s_uart_ideal;
+static uint32_t s_uart_baud = 115200U;
+static char s_rx_queue[1024];
+static uint16_t s_rx_head, s_rx_tail;
+static sim_event_t s_rx_ev;
+static uint8_t s_uart_dr;
+static uint8_t s_uart_rxne;
+static UART_HandleTypeDef *s_uart_rx;
+/* DMA 接收（HAL_UARTEx_ReceiveToIdle_DMA）：ht / tc = 通道半满 / 满，idle = 线路空闲 */
+static struct {
+    UART_HandleTypeDef *h;
+    sim_event_t idle_ev;
+    uint8_t ht;
+    uint8_t tc;
+    uint8_t idle;
+} s_uart_rxdma;
+/* 进行中的 DMA 发送：dma_tc = DMA 通道传输完成，uart_tc = 最后一个字节移出 */
+static struct {
+    UART_HandleTypeDef *h;
+    sim_event_t ev;
+    uint8_t dma_tc;
+    uint8_t uart_tc;
+} s_uart_tx;
+
+/* H 桥输入监视（sim_gpio_watch_bridge） */
+static struct {
+    GPIO_TypeDef *port;
+    uint16_t pin_a, pin_b;
+    uint16_t last_on;       /* 最近一次为高的那一路 */
+    uint8_t off_valid;      /* 已记录本次死区的起点 */
+    uint8_t rise_valid;
+    uint64_t off_ns;
+    uint64_t rise_ns;
+    uint64_t comm_ns[64];   /* 最近的换向时刻（环形，下标 = 换向序号 % 64） */
+} s_bridge;
+
+/* 等效驱动电压的分段记录（环形，下标 = 段序号 % SIM_DRIVE_SEGS），电平 65536 = 满幅 */
+#define SIM_DRIVE_SEGS  65536U
+static struct {
+    uint64_t t_ns;
+    int32_t level;
+} s_drive_seg[SIM_DRIVE_SEGS];
+static uint32_t s_drive_seg_n;
+/* 驱动电平变化的监听者（执行器模型） */
+static void (*s_level_fn)(void *ctx, uint64_t t_ns, double level);
+static void *s_level_ctx;
+
+/* ---------------- DMA ---------------- */
+
+#define SIM_DMA_CCR_EN   0x00000001U
+
+/* HAL_DMA_Start 给出的主机地址（寄存器块里的 CPAR / CMAR 只有 32 bit） */
+static struct {
+    uintptr_t src;
+    uintptr_t dst;
+    uint32_t len;
+} s_dma_xfer[7];
+
+/* ---------------- TIM / ADC ---------------- */
+
+static struct {
+    TIM_HandleTypeDef *h;
+    sim_event_t ev;         /* 更新事件 */
+    sim_event_t cc1_ev;     /* CC1 比较事件 */
+    uint32_t psc, arr, ccr1;  /* 影子寄存器 */
+    uint32_t cnt;             /* 外部时钟模式下的计数值 */
+    uint64_t rem;             /* 周期换算为 ns 的余数（单位 1/72 ns），逐周期累积，平均周期不因截断而偏短 */
+    uint64_t t0;              /* 当前周期开始（计数为 0）的时刻 */
+} s_tim[2];
+
+static uint16_t s_adc_value = 2048U;
+
+
+static int port_index(const GPIO_TypeDef *port)
+{
+    for (int i = 0; i < (int)(sizeof(s_ports) / sizeof(s_ports[0])); ++i) {
+        if (s_ports[i] == port) return i;
+    }
+    return -1;
+}
+
+static int pin_index(uint16_t pin)
+{
+    return pin ? __builtin_ctz(pin) : 0;
+}
+
+static IRQn_Type exti_irqn(int idx)
+{
+    if (idx <= 4) return (IRQn_Type)(EXTI0_IRQn + idx);
+    if (idx <= 9) return EXTI9_5_IRQn;
+    return EXTI15_10_IRQn;
+}
+
+/* 按影子寄存器中的 PSC 计算 ticks 个计数的时间 */
+static uint64_t tim_ticks_ns(int slot, uint64_t ticks)
+{
+    return ticks * ((uint64_t)s_tim[slot].psc + 1U) * 1000000000ULL / SIM_TIM_CLK_HZ;
+}
+
+static uint64_t uart_byte_ns(void)
+{
+    return 10ULL * 1000000000ULL / s_uart_baud;
+}
+
+/* 一次 I2C 事务的总线时间：bytes 个字节（含地址字节）+ conds 个起始/重复起始/停止条件 */
+static uint64_t i2c_bus_ns(const I2C_HandleTypeDef *hi2c, uint32_t bytes, uint32_t conds)
+{
+    uint32_t hz = s_i2c_clock_hz ? s_i2c_clock_hz : hi2c->Init.ClockSpeed;
+    if (hz == 0) hz = 100000U;
+    return ((uint64_t)bytes * 9U + conds) * 1000000000ULL / hz;
+}
+
+static sim_i2c_slave_t *i2c_find(uint16_t addr_hal)
+{
+    for (uint8_t i = 0; i < s_slave_num; ++i) {
+        if (s_slaves[i]->addr_hal == (addr_hal & 0xFEU)) return s_slaves[i];
+    }
+    return NULL;
+}
+
+
+/* ---------------- IRQ 处理（相当于 stm32f1xx_it.c） ---------------- */
+
+static void irq_exti(IRQn_Type irqn)
+{
+    for (int idx = 0; idx < 16; ++idx) {
+        uint16_t pin = (uint16_t)(1U << idx);
+        if (exti_irqn(idx) != irqn || !(s_exti_pending & pin)) continue;
+        s_stats.irq_exti++;
+        HAL_GPIO_EXTI_IRQHandler(pin);
+    }
+}
+
+static void irq_i2c(IRQn_Type irqn)
+{
+    I2C_HandleTypeDef *h = s_i2c_it.h;
+    if (h == NULL || !s_i2c_it.done) return;
+    if ((irqn == I2C1_ER_IRQn) != (s_i2c_it.nack != 0)) return;
+    s_i2c_it.h = NULL;
+    h->State = HAL_I2C_STATE_READY;
+    s_stats.irq_i2c++;
+    if (s_i2c_it.nack) {
+        h->ErrorCode = HAL_I2C_ERROR_AF;
+        HAL_I2C_ErrorCallback(h);
+    } else {
+        HAL_I2C_MemRxCpltCallback(h);
+    }
+}
+
+static void irq_tim(int slot)
+{
+    TIM_HandleTypeDef *h = s_tim[slot].h;
+    if (h == NULL || !(h->Instance->SR & 1U) || !(h->Instance->DIER & 1U)) return;
+    h->Instance->SR &= ~1U;
+    s_stats.irq_tim++;
+    HAL_TIM_PeriodElapsedCallback(h);
+}
+
+static IRQn_Type dma_irqn(const DMA_HandleTypeDef *hdma)
+{
+    return (IRQn_Type)(DMA1_Channel1_IRQn + (hdma->Instance - sim_DMA1_Channel));
+}
+
+static void irq_dma(IRQn_Type irqn)
+{
+    UART_HandleTypeDef *r = s_uart_rxdma.h;
+    if (r != NULL && dma_irqn(r->hdmarx) == irqn && (s_uart_rxdma.ht || s_uart_rxdma.tc)) {
+        s_stats.irq_dma++;
+        /* 与 HAL 相同：HT 回调 Size = 一半，TC 回调 Size = 全长 */
+        if (s_uart_rxdma.ht) {
+            s_uart_rxdma.ht = 0;
+            HAL_UARTEx_RxEventCallback(r, (uint16_t)(r->RxXferSize / 2U));
+        }
+        if (s_uart_rxdma.tc) {
+            s_uart_rxdma.tc = 0;
+            if (!(r->hdmarx->Instance->CCR & DMA_CIRCULAR)) {
+                s_uart_rxdma.h = NULL;
+                r->hdmarx->State = HAL_DMA_STATE_READY;
+                r->RxState = HAL_UART_STATE_READY;
+            }
+            HAL_UARTEx_RxEventCallback(r, r->RxXferSize);
+        }
+    }
+
+    UART_HandleTypeDef *h = s_uart_tx.h;
+    if (h == NULL || !s_uart_tx.dma_tc) return;
+    if (dma_irqn(h->hdmatx) != irqn) return;
+    s_uart_tx.dma_tc = 0;
+    h->hdmatx->Instance->CCR &= ~1U;
+    h->hdmatx->State = HAL_DMA_STATE_READY;
+    s_stats.irq_dma++;
+    /* HAL 在 DMA 完成回调里打开 TCIE，USART 的 TC 中断再结束传输 */
+    s_uart_tx.uart_tc = 1;
+    sim_irq_pend(USART1_IRQn);
+}
+
+static void irq_usart1(void)
+{
+    if (s_uart_tx.uart_tc) {
+        UART_HandleTypeDef *t = s_uart_tx.h;
+        s_uart_tx.uart_tc = 0;
+        s_uart_tx.h = NULL;
+        t->gState = HAL_UART_STATE_READY;
+        s_stats.irq_uart++;
+        HAL_UART_TxCpltCallback(t);
+    }
+
+    if (s_uart_rxdma.idle) {
+        UART_HandleTypeDef *r = s_uart_rxdma.h;
+        s_uart_rxdma.idle = 0;
+        s_stats.irq_uart++;
+        if (r != NULL) {
+            /* HAL 只在缓冲区中有未回调过的数据时回调（正好写满回绕时已由 TC 回调） */
+            uint16_t remaining = (uint16_t)r->hdmarx->Instance->CNDTR;
+            if (remaining > 0U && remaining < r->RxXferSize) {
+                HAL_UARTEx_RxEventCallback(r, (uint16_t)(r->RxXferSize - remaining));
+            }
+        }
+    }
+
+    UART_HandleTypeDef *h = s_uart_rx;
+    if (h == NULL || !s_uart_rxne) return;
+    *h->pRxBuffPtr++ = s_uart_dr;
+    s_uart_rxne = 0;
+    s_stats.irq_uart++;
+    if (--h->RxXferCount == 0) {
+        s_uart_rx = NULL;
+        h->RxState = HAL_UART_STATE_READY;
+        HAL_UART_RxCpltCallback(h);
+    }
+}
+
+static void irq_dispatch(IRQn_Type irqn)
+{
+    switch (irqn) {
+        case EXTI0_IRQn: case EXTI1_IRQn: case EXTI2_IRQn: case EXTI3_IRQn: case EXTI4_IRQn:
+        case EXTI9_5_IRQn: case EXTI15_10_IRQn:
+            irq_exti(irqn);
+            break;
+        case I2C1_EV_IRQn: case I2C1_ER_IRQn: irq_i2c(irqn); break;
+        case TIM2_IRQn: irq_tim(0); break;
+        case TIM3_IRQn: irq_tim(1); break;
+        case USART1_IRQn: irq_usart1(); break;
+        case DMA1_Channel1_IRQn: case DMA1_Channel2_IRQn: case DMA1_Channel3_IRQn: case DMA1_Channel4_IRQn:
+        case DMA1_Channel5_IRQn: case DMA1_Channel6_IRQn: case DMA1_Channel7_IRQn:
+            irq_dma(irqn);
+            break;
+        default: break;
+    }
+}
+
+/* 按优先级（数值小者先，同级 IRQn 小者先）投递所有已挂起且使能的中断 */
+static void deliver_irqs(void)
+{
+    while (!s_primask && !s_in_isr && !s_ending) {
+        uint64_t ready = s_nvic_pending & s_nvic_enabled;
+        if (ready == 0) break;
+        int best = -1;
+        for (int n = 0; n < SIM_NVIC_NUM; ++n) {
+            if ((ready >> n) & 1U) {
+                if (best < 0 || s_nvic_prio[n] < s_nvic_prio[best]) best = n;
+            }
+        }
+        s_nvic_pending &= ~(1ULL << best);
+        s_idle_calls = 0;
+        s_in_isr = 1;
+        irq_dispatch((IRQn_Type)best);
+        s_in_isr = 0;
+    }
+}
+
+static void i2c_it_event(void *ctx);
+static void uart_rx_event(void *ctx);
+static void uart_idle_event(void *ctx);
+static void uart_tx_event(void *ctx);
+static void tim_update_event(void *ctx);
+static void tim_cc1_event(void *ctx);
+
+static void finish_run(void)
+{
+    int (*on_end)(void) = s_on_end;
+    s_on_end = NULL;
+    s_ending = 1;   /* 报告期间 HAL 调用不再推进时间、不再投递中断 */
+    int rc = on_end ? on_end() : 0;
+    fflush(NULL);
+    exit(rc);
+}
+
+
+/* ---------------- 仿真控制接口 ---------------- */
+
+void sim_hal_init(void)
+{
+    s_now = 0;
+    s_uart_sink = stdout;
+    clock_gettime(CLOCK_MONOTONIC, &s_host_t0);
+    sim_event_init(&s_i2c_it.ev, i2c_it_event, NULL);
+    sim_event_init(&s_rx_ev, uart_rx_event, NULL);
+    sim_event_init(&s_uart_rxdma.idle_ev, uart_idle_event, NULL);
+    sim_event_init(&s_uart_tx.ev, uart_tx_event, NULL);
+    for (int i = 0; i < 2; ++i) {
+        sim_event_init(&s_tim[i].ev, tim_update_event, (void *)(intptr_t)i);
+        sim_event_init(&s_tim[i].cc1_ev, tim_cc1_event, (void *)(intptr_t)i);
+    }
+    s_stats.bridge_dead_min_ns = UINT64_MAX;
+    s_stats.bridge_half_min_ns = UINT64_MAX;
+}
+
+void sim_set_realtime(int on)
+{
+    s_realtime = on;
+}
+
+double sim_host_seconds(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)(t.tv_sec - s_host_t0.tv_sec) + (double)(t.tv_nsec - s_host_t0.tv_nsec) * 1e-9;
+}
+
+/* 实时模式：虚拟时间领先主机时间超过 1 ms 时睡眠等待，便于接串口终端交互 */
+static void pace_realtime(void)
+{
+    double ahead = (double)s_now * 1e-9 - sim_host_seconds();
+    if (ahead > 1e-3) {
+        struct timespec d = { (time_t)ahead, (long)((ahead - (double)(time_t)ahead) * 1e9) };
+        nanosleep(&d, NULL);
+    }
+}
+
+uint64_t sim_now_ns(void)
+{
+    return s_now;
+}
+
+void sim_set_cpu_ns(uint32_t ns)
+{
+    s_cpu_ns = ns;
+}
+
+void sim_set_deadline(uint64_t ns, int (*on_end)(void))
+{
+    s_deadline_ns = ns;
+    s_on_end = on_end;
+}
+
+void sim_event_init(sim_event_t *ev, void (*fn)(void *ctx), void *ctx)
+{
+    memset(ev, 0, sizeof(*ev));
+    ev->fn = fn;
+    ev->ctx = ctx;
+}
+
+void sim_event_cancel(sim_event_t *ev)
+{
+    if (!ev->queued) return;
+    for (sim_event_t **pp = &s_evq; *pp != NULL; pp = &(*pp)->next) {
+        if (*pp == ev) {
+            *pp = ev->next;
+            break;
+        }
+    }
+    ev->next = NULL;
+    ev->queued = 0;
+}
+
+void sim_event_schedule(sim_event_t *ev, uint64_t t_ns)
+{
+    sim_event_cancel(ev);
+    if (t_ns < s_now) t_ns = s_now;
+    ev->t_ns = t_ns;
+    sim_event_t **pp = &s_evq;
+    while (*pp != NULL && (*pp)->t_ns <= t_ns) pp = &(*pp)->next;
+    ev->next = *pp;
+    *pp = ev;
+    ev->queued = 1;
+}
+
+void sim_irq_pend(IRQn_Type irqn)
+{
+    if (irqn >= 0 && irqn < SIM_NVIC_NUM) s_nvic_pending |= 1ULL << irqn;
+}
+
+/*
+ * 推进到 t_ns：依次执行到期事件，每个事件之后投递它挂起的中断。
+ * IRQ 处理中的 HAL 调用会嵌套进入本函数，事件出队在执行之前，嵌套是安全的。
+ */
+void sim_advance_to(uint64_t t_ns)
+{
+    if (s_ending) return;
+    if (t_ns < s_now) t_ns = s_now;
+    while (s_evq != NULL && s_evq->t_ns <= t_ns && s_evq->t_ns <= s_deadline_ns) {
+        sim_event_t *ev = s_evq;
+        s_evq = ev->next;
+        ev->next = NULL;
+        ev->queued = 0;
+        if (ev->t_ns > s_now) s_now = ev->t_ns;
+        s_stats.events++;
+        s_idle_calls = 0;
+        ev->fn(ev->ctx);
+        deliver_irqs();
+    }
+    if (t_ns >= s_deadline_ns) {
+        s_now = s_deadline_ns;
+        finish_run();
+    }
+    if (t_ns > s_now) s_now = t_ns;
+    deliver_irqs();
+    if (s_realtime) pace_realtime();
+}
+
+/*
+ * 固件每次调用 HAL 时执行：消耗 cpu_ns；连续 SIM_IDLE_CALLS 次无事可做则快进到
+ * 下一个事件或下一个 SysTick 边界（取早者），与 WFI 被 SysTick 或外设中断唤醒一致，
+ * 因此按 HAL_GetTick() 轮询的周期任务不会被跳过。
+ */
+void sim_service(void)
+{
+    if (s_ending) return;
+    s_stats.hal_calls++;
+    uint64_t t = s_now + s_cpu_ns;
+    if (++s_idle_calls >= SIM_IDLE_CALLS) {
+        uint64_t wake = (s_now / SIM_TICK_NS + 1U) * SIM_TICK_NS;
+        if (s_evq != NULL && s_evq->t_ns < wake) wake = s_evq->t_ns;
+        if (wake > t) {
+            t = wake;
+            s_stats.idle_skips++;
+        }
+        s_idle_calls = 0;
+    }
+    sim_advance_to(t);
+}
+
+void sim_i2c_attach(sim_i2c_slave_t *slave)
+{
+    if (s_slave_num < SIM_MAX_SLAVES) s_slaves[s_slave_num++] = slave;
+}
+
+void sim_i2c_set_clock(uint32_t hz)
+{
+    s_i2c_clock_hz = hz;
+}
+
+void sim_uart_set_sink(FILE *sink)
+{
+    s_uart_sink = sink;
+}
+
+void sim_uart_set_ideal(int ideal)
+{
+    s_uart_ideal = ideal;
+}
+
+/* DMA 取走一个接收字节：写入缓冲区，半满 / 满时置标志并挂起通道中断，循环模式满后回绕 */
+static void uart_rx_dma_write(uint8_t c)
+{
+    UART_HandleTypeDef *h = s_uart_rxdma.h;
+    DMA_Channel_TypeDef *ch = h->hdmarx->Instance;
+    h->pRxBuffPtr[h->RxXferSize - ch->CNDTR] = c;
+    if (--ch->CNDTR == 0U) {
+        if (ch->CCR & DMA_CIRCULAR) ch->CNDTR = h->RxXferSize;
+        else ch->CCR &= ~1U;
+        s_uart_rxdma.tc = 1;
+        sim_irq_pend(dma_irqn(h->hdmarx));
+    } else if (ch->CNDTR == (uint32_t)(h->RxXferSize - h->RxXferSize / 2U)) {
+        s_uart_rxdma.ht = 1;
+        sim_irq_pend(dma_irqn(h->hdmarx));
+    }
+}
+
+/* 接收字节到达 DR：
+ * - DMA 接收中由 DMA 立即取走，之后一个字符时间内没有新字节则置 IDLE；
+ * - 否则上一个字节未被取走则溢出（ORE），使能接收中断时挂起 USART1 */
+static void uart_rx_event(void *ctx)
+{
+    (void)ctx;
+    if (s_rx_tail == s_rx_head) return;
+    uint8_t c = (uint8_t)s_rx_queue[s_rx_tail];
+    s_rx_tail = (uint16_t)((s_rx_tail + 1U) % sizeof(s_rx_queue));
+    int more = (s_rx_tail != s_rx_head);
+    if (s_uart_rxdma.h != NULL) {
+        uart_rx_dma_write(c);
+        if (more) sim_event_cancel(&s_uart_rxdma.idle_ev);
+        else sim_event_schedule(&s_uart_rxdma.idle_ev, s_now + uart_byte_ns());
+    } else {
+        if (s_uart_rxne) s_stats.uart_rx_overrun++;
+        s_uart_dr = c;
+        s_uart_rxne = 1;
+        if (s_uart_rx != NULL) sim_irq_pend(USART1_IRQn);
+    }
+    if (more) sim_event_schedule(&s_rx_ev, s_now + uart_byte_ns());
+}
+
+static void uart_idle_event(void *ctx)
+{
+    (void)ctx;
+    if (s_uart_rxdma.h == NULL) return;
+    s_uart_rxdma.idle = 1;
+    sim_irq_pend(USART1_IRQn);
+}
+
+void sim_uart_inject(const char *text)
+{
+    for (; *text; ++text) {
+        uint16_t next = (uint16_t)((s_rx_head + 1U) % sizeof(s_rx_queue));
+        if (next == s_rx_tail) break;
+        s_rx_queue[s_rx_head] = *text;
+        s_rx_head = next;
+    }
+    if (!s_rx_ev.queued && s_rx_tail != s_rx_head) sim_event_schedule(&s_rx_ev, s_now + uart_byte_ns());
+}
+
+void sim_adc_set_value(uint16_t value)
+{
+    s_adc_value = (uint16_t)(value & 0x0FFFU);
+}
+
+const sim_hal_stats_t *sim_hal_get_stats(void)
+{
+    return &s_stats;
+}
+
+void sim_gpio_watch_bridge(GPIO_TypeDef *port, uint16_t pin_a, uint16_t pin_b)
+{
+    s_bridge.port = port;
+    s_bridge.pin_a = pin_a;
+    s_bridge.pin_b = pin_b;
+}
+
+void sim_gpio_drive(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState level)
+{
+    int p = port_index(port);
+    if (p < 0) return;
+    s_driven[p] |= pin;
+
+    uint16_t old = (uint16_t)(port->IDR & pin);
+    if (level == GPIO_PIN_SET) port->IDR |= pin;
+    else port->IDR &= ~(uint32_t)pin;
+
+    int idx = pin_index(pin);
+    if (s_exti_port[idx] != port) return;
+    if ((old && level == GPIO_PIN_RESET && (s_exti_falling & pin)) ||
+        (!old && level == GPIO_PIN_SET && (s_exti_rising & pin))) {
+        s_exti_pending |= pin;
+        sim_irq_pend(exti_irqn(idx));
+    }
+}
+
+
+/* ---------------- Cortex-M3 内核 ---------------- */
+
+uint32_t __get_PRIMASK(void)
+{
+    return s_primask;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    s_primask = primask & 1U;
+    if (!s_primask) sim_service();
+}
+
+void __disable_irq(void)
+{
+    s_primask = 1;
+}
+
+void __enable_irq(void)
+{
+    s_primask = 0;
+    sim_service();
+}
+
+/* 睡眠到下一个事件或 SysTick；PRIMASK 置位时挂起的中断同样唤醒 CPU */
+void __WFI(void)
+{
+    uint64_t wake = (s_now / SIM_TICK_NS + 1U) * SIM_TICK_NS;
+    if (s_evq != NULL && s_evq->t_ns < wake) wake = s_evq->t_ns;
+    if (s_nvic_pending & s_nvic_enabled) wake = s_now;
+    s_idle_calls = 0;
+    sim_advance_to(wake);
+}
+
+/* CYCCNT 在 TRCENA 与 CYCCNTENA 都置位时才计数，取虚拟时间折算为 72 MHz 周期 */
+DWT_Type *sim_dwt(void)
+{
+    if ((sim_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (s_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        s_dwt.CYCCNT = (uint32_t)(s_now * (SIM_TIM_CLK_HZ / 1000000U) / 1000U);
+    }
+    return &s_dwt;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    if (IRQn >= 0 && IRQn < SIM_NVIC_NUM) s_nvic_prio[IRQn] = (uint8_t)(((PreemptPriority & 0xFU) << 4) | (SubPriority & 0xFU));
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn >= 0 && IRQn < SIM_NVIC_NUM) s_nvic_enabled |= 1ULL << IRQn;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn >= 0 && IRQn < SIM_NVIC_NUM) s_nvic_enabled &= ~(1ULL << IRQn);
+}
+
+
+/* ---------------- HAL 公共 / RCC ---------------- */
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+    return HAL_OK;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    sim_service();
+    return (uint32_t)(s_now / SIM_TICK_NS);
+}
+
+/* 与 HAL 一致：至少等待 Delay + 1 个 tick，时间直接推进到到期的 tick 边界 */
+void HAL_Delay(uint32_t Delay)
+{
+    uint32_t tickstart = HAL_GetTick();
+    uint32_t wait = Delay;
+    if (wait < HAL_MAX_DELAY) wait += 1U;
+    sim_advance_to(((uint64_t)tickstart + wait) * SIM_TICK_NS);
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+    (void)RCC_OscInitStruct;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+    (void)RCC_ClkInitStruct;
+    (void)FLatency;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit)
+{
+    (void)PeriphClkInit;
+    return HAL_OK;
+}
+
+/* 固定为 main.c SystemClock_Config 的配置：HSE 8 MHz × 9，APB1 ÷2，APB2 ÷1 */
+uint32_t HAL_RCC_GetSysClockFreq(void) { return 72000000U; }
+uint32_t HAL_RCC_GetHCLKFreq(void) { return 72000000U; }
+uint32_t HAL_RCC_GetPCLK1Freq(void) { return 36000000U; }
+uint32_t HAL_RCC_GetPCLK2Freq(void) { return 72000000U; }
+
+void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t *pFLatency)
+{
+    RCC_ClkInitStruct->ClockType = RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+    RCC_ClkInitStruct->SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+    RCC_ClkInitStruct->AHBCLKDivider = RCC_SYSCLK_DIV1;
+    RCC_ClkInitStruct->APB1CLKDivider = RCC_HCLK_DIV2;
+    RCC_ClkInitStruct->APB2CLKDivider = RCC_HCLK_DIV1;
+    *pFLatency = FLASH_LATENCY_2;
+}
+
+
+/* ---------------- GPIO ---------------- */
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    int p = port_index(GPIOx);
+    for (int idx = 0; idx < 16; ++idx) {
+        uint16_t pin = (uint16_t)(1U << idx);
+        if (!(GPIO_Init->Pin & pin)) continue;
+        if ((GPIO_Init->Mode & 0x10000000U) != 0U) {
+            s_exti_port[idx] = GPIOx;
+            if (GPIO_Init->Mode & 0x00100000U) s_exti_rising |= pin;
+            else s_exti_rising &= (uint16_t)~pin;
+            if (GPIO_Init->Mode & 0x00200000U) s_exti_falling |= pin;
+            else s_exti_falling &= (uint16_t)~pin;
+        }
+        /* 没有外部驱动的输入引脚按上/下拉决定电平 */
+        if (p >= 0 && !(s_driven[p] & pin)) {
+            if (GPIO_Init->Pull == GPIO_PULLUP) GPIOx->IDR |= pin;
+            else if (GPIO_Init->Pull == GPIO_PULLDOWN) GPIOx->IDR &= ~(uint32_t)pin;
+        }
+    }
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    sim_service();
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+/* 输出引脚的 IDR 跟随 ODR（F1 上读输出引脚得到的是引脚实际电平） */
+/* 一次 H 桥输入电平变化：两路同时为高记为直通；一路拉低到另一路置高之间为死区，
+ * 相邻两次换向（置高的那一路改变）之间为半周期 */
+static void bridge_edge(uint32_t odr)
+{
+    uint16_t on = (uint16_t)(odr & (s_bridge.pin_a | s_bridge.pin_b));
+    s_stats.bridge_edges++;
+    if (on == (s_bridge.pin_a | s_bridge.pin_b)) {
+        s_stats.bridge_overlap++;
+        s_bridge.off_valid = 0;
+        return;
+    }
+    if (on == 0U) {
+        s_bridge.off_ns = s_now;
+        s_bridge.off_valid = 1;
+        return;
+    }
+    if (on == s_bridge.last_on) return;
+    if (s_bridge.off_valid) {
+        uint64_t dead = s_now - s_bridge.off_ns;
+        if (dead < s_stats.bridge_dead_min_ns) s_stats.bridge_dead_min_ns = dead;
+        if (dead > s_stats.bridge_dead_max_ns) s_stats.bridge_dead_max_ns = dead;
+    } else if (s_bridge.last_on != 0U) {
+        /* 没有经过双低直接换向：死区为 0 */
+        s_stats.bridge_dead_min_ns = 0;
+    }
+    if (s_bridge.rise_valid) {
+        uint64_t half = s_now - s_bridge.rise_ns;
+        if (half < s_stats.bridge_half_min_ns) s_stats.bridge_half_min_ns = half;
+        if (half > s_stats.bridge_half_max_ns) s_stats.bridge_half_max_ns = half;
+    }
+    s_bridge.comm_ns[s_stats.bridge_commutations % 64U] = s_now;
+    if (s_stats.bridge_commutations++ == 0U) s_stats.bridge_first_ns = s_now;
+    s_stats.bridge_last_ns = s_now;
+    s_bridge.rise_ns = s_now;
+    s_bridge.rise_valid = 1;
+    s_bridge.last_on = on;
+    s_bridge.off_valid = 0;
+}
+
+/* 等效驱动电压变化时记一段：一路为高时取 ±占空比（TIM2 CH1 未输出时按满幅），两路同为低 / 高时为 0 */
+static void drive_level_update(void)
+{
+    if (s_bridge.port == NULL) return;
+    uint32_t on = s_bridge.port->ODR & (uint32_t)(s_bridge.pin_a | s_bridge.pin_b);
+    int32_t amp = 65536;
+    if (s_tim[0].h != NULL && (TIM2->CCER & 1U)) {
+        uint64_t ccr = s_tim[0].ccr1 > s_tim[0].arr ? (uint64_t)s_tim[0].arr + 1U : s_tim[0].ccr1;
+        amp = (int32_t)((ccr << 16) / ((uint64_t)s_tim[0].arr + 1U));
+    }
+    int32_t level = (on == s_bridge.pin_a) ? amp : (on == s_bridge.pin_b) ? -amp : 0;
+    if (s_drive_seg_n != 0U && s_drive_seg[(s_drive_seg_n - 1U) % SIM_DRIVE_SEGS].level == level) return;
+    s_drive_seg[s_drive_seg_n % SIM_DRIVE_SEGS].t_ns = s_now;
+    s_drive_seg[s_drive_seg_n % SIM_DRIVE_SEGS].level = level;
+    s_drive_seg_n++;
+    if (s_level_fn != NULL) s_level_fn(s_level_ctx, s_now, (double)level / 65536.0);
+}
+
+void sim_bridge_on_level(void (*fn)(void *ctx, uint64_t t_ns, double level), void *ctx)
+{
+    s_level_fn = fn;
+    s_level_ctx = ctx;
+}
+
+uint32_t sim_bridge_harmonics(double *mag, uint32_t kmax)
+{
+    uint32_t nc = s_stats.bridge_commutations;
+    if (nc < 3U || s_drive_seg_n == 0U) return 0;
+    uint32_t first_seg = s_drive_seg_n > SIM_DRIVE_SEGS ? s_drive_seg_n - SIM_DRIVE_SEGS : 0U;
+    uint64_t oldest = s_drive_seg[first_seg % SIM_DRIVE_SEGS].t_ns;
+    /* 窗口：最近一次换向往前偶数个半周期，起点仍在记录范围内 */
+    uint32_t m = (nc - 1U < 63U) ? nc - 1U : 63U;
+    m &= ~1U;
+    uint64_t t1 = s_bridge.comm_ns[(nc - 1U) % 64U];
+    while (m >= 2U && s_bridge.comm_ns[(nc - 1U - m) % 64U] < oldest) m -= 2U;
+    if (m < 2U) return 0;
+    uint64_t t0 = s_bridge.comm_ns[(nc - 1U - m) % 64U];
+    double span = (double)(t1 - t0) * 1e-9;
+    double w = 2.0 * 3.14159265358979323846 * (double)(m / 2U) / span;
+
+    for (uint32_t k = 1; k <= kmax; ++k) {
+        double wk = w * k, re = 0.0, im = 0.0;
+        for (uint32_t i = first_seg; i < s_drive_seg_n; ++i) {
+            uint64_t a = s_drive_seg[i % SIM_DRIVE_SEGS].t_ns;
+            uint64_t b = (i + 1U < s_drive_seg_n) ? s_drive_seg[(i + 1U) % SIM_DRIVE_SEGS].t_ns : s_now;
+            if (a < t0) a = t0;
+            if (b > t1) b = t1;
+            if (b <= a) continue;
+            double v = (double)s_drive_seg[i % SIM_DRIVE_SEGS].level / 65536.0;
+            double ta = (double)(a - t0) * 1e-9, tb = (double)(b - t0) * 1e-9;
+            re += v * (sin(wk * tb) - sin(wk * ta));
+            im += v * (cos(wk * tb) - cos(wk * ta));
+        }
+        mag[k - 1U] = 2.0 * sqrt(re * re + im * im) / (wk * span);
+    }
+    return m / 2U;
+}
+
+/* 输出寄存器写入（HAL_GPIO_WritePin、DMA 写 BSRR / BRR）：同时置位与复位时置位优先 */
+static void gpio_output(GPIO_TypeDef *port, uint32_t set, uint32_t reset)
+{
+    uint32_t mask = (set | reset) & 0xFFFFU;
+    uint32_t old = port->ODR;
+    uint32_t odr = ((old & ~reset) | set) & 0xFFFFU;
+    port->ODR = odr;
+    port->IDR = (port->IDR & ~mask) | (odr & mask);
+    if (port == s_bridge.port && ((old ^ odr) & (uint32_t)(s_bridge.pin_a | s_bridge.pin_b))) {
+        bridge_edge(odr);
+        drive_level_update();
+    }
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState != GPIO_PIN_RESET) gpio_output(GPIOx, GPIO_Pin, 0U);
+    else gpio_output(GPIOx, 0U, GPIO_Pin);
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    HAL_GPIO_WritePin(GPIOx, GPIO_Pin, (GPIOx->ODR & GPIO_Pin) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin)
+{
+    if (s_exti_pending & GPIO_Pin) {
+        s_exti_pending &= (uint16_t)~GPIO_Pin;
+        HAL_GPIO_EXTI_Callback(GPIO_Pin);
+    }
+}
+
+__weak void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    (void)GPIO_Pin;
+}
+
+
+/* ---------------- I2C ---------------- */
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    return HAL_OK;
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c)
+{
+    sim_service();
+    return hi2c->State;
+}
+
+/*
+ * 内部工具函数：i2c_run
+ * 执行一次完整事务：寄存器指针与写数据发给从机（tx），再读出 rx_n 字节。
+ * conds 为起始/重复起始/停止条件个数；地址无应答时只计地址字节的总线时间。
+ * 返回 0 成功，-1 NACK；*bus_ns 输出总线占用时间。
+ */
+static int i2c_run(I2C_HandleTypeDef *hi2c, uint16_t addr, const uint8_t *tx, uint16_t tx_n,
+                   uint8_t *rx, uint16_t rx_n, uint64_t *bus_ns)
+{
+    sim_i2c_slave_t *slave = i2c_find(addr);
+    s_stats.i2c_transfers++;
+    if (slave == NULL || (tx_n && slave->write(slave->ctx, tx, tx_n) != 0) ||
+        (rx_n && slave->read(slave->ctx, rx, rx_n) != 0)) {
+        s_stats.i2c_nacks++;
+        *bus_ns = i2c_bus_ns(hi2c, 1U, 2U);
+        return -1;
+    }
+    uint32_t bytes = (tx_n ? 1U + tx_n : 0U) + (rx_n ? 1U + rx_n : 0U);
+    uint32_t conds = (tx_n && rx_n) ? 3U : 2U;
+    *bus_ns = i2c_bus_ns(hi2c, bytes, conds);
+    return 0;
+}
+
+static HAL_StatusTypeDef i2c_blocking(I2C_HandleTypeDef *hi2c, uint16_t addr, const uint8_t *tx, uint16_t tx_n,
+                                      uint8_t *rx, uint16_t rx_n)
+{
+    sim_service();
+    if (hi2c->State != HAL_I2C_STATE_READY) return HAL_BUSY;
+    hi2c->State = rx_n ? HAL_I2C_STATE_BUSY_RX : HAL_I2C_STATE_BUSY_TX;
+    uint64_t ns = 0;
+    int nack = i2c_run(hi2c, addr, tx, tx_n, rx, rx_n, &ns);
+    s_stats.i2c_busy_ns += ns;
+    sim_advance_to(s_now + ns);
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->ErrorCode = nack ? HAL_I2C_ERROR_AF : HAL_I2C_ERROR_NONE;
+    return nack ? HAL_ERROR : HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                          uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+    return i2c_blocking(hi2c, DevAddress, pData, Size, NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                         uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+    return i2c_blocking(hi2c, DevAddress, NULL, 0, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)MemAddSize;
+    (void)Timeout;
+    uint8_t buf[SIM_I2C_BUF_LEN];
+    if (Size + 1U > sizeof(buf)) return HAL_ERROR;
+    buf[0] = (uint8_t)MemAddress;
+    memcpy(&buf[1], pData, Size);
+    return i2c_blocking(hi2c, DevAddress, buf, (uint16_t)(Size + 1U), NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)MemAddSize;
+    (void)Timeout;
+    uint8_t reg = (uint8_t)MemAddress;
+    return i2c_blocking(hi2c, DevAddress, &reg, 1U, pData, Size);
+}
+
+/* 中断方式传输结束：挂起事件或错误中断 */
+static void i2c_it_event(void *ctx)
+{
+    (void)ctx;
+    s_i2c_it.done = 1;
+    sim_irq_pend(s_i2c_it.nack ? I2C1_ER_IRQn : I2C1_EV_IRQn);
+}
+
+/* 中断方式读取：数据在启动时从模型取出，总线时间结束后投递完成（或 AF 错误）回调 */
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                      uint16_t MemAddSize, uint8_t *pData, uint16_t Size)
+{
+    (void)MemAddSize;
+    sim_service();
+    if (hi2c->State != HAL_I2C_STATE_READY || s_i2c_it.h != NULL) return HAL_BUSY;
+    hi2c->State = HAL_I2C_STATE_BUSY_RX;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    hi2c->pBuffPtr = pData;
+    hi2c->XferSize = Size;
+    hi2c->Devaddress = DevAddress;
+    hi2c->Memaddress = MemAddress;
+
+    uint8_t reg = (uint8_t)MemAddress;
+    uint64_t ns = 0;
+    s_i2c_it.nack = (uint8_t)(i2c_run(hi2c, DevAddress, &reg, 1U, pData, Size, &ns) != 0);
+    s_stats.i2c_busy_ns += ns;
+    s_i2c_it.h = hi2c;
+    s_i2c_it.done = 0;
+    sim_event_schedule(&s_i2c_it.ev, s_now + ns);
+    return HAL_OK;
+}
+
+__weak void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+
+/* ---------------- DMA ---------------- */
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->Instance->CCR = hdma->Init.Direction | hdma->Init.PeriphInc | hdma->Init.MemInc |
+                          hdma->Init.PeriphDataAlignment | hdma->Init.MemDataAlignment |
+                          hdma->Init.Mode | hdma->Init.Priority;
+    hdma->State = HAL_DMA_STATE_READY;
+    hdma->ErrorCode = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    if (hdma == NULL) return HAL_ERROR;
+    hdma->Instance->CCR = 0;
+    hdma->Instance->CNDTR = 0;
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uintptr_t SrcAddress, uintptr_t DstAddress,
+                                uint32_t DataLength)
+{
+    sim_service();
+    if (hdma == NULL) return HAL_ERROR;
+    if (hdma->State != HAL_DMA_STATE_READY) return HAL_BUSY;
+    int n = (int)(hdma->Instance - sim_DMA1_Channel);
+    s_dma_xfer[n].src = SrcAddress;
+    s_dma_xfer[n].dst = DstAddress;
+    s_dma_xfer[n].len = DataLength;
+    hdma->State = HAL_DMA_STATE_BUSY;
+    hdma->Instance->CNDTR = DataLength;
+    hdma->Instance->CCR |= SIM_DMA_CCR_EN;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma)
+{
+    sim_service();
+    if (hdma == NULL) return HAL_ERROR;
+    hdma->Instance->CCR &= ~SIM_DMA_CCR_EN;
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+static uint32_t dma_read(uintptr_t addr, uint32_t size)
+{
+    if (size == 4U) return *(const uint32_t *)addr;
+    if (size == 2U) return *(const uint16_t *)addr;
+    return *(const uint8_t *)addr;
+}
+
+static void dma_write(uintptr_t addr, uint32_t v, uint32_t size)
+{
+    for (size_t i = 0; i < sizeof(s_ports) / sizeof(s_ports[0]); ++i) {
+        GPIO_TypeDef *port = s_ports[i];
+        if (addr == (uintptr_t)&port->BSRR) {
+            gpio_output(port, v & 0xFFFFU, v >> 16);
+            return;
+        }
+        if (addr == (uintptr_t)&port->BRR) {
+            gpio_output(port, 0U, v & 0xFFFFU);
+            return;
+        }
+    }
+    if (size == 4U) *(uint32_t *)addr = v;
+    else if (size == 2U) *(uint16_t *)addr = (uint16_t)v;
+    else *(uint8_t *)addr = (uint8_t)v;
+}
+
+/* 外设 DMA 请求：通道使能时搬运一个数据，计数归零后循环模式重装，普通模式关闭通道 */
+static void dma_request(DMA_HandleTypeDef *hdma)
+{
+    if (hdma == NULL) return;
+    DMA_Channel_TypeDef *ch = hdma->Instance;
+    if (!(ch->CCR & SIM_DMA_CCR_EN) || ch->CNDTR == 0U) return;
+    int n = (int)(ch - sim_DMA1_Channel);
+    uint32_t m2p = ch->CCR & DMA_MEMORY_TO_PERIPH;
+    uint32_t psize = 1U << ((ch->CCR >> 8) & 3U);
+    uint32_t msize = 1U << ((ch->CCR >> 10) & 3U);
+    uint32_t pinc = ch->CCR & DMA_PINC_ENABLE;
+    uint32_t minc = ch->CCR & DMA_MINC_ENABLE;
+    uint32_t done = s_dma_xfer[n].len - ch->CNDTR;
+    uint32_t src_size = m2p ? msize : psize, dst_size = m2p ? psize : msize;
+    uintptr_t src = s_dma_xfer[n].src + ((m2p ? minc : pinc) ? (uintptr_t)done * src_size : 0U);
+    uintptr_t dst = s_dma_xfer[n].dst + ((m2p ? pinc : minc) ? (uintptr_t)done * dst_size : 0U);
+
+    dma_write(dst, dma_read(src, src_size), dst_size);
+    s_stats.dma_xfers++;
+    if (--ch->CNDTR == 0U) {
+        if (ch->CCR & DMA_CIRCULAR) ch->CNDTR = s_dma_xfer[n].len;
+        else ch->CCR &= ~SIM_DMA_CCR_EN;
+    }
+}
+
+
+/* ---------------- UART ---------------- */
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    huart->ErrorCode = 0;
+    if (huart->Init.BaudRate) s_uart_baud = huart->Init.BaudRate;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout)
+{
+    (void)Timeout;
+    sim_service();
+    if (huart->gState != HAL_UART_STATE_READY) return HAL_BUSY;
+    if (pData == NULL || Size == 0U) return HAL_ERROR;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    if (s_uart_sink != NULL) fwrite(pData, 1, Size, s_uart_sink);
+    s_stats.uart_tx_bytes += Size;
+    if (!s_uart_ideal) {
+        uint64_t ns = uart_byte_ns() * Size;
+        s_stats.uart_block_ns += ns;
+        sim_advance_to(s_now + ns);
+    }
+    huart->gState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+/* DMA 发送结束：通道计数归零，置 TCIF 并挂起通道中断 */
+static void uart_tx_event(void *ctx)
+{
+    (void)ctx;
+    UART_HandleTypeDef *h = s_uart_tx.h;
+    if (h == NULL) return;
+    h->hdmatx->Instance->CNDTR = 0;
+    s_uart_tx.dma_tc = 1;
+    sim_irq_pend(dma_irqn(h->hdmatx));
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    sim_service();
+    if (huart->gState != HAL_UART_STATE_READY) return HAL_BUSY;
+    if (pData == NULL || Size == 0U || huart->hdmatx == NULL) return HAL_ERROR;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    huart->pTxBuffPtr = pData;
+    huart->TxXferSize = Size;
+    huart->TxXferCount = 0;
+    DMA_Channel_TypeDef *ch = huart->hdmatx->Instance;
+    ch->CNDTR = Size;
+    ch->CCR |= 1U;
+    huart->hdmatx->State = HAL_DMA_STATE_BUSY;
+
+    if (s_uart_sink != NULL) fwrite(pData, 1, Size, s_uart_sink);
+    s_stats.uart_tx_bytes += Size;
+    uint64_t ns = s_uart_ideal ? 0U : uart_byte_ns() * Size;
+    s_stats.uart_dma_ns += ns;
+    s_uart_tx.h = huart;
+    s_uart_tx.dma_tc = 0;
+    s_uart_tx.uart_tc = 0;
+    sim_event_schedule(&s_uart_tx.ev, s_now + ns);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (huart->RxState != HAL_UART_STATE_READY) return HAL_BUSY;
+    if (pData == NULL || Size == 0U) return HAL_ERROR;
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    s_uart_rx = huart;
+    /* RXNEIE 置位时 DR 中已有的字节立即触发中断 */
+    if (s_uart_rxne) sim_irq_pend(USART1_IRQn);
+    return HAL_OK;
+}
+
+/* 与 HAL 相同：启动时 DR 中已有的字节由 DMA 立即取走 */
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (huart->RxState != HAL_UART_STATE_READY) return HAL_BUSY;
+    if (pData == NULL || Size == 0U || huart->hdmarx == NULL) return HAL_ERROR;
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    DMA_Channel_TypeDef *ch = huart->hdmarx->Instance;
+    ch->CNDTR = Size;
+    ch->CCR |= 1U;
+    huart->hdmarx->State = HAL_DMA_STATE_BUSY;
+    s_uart_rxdma.h = huart;
+    s_uart_rxdma.ht = 0;
+    s_uart_rxdma.tc = 0;
+    s_uart_rxdma.idle = 0;
+    if (s_uart_rxne) {
+        s_uart_rxne = 0;
+        uart_rx_dma_write(s_uart_dr);
+        sim_event_schedule(&s_uart_rxdma.idle_ev, s_now + uart_byte_ns());
+    }
+    return HAL_OK;
+}
+
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    (void)huart;
+    (void)Size;
+}
+
+__weak void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+
+/* ---------------- TIM ---------------- */
+
+static int tim_slot(const TIM_HandleTypeDef *htim)
+{
+    return (htim->Instance == TIM2) ? 0 : (htim->Instance == TIM3) ? 1 : -1;
+}
+
+/* 影子寄存器锁存（UG 或更新事件） */
+static void tim_latch(int slot)
+{
+    TIM_TypeDef *tim = s_tim[slot].h->Instance;
+    s_tim[slot].psc = tim->PSC;
+    s_tim[slot].arr = tim->ARR;
+    s_tim[slot].ccr1 = tim->CCR1;
+}
+
+/* 外部时钟模式 1、触发源 ITR1（TIM3 上即 TIM2 的 TRGO） */
+static int tim_ext_clocked(const TIM_HandleTypeDef *h)
+{
+    return (h->Instance->SMCR & TIM_SMCR_SMS) == 7U && (h->Instance->SMCR & TIM_SMCR_TS) == TIM_CLOCKSOURCE_ITR1;
+}
+
+/* 从时刻 t0（计数为 0）起登记下一次更新事件，以及本周期内的 CC1 比较事件（有 CC1 中断 / DMA 请求时） */
+static void tim_schedule(int slot, uint64_t t0)
+{
+    TIM_TypeDef *tim = s_tim[slot].h->Instance;
+    uint64_t num = ((uint64_t)s_tim[slot].arr + 1U) * ((uint64_t)s_tim[slot].psc + 1U) * 1000000000ULL + s_tim[slot].rem;
+    s_tim[slot].t0 = t0;
+    s_tim[slot].rem = num % SIM_TIM_CLK_HZ;
+    sim_event_schedule(&s_tim[slot].ev, t0 + num / SIM_TIM_CLK_HZ);
+    if ((tim->DIER & (TIM_DIER_CC1IE | TIM_DMA_CC1)) && s_tim[slot].ccr1 <= s_tim[slot].arr) {
+        sim_event_schedule(&s_tim[slot].cc1_ev, t0 + tim_ticks_ns(slot, s_tim[slot].ccr1));
+    }
+}
+
+static void tim_trgo(int slot);
+
+/* 更新事件：锁存影子寄存器，置 UIF，UDE 发出 DMA 请求，UIE 挂起中断，MMS = 更新时输出 TRGO */
+static void tim_update(int slot)
+{
+    TIM_HandleTypeDef *h = s_tim[slot].h;
+    tim_latch(slot);
+    h->Instance->SR |= TIM_SR_UIF;
+    if (h->Instance->DIER & TIM_DMA_UPDATE) dma_request(h->hdma[TIM_DMA_ID_UPDATE]);
+    if (h->Instance->DIER & TIM_DIER_UIE) sim_irq_pend(slot == 0 ? TIM2_IRQn : TIM3_IRQn);
+    if (slot == 0) drive_level_update();
+    if ((h->Instance->CR2 & TIM_CR2_MMS) == TIM_TRGO_UPDATE) tim_trgo(slot);
+}
+
+/* CC1 比较事件（CNT == CCR1）：置 CC1IF，CC1DE 发出 DMA 请求 */
+static void tim_cc1(int slot)
+{
+    TIM_HandleTypeDef *h = s_tim[slot].h;
+    h->Instance->SR |= TIM_SR_CC1IF;
+    if (h->Instance->DIER & TIM_DMA_CC1) dma_request(h->hdma[TIM_DMA_ID_CC1]);
+}
+
+/* TRGO 只接到 TIM3 的 ITR1（来自 TIM2）：外部时钟模式下计一次数 */
+static void tim_trgo(int slot)
+{
+    TIM_HandleTypeDef *h = s_tim[1].h;
+    if (slot != 0 || h == NULL || !tim_ext_clocked(h)) return;
+    if (++s_tim[1].cnt > s_tim[1].arr) {
+        s_tim[1].cnt = 0;
+        tim_update(1);
+    } else if (s_tim[1].cnt == s_tim[1].ccr1 && (h->Instance->DIER & (TIM_DIER_CC1IE | TIM_DMA_CC1))) {
+        tim_cc1(1);
+    }
+    h->Instance->CNT = s_tim[1].cnt;
+}
+
+/* 内部时钟：由当前周期开始以来的时间换算计数；外部时钟（TRGO 计数）或未启动时为 CNT 寄存器 */
+uint32_t sim_tim_get_counter(TIM_TypeDef *tim)
+{
+    int slot = (tim == TIM2) ? 0 : (tim == TIM3) ? 1 : -1;
+    if (slot < 0 || s_tim[slot].h == NULL || tim_ext_clocked(s_tim[slot].h)) return tim->CNT;
+    uint64_t ticks = (s_now - s_tim[slot].t0) * SIM_TIM_CLK_HZ / (((uint64_t)s_tim[slot].psc + 1U) * 1000000000ULL);
+    return ticks > s_tim[slot].arr ? s_tim[slot].arr : (uint32_t)ticks;
+}
+
+static void tim_update_event(void *ctx)
+{
+    int slot = (int)(intptr_t)ctx;
+    tim_update(slot);
+    tim_schedule(slot, s_tim[slot].ev.t_ns);
+}
+
+static void tim_cc1_event(void *ctx)
+{
+    tim_cc1((int)(intptr_t)ctx);
+}
+
+/* 与 HAL_TIM_Base_Init 一样把 Init 写入 PSC / ARR */
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim)
+{
+    htim->Instance->PSC = htim->Init.Prescaler;
+    htim->Instance->ARR = htim->Init.Period;
+    htim->Instance->CR1 = htim->Init.AutoReloadPreload;
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+/* 计数从 0 开始：按当前寄存器锁存影子寄存器（相当于启动前写过 EGR.UG） */
+static HAL_StatusTypeDef tim_start(TIM_HandleTypeDef *htim)
+{
+    int slot = tim_slot(htim);
+    if (slot < 0) return HAL_ERROR;
+    sim_service();
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+    htim->Instance->CNT = 0;
+    s_tim[slot].h = htim;
+    s_tim[slot].cnt = 0;
+    s_tim[slot].rem = 0;
+    tim_latch(slot);
+    /* 外部时钟模式下由 TRGO 计数，不登记时间事件 */
+    if (!tim_ext_clocked(htim)) tim_schedule(slot, s_now);
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef tim_stop(TIM_HandleTypeDef *htim)
+{
+    int slot = tim_slot(htim);
+    if (slot < 0) return HAL_ERROR;
+    sim_service();
+    htim->Instance->CR1 &= ~TIM_CR1_CEN;
+    sim_event_cancel(&s_tim[slot].ev);
+    sim_event_cancel(&s_tim[slot].cc1_ev);
+    s_tim[slot].h = NULL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim)
+{
+    return tim_start(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim)
+{
+    return tim_stop(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+    htim->Instance->DIER |= TIM_DIER_UIE;
+    return tim_start(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim)
+{
+    htim->Instance->DIER &= ~TIM_DIER_UIE;
+    return tim_stop(htim);
+}
+
+/* 只用到 CH1 / CH2：写输出比较模式与比较值 */
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel)
+{
+    uint32_t shift = (Channel == TIM_CHANNEL_2) ? 8U : 0U;
+    htim->Instance->CCMR1 = (htim->Instance->CCMR1 & ~(0xFFU << shift)) | (sConfig->OCMode << shift);
+    __HAL_TIM_SET_COMPARE(htim, Channel, sConfig->Pulse);
+    return HAL_OK;
+}
+
+/* 与 HAL 相同：打开通道输出后启动计数（已在计数时只打开通道） */
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    htim->Instance->CCER |= 1U << Channel;
+    if (htim->Instance->CR1 & TIM_CR1_CEN) return HAL_OK;
+    return tim_start(htim);
+}
+
+/* 所有通道都关闭后才停止计数（__HAL_TIM_DISABLE 的条件） */
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    htim->Instance->CCER &= ~(1U << Channel);
+    if ((htim->Instance->CCER & 0x1111U) != 0U) return HAL_OK;
+    return tim_stop(htim);
+}
+
+/* 只支持内部时钟与 ITR1（外部时钟模式 1） */
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *sClockSourceConfig)
+{
+    htim->Instance->SMCR &= ~(TIM_SMCR_SMS | TIM_SMCR_TS);
+    if (sClockSourceConfig->ClockSource == TIM_CLOCKSOURCE_ITR1) {
+        htim->Instance->SMCR |= TIM_CLOCKSOURCE_ITR1 | 7U;
+    } else if (sClockSourceConfig->ClockSource != TIM_CLOCKSOURCE_INTERNAL) {
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        TIM_MasterConfigTypeDef *sMasterConfig)
+{
+    htim->Instance->CR2 = (htim->Instance->CR2 & ~TIM_CR2_MMS) | sMasterConfig->MasterOutputTrigger;
+    return HAL_OK;
+}
+
+__weak void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+
+/* ---------------- ADC ---------------- */
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc)
+{
+    hadc->State = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef *hadc)
+{
+    hadc->Instance->CR2 |= 1U;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Stop(ADC_HandleTypeDef *hadc)
+{
+    hadc->Instance->CR2 &= ~1U;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef *hadc, uint32_t Timeout)
+{
+    (void)Timeout;
+    sim_service();
+    hadc->Instance->DR = s_adc_value;
+    return (hadc->Instance->CR2 & 1U) ? HAL_OK : HAL_ERROR;
+}
+
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef *hadc)
+{
+    return hadc->Instance->DR;
+}
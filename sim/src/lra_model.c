@@ -0,0 +1,68 @@
+/*
+ * lra_model.c
+ * LRA 二阶模型，见 lra_model.h
+ */
+
+#include "lra_model.h"
+#include <math.h>
+#include <string.h>
+
+/* 第 i 段的参数：取段起点时刻的谐振频率 */
+static void seg_params(lra_model_t *m, uint32_t i)
+{
+    const double f = m->f0 + m->drift * (double)m->seg[i % LRA_MODEL_SEGS].t_ns * 1e-9;
+    const double w0 = 2.0 * 3.14159265358979323846 * (f > 0.1 ? f : 0.1);
+    m->seg[i % LRA_MODEL_SEGS].w0 = w0;
+    m->seg[i % LRA_MODEL_SEGS].sigma = w0 / (2.0 * m->q);
+    m->seg[i % LRA_MODEL_SEGS].wd = w0 * sqrt(1.0 - 1.0 / (4.0 * m->q * m->q));
+}
+
+void lra_model_init(lra_model_t *m, double f0, double q, double gain_ppm, double drift)
+{
+    memset(m, 0, sizeof(*m));
+    m->f0 = f0;
+    m->q = q;
+    m->drift = drift;
+    m->gain = gain_ppm * 1e-6;
+    seg_params(m, 0);
+    m->n = 1;
+}
+
+/* 从第 i 段起点推进到 t_ns：以平衡点 g·u 为零点的自由衰减振荡 */
+static void eval(const lra_model_t *m, uint32_t i, uint64_t t_ns, double *x, double *v)
+{
+    const double t = (double)(t_ns - m->seg[i % LRA_MODEL_SEGS].t_ns) * 1e-9;
+    const double w0 = m->seg[i % LRA_MODEL_SEGS].w0, sigma = m->seg[i % LRA_MODEL_SEGS].sigma;
+    const double wd = m->seg[i % LRA_MODEL_SEGS].wd;
+    const double xe = m->gain * m->seg[i % LRA_MODEL_SEGS].u;
+    const double y0 = m->seg[i % LRA_MODEL_SEGS].x - xe, v0 = m->seg[i % LRA_MODEL_SEGS].v;
+    const double e = exp(-sigma * t), c = cos(wd * t), s = sin(wd * t);
+    *x = xe + e * (y0 * c + (v0 + sigma * y0) / wd * s);
+    if (v != NULL) *v = e * (v0 * c - (sigma * v0 + w0 * w0 * y0) / wd * s);
+}
+
+void lra_model_set_drive(void *ctx, uint64_t t_ns, double level)
+{
+    lra_model_t *m = (lra_model_t *)ctx;
+    double x, v;
+    eval(m, m->n - 1U, t_ns, &x, &v);
+    m->seg[m->n % LRA_MODEL_SEGS].t_ns = t_ns;
+    m->seg[m->n % LRA_MODEL_SEGS].x = x;
+    m->seg[m->n % LRA_MODEL_SEGS].v = v;
+    m->seg[m->n % LRA_MODEL_SEGS].u = level;
+    seg_params(m, m->n);
+    m->n++;
+}
+
+double lra_model_offset(void *ctx, uint64_t t_ns)
+{
+    const lra_model_t *m = (const lra_model_t *)ctx;
+    const uint32_t oldest = m->n > LRA_MODEL_SEGS ? m->n - LRA_MODEL_SEGS : 0U;
+    uint32_t i = m->n - 1U;
+    /* 找到 t_ns 所在的段；早于保留的记录时从最早一段起点推算（近似） */
+    while (i > oldest && m->seg[i % LRA_MODEL_SEGS].t_ns > t_ns) i--;
+    if (m->seg[i % LRA_MODEL_SEGS].t_ns > t_ns) t_ns = m->seg[i % LRA_MODEL_SEGS].t_ns;
+    double x;
+    eval(m, i, t_ns, &x, NULL);
+    return x;
+}
@@ -0,0 +1,310 @@
+/*
+ * sim_main.c
+ * 主机仿真入口：搭建 FDC2214 模型与 HAL 替身，运行未经修改的固件 main()，
+ * 到达运行时长后打印采集链路的统计报告。
+ *
+ * 固件的 main.c 以 -Dmain=fw_main 编译，UART 输出写到 stdout，报告写到 stderr。
+ * 运行时长是虚拟时间，结果与主机负载无关；同样的参数与种子每次得到相同的输出。
+ * 示例：
+ *   fdc_sim -t 5 --quiet                         # 5 s，只看报告
+ *   fdc_sim -t 3600 -q                            # 1 小时长稳，主机上只需数秒
+ *   fdc_sim --cap 0:1:25 --noise 5 --fault 1:3:wd # U0 CH1 = 25 pF，U1 CH3 不起振
+ *   fdc_sim --devices 1 --i2c-hz 400000           # 只焊一片，I2C 快速模式
+ *   fdc_sim --lra 0:0:175:20:50 -t 20 --rx $'seq 0 c0\nsweep 0:0 165 185 1\n'   # LRA 扫频
+ *   fdc_sim --lra 0:0:175:20:50:-0.2 -t 60 --rx $'freq 172\ntrack 0:0\n'       # 谐振漂移时的跟踪
+ * 退出码：每片挂接的芯片都采到样本为 0，否则为 1，可直接用于回归脚本。
+ */
+
+#include "sim_hal.h"
+#include "fdc2214_model.h"
+#include "lra_model.h"
+#include "fdc2214.h"
+#include "main.h"
+#include "usart_debug.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int fw_main(void);
+
+#define SIM_DEV_MAX  2
+#define SIM_RX_MAX   8
+
+static fdc_model_t s_model[SIM_DEV_MAX];
+static fdc_dev_t *const s_dev[SIM_DEV_MAX] = { &fdc_dev0, &fdc_dev1 };
+static int s_dev_num = SIM_DEV_MAX;
+static double s_seconds = 2.0;
+static lra_model_t s_lra;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -t, --seconds S        simulated run time (default 2)\n"
+            "  -n, --devices N        FDC2214 chips on the bus, 0..2 (default 2)\n"
+            "      --coil-uh L        tank inductance, uH (default 18)\n"
+            "      --c0-pf C          tank fixed capacitance, pF (default 20)\n"
+            "      --csensor-pf C     sensor capacitance of all channels, pF (default 19)\n"
+            "      --cap U:CH:PF      sensor capacitance of one channel\n"
+            "      --freq U:CH:HZ     LC frequency of one channel (overrides L/C)\n"
+            "      --noise PPM        rms frequency noise per conversion (default 2)\n"
+            "      --fault U:CH:KIND  inject wd | ahw | alw\n"
+            "      --clkin HZ         CLKIN reference (default 40000000)\n"
+            "      --seed N           noise seed\n"
+            "      --i2c-hz HZ        override I2C clock (default hi2c1.Init.ClockSpeed)\n"
+            "      --uart-ideal       UART transmit takes no time\n"
+            "  -q, --quiet            discard firmware UART output\n"
+            "      --cpu-ns N         CPU time charged per HAL call, ns (default 1000)\n"
+            "      --realtime         pace simulated time to the host clock\n"
+            "      --rx TEXT          bytes fed to USART1 RX (may be repeated)\n"
+            "      --rx-at MS         simulated time at which the matching --rx starts arriving (default 0);\n"
+            "                         the n-th --rx-at applies to the n-th --rx\n"
+            "      --adc N            ADC1 conversion result (default 2048)\n"
+            "      --lra U:CH:F0:Q:PPM[:DRIFT]  LRA driven by the H-bridge, displacement shifts the channel frequency\n"
+            "                         (resonance F0 Hz, quality factor Q, static gain PPM at full drive,\n"
+            "                         resonance drift DRIFT Hz/s)\n",
+            prog);
+}
+
+static void inject_rx(void *ctx)
+{
+    sim_uart_inject((const char *)ctx);
+}
+
+/* 解析 "U:CH:rest"，返回 rest 指针，失败返回 NULL */
+static const char *parse_chan(const char *arg, int *u, int *ch)
+{
+    char *end;
+    *u = (int)strtol(arg, &end, 10);
+    if (*end != ':' || *u < 0 || *u >= SIM_DEV_MAX) return NULL;
+    *ch = (int)strtol(end + 1, &end, 10);
+    if (*end != ':' || *ch < 0 || *ch > 3) return NULL;
+    return end + 1;
+}
+
+static void print_u64x4(const char *name, const uint64_t v[4])
+{
+    fprintf(stderr, " %s=%llu/%llu/%llu/%llu", name, (unsigned long long)v[0], (unsigned long long)v[1],
+            (unsigned long long)v[2], (unsigned long long)v[3]);
+}
+
+static void print_u32x4(const char *name, const uint32_t v[4])
+{
+    fprintf(stderr, " %s=%lu/%lu/%lu/%lu", name, (unsigned long)v[0], (unsigned long)v[1],
+            (unsigned long)v[2], (unsigned long)v[3]);
+}
+
+/* 运行结束：模型真值与驱动统计对照 */
+static int report(void)
+{
+    const double t = (double)sim_now_ns() * 1e-9;
+    const sim_hal_stats_t *hs = sim_hal_get_stats();
+    int rc = 0;
+
+    fflush(stdout);
+    const double host = sim_host_seconds();
+    fprintf(stderr, "\n== fdc_sim %.2f s (host %.2f s, x%.0f) ==\n", t, host, host > 0.0 ? t / host : 0.0);
+    for (int u = 0; u < s_dev_num; ++u) {
+        const fdc_model_t *m = &s_model[u];
+        fdc_stats_t st;
+        fdc_get_stats(s_dev[u], &st);
+        fprintf(stderr, "U%d @0x%02X model: rounds=%llu conv=%llu status_rd=%llu data_rd=%llu", u,
+                (unsigned)(m->addr_hal >> 1), (unsigned long long)m->rounds, (unsigned long long)m->conversions,
+                (unsigned long long)m->status_reads, (unsigned long long)m->data_reads);
+        print_u64x4("overwritten", m->overwritten);
+        fprintf(stderr, "\n   driver: samples=%lu dropped=%lu drdy=%lu i2c_err=%lu retries=%lu",
+                (unsigned long)st.samples, (unsigned long)st.dropped, (unsigned long)fdc_get_drdy_count(s_dev[u]),
+                (unsigned long)st.i2c_errors, (unsigned long)st.i2c_retries);
+        print_u32x4("overruns", st.overruns);
+        print_u32x4("stale", st.stale);
+        print_u32x4("wd", st.err_wd);
+        print_u32x4("range", st.range);
+        fprintf(stderr, "\n   rate: %.1f samples/s (model %.1f rounds/s)\n", (double)st.samples / t,
+                (double)m->rounds / t);
+        if (st.samples == 0) rc = 1;
+    }
+    fdc_debug_tx_stats_t tx;
+    fdc_debug_get_tx_stats(&tx);
+    fprintf(stderr, "bus: i2c busy %.1f%% (%lu transfers, %lu nack), uart %llu B line %.1f%% blocking %.1f%%\n",
+            100.0 * (double)hs->i2c_busy_ns * 1e-9 / t, (unsigned long)hs->i2c_transfers,
+            (unsigned long)hs->i2c_nacks, (unsigned long long)hs->uart_tx_bytes,
+            100.0 * (double)(hs->uart_dma_ns + hs->uart_block_ns) * 1e-9 / t,
+            100.0 * (double)hs->uart_block_ns * 1e-9 / t);
+    fprintf(stderr, "log: queued %lu B, dropped %lu msgs / %lu B, ring high-water %u/%u\n",
+            (unsigned long)tx.queued_bytes, (unsigned long)tx.dropped_msgs, (unsigned long)tx.dropped_bytes,
+            (unsigned)tx.high_water, (unsigned)FDC_DEBUG_TX_BUF_SIZE);
+    fdc_debug_rx_stats_t rxs;
+    fdc_debug_get_rx_stats(&rxs);
+    fprintf(stderr, "cmd: %lu lines, %lu dropped (queue full), %lu overlong, %lu rx restarts\n",
+            (unsigned long)rxs.lines, (unsigned long)rxs.dropped_lines, (unsigned long)rxs.overlong,
+            (unsigned long)rxs.restarts);
+    fprintf(stderr, "irq: exti=%lu i2c=%lu tim=%lu uart=%lu dma=%lu (rx overrun %lu)\n", (unsigned long)hs->irq_exti,
+            (unsigned long)hs->irq_i2c, (unsigned long)hs->irq_tim, (unsigned long)hs->irq_uart,
+            (unsigned long)hs->irq_dma, (unsigned long)hs->uart_rx_overrun);
+    if (hs->bridge_edges != 0U) {
+        /* H 桥驱动（IN1/IN2）：任何直通都判失败 */
+        int have_dead = hs->bridge_dead_min_ns != UINT64_MAX, have_half = hs->bridge_half_min_ns != UINT64_MAX;
+        fprintf(stderr, "drive: %lu edges, overlap %lu, dead %.1f..%.1f us, half-period %.3f..%.3f us, dma %llu xfers\n",
+                (unsigned long)hs->bridge_edges, (unsigned long)hs->bridge_overlap,
+                have_dead ? (double)hs->bridge_dead_min_ns * 1e-3 : 0.0, (double)hs->bridge_dead_max_ns * 1e-3,
+                have_half ? (double)hs->bridge_half_min_ns * 1e-3 : 0.0, (double)hs->bridge_half_max_ns * 1e-3,
+                (unsigned long long)hs->dma_xfers);
+        /* 平均频率：第一次到最后一次换向之间（中途改过频率时为混合值） */
+        if (hs->bridge_commutations > 1U) {
+            double span = (double)(hs->bridge_last_ns - hs->bridge_first_ns) * 1e-9;
+            fprintf(stderr, "   mean %.4f Hz over %lu commutations\n",
+                    (double)(hs->bridge_commutations - 1U) / (2.0 * span), (unsigned long)hs->bridge_commutations);
+        }
+        /* 等效驱动电压（极性 × TIM2 占空比）的谐波：方波驱动 3 次约为基波的 1/3，正弦驱动应接近 0 */
+        double mag[15];
+        uint32_t cycles = sim_bridge_harmonics(mag, 15U);
+        if (cycles != 0U && mag[0] > 0.0) {
+            double sum = 0.0;
+            for (int k = 1; k < 15; ++k) sum += mag[k] * mag[k];
+            fprintf(stderr, "   fundamental %.3f of full scale, THD %.2f%% (3rd %.2f%%, 5th %.2f%%) over %lu cycles\n",
+                    mag[0], 100.0 * sqrt(sum) / mag[0], 100.0 * mag[2] / mag[0], 100.0 * mag[4] / mag[0],
+                    (unsigned long)cycles);
+        }
+        if (hs->bridge_overlap != 0U) rc = 1;
+    }
+    fprintf(stderr, "sim: %llu events, %llu hal calls, %llu idle skips\n", (unsigned long long)hs->events,
+            (unsigned long long)hs->hal_calls, (unsigned long long)hs->idle_skips);
+    fprintf(stderr, "%s\n", rc ? "FAIL" : "PASS");
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    enum { OPT_COIL = 256, OPT_C0, OPT_CSENSOR, OPT_CAP, OPT_FREQ, OPT_NOISE, OPT_FAULT, OPT_CLKIN,
+           OPT_SEED, OPT_I2C_HZ, OPT_UART_IDEAL, OPT_RX, OPT_RX_AT, OPT_ADC, OPT_CPU_NS, OPT_REALTIME,
+           OPT_LRA };
+    static const struct option opts[] = {
+        { "seconds", required_argument, NULL, 't' },
+        { "devices", required_argument, NULL, 'n' },
+        { "quiet", no_argument, NULL, 'q' },
+        { "coil-uh", required_argument, NULL, OPT_COIL },
+        { "c0-pf", required_argument, NULL, OPT_C0 },
+        { "csensor-pf", required_argument, NULL, OPT_CSENSOR },
+        { "cap", required_argument, NULL, OPT_CAP },
+        { "freq", required_argument, NULL, OPT_FREQ },
+        { "noise", required_argument, NULL, OPT_NOISE },
+        { "fault", required_argument, NULL, OPT_FAULT },
+        { "clkin", required_argument, NULL, OPT_CLKIN },
+        { "seed", required_argument, NULL, OPT_SEED },
+        { "i2c-hz", required_argument, NULL, OPT_I2C_HZ },
+        { "uart-ideal", no_argument, NULL, OPT_UART_IDEAL },
+        { "rx", required_argument, NULL, OPT_RX },
+        { "rx-at", required_argument, NULL, OPT_RX_AT },
+        { "adc", required_argument, NULL, OPT_ADC },
+        { "cpu-ns", required_argument, NULL, OPT_CPU_NS },
+        { "realtime", no_argument, NULL, OPT_REALTIME },
+        { "lra", required_argument, NULL, OPT_LRA },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    double coil_h = 18e-6, c0_f = 20e-12, csensor_f = 19e-12, noise_ppm = 2.0, clkin = 40e6;
+    double cap[SIM_DEV_MAX][4] = { { 0 } }, freq[SIM_DEV_MAX][4] = { { 0 } };
+    uint8_t fault[SIM_DEV_MAX][4] = { { 0 } };
+    uint32_t seed = 1;
+    const char *rx[SIM_RX_MAX] = { NULL };
+    double rx_at_ms[SIM_RX_MAX] = { 0.0 };
+    int rx_num = 0, rx_at_num = 0;
+    int lra_u = -1, lra_ch = 0;
+
+    sim_hal_init();
+
+    int c;
+    while ((c = getopt_long(argc, argv, "t:n:qh", opts, NULL)) != -1) {
+        int u, ch;
+        const char *rest;
+        switch (c) {
+            case 't': s_seconds = atof(optarg); break;
+            case 'n': s_dev_num = atoi(optarg); break;
+            case 'q': sim_uart_set_sink(NULL); break;
+            case OPT_COIL: coil_h = atof(optarg) * 1e-6; break;
+            case OPT_C0: c0_f = atof(optarg) * 1e-12; break;
+            case OPT_CSENSOR: csensor_f = atof(optarg) * 1e-12; break;
+            case OPT_NOISE: noise_ppm = atof(optarg); break;
+            case OPT_CLKIN: clkin = atof(optarg); break;
+            case OPT_SEED: seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case OPT_I2C_HZ: sim_i2c_set_clock((uint32_t)strtoul(optarg, NULL, 0)); break;
+            case OPT_UART_IDEAL: sim_uart_set_ideal(1); break;
+            case OPT_RX:
+                if (rx_num < SIM_RX_MAX) rx[rx_num++] = optarg;
+                break;
+            case OPT_RX_AT:
+                if (rx_at_num < SIM_RX_MAX) rx_at_ms[rx_at_num++] = atof(optarg);
+                break;
+            case OPT_ADC: sim_adc_set_value((uint16_t)atoi(optarg)); break;
+            case OPT_CPU_NS: sim_set_cpu_ns((uint32_t)strtoul(optarg, NULL, 0)); break;
+            case OPT_REALTIME: sim_set_realtime(1); break;
+            case OPT_LRA: {
+                double f0, q, ppm, drift = 0.0;
+                rest = parse_chan(optarg, &lra_u, &lra_ch);
+                if (rest == NULL || sscanf(rest, "%lf:%lf:%lf:%lf", &f0, &q, &ppm, &drift) < 3 || f0 <= 0.0 ||
+                    q <= 0.5) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                lra_model_init(&s_lra, f0, q, ppm, drift);
+                break;
+            }
+            case OPT_CAP:
+            case OPT_FREQ:
+            case OPT_FAULT:
+                rest = parse_chan(optarg, &u, &ch);
+                if (rest == NULL) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                if (c == OPT_CAP) cap[u][ch] = atof(rest) * 1e-12;
+                else if (c == OPT_FREQ) freq[u][ch] = atof(rest);
+                else if (!strcmp(rest, "wd")) fault[u][ch] = FDC_MODEL_FAULT_WD;
+                else if (!strcmp(rest, "ahw")) fault[u][ch] = FDC_MODEL_FAULT_AHW;
+                else if (!strcmp(rest, "alw")) fault[u][ch] = FDC_MODEL_FAULT_ALW;
+                else {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return c == 'h' ? 0 : 2;
+        }
+    }
+    if (s_dev_num < 0 || s_dev_num > SIM_DEV_MAX || s_seconds <= 0.0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    for (int u = 0; u < s_dev_num; ++u) {
+        fdc_model_t *m = &s_model[u];
+        fdc_model_init(m, s_dev[u]->addr_hal, s_dev[u]->intb_port, s_dev[u]->intb_pin, seed + (uint32_t)u * 7919U);
+        m->clkin_hz = clkin;
+        for (int ch = 0; ch < 4; ++ch) {
+            double cs = cap[u][ch] > 0.0 ? cap[u][ch] : csensor_f;
+            m->ch[ch].freq_hz = freq[u][ch] > 0.0 ? freq[u][ch] : fdc_model_lc_freq(coil_h, c0_f + cs);
+            m->ch[ch].noise_ppm = noise_ppm;
+            m->ch[ch].fault = fault[u][ch];
+        }
+        if (u == lra_u) {
+            m->ch[lra_ch].offset = lra_model_offset;
+            m->ch[lra_ch].offset_ctx = &s_lra;
+        }
+        fdc_model_attach(m);
+    }
+    static sim_event_t rx_ev[SIM_RX_MAX];
+    for (int i = 0; i < rx_num; ++i) {
+        sim_event_init(&rx_ev[i], inject_rx, (void *)rx[i]);
+        sim_event_schedule(&rx_ev[i], (uint64_t)(rx_at_ms[i] * 1e6));
+    }
+
+    sim_gpio_watch_bridge(IN1_GPIO_Port, IN1_Pin, IN2_Pin);
+    if (lra_u >= 0) sim_bridge_on_level(lra_model_set_drive, &s_lra);
+
+    sim_set_deadline((uint64_t)(s_seconds * 1e9), report);
+    return fw_main();
+}
@@ -0,0 +1,172 @@
+/*
+ * test_fdc_config.c
+ * 采样配置规划器的参数扫描：通道数 × 单端/差分 × 目标 SPS × fCLK × fSENSOR 全组合调用
+ * fdc_plan_config()，对每个结果按手册公式（fdc_config.h）独立复核：
+ *   - fREF = fCLK / FREF_DIVIDER 不超过单 / 多通道上限，且分频已是最小；
+ *   - FIN_SEL 推出的 fIN 满足 fIN × 4 < fREF，fdc_plan_data_fref_hz() 按 FIN_SEL 乘以 1 或 2；
+ *   - 一轮耗时 N × (tS + tC + tSW)（单通道只有 tC）不超过 1 / SPS，且 RCOUNT 已取到预算内最大；
+ *   - RCOUNT ≥ 0x0100、SETTLECOUNT ≥ 4，actual_msps 与寄存器值一致；
+ * 被拒绝的请求必须确实无解：返回码与 fSENSOR / 时间预算的判定一致。
+ * 退出码：0 全部通过，1 有不一致。
+ */
+
+#include "fdc_config.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/* 手册寄存器表：RCOUNT 0x0000..0x00FF 保留。独立于 FDC_PLAN_RCOUNT_MIN 写死，规划器下限改错时能被发现 */
+#define RCOUNT_FLOOR  0x0100U
+
+static int s_fails;
+
+#define EXPECT(cond, req, ...)                                                                      \
+    do {                                                                                            \
+        if (!(cond)) {                                                                              \
+            if (s_fails++ < 20) {                                                                   \
+                printf("FAIL n=%u se=%u sps=%lu fclk=%lu fs=%lu: ", (unsigned)(req)->channel_count, \
+                       (unsigned)(req)->single_ended, (unsigned long)(req)->target_sps,             \
+                       (unsigned long)(req)->fclk_hz, (unsigned long)(req)->fsensor_hz);           \
+                printf(__VA_ARGS__);                                                                \
+                printf("\n");                                                                       \
+            }                                                                                       \
+        }                                                                                           \
+    } while (0)
+
+/* tSW = 692 ns + 5 / fREF，按 fREF 周期向上取整 */
+static uint64_t tsw_cycles(uint32_t fref_hz)
+{
+    return ((uint64_t)692U * fref_hz + 999999999ULL) / 1000000000ULL + 5U;
+}
+
+/* 一个通道一次转换占用的 fREF 周期：多通道时含激活时间与切换延时 */
+static uint64_t slot_cycles(uint8_t n, uint16_t settle, uint32_t rcount, uint32_t fref_hz)
+{
+    uint64_t c = (uint64_t)rcount * 16U + 4U;
+    if (n > 1) c += (uint64_t)settle * 16U + tsw_cycles(fref_hz);
+    return c;
+}
+
+static void check_one(const fdc_plan_req_t *req, int *accepted)
+{
+    fdc_config_t cfg;
+    const int r = fdc_plan_config(req, &cfg);
+    const uint8_t n = req->channel_count;
+    const uint16_t settle = req->settlecount ? req->settlecount : FDC_PLAN_DEFAULT_SETTLECOUNT;
+    const uint32_t fref_max = (n > 1) ? FDC_PLAN_FREF_MAX_MULTI_HZ : FDC_PLAN_FREF_MAX_SINGLE_HZ;
+    const uint32_t div = (req->fclk_hz + fref_max - 1U) / fref_max;
+    const uint32_t fref = req->fclk_hz / div;
+    const int fin_div2 = req->single_ended || req->fsensor_hz > FDC_PLAN_FIN_DIFF_MAX_HZ;
+    const uint32_t fin = fin_div2 ? req->fsensor_hz / 2U : req->fsensor_hz;
+    const int fsensor_ok = req->fsensor_hz <= FDC_PLAN_FSENSOR_MAX_HZ && (uint64_t)fin * 4U < fref;
+    /* 最短一轮（RCOUNT = 最小值）也放不进 1 / SPS 时无解 */
+    const int rate_ok = (uint64_t)slot_cycles(n, settle, RCOUNT_FLOOR, fref) * n * req->target_sps <= fref;
+
+    if (r != FDC_PLAN_OK) {
+        EXPECT(r == FDC_PLAN_ERR_FSENSOR || r == FDC_PLAN_ERR_RATE, req, "unexpected status %d", r);
+        EXPECT(r != FDC_PLAN_ERR_FSENSOR || !fsensor_ok, req, "rejected a valid sensor frequency");
+        EXPECT(r != FDC_PLAN_ERR_RATE || (fsensor_ok && !rate_ok), req, "rejected a feasible sample rate");
+        return;
+    }
+    ++*accepted;
+    EXPECT(fsensor_ok && rate_ok, req, "accepted an impossible request");
+
+    /* 参考时钟：不超过上限，分频最小 */
+    const uint32_t cfg_div = cfg.clock_dividers & FDC_PLAN_FREF_DIVIDER_MAX;
+    EXPECT(cfg_div >= 1U && cfg.fref_hz == req->fclk_hz / cfg_div, req, "fref %lu / divider %lu mismatch",
+           (unsigned long)cfg.fref_hz, (unsigned long)cfg_div);
+    EXPECT(cfg.fref_hz <= fref_max, req, "fref %lu above limit", (unsigned long)cfg.fref_hz);
+    EXPECT(cfg_div == 1U || req->fclk_hz / (cfg_div - 1U) > fref_max, req, "divider %lu not minimal",
+           (unsigned long)cfg_div);
+
+    /* fIN × 4 < fREF，fIN 按寄存器里的 FIN_SEL 计算 */
+    const uint16_t fin_sel = cfg.clock_dividers & (3U << FDC2214_CLOCK_DIVIDERS_FIN_SEL_POS);
+    EXPECT(fin_sel == FDC2214_CLOCK_DIVIDERS_FIN_DIV1 || fin_sel == FDC2214_CLOCK_DIVIDERS_FIN_DIV2, req,
+           "bad FIN_SEL 0x%04X", (unsigned)cfg.clock_dividers);
+    EXPECT(!req->single_ended || fin_sel == FDC2214_CLOCK_DIVIDERS_FIN_DIV2, req, "single-ended needs FIN_SEL /2");
+    const uint32_t cfg_fin = (fin_sel == FDC2214_CLOCK_DIVIDERS_FIN_DIV2) ? req->fsensor_hz / 2U : req->fsensor_hz;
+    EXPECT(cfg_fin <= FDC_PLAN_FIN_DIFF_MAX_HZ || fin_sel == FDC2214_CLOCK_DIVIDERS_FIN_DIV2, req,
+           "differential fIN %lu above 8.75 MHz", (unsigned long)cfg_fin);
+    EXPECT(fdc_plan_data_fref_hz(&cfg) == (fin_sel == FDC2214_CLOCK_DIVIDERS_FIN_DIV2 ? 2U : 1U) * cfg.fref_hz, req,
+           "data fREF %lu", (unsigned long)fdc_plan_data_fref_hz(&cfg));
+    EXPECT((uint64_t)cfg_fin * 4U < cfg.fref_hz, req, "fIN %lu x 4 >= fREF %lu", (unsigned long)cfg_fin,
+           (unsigned long)cfg.fref_hz);
+
+    /* 寄存器下限 */
+    EXPECT(cfg.rcount >= RCOUNT_FLOOR, req, "RCOUNT 0x%04X below 0x%04X", (unsigned)cfg.rcount,
+           (unsigned)RCOUNT_FLOOR);
+    EXPECT(cfg.settlecount >= FDC_PLAN_SETTLECOUNT_MIN && cfg.settlecount == settle, req, "SETTLECOUNT 0x%04X",
+           (unsigned)cfg.settlecount);
+    EXPECT(cfg.channel_count == n, req, "channel_count %u", (unsigned)cfg.channel_count);
+
+    /* 时间预算：每通道 tS + tC + tSW 在 1 / (SPS × N) 以内，RCOUNT + 1 则超出（或已到 0xFFFF） */
+    const uint64_t slot = slot_cycles(n, cfg.settlecount, cfg.rcount, cfg.fref_hz);
+    EXPECT(slot * n * req->target_sps <= cfg.fref_hz, req, "round of %llu cycles exceeds budget at RCOUNT 0x%04X",
+           (unsigned long long)(slot * n), (unsigned)cfg.rcount);
+    EXPECT(cfg.rcount == 0xFFFFU ||
+               (uint64_t)slot_cycles(n, cfg.settlecount, cfg.rcount + 1U, cfg.fref_hz) * n * req->target_sps >
+                   cfg.fref_hz,
+           req, "RCOUNT 0x%04X not maximal", (unsigned)cfg.rcount);
+    EXPECT(cfg.actual_msps == (uint32_t)((uint64_t)cfg.fref_hz * 1000U / (slot * n)), req, "actual_msps %lu",
+           (unsigned long)cfg.actual_msps);
+    EXPECT(cfg.actual_msps >= req->target_sps * 1000U, req, "actual %lu mSPS below target",
+           (unsigned long)cfg.actual_msps);
+
+    /* 扫描通道：多通道为 CH0..CH(n-1) 自动扫描，单通道经 ACTIVE_CHAN 选择 */
+    if (n > 1) {
+        EXPECT((cfg.mux_config & FDC2214_MUX_CONFIG_AUTOSCAN_EN) &&
+                   ((cfg.mux_config & FDC2214_MUX_CONFIG_RR_SEQUENCE_MASK) >> FDC2214_MUX_CONFIG_RR_SEQUENCE_POS) ==
+                       (uint16_t)(n - 2U),
+               req, "MUX_CONFIG 0x%04X", (unsigned)cfg.mux_config);
+    } else {
+        EXPECT(!(cfg.mux_config & FDC2214_MUX_CONFIG_AUTOSCAN_EN) &&
+                   ((cfg.config & FDC2214_CONFIG_ACTIVE_CHAN_MASK) >> FDC2214_CONFIG_ACTIVE_CHAN_POS) ==
+                       req->active_channel,
+               req, "CONFIG 0x%04X / MUX_CONFIG 0x%04X", (unsigned)cfg.config, (unsigned)cfg.mux_config);
+    }
+}
+
+int main(void)
+{
+    static const uint32_t sps[] = { 1, 5, 10, 25, 50, 100, 200, 400, 500, 1000, 2000, 4000, 8000, 20000 };
+    static const uint32_t fclk[] = { 1000000, 4000000, 10000000, 12000000, 20000000, 33000000, 35000000,
+                                     40000000, 43400000, 55000000, 60000000, 80000000 };
+    static const uint16_t settle[] = { 0, FDC_PLAN_SETTLECOUNT_MIN, 0x0040 };
+    int total = 0, accepted = 0;
+
+    for (uint8_t n = 1; n <= 4; ++n)
+        for (uint8_t se = 0; se <= 1; ++se)
+            for (size_t s = 0; s < sizeof(sps) / sizeof(sps[0]); ++s)
+                for (size_t c = 0; c < sizeof(fclk) / sizeof(fclk[0]); ++c)
+                    for (size_t st = 0; st < sizeof(settle) / sizeof(settle[0]); ++st)
+                        /* fSENSOR 10 kHz..12 MHz，跨过 8.75 MHz 差分上限与 10 MHz 总上限 */
+                        for (uint32_t fs = 10000U; fs <= 12000000U; fs = fs < 1000000U ? fs * 2U : fs + 250000U) {
+                            fdc_plan_req_t req = {
+                                .channel_count = n,
+                                .active_channel = (uint8_t)(s & 3U),
+                                .single_ended = se,
+                                .ref_external = (uint8_t)(c & 1U),
+                                .target_sps = sps[s],
+                                .fclk_hz = fclk[c],
+                                .fsensor_hz = fs,
+                                .settlecount = settle[st],
+                            };
+                            check_one(&req, &accepted);
+                            ++total;
+                        }
+
+    /* 非法参数 */
+    fdc_config_t cfg;
+    fdc_plan_req_t bad = { .channel_count = 5, .target_sps = 100, .fclk_hz = 40000000, .fsensor_hz = 3000000 };
+    EXPECT(fdc_plan_config(&bad, &cfg) == FDC_PLAN_ERR_PARAM, &bad, "5 channels accepted");
+    bad.channel_count = 1;
+    bad.active_channel = 4;
+    EXPECT(fdc_plan_config(&bad, &cfg) == FDC_PLAN_ERR_PARAM, &bad, "active_channel 4 accepted");
+    bad.active_channel = 0;
+    bad.settlecount = FDC_PLAN_SETTLECOUNT_MIN - 1U;
+    EXPECT(fdc_plan_config(&bad, &cfg) == FDC_PLAN_ERR_PARAM, &bad, "SETTLECOUNT 3 accepted");
+    EXPECT(fdc_plan_config(NULL, &cfg) == FDC_PLAN_ERR_PARAM, &bad, "NULL request accepted");
+
+    printf("%d requests, %d planned, %d rejected, %d failures\n%s\n", total, accepted, total - accepted, s_fails,
+           s_fails ? "FAIL" : "PASS");
+    return s_fails ? 1 : 0;
+}
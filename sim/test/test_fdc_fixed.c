@@ -0,0 +1,118 @@
+/*
+ * test_fdc_fixed.c
+ * fdc_fixed 定点换算的全码域检查：DATA = 1..2^28-1 逐一与固件的 double 版
+ * fdc_raw_to_freq() / fdc_freq_to_capacitance() 比较，断言 fdc_fixed.h 中写明的误差界：
+ *   频率 |误差| ≤ 0.5 Hz；电容 |误差| ≤ 0.5 fF + 1e-8 * (C + C0)（C + C0 = K / DATA^2）；
+ *   参考值超出 int32 时结果饱和为 INT32_MAX。
+ * 本板参数（main.c：fREF 40 MHz、L 18 uH、C0 20 pF）走全码域，其余组合按步长抽样。
+ * 退出码：0 全部通过，1 有超差。
+ */
+
+#include "fdc_fixed.h"
+#include "fdc2214.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define RAW_MAX  ((1UL << 28) - 1U)
+
+typedef struct {
+    uint32_t fref_hz;
+    uint32_t L_nh;
+    int32_t C0_ff;
+    uint32_t stride;    /* DATA 步长，1 = 全码域 */
+} fixed_case_t;
+
+static const fixed_case_t s_cases[] = {
+    { 80000000U, 18000U, 20000, 1U },       /* 本板：40 MHz fREF，单端 FIN_SEL ÷2 */
+    { 40000000U, 18000U, 20000, 61U },      /* 同一 fREF，差分 FIN_SEL ÷1 */
+    { 43400000U, 18000U, 20000, 61U },      /* 内部振荡器典型值 */
+    { 40000000U, 1000U, 0, 61U },           /* 小电感：高 fSENSOR */
+    { 35000000U, 100000U, 33000, 61U },     /* 大电感 + 大 C0：DATA 较小处早饱和 */
+    { 10000000U, 18000U, 20000, 61U },      /* 外部时钟分频后 fREF 较低 */
+};
+
+static int check_case(const fixed_case_t *tc)
+{
+    fdc_fixed_cal_t cal;
+    if (fdc_fixed_init(&cal, tc->fref_hz, tc->L_nh, tc->C0_ff) != 0) {
+        printf("FAIL fref=%lu L=%lu: fdc_fixed_init rejected valid parameters\n",
+               (unsigned long)tc->fref_hz, (unsigned long)tc->L_nh);
+        return 1;
+    }
+
+    const double L_h = tc->L_nh * 1e-9;
+    const double C0_f = tc->C0_ff * 1e-15;
+    double f_worst = 0.0, c_worst = 0.0, c_margin = -1e300;
+    uint32_t c_worst_raw = 0, n = 0, saturated = 0;
+    int fails = 0;
+
+    for (uint32_t raw = 1; raw <= RAW_MAX; raw += tc->stride) {
+        const double f_ref = fdc_raw_to_freq(raw, (double)tc->fref_hz);
+        const double f_err = fabs((double)fdc_fixed_raw_to_freq_hz(raw, tc->fref_hz) - f_ref);
+        if (f_err > f_worst) f_worst = f_err;
+
+        const double c_ref = fdc_freq_to_capacitance(f_ref, L_h, C0_f) * 1e15;
+        const double c_tot = c_ref + tc->C0_ff;
+        const double bound = 0.5 + 1e-8 * c_tot;
+        const int32_t c = fdc_fixed_raw_to_ff(&cal, raw);
+        ++n;
+
+        if (c_ref - bound >= (double)INT32_MAX) {
+            /* 参考值超出 int32：必须饱和 */
+            ++saturated;
+            if (c != INT32_MAX && fails++ < 5) {
+                printf("FAIL fref=%lu L=%lu raw=%lu: C=%ld, expected saturation (ref %.1f fF)\n",
+                       (unsigned long)tc->fref_hz, (unsigned long)tc->L_nh, (unsigned long)raw, (long)c, c_ref);
+            }
+            continue;
+        }
+        if (c == INT32_MAX && c_ref + bound >= (double)INT32_MAX) {
+            ++saturated;                        /* 饱和边界上两种结果都可接受 */
+            continue;
+        }
+
+        const double c_err = fabs((double)c - c_ref);
+        if (c_err > c_worst) { c_worst = c_err; c_worst_raw = raw; }
+        if (c_err - bound > c_margin) c_margin = c_err - bound;
+        if (c_err > bound && fails++ < 5) {
+            printf("FAIL fref=%lu L=%lu raw=%lu: C=%ld fF, ref %.3f fF, |err| %.3f > %.3f\n",
+                   (unsigned long)tc->fref_hz, (unsigned long)tc->L_nh, (unsigned long)raw, (long)c,
+                   c_ref, c_err, bound);
+        }
+    }
+    if (f_worst > 0.5 + 1e-6) {
+        printf("FAIL fref=%lu: frequency |err| %.6f Hz > 0.5 Hz\n", (unsigned long)tc->fref_hz, f_worst);
+        ++fails;
+    }
+
+    printf("%s fref=%lu L=%lu nH C0=%ld fF stride=%lu: %lu codes (%lu saturated), "
+           "max |dC| %.4f fF at raw=%lu, bound margin %.4f fF, max |df| %.4f Hz\n",
+           fails ? "FAIL" : "ok  ", (unsigned long)tc->fref_hz, (unsigned long)tc->L_nh, (long)tc->C0_ff,
+           (unsigned long)tc->stride, (unsigned long)n, (unsigned long)saturated, c_worst,
+           (unsigned long)c_worst_raw, c_margin, f_worst);
+    return fails != 0;
+}
+
+int main(void)
+{
+    int fails = 0;
+
+    /* 非法参数与 DATA = 0 */
+    fdc_fixed_cal_t cal;
+    if (fdc_fixed_init(&cal, 0U, 18000U, 0) != -1 || fdc_fixed_init(&cal, 40000000U, 0U, 0) != -1 ||
+        fdc_fixed_init(NULL, 40000000U, 18000U, 0) != -1) {
+        printf("FAIL fdc_fixed_init accepted invalid parameters\n");
+        ++fails;
+    }
+    fdc_fixed_init(&cal, 40000000U, 18000U, 20000);
+    if (fdc_fixed_raw_to_ff(&cal, 0U) != FDC_FIXED_C_INVALID || fdc_fixed_raw_to_ff(NULL, 1U) != FDC_FIXED_C_INVALID) {
+        printf("FAIL DATA = 0 / NULL cal did not return FDC_FIXED_C_INVALID\n");
+        ++fails;
+    }
+
+    for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); ++i) fails += check_case(&s_cases[i]);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+/*
+ * test_fdc_fmt.c
+ * fdc_fmt_vsnprintf 与 glibc vsnprintf 的逐项对比：
+ *   - 标准转换 %d %i %u %x %X %o %c %s %p %%，标志 / 宽度 / 精度（含 *）/ 长度修饰的组合网格；
+ *   - %.Nk / %.Nlk / %.Nllk 定点小数：与 glibc "%.Nf" 打印 v / 10^N 比较（|v| < 2^52 时 double 商
+ *     按 N 位舍入必然得到精确值），超出 double 精度的 64-bit 值与 N > 9 的截断用固定期望串；
+ *   - 截断：各种 size 下的缓冲区内容与返回值。
+ * 与 glibc 有意不同的地方不比较：NULL 的 %p 打印 0x0 而不是 (nil)，%f 等不支持的转换原样输出。
+ * 退出码：0 全部通过，1 有不一致。
+ */
+
+#include "fdc_fmt.h"
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static int s_checks, s_fails;
+
+static void report_mismatch(int line, const char *fmt, const char *got, int got_n, const char *want, int want_n)
+{
+    if (s_fails++ < 20) {
+        printf("FAIL line %d fmt \"%s\": got \"%s\" (%d), want \"%s\" (%d)\n", line, fmt, got, got_n, want, want_n);
+    }
+}
+
+/* 同一格式串与参数分别交给 fdc_fmt 与 glibc */
+static void check_libc(int line, const char *fmt, ...)
+{
+    char got[128], want[128];
+    va_list a, b;
+    va_start(a, fmt);
+    va_copy(b, a);
+    int got_n = fdc_fmt_vsnprintf(got, sizeof(got), fmt, a);
+    int want_n = vsnprintf(want, sizeof(want), fmt, b);
+    va_end(b);
+    va_end(a);
+    ++s_checks;
+    if (got_n != want_n || strcmp(got, want) != 0) report_mismatch(line, fmt, got, got_n, want, want_n);
+}
+
+/* fdc_fmt 的输出与固定期望串比较 */
+static void check_str(int line, const char *want, const char *fmt, ...)
+{
+    char got[128];
+    va_list a;
+    va_start(a, fmt);
+    int got_n = fdc_fmt_vsnprintf(got, sizeof(got), fmt, a);
+    va_end(a);
+    ++s_checks;
+    if (got_n != (int)strlen(want) || strcmp(got, want) != 0) {
+        report_mismatch(line, fmt, got, got_n, want, (int)strlen(want));
+    }
+}
+
+#define CHECK(...)       check_libc(__LINE__, __VA_ARGS__)
+#define CHECK_STR(...)   check_str(__LINE__, __VA_ARGS__)
+
+static const char *const s_flags[] = { "", "-", "0", "+", " ", "#", "-0", "+0", " 0", "-+", "#0", "-#" };
+static const int s_widths[] = { -1, 0, 1, 5, 12, 24 };
+static const int s_precs[] = { -1, 0, 1, 3, 7, 12 };   /* -1：不写精度 */
+
+/* 按 flags / width / prec 拼出说明符，conv 为长度修饰 + 转换符 */
+static void make_spec(char *out, size_t n, const char *flags, int width, int prec, const char *conv)
+{
+    char w[12] = "", p[12] = "";
+    if (width >= 0) snprintf(w, sizeof(w), "%d", width);
+    if (prec >= 0) snprintf(p, sizeof(p), ".%d", prec);
+    snprintf(out, n, "[%%%s%s%s%s]", flags, w, p, conv);
+}
+
+static void grid_integers(void)
+{
+    static const long long vals[] = { 0, 1, -1, 7, -42, 255, 4096, -32768, 65535, 2147483647LL, -2147483647LL - 1,
+                                      4294967295LL, 9223372036854775807LL, -9223372036854775807LL - 1 };
+    static const char *const convs[] = { "d", "i", "u", "x", "X", "o", "hd", "hhd", "hu", "hhx", "ld", "lu", "lx",
+                                         "lld", "llu", "llx", "llo", "zu", "zx", "jd", "jx" };
+    char fmt[32];
+    for (size_t f = 0; f < sizeof(s_flags) / sizeof(s_flags[0]); ++f)
+        for (size_t w = 0; w < sizeof(s_widths) / sizeof(s_widths[0]); ++w)
+            for (size_t p = 0; p < sizeof(s_precs) / sizeof(s_precs[0]); ++p)
+                for (size_t c = 0; c < sizeof(convs) / sizeof(convs[0]); ++c) {
+                    const char *conv = convs[c];
+                    /* 标志与转换不搭配时 glibc 行为未定义（如 %#d），只比较有定义的组合 */
+                    if (strchr(s_flags[f], '#') && strpbrk(conv, "xXo") == NULL) continue;
+                    make_spec(fmt, sizeof(fmt), s_flags[f], s_widths[w], s_precs[p], conv);
+                    const size_t len = strlen(conv);
+                    const int is_ll = (len >= 3 && conv[0] == 'l') || conv[0] == 'j';
+                    const int is_l = conv[0] == 'l' || conv[0] == 'z';
+                    for (size_t v = 0; v < sizeof(vals) / sizeof(vals[0]); ++v) {
+                        if (is_ll) CHECK(fmt, vals[v]);
+                        else if (is_l) CHECK(fmt, (long)vals[v]);
+                        else CHECK(fmt, (int)vals[v]);
+                    }
+                }
+}
+
+static void grid_misc(void)
+{
+    char fmt[32];
+    static const char *const strs[] = { "", "a", "FDC2214", "the quick brown fox" };
+    for (size_t f = 0; f < 2; ++f)   /* "" 与 "-"：其他标志对 %s / %c / %p 无定义 */
+        for (size_t w = 0; w < sizeof(s_widths) / sizeof(s_widths[0]); ++w) {
+            for (size_t p = 0; p < sizeof(s_precs) / sizeof(s_precs[0]); ++p) {
+                make_spec(fmt, sizeof(fmt), s_flags[f], s_widths[w], s_precs[p], "s");
+                for (size_t s = 0; s < sizeof(strs) / sizeof(strs[0]); ++s) CHECK(fmt, strs[s]);
+            }
+            make_spec(fmt, sizeof(fmt), s_flags[f], s_widths[w], -1, "c");
+            CHECK(fmt, 'Z');
+            make_spec(fmt, sizeof(fmt), s_flags[f], s_widths[w], -1, "p");
+            CHECK(fmt, (void *)&s_checks);
+        }
+
+    /* 宽度 / 精度用 * 传入：负宽度等价于 '-'，负精度等价于不写精度 */
+    for (int w = -12; w <= 12; w += 3)
+        for (int p = -1; p <= 6; ++p) {
+            CHECK("[%*.*d]", w, p, -1234);
+            CHECK("[%0*.*x]", w, p, 0xBEEFU);
+            CHECK("[%*.*s]", w, p, "telemetry");
+        }
+
+    CHECK("100%% %d%%", 5);
+    CHECK("CH%d raw=%lu BAD status=0x%04X\r\n", 3, 12345678UL, 0x0048U);
+    CHECK("%s=%u %s=%ld%c", "sps", 100U, "d", -17L, '!');
+    CHECK("no conversions");
+    CHECK("");
+}
+
+/* %k 与 glibc %f：fdc_fmt 按 len（0 int / 1 long / 2 long long）取整数 v，glibc 打印 v / 10^N */
+static void check_k(int line, const char *flags, int width, int prec, int len, long long v)
+{
+    static const char *const kconv[] = { "k", "lk", "llk" };
+    static const double scale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    char kfmt[32], ffmt[32], got[128], want[128];
+    make_spec(kfmt, sizeof(kfmt), flags, width, prec, kconv[len]);
+    int frac = (prec < 0) ? 0 : prec;
+    make_spec(ffmt, sizeof(ffmt), flags, width, frac, "f");
+
+    int got_n = (len == 2) ? fdc_fmt_snprintf(got, sizeof(got), kfmt, v)
+              : (len == 1) ? fdc_fmt_snprintf(got, sizeof(got), kfmt, (long)v)
+                           : fdc_fmt_snprintf(got, sizeof(got), kfmt, (int)v);
+    int want_n = snprintf(want, sizeof(want), ffmt, (double)v / scale[frac]);
+    ++s_checks;
+    if (got_n != want_n || strcmp(got, want) != 0) report_mismatch(line, kfmt, got, got_n, want, want_n);
+}
+
+static void grid_fixed_point(void)
+{
+    static const long long vals[] = { 0, 1, -1, 5, -5, 42, -999, 1000, 136042, -136042, 1000000007, 2147483647LL,
+                                      -2147483647LL - 1, 123456789012345LL, -4503599627370495LL };
+    static const char *const kflags[] = { "", "-", "0", "+", " ", "-0", "+0", " 0", "-+" };
+    static const int kprecs[] = { -1, 0, 1, 2, 3, 6, 9 };
+    for (size_t f = 0; f < sizeof(kflags) / sizeof(kflags[0]); ++f)
+        for (size_t w = 0; w < sizeof(s_widths) / sizeof(s_widths[0]); ++w)
+            for (size_t p = 0; p < sizeof(kprecs) / sizeof(kprecs[0]); ++p)
+                for (size_t v = 0; v < sizeof(vals) / sizeof(vals[0]); ++v) {
+                    const long long x = vals[v];
+                    if (x >= INT32_MIN && x <= INT32_MAX) {
+                        check_k(__LINE__, kflags[f], s_widths[w], kprecs[p], 0, x);
+                        check_k(__LINE__, kflags[f], s_widths[w], kprecs[p], 1, x);
+                    }
+                    check_k(__LINE__, kflags[f], s_widths[w], kprecs[p], 2, x);
+                }
+
+    /* 文档示例与固件实际用到的写法 */
+    CHECK_STR("136.042", "%.3k", 136042);
+    CHECK_STR("C=40.125 pF", "C=%.3lk pF", 40125L);
+    CHECK_STR("-0.050", "%.3k", -50);
+    CHECK_STR("12", "%k", 12);
+    /* 超出 double 精度的 64-bit 值 */
+    CHECK_STR("-9223372036854775.808", "%.3llk", (long long)INT64_MIN);
+    CHECK_STR("9223372036.854775807", "%.18llk", (long long)INT64_MAX);   /* N > 9 按 9 处理 */
+    CHECK_STR("9223372036.854775807", "%.9llk", (long long)INT64_MAX);
+    CHECK_STR("+00001.5", "%+08.1k", 15);
+    CHECK_STR("1.000000000", "%.*k", 12, 1000000000);
+}
+
+/* 截断：size 从 0 到完整长度 + 1，内容与返回值与 glibc 一致 */
+static void check_truncation(void)
+{
+    const char *fmt = "%5d|%-6s|%#x|%c";
+    char want_full[64];
+    const int full = snprintf(want_full, sizeof(want_full), fmt, -42, "ab", 0x1fU, 'q');
+    for (int size = 0; size <= full + 1; ++size) {
+        char got[64], want[64];
+        memset(got, 'X', sizeof(got));
+        memset(want, 'X', sizeof(want));
+        int got_n = fdc_fmt_snprintf(size ? got : NULL, (size_t)size, fmt, -42, "ab", 0x1fU, 'q');
+        int want_n = snprintf(size ? want : NULL, (size_t)size, fmt, -42, "ab", 0x1fU, 'q');
+        ++s_checks;
+        if (got_n != want_n || memcmp(got, want, sizeof(got)) != 0) {
+            if (s_fails++ < 20) printf("FAIL truncation size=%d: got %d, want %d\n", size, got_n, want_n);
+        }
+    }
+}
+
+int main(void)
+{
+    grid_integers();
+    grid_misc();
+    grid_fixed_point();
+    check_truncation();
+    printf("%d checks, %d mismatches\n%s\n", s_checks, s_fails, s_fails ? "FAIL" : "PASS");
+    return s_fails ? 1 : 0;
+}
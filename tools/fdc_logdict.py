@@ -0,0 +1,99 @@
+"""Extract the tokenized-log format dictionary from a firmware ELF (Core/Inc/fdc_log.h).
+
+Every tokenized fdc_debug_print call site stores its format string in the ELF
+section 'fdc_log_fmt'; the token sent on the wire is the string's offset in that
+section. This script lists the strings by offset and writes them as JSON:
+
+    {"section": "fdc_log_fmt", "entries": {"0": "fdc_init U%u OK\\r\\n", ...}}
+
+Command line (run as a POST_BUILD step when FDC_LOG_TOKENIZED is ON):
+    python fdc_logdict.py Pelma_DC-CAP.elf               # -> Pelma_DC-CAP.elf.logdict.json
+    python fdc_logdict.py fdc_sim -o logdict.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+SECTION = 'fdc_log_fmt'
+
+
+def read_section(path, name=SECTION):
+    """Return the raw contents of section `name` from a 32/64-bit ELF file."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'\x7fELF':
+        raise ValueError('%s: not an ELF file' % path)
+    is64 = data[4] == 2
+    e = '<' if data[5] == 1 else '>'
+    if is64:
+        shoff, = struct.unpack_from(e + 'Q', data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(e + 'HHH', data, 0x3A)
+        shdr = lambda i: struct.unpack_from(e + 'IIQQQQ', data, shoff + i * shentsize)
+    else:
+        shoff, = struct.unpack_from(e + 'I', data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(e + 'HHH', data, 0x2E)
+        shdr = lambda i: struct.unpack_from(e + 'IIIIII', data, shoff + i * shentsize)
+    # (name, type, flags, addr, offset, size)
+    strtab = shdr(shstrndx)
+    names = data[strtab[4]:strtab[4] + strtab[5]]
+    for i in range(shnum):
+        sh = shdr(i)
+        end = names.find(b'\0', sh[0])
+        if names[sh[0]:end].decode('ascii', 'replace') == name:
+            if sh[1] == 8:  # SHT_NOBITS
+                raise ValueError('%s: section %s has no contents' % (path, name))
+            return data[sh[4]:sh[4] + sh[5]]
+    raise ValueError('%s: no %s section (built without FDC_LOG_TOKENIZED?)' % (path, name))
+
+
+def parse_entries(blob):
+    """Split the section into {offset: format}; zero bytes between strings are alignment padding."""
+    entries = {}
+    i = 0
+    while i < len(blob):
+        if blob[i] == 0:
+            i += 1
+            continue
+        end = blob.find(b'\0', i)
+        if end < 0:
+            end = len(blob)
+        entries[i] = blob[i:end].decode('utf-8', 'replace')
+        i = end + 1
+    return entries
+
+
+def load(path):
+    """Load a dictionary from a .logdict.json file or directly from an ELF; returns {token: format}."""
+    with open(path, 'rb') as f:
+        magic = f.read(4)
+    if magic == b'\x7fELF':
+        return parse_entries(read_section(path))
+    with open(path, 'r', encoding='utf-8') as f:
+        doc = json.load(f)
+    return {int(k): v for k, v in doc['entries'].items()}
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description='Extract the tokenized log dictionary from an ELF')
+    ap.add_argument('elf')
+    ap.add_argument('-o', '--output', help='output JSON (default: <elf>.logdict.json)')
+    args = ap.parse_args(argv)
+
+    try:
+        entries = parse_entries(read_section(args.elf))
+    except ValueError as exc:
+        print('fdc_logdict: %s' % exc, file=sys.stderr)
+        return 1
+    out = args.output or args.elf + '.logdict.json'
+    with open(out, 'w', encoding='utf-8') as f:
+        json.dump({'section': SECTION, 'entries': {str(k): v for k, v in sorted(entries.items())}},
+                  f, indent=1, ensure_ascii=False)
+        f.write('\n')
+    print('fdc_logdict: %d formats -> %s' % (len(entries), out))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
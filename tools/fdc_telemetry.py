@@ -0,0 +1,345 @@
+"""Decoder for the FDC2214 binary telemetry stream (Core/Inc/fdc_telemetry.h).
+
+Frame: 0x00 | COBS(payload | crc16_le[2]) | 0x00, payload[0] >> 4 is the type:
+  1  sample (24-byte payload)
+  2  tokenized log record (Core/Inc/fdc_log.h), expanded with a dictionary
+     produced by fdc_logdict.py
+  3  LRA sweep point / result (Core/Inc/lra_sweep.h)
+Text printed by the firmware on the same UART contains no 0x00, so any chunk
+between delimiters that is not a valid frame is passed through as text.
+
+Library use:
+    dec = StreamDecoder()
+    logdict = fdc_logdict.load('Pelma_DC-CAP.elf.logdict.json')
+    for kind, item in dec.feed(data):
+        if kind == 'sample': print(item.dev, item.seq, item.raw)
+        elif kind == 'log': print(format_log(logdict, item))
+        elif kind == 'sweep': print(format_sweep(item))
+        else: print('text:', item)
+
+Command line:
+    python fdc_telemetry.py capture.bin            # decode a file
+    fdc_sim -q ... | python fdc_telemetry.py -      # decode stdin
+    python fdc_telemetry.py --serial COM5           # live (needs pyserial)
+    python fdc_telemetry.py --dict fdc_sim.logdict.json -    # expand log records
+Prints one CSV line per sample, text, log and sweep lines prefixed with '#' (sweep
+amplitudes also in dB relative to the first point), and a summary
+(frames, CRC errors, sequence gaps per device) on stderr at the end.
+"""
+
+import argparse
+import math
+import os
+import re
+import struct
+import sys
+from collections import namedtuple
+
+TYPE_SAMPLE = 0x1
+TYPE_LOG = 0x2
+TYPE_SWEEP = 0x3
+SAMPLE_PAYLOAD = 24
+SWEEP_POINT_PAYLOAD = 16
+SWEEP_RESULT_PAYLOAD = 20
+SWEEP_SRC_ADC = 0xF
+SWEEP_PHASE_INVALID = -0x8000
+
+Sample = namedtuple('Sample', 'dev seq tick_ms raw active_mask valid_mask status')
+LogRecord = namedtuple('LogRecord', 'token args')
+# amp: response amplitude in sample counts, phase_deg: response relative to the drive fundamental;
+# both are None for a point whose lock-in solve failed (LRA_SWEEP_PHASE_INVALID)
+SweepPoint = namedtuple('SweepPoint', 'src index freq_hz amp phase_deg n')
+# bw_hz / q are None when a -3 dB point fell outside the sweep range
+SweepResult = namedtuple('SweepResult', 'src points f0_hz amp phase_deg bw_hz q')
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, same as fdc_tlm_crc16()."""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    """Decode one COBS block (without the trailing 0x00); raises ValueError."""
+    out = bytearray()
+    i = 0
+    n = len(data)
+    while i < n:
+        code = data[i]
+        if code == 0 or i + code > n:
+            raise ValueError('bad COBS block')
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < n:
+            out.append(0)
+    return bytes(out)
+
+
+def unpack_raw28(b):
+    lo = int.from_bytes(b[0:7], 'little')
+    hi = int.from_bytes(b[7:14], 'little')
+    m = 0x0FFFFFFF
+    return (lo & m, (lo >> 28) & m, hi & m, (hi >> 28) & m)
+
+
+def read_varint(data, i):
+    """Return (value, next index); raises IndexError on truncated input."""
+    v = shift = 0
+    while True:
+        b = data[i]
+        i += 1
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return v, i
+
+
+def parse_payload(p):
+    """Parse a CRC-checked payload into a Sample, LogRecord or sweep record; None for unknown types."""
+    if len(p) >= 2 and (p[0] >> 4) == TYPE_SWEEP:
+        return parse_sweep(p)
+    if len(p) >= 2 and (p[0] >> 4) == TYPE_LOG:
+        try:
+            token, i = read_varint(p, 1)
+        except IndexError:
+            return None
+        return LogRecord(token=token, args=bytes(p[i:]))
+    if len(p) != SAMPLE_PAYLOAD or (p[0] >> 4) != TYPE_SAMPLE:
+        return None
+    seq, tick = struct.unpack_from('<HI', p, 1)
+    status, = struct.unpack_from('<H', p, 22)
+    return Sample(dev=p[0] & 0x0F, seq=seq, tick_ms=tick, raw=unpack_raw28(p[7:21]),
+                  active_mask=p[21] >> 4, valid_mask=p[21] & 0x0F, status=status)
+
+
+def parse_sweep(p):
+    src = p[0] & 0x0F
+    if p[1] == 0 and len(p) == SWEEP_POINT_PAYLOAD:
+        idx, f, amp, ph, n = struct.unpack_from('<HIIhH', p, 2)
+        if ph == SWEEP_PHASE_INVALID:
+            return SweepPoint(src=src, index=idx, freq_hz=f / 1000.0, amp=None, phase_deg=None, n=n)
+        return SweepPoint(src=src, index=idx, freq_hz=f / 1000.0, amp=amp / 256.0, phase_deg=ph / 10.0, n=n)
+    if p[1] == 1 and len(p) == SWEEP_RESULT_PAYLOAD:
+        pts, f0, amp, bw, q, ph = struct.unpack_from('<HIIIHh', p, 2)
+        return SweepResult(src=src, points=pts, f0_hz=f0 / 1000.0, amp=amp / 256.0, phase_deg=ph / 10.0,
+                           bw_hz=bw / 1000.0 if bw else None, q=q / 100.0 if q else None)
+    return None
+
+
+def format_sweep(rec, ref_amp=None):
+    """One text line for a sweep record; dB is relative to ref_amp (e.g. the first point)."""
+    src = 'ADC1' if rec.src == SWEEP_SRC_ADC else 'U%d CH%d' % (rec.src >> 2, rec.src & 3)
+    db = ''
+    if ref_amp and rec.amp:
+        db = ' %+.2f dB' % (20.0 * math.log10(rec.amp / ref_amp))
+    if isinstance(rec, SweepPoint) and rec.amp is None:
+        return 'sweep %s #%d f=%.3f Hz invalid n=%d' % (src, rec.index + 1, rec.freq_hz, rec.n)
+    if isinstance(rec, SweepPoint):
+        return 'sweep %s #%d f=%.3f Hz amp=%.2f%s ph=%.1f deg n=%d' % (
+            src, rec.index + 1, rec.freq_hz, rec.amp, db, rec.phase_deg, rec.n)
+    tail = 'bw=%.3f Hz Q=%.2f' % (rec.bw_hz, rec.q) if rec.bw_hz else '-3 dB points outside range'
+    return 'sweep %s peak f0=%.3f Hz amp=%.2f%s ph=%.1f deg %s' % (
+        src, rec.f0_hz, rec.amp, db, rec.phase_deg, tail)
+
+
+# printf conversion: flags, width, precision, length, conversion
+_CONV = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXcsfFeEgGpk%])')
+# integer width on the target (Cortex-M3: int/long/size_t 32 bit)
+_INT_BITS = {'hh': 8, 'h': 16, 'll': 64, 'j': 64}
+
+
+def format_fixed(flags, width, prec, v):
+    """%.Nk of Core/Inc/fdc_fmt.h: integer v scaled by 10^N, printed with N decimals."""
+    n = min(int(prec or 0), 9)
+    sign = '-' if v < 0 else '+' if '+' in flags else ' ' if ' ' in flags else ''
+    q, r = divmod(abs(v), 10 ** n)
+    body = '%d.%0*d' % (q, n, r) if n else '%d' % q
+    w = int(width or 0) - len(sign)
+    if '-' in flags:
+        return (sign + body).ljust(w + len(sign))
+    if '0' in flags:
+        return sign + body.rjust(w, '0')
+    return (sign + body).rjust(w + len(sign))
+
+
+def format_log(logdict, rec):
+    """Expand a LogRecord with {token: format}; arguments follow the encoding in fdc_log.h."""
+    fmt = logdict.get(rec.token)
+    if fmt is None:
+        return '[log token %d: %s]' % (rec.token, rec.args.hex())
+    data, i, out, pos = rec.args, 0, [], 0
+    for m in _CONV.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        spec = '%' + flags + width + ('.' + prec if prec is not None else '')
+        try:
+            if conv in 'fFeEgG':
+                v, = struct.unpack_from('<f', data, i)
+                i += 4
+                out.append((spec + conv) % v)
+            elif conv == 's':
+                n, i = read_varint(data, i)
+                if i + n > len(data):
+                    raise IndexError
+                out.append((spec + 's') % data[i:i + n].decode('utf-8', 'replace'))
+                i += n
+            else:
+                z, i = read_varint(data, i)
+                v = (z >> 1) ^ -(z & 1)
+                bits = _INT_BITS.get(length, 32)
+                v &= (1 << bits) - 1
+                if conv in 'dik':
+                    if v >> (bits - 1):
+                        v -= 1 << bits
+                    out.append(format_fixed(flags, width, prec, v) if conv == 'k' else (spec + 'd') % v)
+                elif conv == 'c':
+                    out.append((spec + 'c') % chr(v & 0xFF))
+                elif conv == 'p':
+                    out.append('0x%08X' % v)
+                else:
+                    out.append((spec + ('d' if conv == 'u' else conv)) % v)
+        except (IndexError, struct.error):
+            out.append('<?>')
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode_frame(chunk):
+    """Decode one chunk between delimiters; returns Sample, LogRecord, a sweep record or None."""
+    try:
+        body = cobs_decode(chunk)
+    except ValueError:
+        return None
+    if len(body) < 3 or crc16_ccitt(body[:-2]) != int.from_bytes(body[-2:], 'little'):
+        return None
+    return parse_payload(body[:-2])
+
+
+class StreamDecoder:
+    """Incremental decoder: feed() arbitrary byte slices, get samples and text back."""
+
+    def __init__(self):
+        self._buf = bytearray()
+        self.frames = 0
+        self.crc_errors = 0
+        self.gaps = {}        # dev -> missing samples inferred from seq
+        self._last_seq = {}
+
+    def feed(self, data):
+        self._buf += data
+        out = []
+        while True:
+            idx = self._buf.find(0)
+            if idx < 0:
+                break
+            chunk = bytes(self._buf[:idx])
+            del self._buf[:idx + 1]
+            if not chunk:
+                continue
+            item = decode_frame(chunk)
+            if isinstance(item, Sample):
+                self._account(item)
+                out.append(('sample', item))
+            elif isinstance(item, LogRecord):
+                self.frames += 1
+                out.append(('log', item))
+            elif isinstance(item, (SweepPoint, SweepResult)):
+                self.frames += 1
+                out.append(('sweep', item))
+            elif self._looks_binary(chunk):
+                self.crc_errors += 1
+            else:
+                out.append(('text', chunk.decode('ascii', 'replace')))
+        return out
+
+    def flush(self):
+        """Return trailing bytes after the last delimiter as text (end of capture)."""
+        rest, self._buf = bytes(self._buf), bytearray()
+        return [('text', rest.decode('ascii', 'replace'))] if rest else []
+
+    def _account(self, smp):
+        self.frames += 1
+        last = self._last_seq.get(smp.dev)
+        if last is not None:
+            missing = (smp.seq - last - 1) & 0xFFFF
+            if missing:
+                self.gaps[smp.dev] = self.gaps.get(smp.dev, 0) + missing
+        self._last_seq[smp.dev] = smp.seq
+
+    @staticmethod
+    def _looks_binary(chunk):
+        return any(b >= 0x80 or (b < 0x20 and b not in (9, 10, 13)) for b in chunk)
+
+
+def _open_input(args):
+    if args.serial:
+        import serial  # pyserial
+        port = serial.Serial(args.serial, args.baud, timeout=0.1)
+        return lambda: port.read(4096) or b''
+    f = sys.stdin.buffer if args.file in (None, '-') else open(args.file, 'rb')
+    return lambda: f.read1(4096) if hasattr(f, 'read1') else f.read(4096)
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description='Decode FDC2214 binary telemetry')
+    ap.add_argument('file', nargs='?', help="capture file, '-' for stdin")
+    ap.add_argument('--serial', help='serial port (requires pyserial)')
+    ap.add_argument('--baud', type=int, default=115200)
+    ap.add_argument('--no-text', action='store_true', help='hide interleaved text and log lines')
+    ap.add_argument('--dict', help='log dictionary (.logdict.json or the ELF itself)')
+    args = ap.parse_args(argv)
+
+    logdict = {}
+    if args.dict:
+        sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+        import fdc_logdict
+        logdict = fdc_logdict.load(args.dict)
+
+    read = _open_input(args)
+    dec = StreamDecoder()
+    sweep_ref = None
+    print('dev,seq,tick_ms,raw0,raw1,raw2,raw3,active,valid,status')
+    try:
+        while True:
+            data = read()
+            if not data:
+                if args.serial:
+                    continue
+                break
+            for kind, item in dec.feed(data):
+                if kind == 'sample':
+                    print('%d,%d,%d,%d,%d,%d,%d,0x%X,0x%X,0x%04X' % (
+                        item.dev, item.seq, item.tick_ms, *item.raw,
+                        item.active_mask, item.valid_mask, item.status))
+                elif kind == 'sweep':
+                    if isinstance(item, SweepPoint) and (item.index == 0 or sweep_ref is None):
+                        sweep_ref = item.amp   # first valid point of the sweep
+                    if not args.no_text:
+                        print('# ' + format_sweep(item, sweep_ref))
+                elif not args.no_text:
+                    if kind == 'log':
+                        item = format_log(logdict, item)
+                    for line in item.splitlines():
+                        if line.strip():
+                            print('# ' + line)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for _, text in dec.flush():
+            if not args.no_text and text.strip():
+                print('# ' + text.strip())
+        gaps = ' '.join('U%d=%d' % kv for kv in sorted(dec.gaps.items())) or 'none'
+        print('frames=%d crc_errors=%d seq_gaps: %s' % (dec.frames, dec.crc_errors, gaps), file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())